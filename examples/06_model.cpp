@@ -209,33 +209,41 @@ bool recordCommandBuffer(
 	// Dynamic state
 	vkCmdSetCullMode(cmdBuf, vtek::get_cull_mode(gCullMode));
 
-	// Bind vertex buffer for model
-	VkBuffer buffers[2] = {
-		vtek::buffer_get_handle(vtek::model_get_vertex_buffer(model)),
-		vtek::buffer_get_handle(vtek::model_get_normal_buffer(model))
-	};
-	VkDeviceSize offsets[2] = { 0, 0 };
-	vkCmdBindVertexBuffers(cmdBuf, 0, 2, buffers, offsets);
-
-	// Bind descriptor set for the pipeline:
-	// m4 push constant, m4 uniform
-	VkDescriptorSet descriptorSetHandles[2] = {
-		vtek::descriptor_set_get_handle(descriptorSets[0]),
-		vtek::descriptor_set_get_handle(descriptorSets[1]),
-	};
-	vkCmdBindDescriptorSets(
-		cmdBuf, VK_PIPELINE_BIND_POINT_GRAPHICS, pipLayout, 0, 2,
-		descriptorSetHandles, 0, nullptr); // NOTE: Dynamic offset unused
-
-	// Push constant for the model, ie. transformation matrix
-	vtek::PushConstant_m4 pc{};
-	pc.m1 = glm::mat4(1.0f); // unit matrix
-	vtek::cmd_push_constant_graphics(
-		commandBuffer, pipeline, &pc, vtek::ShaderStageGraphics::vertex);
-
-	// Draw the model
-	uint32_t numVertices = vtek::model_get_num_vertices(model);
-	vkCmdDraw(cmdBuf, numVertices, 1, 0, 0);
+	// The model is loaded in the background, and frames are cleared and
+	// presented as usual until it is ready to be drawn.
+	if (vtek::model_is_ready(model))
+	{
+		// Bind vertex buffer for model
+		VkBuffer buffers[2] = {
+			vtek::buffer_get_handle(vtek::model_get_vertex_buffer(model)),
+			vtek::buffer_get_handle(vtek::model_get_normal_buffer(model))
+		};
+		VkDeviceSize offsets[2] = { 0, 0 };
+		vkCmdBindVertexBuffers(cmdBuf, 0, 2, buffers, offsets);
+
+		// Bind descriptor set for the pipeline:
+		// m4 push constant, m4 uniform
+		VkDescriptorSet descriptorSetHandles[2] = {
+			vtek::descriptor_set_get_handle(descriptorSets[0]),
+			vtek::descriptor_set_get_handle(descriptorSets[1]),
+		};
+		vkCmdBindDescriptorSets(
+			cmdBuf, VK_PIPELINE_BIND_POINT_GRAPHICS, pipLayout, 0, 2,
+			descriptorSetHandles, 0, nullptr); // NOTE: Dynamic offset unused
+
+		// Push constant for the model, ie. transformation matrix
+		vtek::PushConstant_m4 pc{};
+		pc.m1 = glm::mat4(1.0f); // unit matrix
+		vtek::cmd_push_constant_graphics(
+			commandBuffer, pipeline, &pc, vtek::ShaderStageGraphics::vertex);
+
+		// Draw the model
+		vtek::cmd_bind_index_buffer(
+			commandBuffer, vtek::model_get_index_buffer(model), 0,
+			vtek::model_get_index_type(model));
+		uint32_t numIndices = vtek::model_get_num_indices(model);
+		vtek::cmd_draw_indexed(commandBuffer, numIndices);
+	}
 
 	vtek::swapchain_dynamic_rendering_end(swapchain, imageIndex, commandBuffer);
 
@@ -438,13 +446,11 @@ int main()
 	vtek::ModelInfo modelInfo{};
 	modelInfo.keepVertexDataInMemory = false; // Preferred usage
 	modelInfo.loadNormals = true;
-	vtek::Model* model = vtek::model_load_obj(
-		&modelInfo, modeldir, "car_tutorial.obj", device);
-	if (model == nullptr)
-	{
-		log_error("Failed to load obj model!");
-		return -1;
-	}
+	vtek::Model* model = vtek::model_load_async(
+		&modelInfo, modeldir, "car_tutorial.obj", device,
+		[](vtek::Model*, bool success) {
+			if (!success) { log_error("Failed to load obj model!"); }
+		});
 
 	// Descriptor pool
 	vtek::DescriptorPoolInfo descriptorPoolInfo{};
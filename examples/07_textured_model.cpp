@@ -212,8 +212,11 @@ bool recordCommandBuffer(
 		commandBuffer, pipeline, &pc, vtek::ShaderStageGraphics::vertex);
 
 	// Draw the model
-	uint32_t numVertices = vtek::model_get_num_vertices(model);
-	vkCmdDraw(cmdBuf, numVertices, 1, 0, 0);
+	vtek::cmd_bind_index_buffer(
+		commandBuffer, vtek::model_get_index_buffer(model), 0,
+		vtek::model_get_index_type(model));
+	uint32_t numIndices = vtek::model_get_num_indices(model);
+	vtek::cmd_draw_indexed(commandBuffer, numIndices);
 
 	vtek::swapchain_dynamic_rendering_end(swapchain, imageIndex, commandBuffer);
 
@@ -220,8 +220,11 @@ bool recordCommandBuffer(
 	pc.m1 = glm::mat4(1.0f); // unit matrix
 	vtek::cmd_push_constant_graphics(
 		commandBuffer, info->mainPipeline, &pc, vtek::ShaderStageGraphics::vertex);
-	uint32_t numVertices = vtek::model_get_num_vertices(model);
-	vtek::cmd_draw_vertices(commandBuffer, numVertices);
+	vtek::cmd_bind_index_buffer(
+		commandBuffer, vtek::model_get_index_buffer(model), 0,
+		vtek::model_get_index_type(model));
+	uint32_t numIndices = vtek::model_get_num_indices(model);
+	vtek::cmd_draw_indexed(commandBuffer, numIndices);
 
 	// 5) end dynamic rendering on the framebuffer
 	vtek::framebuffer_dynamic_rendering_end(framebuffer, commandBuffer);
@@ -27,25 +27,37 @@
 
 #include "vtek_application_window.hpp"
 #include "vtek_allocator.hpp"
+#include "vtek_barrier_batch.hpp"
+#include "vtek_bindless_table.hpp"
 #include "vtek_buffer.hpp"
 #include "vtek_camera.hpp"
 #include "vtek_command_buffer.hpp"
 #include "vtek_command_pool.hpp"
 #include "vtek_commands.hpp"
+#include "vtek_culling.hpp"
+#include "vtek_descriptor_allocator.hpp"
 #include "vtek_descriptor_pool.hpp"
 #include "vtek_descriptor_set.hpp"
 #include "vtek_descriptor_set_layout.hpp"
+#include "vtek_descriptor_update_template.hpp"
 #include "vtek_device.hpp"
 #include "vtek_format_support.hpp"
+#include "vtek_geometry_arena.hpp"
 #include "vtek_framebuffer.hpp"
+#include "vtek_gpu_profiler.hpp"
 #include "vtek_graphics_pipeline.hpp"
 #include "vtek_image.hpp"
+#include "vtek_indirect_draw_buffer.hpp"
 #include "vtek_input.hpp"
 #include "vtek_instance.hpp"
+#include "vtek_instance_buffer.hpp"
 #include "vtek_logging.hpp"
 #include "vtek_models.hpp"
+#include "vtek_query_pool.hpp"
 #include "vtek_queue.hpp"
+#include "vtek_render_graph.hpp"
 #include "vtek_render_pass.hpp"
+#include "vtek_render_queue.hpp"
 #include "vtek_physical_device.hpp"
 #include "vtek_push_constants.hpp"
 #include "vtek_sampler.hpp"
@@ -53,4 +65,5 @@
 #include "vtek_submit_info.hpp"
 #include "vtek_swapchain.hpp"
 #include "vtek_uniform_data.hpp"
+#include "vtek_uniform_ring.hpp"
 #include "vtek_vertex_data.hpp"
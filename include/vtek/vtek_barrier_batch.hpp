@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstdint>
+
+#include "vtek_object_handles.hpp"
+
+
+namespace vtek
+{
+	// ===================== //
+	// === Barrier batch === //
+	// ===================== //
+
+	// How an image is about to be accessed. Each access type implies an
+	// image layout, the pipeline stages accessing the image, and whether
+	// the access writes to it.
+	enum class ImageAccessType
+	{
+		color_attachment_write,         // color_attachment_optimal
+		depth_stencil_attachment_write, // depth_stencil_attachment_optimal
+		depth_stencil_attachment_read,  // depth_stencil_readonly_optimal
+		vertex_shader_read,             // shader_readonly_optimal
+		fragment_shader_read,           // shader_readonly_optimal
+		compute_shader_read,            // shader_readonly_optimal
+		any_shader_read,                // shader_readonly_optimal
+		compute_shader_write,           // general, for storage images
+		transfer_src,                   // transfer_src_optimal
+		transfer_dst,                   // transfer_dst_optimal
+		present,                        // present_src_khr
+		general                         // general, any stage may read or write
+	};
+
+	// How a buffer is about to be accessed by the device. Buffers written
+	// by the host, e.g. uniform rings, need no barriers and are not tracked.
+	enum class BufferAccessType
+	{
+		vertex_input_read,    // vertex and index buffers
+		indirect_read,        // indirect draw and dispatch parameters
+		vertex_shader_read,   // uniform or storage reads
+		fragment_shader_read, // uniform or storage reads
+		compute_shader_read,  // uniform or storage reads
+		any_shader_read,      // uniform or storage reads
+		compute_shader_write, // storage writes
+		transfer_src,
+		transfer_dst,
+		general               // any stage may read or write
+	};
+
+	bool image_access_is_write(ImageAccessType access);
+	bool buffer_access_is_write(BufferAccessType access);
+
+	// Range of mip levels and array layers. By default the whole image.
+	struct ImageSubresourceRange
+	{
+		uint32_t baseMipLevel {0U};
+		uint32_t numMipLevels {UINT32_MAX};
+		uint32_t baseArrayLayer {0U};
+		uint32_t numArrayLayers {UINT32_MAX};
+	};
+
+	// A barrier batch collects image and buffer barriers and records them
+	// with a single pipeline barrier command. Every `Image2D` tracks the
+	// layout and the last accesses of each of its mip levels and array
+	// layers, and every `Buffer` its last accesses, so only the new access
+	// needs to be given, and barriers are only added when there is a
+	// hazard: a layout change, a write, or a read of data not yet made
+	// visible to the reading stages.
+	//
+	// With `PhysicalDeviceInfo::requireSynchronization2` enabled, the batch
+	// is recorded with `vkCmdPipelineBarrier2`, with exact stage masks for
+	// each barrier. Otherwise it falls back to a single `vkCmdPipelineBarrier`
+	// with the union of all stage masks.
+	//
+	// Typical usage:
+	//   barrier_batch_image(batch, gbufferAlbedo, ImageAccessType::fragment_shader_read);
+	//   barrier_batch_image(batch, gbufferNormal, ImageAccessType::fragment_shader_read);
+	//   barrier_batch_image(batch, hdrTarget, ImageAccessType::color_attachment_write, true);
+	//   barrier_batch_flush(batch, commandBuffer);
+	//
+	// NOTE: A subresource should be added at most once before each flush,
+	// since barriers in the same command are not ordered with each other.
+	BarrierBatch* barrier_batch_create(Device* device);
+	void barrier_batch_destroy(BarrierBatch* batch);
+
+	// Add a transition of the image (or part of it) into the given access.
+	// If `discardContents` is true, the previous contents are not preserved,
+	// which lets the driver skip work, e.g. before clearing an attachment.
+	void barrier_batch_image(
+		BarrierBatch* batch, Image2D* image, ImageAccessType access,
+		bool discardContents = false, const ImageSubresourceRange* range = nullptr);
+
+	// Add a barrier for the whole buffer, before the given access.
+	void barrier_batch_buffer(BarrierBatch* batch, Buffer* buffer, BufferAccessType access);
+
+	// Record all collected barriers into the command buffer. Does nothing
+	// if no barriers were needed.
+	void barrier_batch_flush(BarrierBatch* batch, CommandBuffer* commandBuffer);
+
+	uint32_t barrier_batch_get_num_pending(BarrierBatch* batch);
+
+	// Forget all tracked state for the image or buffer, e.g. after it has
+	// been used by commands outside of vtek's tracking. The next barrier
+	// then starts from an undefined layout, and the contents are discarded.
+	void image2d_reset_tracked_state(Image2D* image);
+	void buffer_reset_tracked_state(Buffer* buffer);
+}
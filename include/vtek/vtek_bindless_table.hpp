@@ -0,0 +1,91 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+
+#include "vtek_image.hpp"
+#include "vtek_object_handles.hpp"
+#include "vtek_shaders.hpp"
+#include "vtek_types.hpp"
+
+
+namespace vtek
+{
+	// ======================= //
+	// === Bindless tables === //
+	// ======================= //
+
+	// A bindless table is one large descriptor set, containing arrays of
+	// sampled images, samplers, and storage buffers. Resources are registered
+	// into the table once, and receive a stable index which shaders use for
+	// looking them up, typically passed along with push constants. This way
+	// the descriptor set is bound once per frame, instead of once per draw.
+	//
+	// The descriptor set layout is:
+	//   binding 0: `texture2D  images[]`  (sampled images)
+	//   binding 1: `sampler    samplers[]`
+	//   binding 2: storage buffers, `buffer Xyz { ... } buffers[]`
+	// All bindings are update-after-bind and partially bound, so only the
+	// indices that were registered need to be valid.
+	//
+	// NOTE: Requires `DeviceInfo::enableBindlessTextureSupport` during device
+	// creation, and hence Vulkan >= 1.2.
+
+	// Returned when a resource could not be registered.
+	constexpr uint32_t kBindlessInvalidIndex = UINT32_MAX;
+
+	struct BindlessTableInfo
+	{
+		// Capacity of each array. These are clamped to the device limits
+		// for update-after-bind descriptors.
+		uint32_t maxSampledImages {4096U};
+		uint32_t maxSamplers {64U};
+		uint32_t maxStorageBuffers {1024U};
+
+		// In which shader stages the table should be visible.
+		EnumBitmask<ShaderStage> shaderStages {ShaderStage::all};
+
+		// A released index is not handed out again before this many frames
+		// have passed, so that frames still in flight on the GPU may keep
+		// reading the old descriptor. Should match the number of frames in
+		// flight for the swapchain.
+		uint32_t numFramesInFlight {2U};
+	};
+
+	BindlessTable* bindless_table_create(
+		const BindlessTableInfo* info, Device* device);
+	void bindless_table_destroy(BindlessTable* table, Device* device);
+
+	// The layout should be added to the graphics pipeline, and the set bound
+	// once per frame with e.g. `cmd_bind_descriptor_set_graphics`.
+	DescriptorSetLayout* bindless_table_get_layout(BindlessTable* table);
+	DescriptorSet* bindless_table_get_set(BindlessTable* table);
+
+	// Call this once per frame, after waiting for the frame's in-flight fence
+	// (e.g. after `swapchain_wait_begin_frame`). Indices released long enough
+	// ago become available for new registrations.
+	void bindless_table_begin_frame(BindlessTable* table);
+
+	// Write all registrations made since the last call into the descriptor
+	// set. Since the table is update-after-bind, this may be done while the
+	// set is bound in a command buffer, but it must happen before that
+	// command buffer is submitted.
+	void bindless_table_update(BindlessTable* table, Device* device);
+
+
+	// === Registration === //
+	uint32_t bindless_table_register_image(
+		BindlessTable* table, Image2D* image,
+		ImageLayout layout = ImageLayout::shader_readonly_optimal);
+	uint32_t bindless_table_register_sampler(
+		BindlessTable* table, Sampler* sampler);
+	uint32_t bindless_table_register_storage_buffer(
+		BindlessTable* table, Buffer* buffer);
+
+	// Releasing an index does not touch the descriptor, which is fine since
+	// the arrays are partially bound. The index is recycled after
+	// `numFramesInFlight` frames.
+	void bindless_table_release_image(BindlessTable* table, uint32_t index);
+	void bindless_table_release_sampler(BindlessTable* table, uint32_t index);
+	void bindless_table_release_storage_buffer(BindlessTable* table, uint32_t index);
+}
@@ -48,6 +48,12 @@ namespace vtek
 		// CPU/GPU, but is slower for the GPU to read.
 		bool requireHostVisibleStorage {false};
 
+		// Only used with `requireHostVisibleStorage`. If the host reads from
+		// the buffer, e.g. for readback of GPU results, then host-cached memory
+		// is preferred, which is much faster for the CPU to read from than the
+		// uncached memory used for uploads.
+		bool preferHostCachedStorage {false};
+
 		// If set, the buffer will not internally create a staging buffer, even
 		// when its contents is overwritten often. This may be used to prevent
 		// additional staging memory usage, or if several buffers share the same
@@ -85,7 +91,7 @@ namespace vtek
 	// TODO: Alternative buffer creation, using a specific allocator
 	Buffer* buffer_create(const BufferInfo* info, Allocator* allocator);
 
-	// TODO: If a buffer is host visible it can be directly memory-mapped.
+	// If a buffer is host visible it can be directly memory-mapped.
 	bool buffer_is_host_visible(Buffer* buffer);
 
 	// TODO: View into the buffer for binding purposes (SRV,UAV,VB,etc.)
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <vulkan/vulkan.h>
+
 #include "vtek_object_handles.hpp"
 
 
@@ -46,6 +48,30 @@ namespace vtek
 	bool command_scheduler_submit_transfer(
 		CommandScheduler* scheduler, CommandBuffer* commandBuffer, Device* device);
 
+	// Submit a single-use transfer command buffer without waiting for it to
+	// finish. Instead a fence is signaled once the transfer has completed.
+	// Every successful submission must be finished with
+	// `command_scheduler_wait_transfer`, which waits on the fence and frees
+	// both the fence and the command buffer.
+	struct TransferSubmission
+	{
+		CommandBuffer* commandBuffer {nullptr};
+		VkFence fence {VK_NULL_HANDLE};
+	};
+
+	bool command_scheduler_submit_transfer_async(
+		CommandScheduler* scheduler, CommandBuffer* commandBuffer,
+		TransferSubmission* outSubmission, Device* device);
+
+	// Non-blocking check if the transfer has completed.
+	bool command_scheduler_transfer_is_complete(
+		const TransferSubmission* submission, Device* device);
+
+	// Wait for the transfer to complete, and release it. Returns false if
+	// the wait failed, e.g. on device loss.
+	bool command_scheduler_wait_transfer(
+		CommandScheduler* scheduler, TransferSubmission* submission, Device* device);
+
 	// Obtain a handle to the transfer queue used by the command scheduler
 	// for issuing transfer operations.
 	Queue* command_scheduler_get_transfer_queue(CommandScheduler* scheduler);
@@ -2,6 +2,7 @@
 
 #include <vulkan/vulkan.h>
 
+#include "vtek_descriptor_update_template.hpp"
 #include "vtek_image.hpp"
 #include "vtek_object_handles.hpp"
 #include "vtek_push_constants.hpp"
@@ -17,6 +18,9 @@ namespace vtek
 
 	// It is optional to specify queues, and only needed if the image
 	// should have transferred queue ownership.
+	// NOTE: Only the first mip level and array layer is transitioned. For
+	// whole images, and for batching several transitions into one barrier
+	// command, prefer `BarrierBatch`, which also tracks the old layout.
 	struct ImageLayoutTransitionCmdInfo
 	{
 		Image2D* image {nullptr};
@@ -53,17 +57,78 @@ namespace vtek
 		CommandBuffer* commandBuffer, GraphicsPipeline* pipeline,
 		IPushConstant* pushConstant, EnumBitmask<ShaderStageGraphics> stages);
 
+	// Same as above, with push constant data given as raw bytes.
+	void cmd_push_constant_graphics(
+		CommandBuffer* commandBuffer, GraphicsPipeline* pipeline,
+		const void* data, uint32_t size, EnumBitmask<ShaderStageGraphics> stages);
+
 	// ========================= //
 	// === Resource bindings === //
 	// ========================= //
 	void cmd_bind_vertex_buffer(
 		CommandBuffer* commandBuffer, Buffer* buffer, uint64_t offset);
-	void cmd_bind_vertex_buffers();
+
+	// Bind several vertex buffers to consecutive bindings, starting at
+	// `firstBinding`, in a single call. `offsets` may be nullptr, in which
+	// case all buffers are bound from their beginning. Typically used for
+	// binding the separate attribute streams of a model together with a
+	// per-instance buffer.
+	void cmd_bind_vertex_buffers(
+		CommandBuffer* commandBuffer, uint32_t firstBinding,
+		const Buffer* const* buffers, const uint64_t* offsets, uint32_t numBuffers);
+
+	// Bind an index buffer for subsequent indexed draw commands. The buffer
+	// must have been created with the `index_buffer` usage flag.
+	void cmd_bind_index_buffer(
+		CommandBuffer* commandBuffer, const Buffer* buffer, uint64_t offset,
+		IndexType indexType);
 
 	void cmd_bind_descriptor_set_graphics(
 		CommandBuffer* commandBuffer, GraphicsPipeline* pipeline,
 		DescriptorSet* descriptorSet);
 
+	// Bind a descriptor set containing dynamic uniform/storage buffers. One
+	// offset must be given for each dynamic descriptor in the set, ordered by
+	// binding number, and each offset must be a multiple of the device's
+	// minimum uniform/storage buffer offset alignment.
+	void cmd_bind_descriptor_set_graphics(
+		CommandBuffer* commandBuffer, GraphicsPipeline* pipeline,
+		DescriptorSet* descriptorSet,
+		const uint32_t* dynamicOffsets, uint32_t numDynamicOffsets);
+
+	// Bind a descriptor set at the given set index, for pipeline layouts
+	// with more than one descriptor set layout.
+	void cmd_bind_descriptor_set_graphics(
+		CommandBuffer* commandBuffer, GraphicsPipeline* pipeline,
+		uint32_t set, DescriptorSet* descriptorSet,
+		const uint32_t* dynamicOffsets = nullptr, uint32_t numDynamicOffsets = 0);
+
+	// Push descriptors (VK_KHR_push_descriptor) into the command buffer at the
+	// given set index, which must correspond to a layout created with the
+	// `pushDescriptor` flag. The descriptor writes recorded into `writes`
+	// (see `descriptor_set_create_push`) are consumed by this call.
+	void cmd_push_descriptor_set_graphics(
+		CommandBuffer* commandBuffer, GraphicsPipeline* pipeline,
+		uint32_t set, DescriptorSet* writes, Device* device);
+
+	// Same as above, with the descriptors read through an update template
+	// created with `descriptor_update_template_create_push`.
+	void cmd_push_descriptor_set_with_template_graphics(
+		CommandBuffer* commandBuffer, DescriptorUpdateTemplate* updateTemplate,
+		GraphicsPipeline* pipeline, uint32_t set,
+		const DescriptorTemplateSlot* data, Device* device);
+
+	// NOTE: vtek has no compute pipeline object (yet), so the compute
+	// variants take the pipeline layout directly.
+	void cmd_push_descriptor_set_compute(
+		CommandBuffer* commandBuffer, VkPipelineLayout pipelineLayout,
+		uint32_t set, DescriptorSet* writes, Device* device);
+
+	void cmd_push_descriptor_set_with_template_compute(
+		CommandBuffer* commandBuffer, DescriptorUpdateTemplate* updateTemplate,
+		VkPipelineLayout pipelineLayout, uint32_t set,
+		const DescriptorTemplateSlot* data, Device* device);
+
 	// ======================== //
 	// === Drawing commands === //
 	// ======================== //
@@ -71,4 +136,57 @@ namespace vtek
 	// Issue a draw command, explicitly setting number of vertices and assuming
 	// bound vertex buffer(s). Instances are ignored / not assumed.
 	void cmd_draw_vertices(CommandBuffer* commandBuffer, uint32_t numVertices);
+
+	// Issue an indexed draw command, assuming bound vertex buffer(s) and a
+	// bound index buffer. `firstIndex` is counted in indices, not bytes, and
+	// `vertexOffset` is added to each index before fetching vertices.
+	void cmd_draw_indexed(
+		CommandBuffer* commandBuffer, uint32_t numIndices,
+		uint32_t firstIndex = 0, int32_t vertexOffset = 0);
+
+	// Instanced variants of the above, drawing `numInstances` copies of the
+	// same geometry. Per-instance data is read either from vertex buffers
+	// bound with a `per_instance` input rate (see `InstanceBuffer`), or by
+	// the shader using `gl_InstanceIndex`, which starts at `firstInstance`.
+	void cmd_draw_vertices_instanced(
+		CommandBuffer* commandBuffer, uint32_t numVertices, uint32_t numInstances,
+		uint32_t firstVertex = 0, uint32_t firstInstance = 0);
+
+	void cmd_draw_indexed_instanced(
+		CommandBuffer* commandBuffer, uint32_t numIndices, uint32_t numInstances,
+		uint32_t firstIndex = 0, int32_t vertexOffset = 0, uint32_t firstInstance = 0);
+
+	// ======================== //
+	// === Indirect drawing === //
+	// ======================== //
+
+	// Issue `drawCount` draws with parameters read from a buffer created with
+	// the `indirect_buffer` usage flag, starting at `offset` bytes and spaced
+	// `stride` bytes apart. A `drawCount` larger than 1 requires the
+	// `multiDrawIndirect` feature, see `PhysicalDeviceInfo::requiredFeatures`.
+	// The draw parameters are typically written with an `IndirectDrawBuffer`,
+	// or by a compute shader.
+	void cmd_draw_indirect(
+		CommandBuffer* commandBuffer, const Buffer* buffer, uint64_t offset,
+		uint32_t drawCount, uint32_t stride = sizeof(VkDrawIndirectCommand));
+
+	// Same as above, with indexed draws and a bound index buffer.
+	void cmd_draw_indexed_indirect(
+		CommandBuffer* commandBuffer, const Buffer* buffer, uint64_t offset,
+		uint32_t drawCount, uint32_t stride = sizeof(VkDrawIndexedIndirectCommand));
+
+	// Variants where the number of draws is also read from a buffer, as a
+	// uint32 at `countOffset`, and clamped to `maxDrawCount`. This lets a
+	// compute shader decide how many draws to issue, e.g. after culling.
+	// Requires VK_KHR_draw_indirect_count, see
+	// `PhysicalDeviceInfo::requireDrawIndirectCount`.
+	void cmd_draw_indirect_count(
+		CommandBuffer* commandBuffer, const Buffer* buffer, uint64_t offset,
+		const Buffer* countBuffer, uint64_t countOffset, uint32_t maxDrawCount,
+		uint32_t stride, Device* device);
+
+	void cmd_draw_indexed_indirect_count(
+		CommandBuffer* commandBuffer, const Buffer* buffer, uint64_t offset,
+		const Buffer* countBuffer, uint64_t countOffset, uint32_t maxDrawCount,
+		uint32_t stride, Device* device);
 }
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "vtek_glm_includes.hpp"
+#include "vtek_object_handles.hpp"
+
+
+namespace vtek
+{
+	// ======================== //
+	// === Bounding volumes === //
+	// ======================== //
+
+	struct BoundingBox
+	{
+		glm::vec3 min {0.0f};
+		glm::vec3 max {0.0f};
+	};
+
+	struct BoundingSphere
+	{
+		glm::vec3 center {0.0f};
+		float radius {0.0f};
+	};
+
+	// Transform bounds, e.g. from model space to world space. The box is the
+	// axis-aligned box enclosing the transformed box, and the sphere radius
+	// is scaled by the largest axis scale of the matrix.
+	BoundingBox bounding_box_transform(const BoundingBox& box, const glm::mat4& m);
+	BoundingSphere bounding_sphere_transform(
+		const BoundingSphere& sphere, const glm::mat4& m);
+
+
+	// ======================= //
+	// === Frustum culling === //
+	// ======================= //
+
+	// Planes are stored as (normal, distance), with normals pointing into
+	// the frustum and normalized, in the order: left, right, bottom, top,
+	// near, far.
+	struct Frustum
+	{
+		glm::vec4 planes[6];
+	};
+
+	// Extract the frustum planes in world space from a combined
+	// projection * view matrix, with Vulkan's [0, 1] depth range.
+	Frustum frustum_extract(const glm::mat4& viewProjection);
+	Frustum frustum_extract(Camera* camera);
+
+	bool frustum_test_sphere(const Frustum* frustum, const BoundingSphere& sphere);
+	bool frustum_test_box(const Frustum* frustum, const BoundingBox& box);
+
+	// Bounds of many objects in structure-of-arrays layout, so that several
+	// objects are tested at once with SIMD instructions. Bounds must be in
+	// the same space as the frustum, usually world space.
+	struct CullingSpheres
+	{
+		std::vector<float> x;
+		std::vector<float> y;
+		std::vector<float> z;
+		std::vector<float> radius;
+
+		inline void add(const BoundingSphere& sphere)
+		{
+			x.push_back(sphere.center.x);
+			y.push_back(sphere.center.y);
+			z.push_back(sphere.center.z);
+			radius.push_back(sphere.radius);
+		}
+		inline void clear() { x.clear(); y.clear(); z.clear(); radius.clear(); }
+		inline uint32_t size() const { return static_cast<uint32_t>(x.size()); }
+	};
+
+	struct CullingBoxes
+	{
+		std::vector<float> minX;
+		std::vector<float> minY;
+		std::vector<float> minZ;
+		std::vector<float> maxX;
+		std::vector<float> maxY;
+		std::vector<float> maxZ;
+
+		inline void add(const BoundingBox& box)
+		{
+			minX.push_back(box.min.x);
+			minY.push_back(box.min.y);
+			minZ.push_back(box.min.z);
+			maxX.push_back(box.max.x);
+			maxY.push_back(box.max.y);
+			maxZ.push_back(box.max.z);
+		}
+		inline void clear()
+		{
+			minX.clear(); minY.clear(); minZ.clear();
+			maxX.clear(); maxY.clear(); maxZ.clear();
+		}
+		inline uint32_t size() const { return static_cast<uint32_t>(minX.size()); }
+	};
+
+	// Test all bounds against the frustum, and write the indices of the
+	// visible (or intersecting) ones to `outVisible`, in increasing order.
+	// Returns the number of visible objects.
+	// Uses AVX when vtek is built with `VTEK_ENABLE_AVX`, otherwise SSE2 on
+	// x86 and a scalar fallback elsewhere. With `numThreads` > 1 the arrays
+	// are split between threads, which only pays off for large arrays.
+	uint32_t frustum_cull_spheres(
+		const Frustum* frustum, const CullingSpheres* spheres,
+		std::vector<uint32_t>& outVisible, uint32_t numThreads = 1U);
+
+	uint32_t frustum_cull_boxes(
+		const Frustum* frustum, const CullingBoxes* boxes,
+		std::vector<uint32_t>& outVisible, uint32_t numThreads = 1U);
+}
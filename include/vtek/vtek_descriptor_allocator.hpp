@@ -0,0 +1,88 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <vector>
+
+#include "vtek_descriptor_type.hpp"
+#include "vtek_object_handles.hpp"
+
+
+namespace vtek
+{
+	// ============================ //
+	// === Descriptor allocator === //
+	// ============================ //
+
+	// A descriptor allocator owns a growing list of descriptor pools, and
+	// hands out descriptor sets without the client having to know up front
+	// exactly how many descriptors of each type will be needed.
+	// When a pool runs full (`VK_ERROR_OUT_OF_POOL_MEMORY` or
+	// `VK_ERROR_FRAGMENTED_POOL`), the allocator simply moves on to another
+	// pool, either a recycled one or a freshly created one.
+	//
+	// Sets are allocated into one of several "frames", typically one for each
+	// frame in flight. Calling `descriptor_allocator_reset_frame` resets all
+	// pools used by that frame in bulk with `vkResetDescriptorPool` and puts
+	// them back on a free-list for re-use, which makes transient per-frame
+	// descriptor sets cheap with no fragmentation over time.
+
+	// Expected number of descriptors of a given type, for each allocated set.
+	// Used for sizing the first pools, before any usage has been observed.
+	struct DescriptorAllocatorRatio
+	{
+		DescriptorType type;
+		float ratio {1.0f};
+	};
+
+	struct DescriptorAllocatorInfo
+	{
+		// Number of independent frames that sets are allocated into. Should
+		// normally match the number of frames in flight for the swapchain.
+		uint32_t numFrames {1U};
+
+		// Number of descriptor sets that fit into the first created pool.
+		uint32_t initialSetsPerPool {64U};
+
+		// Each time the allocator runs out of pools, the next pool will be
+		// this much larger, until `maxSetsPerPool` is reached.
+		float growthFactor {2.0f};
+		uint32_t maxSetsPerPool {4096U};
+
+		// Extra room added to every pool size, on top of what the ratios or
+		// the observed usage suggest. 0.25 means 25% extra.
+		float safetyMargin {0.25f};
+
+		// Initial guess at the descriptor types needed for each set. If left
+		// empty, a small default spread of common types is used. When sets
+		// are allocated, the allocator records the actual usage and sizes
+		// new pools from that instead.
+		std::vector<DescriptorAllocatorRatio> typeRatios;
+
+		bool allowUpdateAfterBind {false};
+	};
+
+
+	DescriptorAllocator* descriptor_allocator_create(
+		const DescriptorAllocatorInfo* info, Device* device);
+	void descriptor_allocator_destroy(
+		DescriptorAllocator* allocator, Device* device);
+
+	// Allocate a descriptor set into the given frame. The returned set is
+	// owned by the allocator and stays valid until that frame is reset.
+	DescriptorSet* descriptor_allocator_alloc_set(
+		DescriptorAllocator* allocator, DescriptorSetLayout* layout,
+		uint32_t frameIndex, Device* device);
+
+	// Free all descriptor sets allocated into the given frame, and recycle
+	// the pools they came from. Before calling this function, make sure that
+	// the GPU is no longer using any of the sets, e.g. after waiting for the
+	// frame's in-flight fence.
+	void descriptor_allocator_reset_frame(
+		DescriptorAllocator* allocator, uint32_t frameIndex, Device* device);
+
+	// Reset every frame at once.
+	void descriptor_allocator_reset(DescriptorAllocator* allocator, Device* device);
+
+	// Total number of descriptor pools owned by the allocator, in use or not.
+	uint32_t descriptor_allocator_get_num_pools(DescriptorAllocator* allocator);
+}
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <vector>
+
 #include "vtek_object_handles.hpp"
 
 #include "vtek_image.hpp"
@@ -10,11 +12,26 @@ namespace vtek
 {
 	VkDescriptorSet descriptor_set_get_handle(const DescriptorSet* set);
 
+	// Create a descriptor set which is not allocated from any pool, and only
+	// used for recording descriptor writes with the functions declared below.
+	// The writes are then pushed into a command buffer with
+	// `cmd_push_descriptor_set_graphics`, for layouts created with the
+	// `pushDescriptor` flag. The same object may be re-used for every draw.
+	DescriptorSet* descriptor_set_create_push();
+	void descriptor_set_destroy_push(DescriptorSet* set);
+
 	// Apply the descriptors added/modified with the functions declared below.
 	// This function will finalize these changes into the descriptor set,
 	// and must be called before command buffer recording.
 	void descriptor_set_update(DescriptorSet* set, Device* device);
 
+	// Same as above, but for many descriptor sets at once. All pending
+	// descriptor writes are gathered and submitted in a single call to
+	// `vkUpdateDescriptorSets`, which is considerably cheaper than updating
+	// each set on its own when there are many sets to update every frame.
+	void descriptor_set_update_batch(
+		const std::vector<DescriptorSet*>& sets, Device* device);
+
 
 	// ========================== //
 	// === Update descriptors === //
@@ -37,9 +54,18 @@ namespace vtek
 
 	bool descriptor_set_bind_storage_buffer();
 
-	bool descriptor_set_bind_uniform_buffer_dynamic();
+	// Dynamic uniform/storage buffers are bound with a range instead of a
+	// fixed offset. The offset is then supplied each time the descriptor set
+	// is bound, with `cmd_bind_descriptor_set_graphics`, so that many draws
+	// can read different parts of one large buffer through a single set.
+	// See also `vtek_uniform_ring.hpp`.
+	bool descriptor_set_bind_uniform_buffer_dynamic(
+		DescriptorSet* set, uint32_t binding,
+		Buffer* buffer, UniformBufferType type);
 
-	bool descriptor_set_bind_storage_buffer_dynamic();
+	bool descriptor_set_bind_storage_buffer_dynamic(
+		DescriptorSet* set, uint32_t binding,
+		Buffer* buffer, uint64_t range);
 
 	bool descriptor_set_bind_input_attachment();
 
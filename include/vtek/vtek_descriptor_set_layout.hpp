@@ -36,11 +36,27 @@ namespace vtek
 		// and requires re-recording.
 		// NOTE: This feature must be required when picking a physical device.
 		bool updateAfterBind {false};
+
+		// Specifies that not all descriptors in the binding need to be valid,
+		// as long as the shader does not access the invalid ones. Mostly useful
+		// for large descriptor arrays which are filled in gradually, e.g. for
+		// bindless resources.
+		// NOTE: Requires Vulkan >= 1.2 and the `descriptorBindingPartiallyBound`
+		// feature, which is enabled by `DeviceInfo::enableBindlessTextureSupport`.
+		bool partiallyBound {false};
 	};
 
 	struct DescriptorSetLayoutInfo
 	{
 		std::vector<DescriptorLayoutBinding> bindings;
+
+		// Descriptors for a push-descriptor layout are not allocated from a
+		// pool, but recorded directly into the command buffer with
+		// `cmd_push_descriptor_set_graphics`. This is the cheapest path for
+		// bindings that change with every draw.
+		// NOTE: Requires `PhysicalDeviceInfo::requirePushDescriptors`, and may
+		// not be combined with `updateAfterBind` or dynamic buffers.
+		bool pushDescriptor {false};
 	};
 
 
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <vector>
+
+#include "vtek_descriptor_set_layout.hpp"
+#include "vtek_image.hpp"
+#include "vtek_object_handles.hpp"
+
+
+namespace vtek
+{
+	// =================================== //
+	// === Descriptor update templates === //
+	// =================================== //
+
+	// A descriptor update template describes, once and for all, where the
+	// descriptors of a descriptor set layout can be found in a block of
+	// client memory. Updating a set is then a single call, with no need to
+	// build `VkWriteDescriptorSet` structures every frame.
+	// Requires Vulkan >= 1.1.
+	//
+	// The template generated here expects the data as a contiguous array of
+	// slots, one for each descriptor, in the same order as the bindings
+	// were listed in `DescriptorSetLayoutInfo`. A binding with `count > 1`
+	// occupies that many consecutive slots. Use
+	// `descriptor_update_template_get_slot` to look up where a binding starts.
+	union DescriptorTemplateSlot
+	{
+		VkDescriptorImageInfo image;
+		VkDescriptorBufferInfo buffer;
+		VkBufferView texelBufferView;
+	};
+
+	// NOTE: Inline uniform blocks and acceleration structures are not
+	// supported by the generated templates.
+	DescriptorUpdateTemplate* descriptor_update_template_create(
+		const DescriptorSetLayoutInfo* info, DescriptorSetLayout* layout,
+		Device* device);
+	// Create a template for pushing descriptors with
+	// `cmd_push_descriptor_set_with_template_graphics`. The layout info must
+	// have the `pushDescriptor` flag set, and `set` is the index of the push
+	// descriptor set layout within the pipeline layout.
+	DescriptorUpdateTemplate* descriptor_update_template_create_push(
+		const DescriptorSetLayoutInfo* info, GraphicsPipeline* pipeline,
+		uint32_t set, Device* device);
+	DescriptorUpdateTemplate* descriptor_update_template_create_push_compute(
+		const DescriptorSetLayoutInfo* info, VkPipelineLayout pipelineLayout,
+		uint32_t set, Device* device);
+
+	void descriptor_update_template_destroy(
+		DescriptorUpdateTemplate* updateTemplate, Device* device);
+
+	VkDescriptorUpdateTemplate descriptor_update_template_get_handle(
+		const DescriptorUpdateTemplate* updateTemplate);
+
+	// Number of slots needed for updating one descriptor set.
+	uint32_t descriptor_update_template_get_num_slots(
+		const DescriptorUpdateTemplate* updateTemplate);
+
+	// Index of the slot for the given binding and array element, or
+	// `UINT32_MAX` if the binding is not part of the template.
+	uint32_t descriptor_update_template_get_slot(
+		const DescriptorUpdateTemplate* updateTemplate,
+		uint32_t binding, uint32_t arrayElement = 0U);
+
+
+	// === Filling in slots === //
+	void descriptor_template_slot_set_buffer(
+		DescriptorTemplateSlot* slot, Buffer* buffer,
+		uint64_t offset, uint64_t range);
+
+	void descriptor_template_slot_set_image(
+		DescriptorTemplateSlot* slot, Sampler* sampler,
+		Image2D* image, ImageLayout imageLayout);
+
+
+	// === Updating descriptor sets === //
+
+	// Update one descriptor set from `data`, which must hold
+	// `descriptor_update_template_get_num_slots()` slots.
+	void descriptor_set_update_with_template(
+		DescriptorSet* set, DescriptorUpdateTemplate* updateTemplate,
+		const DescriptorTemplateSlot* data, Device* device);
+
+	// Update several descriptor sets, where `data` holds the slots for each
+	// set one after another, i.e. `sets.size() * num_slots` slots in total.
+	void descriptor_sets_update_with_template(
+		const std::vector<DescriptorSet*>& sets,
+		DescriptorUpdateTemplate* updateTemplate,
+		const DescriptorTemplateSlot* data, Device* device);
+}
@@ -44,6 +44,10 @@ namespace vtek
 		uint32_t numComputeQueues {0U};
 
 		// Features
+		// Enable the descriptor indexing features needed for a bindless
+		// resource table, i.e. large partially bound descriptor arrays which
+		// are updated while bound and indexed non-uniformly from shaders.
+		// Requires Vulkan >= 1.2. See `vtek_bindless_table.hpp`.
 		bool enableBindlessTextureSupport {false};
 
 		// If this is set to false, an allocator must be manually created
@@ -59,8 +63,11 @@ namespace vtek
 
 	struct DeviceExtensions
 	{
+		bool drawIndirectCount {false};
 		bool dynamicRendering {false};
+		bool pushDescriptor {false};
 		bool swapchain {false};
+		bool synchronization2 {false};
 		bool getMemoryRequirements2 {false};
 		bool rayTracingNV {false}; // TODO: This is only NVidia specific!
 		// NEXT: Better!
@@ -86,6 +93,11 @@ namespace vtek
 
 	Allocator* device_get_allocator(const Device* device);
 	CommandScheduler* device_get_command_scheduler(const Device* device);
+	bool device_get_bindless_support(const Device* device);
+
+	// Timeline semaphores are enabled whenever the device supports them,
+	// which requires Vulkan >= 1.2. Needed by the swapchain.
+	bool device_get_timeline_semaphore_support(const Device* device);
 
 	// If any of these functions return `nullptr`, then no corresponding queues
 	// were created.
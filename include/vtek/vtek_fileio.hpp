@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -10,6 +11,7 @@ namespace vtek
 	// Opaque handles
 	struct Directory;
 	struct File;
+	struct FileMapping;
 
 
 	// ========================= //
@@ -79,6 +81,11 @@ namespace vtek
 	// Check if a given file exists within a previously opened directory.
 	bool file_exists(const Directory* dir, std::string_view filename);
 
+	// Rename a file within a directory, replacing `to` if it exists. On most
+	// platforms the replacement is atomic, so readers of `to` see either the
+	// old or the new file, never a partially written one.
+	bool file_rename(const Directory* dir, std::string_view from, std::string_view to);
+
 	// Various flags for controlling how a file should be opened. These
 	// may be combined into bitmasks, though not all combinations are valid:
 	// (read)
@@ -117,7 +124,8 @@ namespace vtek
 	// must be specified with the `flags` parameter described above.
 	// Returns nullptr if flags are invalid, if the application has no rights
 	// to read/write the file, or if the flags are not allowed by the underlying
-	// platform's file system - ie. opening a file that does not exist.
+	// platform's file system - ie. opening a file for reading that does not
+	// exist. When opening for writing, a non-existing file is created.
 	File* file_open(
 		const Directory* dir, std::string_view filename, FileModeFlags flags);
 
@@ -132,10 +140,28 @@ namespace vtek
 	// Read the entire contents of the file, and copy it into `buffer`.
 	bool file_read_into_buffer(File* file, std::vector<char>& buffer);
 
+	// Write `size` bytes to a file opened for writing.
+	bool file_write_data(File* file, const void* data, uint64_t size);
+
 	// Read the file, line by line, until reaching EOF. The accumulated result
 	// is stored in `accumBuffer`, while each consecutive read replaces the
 	// contents of `line` with the next line.
 	// Returns true if a line was read, and false otherwise (ie. EOF).
 	bool file_read_line_accum(
 		File* file, std::vector<char>& accumBuffer, std::vector<char>& line);
+
+
+	// =========================== //
+	// === Memory-mapped files === //
+	// =========================== //
+
+	// Map the entire contents of a file into memory for reading, which avoids
+	// copying the file into an intermediate buffer. Pages are loaded lazily
+	// by the OS. On platforms without memory mapping the file is read into
+	// memory instead. Returns nullptr if the file does not exist or is empty.
+	FileMapping* file_map(const Directory* dir, std::string_view filename);
+	void file_unmap(FileMapping* mapping);
+
+	const void* file_mapping_get_data(const FileMapping* mapping);
+	uint64_t file_mapping_get_size(const FileMapping* mapping);
 }
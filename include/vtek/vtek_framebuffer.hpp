@@ -77,6 +77,8 @@ namespace vtek
 	glm::uvec2 framebuffer_get_resolution(Framebuffer* framebuffer);
 
 	std::vector<Image2D*> framebuffer_get_color_images(Framebuffer* framebuffer);
+	// nullptr if the framebuffer has no depth/stencil attachment.
+	Image2D* framebuffer_get_depth_stencil_image(Framebuffer* framebuffer);
 
 	void framebuffer_set_clear_color(
 		Framebuffer* framebuffer, uint32_t attachmentIndex, ClearValue clearValue);
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstdint>
+
+#include "vtek_object_handles.hpp"
+#include "vtek_vertex_data.hpp"
+#include "vtek_vulkan_types.hpp"
+
+
+namespace vtek
+{
+	// ====================== //
+	// === Geometry arena === //
+	// ====================== //
+
+	// A geometry arena is a set of large, device-local vertex buffers (one
+	// for each attribute stream) and one index buffer, shared between many
+	// models. Space is sub-allocated from two VMA virtual blocks, counted in
+	// vertices and indices, so a vertex range has the same base vertex in
+	// every attribute stream.
+	//
+	// Models are loaded into an arena by setting `ModelInfo::geometryArena`,
+	// and report where they were placed with `model_get_base_vertex` and
+	// `model_get_first_index`. A whole scene may then be drawn with a single
+	// binding of the arena buffers, and one `cmd_draw_indexed` per model or
+	// submesh with a vertex offset, or with a single indirect draw.
+	struct GeometryArenaInfo
+	{
+		// Capacity, in number of vertices and indices
+		uint32_t maxVertices {1U << 20};
+		uint32_t maxIndices {1U << 22};
+
+		// With 16-bit indices, only models with less than 65535 vertices in
+		// each submesh may be loaded, see `ModelInfo::separateSubmeshes`.
+		IndexType indexType {IndexType::uint32};
+
+		// Attribute streams, which must match the formats of the models.
+		// Models without normals or texture coordinates may still be loaded
+		// into an arena with those streams, leaving their contents undefined.
+		VertexAttributeType positionType {VertexAttributeType::vec3};
+		bool normals {true};
+		VertexAttributeType normalType {VertexAttributeType::vec3};
+		bool textureCoordinates {true};
+		VertexAttributeType texCoordType {VertexAttributeType::vec2};
+
+		// Also allow reading the buffers as storage buffers, e.g. for
+		// compute culling or vertex pulling.
+		bool allowStorageBuffer {false};
+	};
+
+	// Location of an allocation inside the arena. The handles are internal.
+	struct GeometryArenaRange
+	{
+		uint32_t baseVertex {0U};
+		uint32_t numVertices {0U};
+		uint32_t firstIndex {0U};
+		uint32_t numIndices {0U};
+
+		uint64_t vertexAllocation {0UL};
+		uint64_t indexAllocation {0UL};
+	};
+
+	struct GeometryArenaStats
+	{
+		uint32_t numAllocations {0U};
+		uint32_t usedVertices {0U};
+		uint32_t usedIndices {0U};
+
+		// Largest allocation that can currently succeed, which is smaller
+		// than the total free space when the arena is fragmented.
+		uint32_t largestFreeVertexRange {0U};
+		uint32_t largestFreeIndexRange {0U};
+	};
+
+	GeometryArena* geometry_arena_create(const GeometryArenaInfo* info, Device* device);
+
+	// All models loaded into the arena must be destroyed first.
+	void geometry_arena_destroy(GeometryArena* arena);
+
+	// Reserve space for `numVertices` vertices and `numIndices` indices.
+	// Returns false if the arena has no contiguous free range of either size.
+	// Thread-safe, so models may be loaded into the arena asynchronously.
+	bool geometry_arena_allocate(
+		GeometryArena* arena, uint32_t numVertices, uint32_t numIndices,
+		GeometryArenaRange* outRange);
+
+	// Return the range to the arena. The GPU must have finished reading it.
+	void geometry_arena_free(GeometryArena* arena, GeometryArenaRange* range);
+
+	// Buffers, for binding and for writing data at the range offsets. The
+	// normal and texcoord buffers are nullptr if the stream is disabled.
+	Buffer* geometry_arena_get_vertex_buffer(GeometryArena* arena);
+	Buffer* geometry_arena_get_normal_buffer(GeometryArena* arena);
+	Buffer* geometry_arena_get_texcoord_buffer(GeometryArena* arena);
+	Buffer* geometry_arena_get_index_buffer(GeometryArena* arena);
+
+	IndexType geometry_arena_get_index_type(GeometryArena* arena);
+	VertexAttributeType geometry_arena_get_position_type(GeometryArena* arena);
+	VertexAttributeType geometry_arena_get_normal_type(GeometryArena* arena);
+	VertexAttributeType geometry_arena_get_texcoord_type(GeometryArena* arena);
+
+	GeometryArenaStats geometry_arena_get_stats(GeometryArena* arena);
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "vtek_object_handles.hpp"
+
+
+namespace vtek
+{
+	// ==================== //
+	// === GPU profiler === //
+	// ==================== //
+
+	// A GPU profiler measures how long named scopes of a command buffer take
+	// to execute on the GPU, by writing timestamps into a query pool. There
+	// is one query pool for each frame in flight, and the results of a frame
+	// are read back the next time its pool is used, when the frame's fence
+	// has signalled, so reading them never stalls.
+	//
+	// Typical usage:
+	//   frame:  swapchain_wait_begin_frame(swapchain, device);
+	//           swapchain_acquire_next_image(swapchain, device, &frameIndex);
+	//           gpu_profiler_begin_frame(profiler, commandBuffer, frameIndex);
+	//   scope:  cmd_profile_begin(commandBuffer, profiler, "shadows");
+	//           ...
+	//           cmd_profile_end(commandBuffer, profiler);
+	//   stats:  gpu_profiler_get_stats(profiler);
+	//
+	// NOTE: Scopes may be nested, but must begin and end in the same command
+	// buffer, and the command buffer must run on the graphics queue.
+	struct GpuProfilerInfo
+	{
+		// Number of query pools, one for each frame in flight.
+		uint32_t numFrames {2U};
+
+		// Scopes that can be recorded each frame. Scopes beyond this are
+		// not measured.
+		uint32_t maxScopesPerFrame {64U};
+
+		// Number of frames to compute rolling statistics over.
+		uint32_t historyLength {60U};
+	};
+
+	// Timings of one scope in milliseconds, over the last `historyLength`
+	// frames. Scopes recorded more than once in a frame are summed.
+	struct GpuProfileStats
+	{
+		std::string name;
+		uint32_t depth {0U}; // nesting level, when last recorded
+		float lastMs {0.0f};
+		float averageMs {0.0f};
+		float minMs {0.0f};
+		float maxMs {0.0f};
+		uint32_t numSamples {0U};
+	};
+
+	// Returns nullptr if the graphics queue does not support timestamps.
+	GpuProfiler* gpu_profiler_create(const GpuProfilerInfo* info, Device* device);
+	void gpu_profiler_destroy(GpuProfiler* profiler);
+
+	// Read back the results of the frame's previous use, and reset its
+	// queries. Must be called after the frame's fence has signalled, and
+	// before any scopes are recorded, outside of a render pass.
+	void gpu_profiler_begin_frame(
+		GpuProfiler* profiler, CommandBuffer* commandBuffer, uint32_t frameIndex);
+
+	void cmd_profile_begin(
+		CommandBuffer* commandBuffer, GpuProfiler* profiler, std::string_view name);
+	void cmd_profile_end(CommandBuffer* commandBuffer, GpuProfiler* profiler);
+
+	// Statistics for all scopes recorded so far, in order of first use.
+	std::vector<GpuProfileStats> gpu_profiler_get_stats(GpuProfiler* profiler);
+
+	// Sum of all top-level scopes of the latest frame with results.
+	float gpu_profiler_get_frame_time_ms(GpuProfiler* profiler);
+
+	void gpu_profiler_reset_stats(GpuProfiler* profiler);
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+
+#include "vtek_object_handles.hpp"
+
+
+namespace vtek
+{
+	// ============================ //
+	// === Indirect draw buffer === //
+	// ============================ //
+
+	// An indirect draw buffer is one persistently mapped, host-visible buffer
+	// holding draw parameters, which are built on the CPU and consumed by
+	// `cmd_draw_indirect` or `cmd_draw_indexed_indirect`. Like a uniform
+	// ring, it is split into one region for each frame in flight, so that a
+	// frame's draws can be written while the GPU reads the previous frame's.
+	//
+	// Each region starts with the number of draws as a uint32, so the buffer
+	// may also be used with the `*_count` variants, followed by the draw
+	// commands, tightly packed.
+	//
+	// Typical usage:
+	//   frame:    indirect_draw_buffer_begin_frame(draws, frameIndex);
+	//   per mesh: indirect_draw_buffer_add_indexed(draws, command);
+	//   submit:   indirect_draw_buffer_flush(draws);
+	//             cmd_draw_indexed_indirect(
+	//                 cmdBuf, indirect_draw_buffer_get_buffer(draws),
+	//                 indirect_draw_buffer_get_offset(draws),
+	//                 indirect_draw_buffer_get_num_draws(draws));
+	struct IndirectDrawBufferInfo
+	{
+		// Maximum number of draws for each frame.
+		uint32_t maxDraws {4096U};
+
+		// Number of regions in the buffer, one for each frame in flight.
+		uint32_t numFrames {2U};
+
+		// Whether the buffer holds `VkDrawIndexedIndirectCommand` or
+		// `VkDrawIndirectCommand`. The two may not be mixed.
+		bool indexed {true};
+
+		// Also allow binding the buffer as a storage buffer, e.g. for
+		// culling draws in a compute shader. Regions are then aligned to
+		// the device's minimum storage buffer offset alignment.
+		bool allowStorageBuffer {false};
+	};
+
+	IndirectDrawBuffer* indirect_draw_buffer_create(
+		const IndirectDrawBufferInfo* info, Device* device);
+	void indirect_draw_buffer_destroy(IndirectDrawBuffer* draws);
+
+	Buffer* indirect_draw_buffer_get_buffer(IndirectDrawBuffer* draws);
+
+	// Start writing into the region for the given frame. Before calling this,
+	// make sure that the GPU has finished reading the frame's previous draws.
+	void indirect_draw_buffer_begin_frame(IndirectDrawBuffer* draws, uint32_t frameIndex);
+
+	// Append draw commands to the current frame. Returns false, and appends
+	// nothing, if the commands do not fit in the frame's region.
+	bool indirect_draw_buffer_add(
+		IndirectDrawBuffer* draws, const VkDrawIndirectCommand& command);
+	bool indirect_draw_buffer_add_indexed(
+		IndirectDrawBuffer* draws, const VkDrawIndexedIndirectCommand& command);
+	bool indirect_draw_buffer_add_indexed(
+		IndirectDrawBuffer* draws, const VkDrawIndexedIndirectCommand* commands,
+		uint32_t numCommands);
+
+	// Append one indexed draw for each submesh of a loaded model. Works both
+	// for models with their own buffers and for models in a geometry arena,
+	// where the draws for many models may be issued with a single call.
+	bool indirect_draw_buffer_add_model(
+		IndirectDrawBuffer* draws, Model* model,
+		uint32_t numInstances = 1U, uint32_t firstInstance = 0U);
+
+	// Write the number of draws, and make data written this frame visible
+	// to the GPU. Call before submitting the command buffer(s) reading from
+	// the buffer.
+	void indirect_draw_buffer_flush(IndirectDrawBuffer* draws);
+
+	// Offset of the current frame's first draw command, and of its draw count.
+	uint64_t indirect_draw_buffer_get_offset(IndirectDrawBuffer* draws);
+	uint64_t indirect_draw_buffer_get_count_offset(IndirectDrawBuffer* draws);
+
+	uint32_t indirect_draw_buffer_get_num_draws(IndirectDrawBuffer* draws);
+
+	// Distance between draw commands, to be passed as `stride`.
+	uint32_t indirect_draw_buffer_get_stride(IndirectDrawBuffer* draws);
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstdint>
+
+#include "vtek_glm_includes.hpp"
+#include "vtek_object_handles.hpp"
+
+
+namespace vtek
+{
+	// ======================= //
+	// === Instance buffer === //
+	// ======================= //
+
+	// An instance buffer is one persistently mapped, host-visible vertex
+	// buffer, split into one region for each frame in flight, into which
+	// per-instance data (typically transforms) is streamed every frame.
+	// Bound with a `per_instance` input rate, it lets many copies of the
+	// same mesh, such as trees in a forest, be drawn with a single
+	// instanced draw command.
+	//
+	// Typical usage:
+	//   pipeline: bindings.add_buffer(...);  // model attributes
+	//             bindings.add_instance_transform_buffer();
+	//   frame:    instance_buffer_begin_frame(instances, frameIndex);
+	//             uint32_t first;
+	//             instance_buffer_push(instances, transforms, count, &first);
+	//             instance_buffer_flush(instances);
+	//   record:   cmd_bind_vertex_buffers(cmdBuf, 0, buffers, offsets, 2);
+	//             cmd_draw_indexed_instanced(cmdBuf, numIndices, count, 0, 0, first);
+	// where the last entry of `buffers` and `offsets` is the instance
+	// buffer and `instance_buffer_get_offset`.
+	struct InstanceBufferInfo
+	{
+		// Size of the data for a single instance, in bytes.
+		uint32_t instanceSize {sizeof(glm::mat4)};
+
+		// Number of instances available for each frame.
+		uint32_t maxInstances {4096U};
+
+		// Number of regions in the buffer, one for each frame in flight.
+		uint32_t numFrames {2U};
+
+		// Also allow binding the buffer as a storage buffer, e.g. for
+		// reading instances with `gl_InstanceIndex` instead of attributes.
+		bool allowStorageBuffer {false};
+	};
+
+	InstanceBuffer* instance_buffer_create(const InstanceBufferInfo* info, Device* device);
+	void instance_buffer_destroy(InstanceBuffer* instances);
+
+	Buffer* instance_buffer_get_buffer(InstanceBuffer* instances);
+
+	// Start writing into the region for the given frame. Before calling this,
+	// make sure that the GPU has finished reading the frame's previous data.
+	void instance_buffer_begin_frame(InstanceBuffer* instances, uint32_t frameIndex);
+
+	// Copy `numInstances` instances, each of the size given at creation,
+	// into the current frame's region, and return the index of the first
+	// one, for use as `firstInstance` in a draw command. Returns false, and
+	// copies nothing, if the frame's region is full.
+	bool instance_buffer_push(
+		InstanceBuffer* instances, const void* data, uint32_t numInstances,
+		uint32_t* outFirstInstance);
+
+	// Reserve space for `numInstances` instances and return a pointer to
+	// write them to directly, e.g. from a culling loop. The pointer is only
+	// valid until the next call to `instance_buffer_begin_frame`, and should
+	// only be written to, since mapped memory may be very slow to read.
+	void* instance_buffer_allocate(
+		InstanceBuffer* instances, uint32_t numInstances, uint32_t* outFirstInstance);
+
+	// Make data written this frame visible to the GPU. Only does any work
+	// if the underlying memory is not host-coherent.
+	void instance_buffer_flush(InstanceBuffer* instances);
+
+	// Offset of the current frame's region, to bind the buffer at.
+	uint64_t instance_buffer_get_offset(InstanceBuffer* instances);
+
+	// Number of instances pushed in the current frame.
+	uint32_t instance_buffer_get_num_instances(InstanceBuffer* instances);
+}
@@ -1,9 +1,15 @@
 #pragma once
 
+#include <functional>
+#include <string>
 #include <string_view>
 
+#include "vtek_culling.hpp"
 #include "vtek_fileio.hpp"
+#include "vtek_glm_includes.hpp"
 #include "vtek_object_handles.hpp"
+#include "vtek_vertex_data.hpp"
+#include "vtek_vulkan_types.hpp"
 
 
 namespace vtek
@@ -13,6 +19,130 @@ namespace vtek
 
 	};
 
+	// How vertex attributes and indices are laid out in GPU memory.
+	enum class ModelVertexLayout
+	{
+		// One vertex buffer for each attribute, and a separate index buffer.
+		separate_buffers,
+
+		// All attributes interleaved in a single vertex buffer, in the order
+		// [position, normal, texcoord] and leaving out attributes that were
+		// not loaded. With all attributes, this matches
+		// `VertexBufferBindings::add_buffer(vec3, vec3, vec2, per_vertex)`,
+		// or the attribute types of the model if quantized. Attributes are
+		// padded to 4 bytes, which is included in the vertex stride.
+		// Indices are placed in a separate index buffer, and the normal and
+		// texcoord buffer getters return nullptr.
+		interleaved,
+
+		// The attribute streams and the indices are placed at aligned
+		// offsets inside one buffer, so the model needs one allocation only.
+		// All buffer getters return the same buffer, and the offsets must be
+		// used when binding.
+		single_allocation
+	};
+
+	// Vertex attribute formats. Quantized formats reduce vertex memory and
+	// bandwidth, at the cost of precision, and require the vertex shader to
+	// dequantize the attributes, see `ModelDequantization` and
+	// shaders/utils/vertex_quantization.glsl.
+	enum class ModelPositionFormat
+	{
+		// 3x 32-bit float, `VertexAttributeType::vec3`.
+		float32,
+		// 4x 16-bit float, `VertexAttributeType::vec4_half`. Fine for
+		// models centered around the origin with moderate extents.
+		float16,
+		// 4x 16-bit unorm relative to the model's bounding box,
+		// `VertexAttributeType::vec4_unorm16`. Must be dequantized.
+		unorm16
+	};
+
+	enum class ModelNormalFormat
+	{
+		// 3x 32-bit float, `VertexAttributeType::vec3`.
+		float32,
+		// Octahedral encoding in 2x 16-bit snorm,
+		// `VertexAttributeType::vec2_snorm16`. Must be decoded.
+		octahedral_snorm16,
+		// Octahedral encoding in 2x 8-bit snorm,
+		// `VertexAttributeType::vec2_snorm8`. Must be decoded.
+		octahedral_snorm8
+	};
+
+	enum class ModelTexCoordFormat
+	{
+		// 2x 32-bit float, `VertexAttributeType::vec2`.
+		float32,
+		// 2x 16-bit unorm relative to the range of texture coordinates,
+		// `VertexAttributeType::vec2_unorm16`. Must be dequantized.
+		unorm16
+	};
+
+	// Parameters for reconstructing quantized attributes, laid out so they
+	// can be copied directly into a uniform buffer or push constant:
+	//   position = quantized.xyz * positionScale.xyz + positionOffset.xyz
+	//   texcoord = quantized * texCoordScale + texCoordOffset
+	// For non-quantized formats the values are identity.
+	struct ModelDequantization
+	{
+		glm::vec4 positionScale {1.0f};
+		glm::vec4 positionOffset {0.0f};
+		glm::vec2 texCoordScale {1.0f};
+		glm::vec2 texCoordOffset {0.0f};
+	};
+
+	// Texture references of a material, in the order of `ModelMaterial::textures`.
+	enum class ModelTextureType : uint32_t
+	{
+		base_color, normal, metallic_roughness, occlusion, emissive
+	};
+	constexpr uint32_t kModelNumTextureTypes = 5U;
+
+	struct ModelMaterial
+	{
+		std::string name;
+
+		// Factors are multiplied with the texture values, if any
+		glm::vec4 baseColorFactor {1.0f};
+		glm::vec3 emissiveFactor {0.0f};
+		float metallicFactor {1.0f};
+		float roughnessFactor {1.0f};
+		bool doubleSided {false};
+
+		// Texture paths relative to the model file, or empty if the material
+		// has no such texture. Textures embedded in the model file are
+		// referenced as "*<index>", following the Assimp convention.
+		// Textures are not loaded, this is left to the application.
+		std::string textures[kModelNumTextureTypes];
+	};
+
+	// A separately drawable part of a model, ie. one mesh referenced by one
+	// node in the scene. All submeshes share the model's buffers, and are
+	// drawn with `cmd_draw_indexed(commandBuffer, numIndices, firstIndex,
+	// vertexOffset)`.
+	struct ModelSubmesh
+	{
+		uint32_t firstIndex {0U};
+		uint32_t numIndices {0U};
+		int32_t vertexOffset {0};
+
+		// The vertex range referenced by the submesh, starting at
+		// `firstVertex`, which may be shared with other submeshes.
+		uint32_t firstVertex {0U};
+		uint32_t numVertices {0U};
+
+		// Index into the model's materials.
+		uint32_t materialIndex {0U};
+
+		// Accumulated node transform, from mesh space to model space.
+		glm::mat4 transform {1.0f};
+
+		// Bounds of the submesh in model space, ie. with `transform` applied.
+		BoundingBox boundingBox {};
+		BoundingSphere boundingSphere {};
+	};
+
 	struct ModelInfo
 	{
 		// If for some reason the vertex data should reside in main memory
@@ -24,6 +154,55 @@ namespace vtek
 
 		// Various options
 		bool flipUVs {false};
+
+		// Store each mesh of the scene once, with indices relative to the
+		// start of its vertex range, so that every submesh must be drawn
+		// with its own vertex offset. This allows 16-bit indices for larger
+		// models, and meshes referenced by several nodes are not duplicated.
+		// When disabled, all indices refer to the whole vertex buffer, so
+		// the entire model may also be drawn in a single draw call.
+		bool separateSubmeshes {false};
+
+		ModelVertexLayout vertexLayout {ModelVertexLayout::separate_buffers};
+
+		// Vertex attribute formats, default is no quantization.
+		ModelPositionFormat positionFormat {ModelPositionFormat::float32};
+		ModelNormalFormat normalFormat {ModelNormalFormat::float32};
+		ModelTexCoordFormat texCoordFormat {ModelTexCoordFormat::float32};
+
+		// Mesh optimizations, performed on each mesh after loading.
+		// Reorder triangles for post-transform vertex cache locality.
+		bool optimizeVertexCache {false};
+
+		// Reorder clusters of triangles so that outward-facing clusters are
+		// drawn first, to reduce overdraw. Implies `optimizeVertexCache`.
+		// The threshold is how much the vertex cache miss ratio may grow in
+		// exchange for smaller clusters, ie. 1.05 allows 5% more misses.
+		bool optimizeOverdraw {false};
+		float overdrawThreshold {1.05f};
+
+		// Reorder vertex data in the order it is first used by the indices,
+		// for vertex fetch locality. Should be the last optimization.
+		bool optimizeVertexFetch {false};
+
+		// Vertex cache size assumed by the optimizations.
+		uint32_t vertexCacheSize {16U};
+
+		// Store the processed buffer contents in a binary `.vtekmesh` file
+		// on first load, and load from that file on later loads, which skips
+		// importing and processing the source file. The cache file is
+		// rewritten when the source file or any of the above options change.
+		bool useMeshCache {false};
+
+		// Where to store cache files. If nullptr, the cache file is stored
+		// next to the source file, as "<filename>.vtekmesh".
+		const Directory* meshCacheDirectory {nullptr};
+
+		// Load the vertex and index data into a range of a shared geometry
+		// arena, instead of into buffers owned by the model. Requires the
+		// `separate_buffers` layout, and vertex formats matching the arena.
+		// The arena must outlive the model.
+		GeometryArena* geometryArena {nullptr};
 	};
 
 	// Loads an obj model from disk and buffer its vertex data to GPU memory.
@@ -31,6 +210,60 @@ namespace vtek
 		const ModelInfo* info, Directory* directory, std::string_view filename,
 		Device* device);
 
+	// Loads a scene file of any format supported by Assimp, and keeps each
+	// of its meshes as a submesh with node transform and material. This is
+	// the same as `model_load_obj` with `separateSubmeshes` enabled.
+	Model* model_load_scene(
+		const ModelInfo* info, Directory* directory, std::string_view filename,
+		Device* device);
+
+	// Loads a glTF 2.0 file, either `.gltf` or `.glb`, with submeshes as
+	// `model_load_scene`. When the accessors match the vertex formats, ie.
+	// float positions, normals and texture coordinates, and 8/16/32-bit
+	// indices, the buffer views are copied straight from the file into
+	// staging memory, without Assimp and without the mesh cache. This
+	// requires the default layout and formats, and no UV flip or mesh
+	// optimizations, otherwise the file is converted through Assimp.
+	// Indices are kept as they are, unless primitives mix index types, in
+	// which case smaller indices are widened.
+	Model* model_load_gltf(
+		const ModelInfo* info, Directory* directory, std::string_view filename,
+		Device* device);
+
+
+	// ============================ //
+	// === Asynchronous loading === //
+	// ============================ //
+
+	enum class ModelLoadState
+	{
+		loading, ready, failed
+	};
+
+	// Called from the worker thread when loading has finished. The model
+	// must not be destroyed from inside the callback.
+	using ModelLoadCallback = std::function<void(Model* model, bool success)>;
+
+	// Same as `model_load_obj`, but returns a handle immediately, while the
+	// model is imported, processed and uploaded on a worker thread. The
+	// upload is submitted on the transfer queue and waited on with a fence
+	// by the worker, so the calling thread may keep rendering meanwhile.
+	// The directory and device must stay alive until loading has finished.
+	// The model must not be used until it is ready, and must be destroyed
+	// with `model_destroy` even if loading failed.
+	Model* model_load_async(
+		const ModelInfo* info, Directory* directory, std::string_view filename,
+		Device* device, ModelLoadCallback callback = nullptr);
+
+	ModelLoadState model_get_load_state(Model* model);
+
+	// Non-blocking check, true if the model was loaded successfully.
+	bool model_is_ready(Model* model);
+
+	// Block until loading has finished, returns true on success. Models
+	// loaded with `model_load_obj` are always ready.
+	bool model_wait(Model* model);
+
 	void model_destroy(Model* model, Device* device);
 
 	const Buffer* model_get_vertex_buffer(Model* model);
@@ -38,4 +271,47 @@ namespace vtek
 	const Buffer* model_get_texcoord_buffer(Model* model);
 
 	uint32_t model_get_num_vertices(Model* model);
+
+	// Identical vertices are welded during loading, so models are drawn
+	// indexed. The index type is 16-bit if the model has fewer than 65535
+	// vertices, otherwise 32-bit.
+	const Buffer* model_get_index_buffer(Model* model);
+	uint32_t model_get_num_indices(Model* model);
+	IndexType model_get_index_type(Model* model);
+
+	// Layout information. The stride is that of the vertex buffer for the
+	// `interleaved` layout, and that of the position stream otherwise. The
+	// offsets are only relevant for `single_allocation`, otherwise 0.
+	ModelVertexLayout model_get_vertex_layout(Model* model);
+	uint32_t model_get_vertex_stride(Model* model);
+	uint64_t model_get_normal_offset(Model* model);
+	uint64_t model_get_texcoord_offset(Model* model);
+	uint64_t model_get_index_offset(Model* model);
+
+	// Attribute types as uploaded, for describing the vertex input of a
+	// graphics pipeline, and parameters for dequantizing them in shaders.
+	VertexAttributeType model_get_position_type(Model* model);
+	VertexAttributeType model_get_normal_type(Model* model);
+	VertexAttributeType model_get_texcoord_type(Model* model);
+	const ModelDequantization* model_get_dequantization(Model* model);
+
+	// Submeshes in the order of the scene's node hierarchy, and materials
+	// in the order of the source file. Submeshes are also available for
+	// models loaded with `model_load_obj`.
+	uint32_t model_get_num_submeshes(Model* model);
+	const ModelSubmesh* model_get_submeshes(Model* model);
+	uint32_t model_get_num_materials(Model* model);
+	const ModelMaterial* model_get_material(Model* model, uint32_t index);
+
+	// Bounds enclosing all submeshes in model space, to be transformed with
+	// the model matrix before culling, see `bounding_box_transform`.
+	const BoundingBox* model_get_bounding_box(Model* model);
+	const BoundingSphere* model_get_bounding_sphere(Model* model);
+
+	// Placement of the model in its geometry arena, or 0 if the model was
+	// not loaded into an arena. The whole model is drawn with
+	// `cmd_draw_indexed(commandBuffer, numIndices, firstIndex, baseVertex)`,
+	// and submeshes are already offset by these values.
+	uint32_t model_get_base_vertex(Model* model);
+	uint32_t model_get_first_index(Model* model);
 }
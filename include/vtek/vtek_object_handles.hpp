@@ -8,24 +8,36 @@ namespace vtek
 	// ====================== //
 	struct Allocator;
 	struct ApplicationWindow;
+	struct BarrierBatch;
+	struct BindlessTable;
 	struct Buffer;
 	struct CommandBuffer;
 	struct CommandPool;
 	struct CommandScheduler;
+	struct DescriptorAllocator;
 	struct DescriptorPool;
 	struct DescriptorSet;
 	struct DescriptorSetLayout;
+	struct DescriptorUpdateTemplate;
 	struct Device;
 	struct Framebuffer;
+	struct GeometryArena;
+	struct GpuProfiler;
 	struct GraphicsPipeline;
 	struct GraphicsShader;
 	struct Image2D;
+	struct IndirectDrawBuffer;
+	struct InstanceBuffer;
 	struct Instance;
 	struct PhysicalDevice;
+	struct QueryPool;
 	struct Queue;
+	struct RenderGraph;
 	struct RenderPass;
+	struct RenderQueue;
 	struct Sampler;
 	struct Swapchain;
+	struct UniformRing;
 	// TODO: struct SwapchainFramebuffers;
 
 	// ======================= //
@@ -46,6 +46,15 @@ namespace vtek
 		bool requireRaytracingSupport {false};
 		bool requireSwapchainSupport {false};
 		bool requireDynamicRendering {false};
+		// VK_KHR_push_descriptor, for pushing descriptors directly into a
+		// command buffer without allocating descriptor sets.
+		bool requirePushDescriptors {false};
+		// VK_KHR_draw_indirect_count, for indirect draws where the number of
+		// draws is read from a buffer, see `cmd_draw_indirect_count`.
+		bool requireDrawIndirectCount {false};
+		// VK_KHR_synchronization2, for recording pipeline barriers with
+		// per-barrier stage masks, see `BarrierBatch`.
+		bool requireSynchronization2 {false};
 	};
 
 	// TODO: Since this is only needed by device creation, maybe place it somewhere else?
@@ -85,9 +94,12 @@ namespace vtek
 	struct PhysicalDeviceExtensionSupport
 	{
 		// extension support
+		bool drawIndirectCount {false};
 		bool dynamicRendering {false};
+		bool pushDescriptor {false};
 		bool raytracing {false};
 		bool swapchain {false};
+		bool synchronization2 {false};
 	};
 
 
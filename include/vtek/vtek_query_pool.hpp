@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstdint>
+
+#include "vtek_object_handles.hpp"
+#include "vtek_types.hpp"
+
+
+namespace vtek
+{
+	// ================== //
+	// === Query pool === //
+	// ================== //
+
+	enum class QueryType
+	{
+		// Number of samples passing the depth and stencil tests, e.g. for
+		// visibility-based LOD. With `precise` queries the exact count is
+		// returned, otherwise only zero or non-zero is guaranteed.
+		occlusion,
+		// Counters of the pipeline stages, selected by `PipelineStatisticFlag`.
+		// Requires the `pipelineStatisticsQuery` device feature.
+		pipeline_statistics,
+		// Written with `cmd_write_timestamp`, see also `GpuProfiler`.
+		timestamp
+	};
+
+	// Same order as `VkQueryPipelineStatisticFlagBits`, which is also the
+	// order of the results of a pipeline statistics query.
+	enum class PipelineStatisticFlag : uint32_t
+	{
+		input_assembly_vertices                    = 0x0001,
+		input_assembly_primitives                  = 0x0002,
+		vertex_shader_invocations                  = 0x0004,
+		geometry_shader_invocations                = 0x0008,
+		geometry_shader_primitives                 = 0x0010,
+		clipping_invocations                       = 0x0020,
+		clipping_primitives                        = 0x0040,
+		fragment_shader_invocations                = 0x0080,
+		tessellation_control_shader_patches        = 0x0100,
+		tessellation_evaluation_shader_invocations = 0x0200,
+		compute_shader_invocations                 = 0x0400
+	};
+
+	// Results of a pipeline statistics query. Counters that were not
+	// enabled for the pool are zero.
+	struct PipelineStatistics
+	{
+		uint64_t inputAssemblyVertices {0UL};
+		uint64_t inputAssemblyPrimitives {0UL};
+		uint64_t vertexShaderInvocations {0UL};
+		uint64_t geometryShaderInvocations {0UL};
+		uint64_t geometryShaderPrimitives {0UL};
+		uint64_t clippingInvocations {0UL};
+		uint64_t clippingPrimitives {0UL};
+		uint64_t fragmentShaderInvocations {0UL};
+		uint64_t tessellationControlShaderPatches {0UL};
+		uint64_t tessellationEvaluationShaderInvocations {0UL};
+		uint64_t computeShaderInvocations {0UL};
+	};
+
+	// A query pool holds `numQueries` queries for each frame in flight.
+	// Queries are recorded into the current frame's range, and the results
+	// of a frame are read back the next time its range is used, when the
+	// frame's fence has signalled, so retrieving results never stalls.
+	// Results are thus a few frames old, which is usually fine for both
+	// statistics and visibility.
+	//
+	// Typical usage:
+	//   frame:  swapchain_wait_begin_frame(swapchain, device);
+	//           swapchain_acquire_next_image(swapchain, device, &frameIndex);
+	//           query_pool_begin_frame(pool, commandBuffer, frameIndex);
+	//   draw:   cmd_begin_query(commandBuffer, pool, objectIndex);
+	//           ...
+	//           cmd_end_query(commandBuffer, pool, objectIndex);
+	//   later:  uint64_t samples;
+	//           if (query_pool_get_result(pool, objectIndex, &samples)) { ... }
+	struct QueryPoolInfo
+	{
+		QueryType type {QueryType::occlusion};
+
+		// Number of queries available each frame.
+		uint32_t numQueries {64U};
+
+		// Number of query ranges, one for each frame in flight.
+		uint32_t numFrames {2U};
+
+		// Only used for pipeline statistics queries, and must not be empty.
+		EnumBitmask<PipelineStatisticFlag> pipelineStatistics {0U};
+	};
+
+	QueryPool* query_pool_create(const QueryPoolInfo* info, Device* device);
+	void query_pool_destroy(QueryPool* pool);
+
+	// Read back the results of the frame's previous use, and reset its
+	// queries. Must be called after the frame's fence has signalled, and
+	// before any queries are recorded, outside of a render pass.
+	void query_pool_begin_frame(
+		QueryPool* pool, CommandBuffer* commandBuffer, uint32_t frameIndex);
+
+	// Queries of the current frame. Occlusion and pipeline statistics queries
+	// must begin and end in the same subpass, or dynamic rendering instance.
+	void cmd_begin_query(
+		CommandBuffer* commandBuffer, QueryPool* pool, uint32_t query, bool precise = false);
+	void cmd_end_query(CommandBuffer* commandBuffer, QueryPool* pool, uint32_t query);
+	void cmd_write_timestamp(
+		CommandBuffer* commandBuffer, QueryPool* pool, uint32_t query);
+
+	// Latest available result of a query, i.e. samples passed or a timestamp
+	// in ticks. Returns false if the query has no result yet, e.g. because
+	// it was not recorded in the frame that was read back last.
+	bool query_pool_get_result(QueryPool* pool, uint32_t query, uint64_t* outResult);
+	bool query_pool_get_pipeline_statistics(
+		QueryPool* pool, uint32_t query, PipelineStatistics* outStatistics);
+
+	uint32_t query_pool_get_num_queries(QueryPool* pool);
+}
@@ -29,5 +29,10 @@ namespace vtek
 	bool queue_supports_compute(const Queue* queue);
 	bool queue_supports_sparse_binding(const Queue* queue);
 
+	// Submits and presents are synchronized per `VkQueue`, so they may be
+	// called from several threads, e.g. by asynchronous model loading on a
+	// transfer queue which is the same as the graphics queue.
 	bool queue_submit(Queue* queue, CommandBuffer* commandBuffer, const SubmitInfo* submitInfo);
+
+	VkResult queue_present(Queue* queue, const VkPresentInfoKHR* presentInfo);
 }
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <functional>
+#include <string_view>
+
+#include "vtek_barrier_batch.hpp"
+#include "vtek_format_support.hpp"
+#include "vtek_object_handles.hpp"
+#include "vtek_vulkan_types.hpp"
+
+
+namespace vtek
+{
+	// ==================== //
+	// === Render graph === //
+	// ==================== //
+
+	// A render graph describes the passes of a frame, and which resources
+	// each pass reads and writes. Compiling the graph:
+	// - culls passes whose results are never used, i.e. passes without side
+	//   effects that write no imported resource and no transient image read
+	//   by a later pass;
+	// - creates transient images, which only live within the graph, and
+	//   lets transients whose lifetimes do not overlap share memory.
+	// Executing the graph records the remaining passes in declaration order,
+	// each preceded by a single barrier command with the barriers needed for
+	// its resource accesses.
+	//
+	// Typical usage:
+	//   setup:  id = render_graph_create_image(graph, &imageInfo);
+	//           pass = render_graph_add_pass(graph, "ssao", recordFn);
+	//           render_graph_pass_use_image(graph, pass, id, ImageAccessType::...);
+	//           render_graph_compile(graph);
+	//   frame:  render_graph_execute(graph, commandBuffer);
+	//   resize: render_graph_reset(graph), then setup again.
+	//
+	// NOTE: All passes are recorded into the given command buffer, i.e. on a
+	// single queue. Independent passes are not moved to an async compute queue.
+
+	constexpr uint32_t kRenderGraphInvalidId = UINT32_MAX;
+
+	// Records the commands of a pass. Resources are looked up with
+	// `render_graph_get_image` and `render_graph_get_buffer`.
+	using RenderGraphExecuteFn = std::function<void(CommandBuffer*)>;
+
+	// Transient image, created by the graph. Usage flags are derived from
+	// the accesses declared by the passes.
+	struct RenderGraphImageInfo
+	{
+		VkExtent2D extent {0U, 0U};
+		SupportedFormat supportedFormat {};
+		MultisampleType multisampling {MultisampleType::none};
+	};
+
+	struct RenderGraphStats
+	{
+		uint32_t numPasses {0U};
+		uint32_t numCulledPasses {0U};
+		uint32_t numTransientImages {0U};
+
+		// Size of the memory shared by all transient images, and the size
+		// it would have been without aliasing.
+		uint64_t transientMemoryBytes {0UL};
+		uint64_t memoryWithoutAliasing {0UL};
+	};
+
+	RenderGraph* render_graph_create(Device* device);
+	void render_graph_destroy(RenderGraph* graph);
+
+	// Remove all passes and resources, and destroy the transient images.
+	// Must not be called while the graph's commands are pending execution.
+	void render_graph_reset(RenderGraph* graph);
+
+	// Resources, returning an id to be used with the graph. Importing the same
+	// image or buffer more than once returns the same id. Imported resources
+	// are owned by the application, and writing to them counts as a side
+	// effect when culling passes.
+	uint32_t render_graph_import_image(RenderGraph* graph, Image2D* image);
+	uint32_t render_graph_import_buffer(RenderGraph* graph, Buffer* buffer);
+	uint32_t render_graph_create_image(RenderGraph* graph, const RenderGraphImageInfo* info);
+
+	// Passes are executed in the order they are added. Returns the pass id.
+	uint32_t render_graph_add_pass(
+		RenderGraph* graph, std::string_view name, RenderGraphExecuteFn fn);
+
+	void render_graph_pass_use_image(
+		RenderGraph* graph, uint32_t pass, uint32_t image, ImageAccessType access);
+	void render_graph_pass_use_buffer(
+		RenderGraph* graph, uint32_t pass, uint32_t buffer, BufferAccessType access);
+
+	// The pass renders into the framebuffer with `framebuffer_dynamic_rendering_begin`,
+	// which transitions the attachments itself. Its attachments are imported and
+	// written by the pass, but no barriers are added for them.
+	void render_graph_pass_use_framebuffer(
+		RenderGraph* graph, uint32_t pass, Framebuffer* framebuffer);
+
+	// The pass is never culled, e.g. because it writes to the swapchain.
+	void render_graph_pass_set_side_effects(RenderGraph* graph, uint32_t pass);
+
+	// Cull passes and create the transient images. Must be called after
+	// setup, before the graph is executed.
+	bool render_graph_compile(RenderGraph* graph);
+
+	// Record all passes that were not culled, with barriers.
+	void render_graph_execute(RenderGraph* graph, CommandBuffer* commandBuffer);
+
+	// nullptr for unknown ids, or transient images of culled passes.
+	Image2D* render_graph_get_image(RenderGraph* graph, uint32_t image);
+	Buffer* render_graph_get_buffer(RenderGraph* graph, uint32_t buffer);
+
+	bool render_graph_pass_is_culled(RenderGraph* graph, uint32_t pass);
+	RenderGraphStats render_graph_get_stats(RenderGraph* graph);
+}
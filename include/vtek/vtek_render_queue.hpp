@@ -0,0 +1,141 @@
+#pragma once
+
+#include <cstdint>
+
+#include "vtek_object_handles.hpp"
+#include "vtek_shaders.hpp"
+#include "vtek_types.hpp"
+#include "vtek_vulkan_types.hpp"
+
+
+namespace vtek
+{
+	// ==================== //
+	// === Render queue === //
+	// ==================== //
+
+	// A render queue collects the draws of a frame in any order, each with
+	// a 64-bit sort key, and records them sorted by key. Draws that share a
+	// pipeline, descriptor sets, or buffers then end up next to each other,
+	// and binds that would not change any state are skipped.
+	//
+	// Typical usage:
+	//   frame:    render_queue_reset(queue);
+	//   per draw: render_queue_submit(queue, render_queue_make_key(&key), &draw);
+	//   record:   render_queue_record(queue, commandBuffer);
+	// with the render pass (or dynamic rendering), viewport and scissor set
+	// up by the application.
+
+	constexpr uint32_t kRenderQueueMaxVertexBuffers = 4U;
+	constexpr uint32_t kRenderQueueMaxDynamicOffsets = 4U;
+	constexpr uint32_t kRenderQueueMaxPushConstantSize = 128U;
+
+	// Everything needed to record a single draw. Pointers are not owned by
+	// the queue, and must stay valid until the draw has been recorded.
+	struct RenderQueueDraw
+	{
+		GraphicsPipeline* pipeline {nullptr};
+
+		// Bound at set 0, optionally with dynamic offsets, e.g. from a
+		// uniform ring.
+		DescriptorSet* descriptorSet {nullptr};
+		uint32_t dynamicOffsets[kRenderQueueMaxDynamicOffsets] {};
+		uint32_t numDynamicOffsets {0U};
+
+		// Bound at set 1, typically holding material textures and parameters.
+		DescriptorSet* materialSet {nullptr};
+
+		// Bound to consecutive bindings, starting at 0.
+		const Buffer* vertexBuffers[kRenderQueueMaxVertexBuffers] {};
+		uint64_t vertexOffsets[kRenderQueueMaxVertexBuffers] {};
+		uint32_t numVertexBuffers {0U};
+
+		// If nullptr, the draw is non-indexed.
+		const Buffer* indexBuffer {nullptr};
+		uint64_t indexOffset {0UL};
+		IndexType indexType {IndexType::uint32};
+
+		// Number of indices, or vertices for non-indexed draws.
+		uint32_t numElements {0U};
+		uint32_t firstElement {0U};
+		int32_t vertexOffset {0};
+		uint32_t numInstances {1U};
+		uint32_t firstInstance {0U};
+
+		// Optional push constant data, which is copied on submission.
+		const void* pushConstantData {nullptr};
+		uint32_t pushConstantSize {0U};
+		EnumBitmask<ShaderStageGraphics> pushConstantStages {};
+	};
+
+	// Fields of a sort key, from most to least significant. Pipelines,
+	// descriptor sets, and materials are identified by small integers chosen
+	// by the application, e.g. indices into its own arrays.
+	struct RenderQueueKey
+	{
+		uint32_t pass {0U};          // 4 bits, e.g. opaque before transparent
+		uint32_t pipeline {0U};      // 12 bits
+		uint32_t descriptorSet {0U}; // 12 bits
+		uint32_t material {0U};      // 12 bits
+
+		// View depth, normalized to [0, 1], quantized to 24 bits. Opaque
+		// draws are sorted front-to-back by default, so early depth testing
+		// rejects more fragments; transparent draws must be back-to-front.
+		float depth {0.0f};
+		bool backToFront {false};
+	};
+
+	uint64_t render_queue_make_key(const RenderQueueKey* key);
+
+	// Pass stored in the topmost 4 bits of a sort key.
+	uint32_t render_queue_key_get_pass(uint64_t key);
+
+	struct RenderQueueInfo
+	{
+		// Number of draws to reserve space for. The queue grows as needed.
+		uint32_t initialCapacity {1024U};
+	};
+
+	// Number of binds recorded since the last reset, and number of binds
+	// skipped because they would not have changed any state.
+	struct RenderQueueStats
+	{
+		uint32_t numDraws {0U};
+		uint32_t pipelineBinds {0U};
+		uint32_t descriptorSetBinds {0U};
+		uint32_t vertexBufferBinds {0U};
+		uint32_t indexBufferBinds {0U};
+		uint32_t bindsSkipped {0U};
+	};
+
+	RenderQueue* render_queue_create(const RenderQueueInfo* info);
+	void render_queue_destroy(RenderQueue* queue);
+
+	// Remove all draws, and reset the statistics. Allocated memory is kept.
+	void render_queue_reset(RenderQueue* queue);
+
+	// Add a draw to the queue. Returns false if the draw is invalid.
+	// Draws with equal keys are recorded in the order they were submitted.
+	bool render_queue_submit(RenderQueue* queue, uint64_t key, const RenderQueueDraw* draw);
+
+	// Sort the submitted draws by key, using a radix sort. Called by the
+	// record functions if needed, but may be called earlier, e.g. from a
+	// worker thread.
+	void render_queue_sort(RenderQueue* queue);
+
+	// Record all draws in sorted order.
+	void render_queue_record(RenderQueue* queue, CommandBuffer* commandBuffer);
+
+	// Record only the draws of the given pass, e.g. when passes are recorded
+	// into different render passes.
+	void render_queue_record_pass(
+		RenderQueue* queue, CommandBuffer* commandBuffer, uint32_t pass);
+
+	uint32_t render_queue_get_num_draws(RenderQueue* queue);
+	RenderQueueStats render_queue_get_stats(RenderQueue* queue);
+
+	// Draw at position `index` in sorted order, or nullptr if out of range.
+	// Sorts the queue if needed. Push constant data is not returned, since
+	// it is copied into the queue on submission.
+	const RenderQueueDraw* render_queue_get_sorted_draw(RenderQueue* queue, uint32_t index);
+}
@@ -14,15 +14,22 @@ namespace vtek
 
 		// SET
 		inline void SetPostSignalFence(VkFence fence) { postSignalFence = fence; }
-		inline void AddSignalSemaphore(VkSemaphore sem) {
+		// For timeline semaphores `value` is the value to signal or wait for,
+		// and for binary semaphores it is ignored.
+		inline void AddSignalSemaphore(VkSemaphore sem, uint64_t value = 0UL) {
 			if (numSignal >= kMaxSemaphores) { return; }
+			signalValues[numSignal] = value;
 			signalSemaphores[numSignal++] = sem;
+			if (value != 0UL) { hasTimelineValues = true; }
 		}
-		inline void AddWaitSemaphore(VkSemaphore sem, VkPipelineStageFlags stage) {
+		inline void AddWaitSemaphore(
+			VkSemaphore sem, VkPipelineStageFlags stage, uint64_t value = 0UL) {
 			if (numWait >= kMaxSemaphores) { return; }
 			waitSemaphores[numWait] = sem;
 			waitPipelineStages[numWait] = stage;
+			waitValues[numWait] = value;
 			numWait++;
+			if (value != 0UL) { hasTimelineValues = true; }
 		}
 
 		// GET
@@ -53,12 +60,30 @@ namespace vtek
 			return (numWait > 0) ? waitPipelineStages : nullptr;
 		}
 
+		// True if any timeline semaphore was added, in which case the values
+		// must be passed on with `VkTimelineSemaphoreSubmitInfo`.
+		bool HasTimelineValues() const
+		{
+			return hasTimelineValues;
+		}
+		const uint64_t* SignalSemaphoreValues() const
+		{
+			return (numSignal > 0) ? signalValues : nullptr;
+		}
+		const uint64_t* WaitSemaphoreValues() const
+		{
+			return (numWait > 0) ? waitValues : nullptr;
+		}
+
 	private:
 		uint8_t numSignal {0U};
 		VkSemaphore signalSemaphores[kMaxSemaphores];
+		uint64_t signalValues[kMaxSemaphores] {0};
 		uint8_t numWait {0U};
 		VkSemaphore waitSemaphores[kMaxSemaphores];
 		VkPipelineStageFlags waitPipelineStages[kMaxSemaphores] {0};
+		uint64_t waitValues[kMaxSemaphores] {0};
+		bool hasTimelineValues {false};
 		VkFence postSignalFence {VK_NULL_HANDLE};
 	};
 }
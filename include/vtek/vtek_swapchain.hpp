@@ -10,22 +10,19 @@
 
 namespace vtek
 {
-	// No more frames than this numbers shall be rendered on the GPU
-	// at any given time. The actual number of frames in flight depends
-	// on whether or not the swapchain was created for triple buffering.
-	// If triple buffering then swapchain length is 3, and else probably 2.
+	// No more frames than this number shall be rendered on the GPU at any
+	// given time. The actual number of frames in flight is set when creating
+	// the swapchain, see `SwapchainInfo::numFramesInFlight`.
 	//
 	// Use this number when creating arrays of framebuffers, command buffers,
-	// uniform buffers, etc., one of each for each frame.
+	// uniform buffers, etc., one of each for each frame, or size them by the
+	// _actual_ number of frames in flight, obtained by calling
+	// `swapchain_get_num_frames_in_flight()`.
 	//
-	// The number of _actual_ frames in flight is then obtained by
-	// calling `swapchain_get_num_frames_in_flight()`.
-	//
-	// NOTE: There are no performance gains in making a swapchain longer,
-	// since we allow for max 2 simultaneous frames in flight. And even
-	// if higher number of frames in flight were allowed, it would only
-	// reduce rendering latency and increase memory usage.
-	static constexpr uint32_t kMaxFramesInFlight = 2;
+	// NOTE: More frames in flight let the CPU run further ahead of the GPU,
+	// which may smooth out uneven frame times, but also increases input
+	// latency and memory usage. Two is a sensible default.
+	static constexpr uint32_t kMaxFramesInFlight = 4;
 
 	enum class SwapchainDepthBuffer
 	{
@@ -59,12 +56,23 @@ namespace vtek
 		uint32_t framebufferWidth {0};
 		uint32_t framebufferHeight {0};
 
+		// Number of frames that may be recorded and rendered simultaneously,
+		// in the range [1, kMaxFramesInFlight]. Values outside are clamped.
+		uint32_t numFramesInFlight {2U};
+
 		// If no deferred technique is used, default depth buffers may be
 		// created with and managed by the swapchain. This should be disabled
 		// if render passes together with swapchain framebuffers are used, and
 		// might be enabled if dynamic rendering is used.
 		// TODO: `single_shared` is not implemented!
 		SwapchainDepthBuffer depthBuffer {SwapchainDepthBuffer::none};
+
+		// Only used by `swapchain_create_headless`, whose image extent is
+		// given by `framebufferWidth` and `framebufferHeight`. For readback
+		// the format must be an uncompressed RGBA format, e.g. 8-bit unorm.
+		Format headlessFormat {Format::r8g8b8a8_unorm};
+		uint32_t headlessLength {3U};
+		bool headlessReadback {true};
 	};
 
 
@@ -76,6 +84,28 @@ namespace vtek
 		uint32_t framebufferWidth, uint32_t framebufferHeight);
 	void swapchain_destroy(Swapchain* swapchain, Device* device);
 
+	// A headless swapchain renders without a window or surface, e.g. on a
+	// server. Its images are a ring of offscreen images, acquired in order,
+	// which are used with the same frame functions as a regular swapchain.
+	// Presenting an image copies it into a host-cached readback buffer on
+	// the GPU, so frame N is copied out while frame N+1 is rendered, and
+	// the copied frames are retrieved with `swapchain_poll_readback`.
+	// `swapchain_recreate` resizes the images, and ignores the surface.
+	//
+	// Typical usage:
+	//   frame:  swapchain_wait_begin_frame(swapchain, device);
+	//           swapchain_acquire_next_image(swapchain, device, &imageIndex);
+	//           swapchain_wait_image_ready(swapchain, device, imageIndex);
+	//           ... record, fill submit info, and submit ...
+	//           swapchain_present_frame(swapchain, imageIndex);
+	//   output: SwapchainReadback readback;
+	//           while (swapchain_poll_readback(swapchain, device, &readback)) { ... }
+	//
+	// NOTE: Images are left in transfer src layout when presented, so render
+	// passes targeting them must use `transfer_src_optimal` as final layout.
+	Swapchain* swapchain_create_headless(const SwapchainInfo* info, Device* device);
+	bool swapchain_is_headless(Swapchain* swapchain);
+
 	// Return the number of images in the swapchain.
 	uint32_t swapchain_get_length(Swapchain* swapchain);
 
@@ -83,6 +113,12 @@ namespace vtek
 	// same as the swapchain length.
 	uint32_t swapchain_get_num_frames_in_flight(Swapchain* swapchain);
 
+	// Frames are synchronized with a single timeline semaphore, which each
+	// submitted frame signals with the next value of the frame counter. Other
+	// work may wait on it, e.g. to know when resources of a frame are free.
+	uint64_t swapchain_get_frame_counter(Swapchain* swapchain);
+	VkSemaphore swapchain_get_frame_timeline_semaphore(Swapchain* swapchain);
+
 	VkImage swapchain_get_image(Swapchain* swapchain, uint32_t index);
 	VkImageView swapchain_get_image_view(Swapchain* swapchain, uint32_t index);
 	Format swapchain_get_image_format(Swapchain* swapchain);
@@ -129,8 +165,9 @@ namespace vtek
 	// Before submitting work to a queue which renders into the swapchain image, the
 	// queue needs to know which semaphore to wait on, and which semaphore to signal
 	// after rendering is completed. This function will provide these semaphores and
-	// return them inside the `submitInfo` argument, as well as a post-signal fence
-	// to synchronize the CPU with the rendered frame.
+	// return them inside the `submitInfo` argument, as well as the frame's value of
+	// the timeline semaphore to synchronize the CPU with the rendered frame.
+	// NOTE: Must be called exactly once for each frame, before submitting it.
 	void swapchain_fill_queue_submit_info(Swapchain* swapchain, SubmitInfo* submitInfo);
 
 	// This function should be called after a rendering workload has been submitted
@@ -139,6 +176,28 @@ namespace vtek
 	// rendering queue to finishe execution before presenting the frame.
 	SwapchainStatus swapchain_present_frame(Swapchain* swapchain, uint32_t frameIndex);
 
+	// A presented frame of a headless swapchain, as tightly packed rows of
+	// texels in the swapchain image format.
+	struct SwapchainReadback
+	{
+		const void* data {nullptr};
+		uint64_t size {0UL};
+		uint32_t rowPitch {0U};
+		VkExtent2D extent {0U, 0U};
+		Format format {Format::undefined};
+		uint32_t imageIndex {0U};
+		// Value of the frame counter of the frame, see `swapchain_get_frame_counter`.
+		uint64_t frameNumber {0UL};
+	};
+
+	// Return the oldest presented frame whose copy has completed, and which
+	// has not been returned before. Returns false without waiting if there
+	// is none, or if the swapchain was not created for headless readback.
+	// NOTE: The data remains valid until the same image is presented again,
+	// i.e. for the next `swapchain_get_length() - 1` frames.
+	bool swapchain_poll_readback(
+		Swapchain* swapchain, Device* device, SwapchainReadback* outReadback);
+
 
 	// Explicit image barriers for using the swapchain images in command buffers.
 	// NOTE: Only use these functions wherever dynamic rendering is applied, and
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+
+#include "vtek_object_handles.hpp"
+#include "vtek_uniform_data.hpp"
+
+
+namespace vtek
+{
+	// ==================== //
+	// === Uniform ring === //
+	// ==================== //
+
+	// A uniform ring is one large, persistently mapped, host-visible buffer,
+	// which is split into one region for each frame in flight. Each frame,
+	// uniform data for every draw is pushed linearly into the frame's region,
+	// and the returned offset is used as a dynamic offset when binding a
+	// descriptor set with a dynamic uniform (or storage) buffer.
+	// This replaces creating one uniform buffer, and one descriptor set, for
+	// each object and each frame in flight.
+	//
+	// Typical usage:
+	//   create:   descriptor_set_bind_uniform_buffer_dynamic(
+	//                 set, 0, uniform_ring_get_buffer(ring), type);
+	//   frame:    uniform_ring_begin_frame(ring, frameIndex);
+	//   per draw: uint32_t offset;
+	//             uniform_ring_push(ring, &uniform, &offset);
+	//             cmd_bind_descriptor_set_graphics(cmdBuf, pipeline, set, &offset, 1);
+	//   submit:   uniform_ring_flush(ring);
+	struct UniformRingInfo
+	{
+		// Number of bytes available for each frame. Pushes beyond this will
+		// fail, so size it for the worst case.
+		uint64_t sizePerFrame {64UL * 1024UL};
+
+		// Number of regions in the ring, one for each frame in flight.
+		uint32_t numFrames {2U};
+
+		// Also allow binding the ring as a dynamic storage buffer.
+		bool allowStorageBuffer {false};
+	};
+
+	UniformRing* uniform_ring_create(const UniformRingInfo* info, Device* device);
+	void uniform_ring_destroy(UniformRing* ring);
+
+	Buffer* uniform_ring_get_buffer(UniformRing* ring);
+
+	// Start writing into the region for the given frame. Before calling this,
+	// make sure that the GPU has finished reading the frame's previous data,
+	// e.g. by calling `swapchain_wait_begin_frame`.
+	void uniform_ring_begin_frame(UniformRing* ring, uint32_t frameIndex);
+
+	// Copy `size` bytes into the current frame's region, and return the
+	// offset of the copied data, correctly aligned for use as a dynamic
+	// offset. Returns false if the frame's region is full.
+	bool uniform_ring_push(
+		UniformRing* ring, const void* data, uint64_t size, uint32_t* outOffset);
+
+	template<typename UniformType>
+	inline bool uniform_ring_push(
+		UniformRing* ring, UniformType* uniform, uint32_t* outOffset)
+	{
+		return uniform_ring_push(ring, uniform, uniform->size(), outOffset);
+	}
+
+	// Make data written this frame visible to the GPU. Only does any work
+	// if the underlying memory is not host-coherent. Call before submitting
+	// the command buffer(s) reading from the ring.
+	void uniform_ring_flush(UniformRing* ring);
+
+	// Number of bytes pushed in the current frame, including alignment padding.
+	uint64_t uniform_ring_get_frame_usage(UniformRing* ring);
+}
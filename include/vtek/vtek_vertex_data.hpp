@@ -22,7 +22,16 @@ namespace vtek
 		ivec2,
 		vec2,
 		vec3,
-		vec4
+		vec4,
+
+		// Quantized types, which are converted to floating-point vectors
+		// when read by the vertex shader. Normalized types are mapped to
+		// [0, 1] (unorm) or [-1, 1] (snorm).
+		vec4_half,    // 4x 16-bit float
+		vec4_unorm16, // 4x 16-bit unorm
+		vec2_unorm16, // 2x 16-bit unorm
+		vec2_snorm16, // 2x 16-bit snorm
+		vec2_snorm8   // 2x 8-bit snorm
 	};
 
 	// With a per-instance input rate, the vertex shader only updates the
@@ -36,6 +45,13 @@ namespace vtek
 		per_vertex, per_instance
 	};
 
+	// Size in bytes of a single attribute of the given type.
+	uint32_t vertex_attribute_get_size(VertexAttributeType type);
+
+	// Round an offset or size up to the 4-byte alignment used for
+	// interleaved attributes and vertex strides.
+	uint32_t vertex_attribute_align(uint32_t offset);
+
 
 	// ====================================== //
 	// === Binding/attribute descriptions === //
@@ -51,10 +67,17 @@ namespace vtek
 
 		// When a vertex buffer contains several interleaved attributes
 		// Example: [ vertex, normal, texcoord, vertex, normal, texcoord, ... ]
+		// Each attribute offset and the stride are padded to 4 bytes.
 		void add_buffer(VAT vt1, VAT vt2, VIR rate);
 		void add_buffer(VAT vt1, VAT vt2, VAT vt3, VIR rate);
 		void add_buffer(VAT vt1, VAT vt2, VAT vt3, VAT vt4, VIR rate);
 
+		// A per-instance buffer of column-major `glm::mat4` transforms, as
+		// written by an `InstanceBuffer`. The matrix occupies four
+		// consecutive shader locations, one for each column, and may be
+		// declared in the vertex shader as `layout(location = N) in mat4`.
+		void add_instance_transform_buffer();
+
 		using BindingList = std::vector<VkVertexInputBindingDescription>;
 		using AttributeList = std::vector<VkVertexInputAttributeDescription>;
 
@@ -62,6 +85,8 @@ namespace vtek
 		inline const AttributeList& GetAttributeDescriptions() { return mAttrDesc; }
 
 	private:
+		void add_interleaved_buffer(const VAT* types, uint32_t count, VIR rate);
+
 		BindingList mBindDesc {};
 		AttributeList mAttrDesc {};
 		uint32_t mBindCount {0};
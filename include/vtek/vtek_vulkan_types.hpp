@@ -61,6 +61,17 @@ namespace vtek
 	VkCullModeFlags get_cull_mode(CullMode mode);
 
 
+	// Index type for indexed drawing. 16-bit indices halve the size of the
+	// index buffer, and should be preferred when a mesh has at most 65535
+	// vertices (the value 0xFFFF is reserved for primitive restart).
+	enum class IndexType
+	{
+		uint16, uint32
+	};
+
+	VkIndexType get_index_type(IndexType type);
+
+
 	// Pipeline stages, which may be used for synchronization of resources,
 	// such as signaling of fences/semaphores, or issuing pipeline barriers.
 	enum class PipelineStage
@@ -0,0 +1,25 @@
+//
+// Dequantization of vertex attributes, matching the quantized formats
+// of `vtek::ModelInfo`. The parameters are those of
+// `vtek::ModelDequantization`, which can be placed in a uniform buffer.
+//
+
+vec3 dequantize_position(vec4 quantized, vec4 scale, vec4 offset)
+{
+	return quantized.xyz * scale.xyz + offset.xyz;
+}
+
+vec2 dequantize_texcoord(vec2 quantized, vec2 scale, vec2 offset)
+{
+	return quantized * scale + offset;
+}
+
+// Decode a unit normal stored with octahedral encoding, in [-1, 1]^2.
+vec3 octahedral_decode(vec2 e)
+{
+	vec3 n = vec3(e.x, e.y, 1.0 - abs(e.x) - abs(e.y));
+	float t = max(-n.z, 0.0);
+	n.x += (n.x >= 0.0) ? -t : t;
+	n.y += (n.y >= 0.0) ? -t : t;
+	return normalize(n);
+}
@@ -0,0 +1,19 @@
+// Internal header file, do not include.
+
+#pragma once
+
+#include <vector>
+
+
+namespace vtek
+{
+	struct DescriptorSetLayout
+	{
+		VkDescriptorSetLayout vulkanHandle {VK_NULL_HANDLE};
+
+		// Copy of the bindings the layout was created with. Kept around so
+		// that descriptor allocators can tell how many descriptors of each
+		// type a single set from this layout consumes.
+		std::vector<VkDescriptorSetLayoutBinding> bindings;
+	};
+}
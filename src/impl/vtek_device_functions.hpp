@@ -0,0 +1,30 @@
+// Internal header file, do not include.
+
+#pragma once
+
+#include "vtek_object_handles.hpp"
+
+
+namespace vtek
+{
+	// Function pointers for device extension commands, which are not
+	// exported by the Vulkan loader and must be fetched with
+	// `vkGetDeviceProcAddr` after device creation. A pointer is only
+	// non-null if the corresponding extension was enabled.
+	struct DeviceExtensionFunctions
+	{
+		// VK_KHR_push_descriptor
+		PFN_vkCmdPushDescriptorSetKHR cmdPushDescriptorSet {nullptr};
+		PFN_vkCmdPushDescriptorSetWithTemplateKHR cmdPushDescriptorSetWithTemplate {nullptr};
+
+		// VK_KHR_draw_indirect_count
+		PFN_vkCmdDrawIndirectCountKHR cmdDrawIndirectCount {nullptr};
+		PFN_vkCmdDrawIndexedIndirectCountKHR cmdDrawIndexedIndirectCount {nullptr};
+
+		// VK_KHR_synchronization2
+		PFN_vkCmdPipelineBarrier2KHR cmdPipelineBarrier2 {nullptr};
+	};
+
+	const DeviceExtensionFunctions* device_get_extension_functions(
+		const Device* device);
+}
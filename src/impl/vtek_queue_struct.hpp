@@ -2,6 +2,9 @@
 
 #pragma once
 
+#include <memory>
+#include <mutex>
+
 namespace vtek
 {
 	struct Queue
@@ -10,5 +13,11 @@ namespace vtek
 		uint32_t familyIndex {UINT32_MAX}; // or UINT_MAX, or std::numeric_limits<uint32_t>::max_value()
 		VkQueueFlags queueFlags {0}; // VK_QUEUE_TRANSFER_BIT etc.
 		bool presentSupport {false};
+
+		// Vulkan requires external synchronization of submits and presents
+		// to a queue. The device stores copies of a queue when it is used
+		// for several purposes, e.g. graphics and transfer, and the copies
+		// share this mutex since they refer to the same `VkQueue`.
+		std::shared_ptr<std::mutex> mutex {std::make_shared<std::mutex>()};
 	};
 }
@@ -7,6 +7,8 @@
 #include "vtek_image.hpp"
 #include "vtek_object_handles.hpp"
 
+#include <vector>
+
 
 namespace vtek
 {
@@ -28,6 +30,15 @@ namespace vtek
 	// === Buffer management === //
 	// ========================= //
 
+	// Last known device access of a buffer, as recorded into command
+	// buffers. Same as for image subresources, but without layouts.
+	struct BufferAccessState
+	{
+		VkPipelineStageFlags2 writeStages {VK_PIPELINE_STAGE_2_NONE};
+		VkAccessFlags2 writeAccess {VK_ACCESS_2_NONE};
+		VkPipelineStageFlags2 readStages {VK_PIPELINE_STAGE_2_NONE};
+	};
+
 	struct Buffer
 	{
 		VkBuffer vulkanHandle {VK_NULL_HANDLE};
@@ -40,6 +51,9 @@ namespace vtek
 		// to "frequently", then the buffer should manage its own staging memory.
 		vtek::Buffer* stagingBuffer {nullptr};
 
+		// Used by `BarrierBatch`
+		BufferAccessState accessState {};
+
 		// The buffer knows who created it.
 		// Will be used for all subsequent operations on the buffer, including
 		// its deletion.
@@ -53,12 +67,31 @@ namespace vtek
 	void* allocator_buffer_map(Buffer* buffer);
 	void allocator_buffer_unmap(Buffer* buffer);
 	void allocator_buffer_flush(Buffer* buffer, const BufferRegion* region);
+	void allocator_buffer_invalidate(Buffer* buffer, const BufferRegion* region);
 
 
 	// ======================== //
 	// === Image management === //
 	// ======================== //
 
+	// Last known layout and access of a single mip level and array layer,
+	// as recorded into command buffers. Used by `BarrierBatch` to find the
+	// source half of each barrier.
+	struct ImageSubresourceState
+	{
+		VkImageLayout layout {VK_IMAGE_LAYOUT_UNDEFINED};
+
+		// Stages and accesses of the last write, or of the last layout
+		// transition, which must complete before any later access.
+		VkPipelineStageFlags2 writeStages {VK_PIPELINE_STAGE_2_NONE};
+		VkAccessFlags2 writeAccess {VK_ACCESS_2_NONE};
+
+		// Stages that have read the subresource since the last write, which
+		// need no further barrier for reading, but must complete before the
+		// next write.
+		VkPipelineStageFlags2 readStages {VK_PIPELINE_STAGE_2_NONE};
+	};
+
 	struct Image2D
 	{
 		VkImage vulkanHandle {VK_NULL_HANDLE};
@@ -67,6 +100,14 @@ namespace vtek
 
 		VkExtent2D extent {0U, 0U};
 		VkFormat format {VK_FORMAT_UNDEFINED};
+		VkImageAspectFlags aspectMask {VK_IMAGE_ASPECT_COLOR_BIT};
+		uint32_t mipLevels {1U};
+		uint32_t arrayLayers {1U};
+
+		// One entry per subresource, indexed by `mip * arrayLayers + layer`.
+		// NOTE: Tracking assumes that all commands using the image are
+		// recorded in submission order, e.g. from a single thread.
+		std::vector<ImageSubresourceState> subresourceStates;
 
 		// The image knows who created it. Same as for buffer.
 		vtek::Allocator* allocator {nullptr};
@@ -76,6 +117,26 @@ namespace vtek
 		Allocator* allocator, const Image2DInfo* info, Image2D* outImage);
 	void allocator_image2d_destroy(Image2D* image);
 
+	// Memory aliasing, where several images are bound to (parts of) the same
+	// allocation, e.g. transient attachments of a render graph which are never
+	// in use at the same time. Aliased images do not own their memory, and
+	// the allocation must be freed after all images using it are destroyed.
+	bool allocator_image2d_get_memory_requirements(
+		Allocator* allocator, const Image2DInfo* info,
+		VkMemoryRequirements* outRequirements);
+	VmaAllocation allocator_memory_allocate(
+		Allocator* allocator, const VkMemoryRequirements* requirements);
+	void allocator_memory_free(Allocator* allocator, VmaAllocation allocation);
+	bool allocator_image2d_create_aliased(
+		Allocator* allocator, const Image2DInfo* info,
+		VmaAllocation allocation, uint64_t offset, Image2D* outImage);
+
+	// Same as `image2d_create`, but bound to the given allocation at `offset`.
+	// Destroyed with `image2d_destroy`, which leaves the allocation intact.
+	Image2D* image2d_create_aliased(
+		const Image2DInfo* info, VmaAllocation allocation, uint64_t offset,
+		Device* device);
+
 	// TODO: Image map and layout transition into optimal tiling !!!
 
 	// TODO: Mipmap generation. Two strategies: blit and compute - try both?
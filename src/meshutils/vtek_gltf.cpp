@@ -0,0 +1,923 @@
+#include "vtek_gltf.hpp"
+
+#include "vtek_logging.hpp"
+
+// Standard
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <string>
+
+
+/* helper functions */
+// Minimal JSON document tree, sufficient for glTF. Objects keep their keys
+// and values in separate arrays, in file order.
+struct JsonValue
+{
+	enum class Type { null, boolean, number, string, array, object };
+
+	Type type {Type::null};
+	bool boolean {false};
+	double number {0.0};
+	std::string string;
+	std::vector<JsonValue> values;  // array elements, or object values
+	std::vector<std::string> keys;  // object keys
+
+	const JsonValue* find(std::string_view key) const
+	{
+		if (type != Type::object) { return nullptr; }
+		for (size_t i = 0; i < keys.size(); i++)
+		{
+			if (keys[i] == key) { return &values[i]; }
+		}
+		return nullptr;
+	}
+
+	bool is_number() const { return type == Type::number; }
+	bool is_array() const { return type == Type::array; }
+	bool is_object() const { return type == Type::object; }
+};
+
+class JsonParser
+{
+public:
+	JsonParser(const char* begin, const char* end) : mPos(begin), mEnd(end) {}
+
+	bool parse(JsonValue& out)
+	{
+		if (!parse_value(out, 0)) { return false; }
+		skip_whitespace();
+		return mPos == mEnd;
+	}
+
+private:
+	static constexpr uint32_t kMaxDepth = 64U;
+
+	const char* mPos;
+	const char* mEnd;
+
+	void skip_whitespace()
+	{
+		while (mPos < mEnd &&
+		       (*mPos == ' ' || *mPos == '\t' || *mPos == '\n' || *mPos == '\r'))
+		{
+			mPos++;
+		}
+	}
+
+	bool consume(char c)
+	{
+		skip_whitespace();
+		if (mPos < mEnd && *mPos == c) { mPos++; return true; }
+		return false;
+	}
+
+	bool consume_literal(const char* literal)
+	{
+		const size_t len = std::strlen(literal);
+		if (static_cast<size_t>(mEnd - mPos) < len ||
+		    std::memcmp(mPos, literal, len) != 0)
+		{
+			return false;
+		}
+		mPos += len;
+		return true;
+	}
+
+	bool parse_value(JsonValue& out, uint32_t depth)
+	{
+		if (depth > kMaxDepth) { return false; }
+
+		skip_whitespace();
+		if (mPos >= mEnd) { return false; }
+
+		switch (*mPos)
+		{
+		case '{': return parse_object(out, depth);
+		case '[': return parse_array(out, depth);
+		case '"':
+			out.type = JsonValue::Type::string;
+			return parse_string(out.string);
+		case 't':
+			out.type = JsonValue::Type::boolean;
+			out.boolean = true;
+			return consume_literal("true");
+		case 'f':
+			out.type = JsonValue::Type::boolean;
+			out.boolean = false;
+			return consume_literal("false");
+		case 'n':
+			out.type = JsonValue::Type::null;
+			return consume_literal("null");
+		default:
+			return parse_number(out);
+		}
+	}
+
+	bool parse_object(JsonValue& out, uint32_t depth)
+	{
+		out.type = JsonValue::Type::object;
+		mPos++; // '{'
+		if (consume('}')) { return true; }
+
+		do
+		{
+			skip_whitespace();
+			if (mPos >= mEnd || *mPos != '"') { return false; }
+
+			out.keys.emplace_back();
+			if (!parse_string(out.keys.back())) { return false; }
+			if (!consume(':')) { return false; }
+
+			out.values.emplace_back();
+			if (!parse_value(out.values.back(), depth + 1)) { return false; }
+		}
+		while (consume(','));
+
+		return consume('}');
+	}
+
+	bool parse_array(JsonValue& out, uint32_t depth)
+	{
+		out.type = JsonValue::Type::array;
+		mPos++; // '['
+		if (consume(']')) { return true; }
+
+		do
+		{
+			out.values.emplace_back();
+			if (!parse_value(out.values.back(), depth + 1)) { return false; }
+		}
+		while (consume(','));
+
+		return consume(']');
+	}
+
+	bool parse_number(JsonValue& out)
+	{
+		// The character set is checked, since strtod also accepts e.g. "inf"
+		const char* start = mPos;
+		while (mPos < mEnd && (std::strchr("+-.0123456789eE", *mPos) != nullptr))
+		{
+			mPos++;
+		}
+		if (mPos == start) { return false; }
+
+		const std::string text(start, mPos);
+		char* parsedEnd = nullptr;
+		out.type = JsonValue::Type::number;
+		out.number = std::strtod(text.c_str(), &parsedEnd);
+		return parsedEnd == text.c_str() + text.size();
+	}
+
+	static void append_utf8(std::string& out, uint32_t cp)
+	{
+		if (cp < 0x80)
+		{
+			out += static_cast<char>(cp);
+		}
+		else if (cp < 0x800)
+		{
+			out += static_cast<char>(0xC0 | (cp >> 6));
+			out += static_cast<char>(0x80 | (cp & 0x3F));
+		}
+		else if (cp < 0x10000)
+		{
+			out += static_cast<char>(0xE0 | (cp >> 12));
+			out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+			out += static_cast<char>(0x80 | (cp & 0x3F));
+		}
+		else
+		{
+			out += static_cast<char>(0xF0 | (cp >> 18));
+			out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+			out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+			out += static_cast<char>(0x80 | (cp & 0x3F));
+		}
+	}
+
+	bool parse_hex4(uint32_t& out)
+	{
+		if (mEnd - mPos < 4) { return false; }
+		out = 0U;
+		for (int i = 0; i < 4; i++)
+		{
+			const char c = *mPos++;
+			out <<= 4;
+			if (c >= '0' && c <= '9') { out |= c - '0'; }
+			else if (c >= 'a' && c <= 'f') { out |= c - 'a' + 10; }
+			else if (c >= 'A' && c <= 'F') { out |= c - 'A' + 10; }
+			else { return false; }
+		}
+		return true;
+	}
+
+	bool parse_string(std::string& out)
+	{
+		mPos++; // '"'
+		while (mPos < mEnd && *mPos != '"')
+		{
+			if (*mPos != '\\')
+			{
+				out += *mPos++;
+				continue;
+			}
+
+			if (++mPos >= mEnd) { return false; }
+			const char escape = *mPos++;
+			switch (escape)
+			{
+			case '"': out += '"'; break;
+			case '\\': out += '\\'; break;
+			case '/': out += '/'; break;
+			case 'b': out += '\b'; break;
+			case 'f': out += '\f'; break;
+			case 'n': out += '\n'; break;
+			case 'r': out += '\r'; break;
+			case 't': out += '\t'; break;
+			case 'u':
+			{
+				uint32_t cp;
+				if (!parse_hex4(cp)) { return false; }
+				if (cp >= 0xDC00 && cp < 0xE000) { return false; } // lone low surrogate
+
+				// A high surrogate must be followed by a low surrogate
+				if (cp >= 0xD800 && cp < 0xDC00)
+				{
+					if (mEnd - mPos < 6 || mPos[0] != '\\' || mPos[1] != 'u') { return false; }
+					mPos += 2;
+					uint32_t low;
+					if (!parse_hex4(low) || low < 0xDC00 || low >= 0xE000) { return false; }
+					cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+				}
+				append_utf8(out, cp);
+				break;
+			}
+			default:
+				return false;
+			}
+		}
+
+		if (mPos >= mEnd) { return false; }
+		mPos++; // '"'
+		return true;
+	}
+};
+
+// JSON numbers are doubles, so indices and counts must be checked to be
+// non-negative integers within range of their type before the cast. Above
+// 2^53 doubles can no longer represent every integer.
+template <typename T>
+static bool is_integer(const JsonValue& v)
+{
+	constexpr double kMaxExact = 9007199254740992.0;
+	const double max = std::min(static_cast<double>(std::numeric_limits<T>::max()), kMaxExact);
+	return v.is_number() && v.number >= 0.0 && v.number <= max &&
+		std::floor(v.number) == v.number;
+}
+
+// If the key is missing, `out` keeps its default. Returns false if the value
+// is not a valid integer, in which case the document is rejected.
+template <typename T>
+static bool get_integer(const JsonValue& obj, std::string_view key, T& out)
+{
+	const JsonValue* v = obj.find(key);
+	if (v == nullptr) { return true; }
+	if (!is_integer<T>(*v)) { return false; }
+
+	out = static_cast<T>(v->number);
+	return true;
+}
+
+static float get_float(const JsonValue& obj, std::string_view key, float fallback)
+{
+	const JsonValue* v = obj.find(key);
+	return (v != nullptr && v->is_number()) ? static_cast<float>(v->number) : fallback;
+}
+
+// Read up to `count` numbers from an array into `out`, returns the number read
+static uint32_t get_floats(
+	const JsonValue& obj, std::string_view key, float* out, uint32_t count)
+{
+	const JsonValue* v = obj.find(key);
+	if (v == nullptr || !v->is_array()) { return 0U; }
+
+	uint32_t n = 0U;
+	for (; n < count && n < v->values.size(); n++)
+	{
+		if (!v->values[n].is_number()) { return n; }
+		out[n] = static_cast<float>(v->values[n].number);
+	}
+	return n;
+}
+
+static const std::vector<JsonValue>* get_array(const JsonValue& obj, std::string_view key)
+{
+	const JsonValue* v = obj.find(key);
+	return (v != nullptr && v->is_array()) ? &v->values : nullptr;
+}
+
+static uint32_t get_num_components(std::string_view type)
+{
+	if (type == "SCALAR") { return 1U; }
+	if (type == "VEC2") { return 2U; }
+	if (type == "VEC3") { return 3U; }
+	if (type == "VEC4") { return 4U; }
+	if (type == "MAT2") { return 4U; }
+	if (type == "MAT3") { return 9U; }
+	if (type == "MAT4") { return 16U; }
+	return 0U;
+}
+
+static bool decode_base64(std::string_view in, std::vector<uint8_t>& out)
+{
+	auto decode = [](char c) -> int {
+		if (c >= 'A' && c <= 'Z') { return c - 'A'; }
+		if (c >= 'a' && c <= 'z') { return c - 'a' + 26; }
+		if (c >= '0' && c <= '9') { return c - '0' + 52; }
+		if (c == '+') { return 62; }
+		if (c == '/') { return 63; }
+		return -1;
+	};
+
+	out.clear();
+	out.reserve(in.size() / 4 * 3);
+
+	uint32_t accum = 0U;
+	int bits = 0;
+	for (char c : in)
+	{
+		if (c == '=') { break; }
+		const int value = decode(c);
+		if (value < 0) { return false; }
+
+		accum = (accum << 6) | static_cast<uint32_t>(value);
+		bits += 6;
+		if (bits >= 8)
+		{
+			bits -= 8;
+			out.push_back(static_cast<uint8_t>(accum >> bits));
+		}
+	}
+	return true;
+}
+
+// Relative URIs may contain percent-encoded characters, e.g. "%20"
+static std::string decode_uri(std::string_view uri)
+{
+	std::string out;
+	for (size_t i = 0; i < uri.size(); i++)
+	{
+		if (uri[i] == '%' && i + 2 < uri.size())
+		{
+			const std::string hex(uri.substr(i + 1, 2));
+			out += static_cast<char>(std::strtol(hex.c_str(), nullptr, 16));
+			i += 2;
+		}
+		else
+		{
+			out += uri[i];
+		}
+	}
+	return out;
+}
+
+static bool load_buffers(
+	const vtek::Directory* dir, const JsonValue& root,
+	const uint8_t* glbChunk, uint64_t glbChunkSize, vtek::GltfDocument* doc)
+{
+	const auto* buffers = get_array(root, "buffers");
+	if (buffers == nullptr) { return true; }
+
+	for (size_t i = 0; i < buffers->size(); i++)
+	{
+		const JsonValue& buffer = (*buffers)[i];
+		uint64_t byteLength = 0UL;
+		if (!get_integer(buffer, "byteLength", byteLength))
+		{
+			vtek_log_error("glTF buffer {} has invalid byteLength!", i);
+			return false;
+		}
+		const JsonValue* uri = buffer.find("uri");
+
+		const uint8_t* data = nullptr;
+		uint64_t size = 0UL;
+
+		if (uri == nullptr || uri->type != JsonValue::Type::string)
+		{
+			// Only the first buffer may refer to the GLB binary chunk
+			if (i != 0 || glbChunk == nullptr)
+			{
+				vtek_log_error("glTF buffer {} has no uri!", i);
+				return false;
+			}
+			data = glbChunk;
+			size = glbChunkSize;
+		}
+		else if (uri->string.compare(0, 5, "data:") == 0)
+		{
+			const size_t comma = uri->string.find(";base64,");
+			if (comma == std::string::npos)
+			{
+				vtek_log_error("glTF buffer {} has unsupported data uri!", i);
+				return false;
+			}
+			doc->embedded.emplace_back();
+			auto& bytes = doc->embedded.back();
+			if (!decode_base64(std::string_view(uri->string).substr(comma + 8), bytes))
+			{
+				vtek_log_error("glTF buffer {} has invalid base64 data!", i);
+				return false;
+			}
+			data = bytes.data();
+			size = bytes.size();
+		}
+		else
+		{
+			const std::string path = decode_uri(uri->string);
+			vtek::FileMapping* mapping = vtek::file_map(dir, path);
+			if (mapping == nullptr)
+			{
+				vtek_log_error("Failed to open glTF buffer file {}!", path);
+				return false;
+			}
+			doc->mappings.push_back(mapping);
+			data = static_cast<const uint8_t*>(vtek::file_mapping_get_data(mapping));
+			size = vtek::file_mapping_get_size(mapping);
+		}
+
+		if (size < byteLength)
+		{
+			vtek_log_error("glTF buffer {} is smaller than its byteLength!", i);
+			return false;
+		}
+		doc->bufferData.push_back(data);
+		doc->bufferSizes.push_back(byteLength);
+	}
+
+	return true;
+}
+
+static bool parse_accessors(const JsonValue& root, vtek::GltfDocument* doc)
+{
+	const auto* accessors = get_array(root, "accessors");
+	if (accessors == nullptr) { return true; }
+
+	for (const auto& a : *accessors)
+	{
+		vtek::GltfAccessor accessor{};
+		uint32_t componentType = 0U;
+		if (!get_integer(a, "bufferView", accessor.bufferView) ||
+		    !get_integer(a, "byteOffset", accessor.byteOffset) ||
+		    !get_integer(a, "componentType", componentType) ||
+		    !get_integer(a, "count", accessor.count))
+		{
+			return false;
+		}
+		accessor.componentType = static_cast<vtek::GltfComponentType>(componentType);
+
+		const JsonValue* type = a.find("type");
+		accessor.numComponents = (type != nullptr) ? get_num_components(type->string) : 0U;
+
+		const JsonValue* normalized = a.find("normalized");
+		accessor.normalized = (normalized != nullptr) && normalized->boolean;
+		accessor.sparse = a.find("sparse") != nullptr;
+
+		accessor.hasBounds =
+			get_floats(a, "min", &accessor.min.x, 3) == 3 &&
+			get_floats(a, "max", &accessor.max.x, 3) == 3;
+
+		doc->accessors.push_back(accessor);
+	}
+
+	return true;
+}
+
+static bool parse_buffer_views(const JsonValue& root, vtek::GltfDocument* doc)
+{
+	const auto* views = get_array(root, "bufferViews");
+	if (views == nullptr) { return true; }
+
+	for (const auto& v : *views)
+	{
+		vtek::GltfBufferView view{};
+		if (!get_integer(v, "buffer", view.buffer) ||
+		    !get_integer(v, "byteOffset", view.byteOffset) ||
+		    !get_integer(v, "byteLength", view.byteLength) ||
+		    !get_integer(v, "byteStride", view.byteStride))
+		{
+			return false;
+		}
+		doc->bufferViews.push_back(view);
+	}
+
+	return true;
+}
+
+static bool parse_meshes(const JsonValue& root, vtek::GltfDocument* doc)
+{
+	const auto* meshes = get_array(root, "meshes");
+	if (meshes == nullptr) { return true; }
+
+	for (const auto& m : *meshes)
+	{
+		vtek::GltfMesh mesh;
+		const auto* primitives = get_array(m, "primitives");
+		if (primitives != nullptr)
+		{
+			for (const auto& p : *primitives)
+			{
+				vtek::GltfPrimitive primitive{};
+				const JsonValue* attributes = p.find("attributes");
+				if (attributes != nullptr &&
+				    (!get_integer(*attributes, "POSITION", primitive.position) ||
+				     !get_integer(*attributes, "NORMAL", primitive.normal) ||
+				     !get_integer(*attributes, "TEXCOORD_0", primitive.texCoord)))
+				{
+					return false;
+				}
+				if (!get_integer(p, "indices", primitive.indices) ||
+				    !get_integer(p, "material", primitive.material) ||
+				    !get_integer(p, "mode", primitive.mode))
+				{
+					return false;
+				}
+				mesh.primitives.push_back(primitive);
+			}
+		}
+		doc->meshes.push_back(std::move(mesh));
+	}
+
+	return true;
+}
+
+static bool parse_nodes(const JsonValue& root, vtek::GltfDocument* doc)
+{
+	const auto* nodes = get_array(root, "nodes");
+	if (nodes == nullptr) { return true; }
+
+	for (const auto& n : *nodes)
+	{
+		vtek::GltfNode node;
+		if (!get_integer(n, "mesh", node.mesh)) { return false; }
+
+		const auto* children = get_array(n, "children");
+		if (children != nullptr)
+		{
+			for (const auto& c : *children)
+			{
+				if (!is_integer<uint32_t>(c)) { return false; }
+				node.children.push_back(static_cast<uint32_t>(c.number));
+			}
+		}
+
+		// Either a column-major matrix, or translation * rotation * scale
+		float matrix[16];
+		if (get_floats(n, "matrix", matrix, 16) == 16)
+		{
+			std::memcpy(&node.transform[0][0], matrix, sizeof(matrix));
+		}
+		else
+		{
+			glm::vec3 t(0.0f);
+			glm::vec4 r(0.0f, 0.0f, 0.0f, 1.0f); // quaternion as (x, y, z, w)
+			glm::vec3 s(1.0f);
+			get_floats(n, "translation", &t.x, 3);
+			get_floats(n, "rotation", &r.x, 4);
+			get_floats(n, "scale", &s.x, 3);
+
+			node.transform =
+				glm::translate(glm::mat4(1.0f), t) *
+				glm::mat4_cast(glm::quat(r.w, r.x, r.y, r.z)) *
+				glm::scale(glm::mat4(1.0f), s);
+		}
+
+		doc->nodes.push_back(std::move(node));
+	}
+
+	return true;
+}
+
+// Texture references are resolved to the image uri, or "*<image index>" for
+// images stored in a buffer view, as with Assimp. Missing textures leave
+// `out` empty, and only invalid index values fail.
+static bool get_texture_path(
+	const JsonValue& root, const JsonValue* textureInfo, std::string& out)
+{
+	if (textureInfo == nullptr) { return true; }
+
+	const auto* textures = get_array(root, "textures");
+	const auto* images = get_array(root, "images");
+	int32_t texture = -1;
+	if (!get_integer(*textureInfo, "index", texture)) { return false; }
+	if (textures == nullptr || images == nullptr ||
+	    texture < 0 || static_cast<size_t>(texture) >= textures->size())
+	{
+		return true;
+	}
+
+	int32_t image = -1;
+	if (!get_integer((*textures)[texture], "source", image)) { return false; }
+	if (image < 0 || static_cast<size_t>(image) >= images->size()) { return true; }
+
+	const JsonValue* uri = (*images)[image].find("uri");
+	if (uri != nullptr && uri->string.compare(0, 5, "data:") != 0)
+	{
+		out = decode_uri(uri->string);
+	}
+	else
+	{
+		out = "*" + std::to_string(image);
+	}
+	return true;
+}
+
+static bool parse_materials(const JsonValue& root, vtek::GltfDocument* doc)
+{
+	const auto* materials = get_array(root, "materials");
+	if (materials == nullptr) { return true; }
+
+	using TT = vtek::ModelTextureType;
+	auto slot = [](TT type) { return static_cast<uint32_t>(type); };
+
+	for (const auto& m : *materials)
+	{
+		vtek::ModelMaterial material;
+		const JsonValue* name = m.find("name");
+		if (name != nullptr) { material.name = name->string; }
+
+		const JsonValue* pbr = m.find("pbrMetallicRoughness");
+		if (pbr != nullptr)
+		{
+			get_floats(*pbr, "baseColorFactor", &material.baseColorFactor.x, 4);
+			material.metallicFactor = get_float(*pbr, "metallicFactor", 1.0f);
+			material.roughnessFactor = get_float(*pbr, "roughnessFactor", 1.0f);
+
+			if (!get_texture_path(root, pbr->find("baseColorTexture"),
+			                      material.textures[slot(TT::base_color)]) ||
+			    !get_texture_path(root, pbr->find("metallicRoughnessTexture"),
+			                      material.textures[slot(TT::metallic_roughness)]))
+			{
+				return false;
+			}
+		}
+
+		get_floats(m, "emissiveFactor", &material.emissiveFactor.x, 3);
+		const JsonValue* doubleSided = m.find("doubleSided");
+		material.doubleSided = (doubleSided != nullptr) && doubleSided->boolean;
+
+		if (!get_texture_path(root, m.find("normalTexture"),
+		                      material.textures[slot(TT::normal)]) ||
+		    !get_texture_path(root, m.find("occlusionTexture"),
+		                      material.textures[slot(TT::occlusion)]) ||
+		    !get_texture_path(root, m.find("emissiveTexture"),
+		                      material.textures[slot(TT::emissive)]))
+		{
+			return false;
+		}
+
+		doc->materials.push_back(std::move(material));
+	}
+
+	return true;
+}
+
+static bool parse_scene(const JsonValue& root, vtek::GltfDocument* doc)
+{
+	const auto* scenes = get_array(root, "scenes");
+	uint32_t scene = 0U;
+	if (!get_integer(root, "scene", scene)) { return false; }
+	if (scenes != nullptr && scene < scenes->size())
+	{
+		const auto* nodes = get_array((*scenes)[scene], "nodes");
+		if (nodes != nullptr)
+		{
+			for (const auto& n : *nodes)
+			{
+				if (!is_integer<uint32_t>(n)) { return false; }
+				doc->sceneNodes.push_back(static_cast<uint32_t>(n.number));
+			}
+		}
+		return true;
+	}
+
+	// Without scenes, all nodes which are not children are roots
+	std::vector<bool> isChild(doc->nodes.size(), false);
+	for (const auto& node : doc->nodes)
+	{
+		for (uint32_t c : node.children)
+		{
+			if (c < isChild.size()) { isChild[c] = true; }
+		}
+	}
+	for (uint32_t i = 0; i < isChild.size(); i++)
+	{
+		if (!isChild[i]) { doc->sceneNodes.push_back(i); }
+	}
+
+	return true;
+}
+
+// All indices are checked once here, so the loader may use them freely
+static bool validate_document(const vtek::GltfDocument* doc)
+{
+	auto valid = [](int32_t index, size_t size) {
+		return index < 0 || static_cast<size_t>(index) < size;
+	};
+
+	// Strides are limited to [4, 252] by the specification, which also keeps
+	// accessor extents from overflowing in `gltf_get_accessor_data`.
+	for (const auto& view : doc->bufferViews)
+	{
+		if (view.buffer >= doc->bufferData.size() ||
+		    view.byteOffset + view.byteLength > doc->bufferSizes[view.buffer] ||
+		    (view.byteStride != 0 &&
+		     (view.byteStride < 4 || view.byteStride > 252 || view.byteStride % 4 != 0)))
+		{
+			return false;
+		}
+	}
+	for (const auto& accessor : doc->accessors)
+	{
+		if (!valid(accessor.bufferView, doc->bufferViews.size()) ||
+		    accessor.numComponents == 0 ||
+		    vtek::gltf_component_size(accessor.componentType) == 0)
+		{
+			return false;
+		}
+	}
+	for (const auto& mesh : doc->meshes)
+	{
+		for (const auto& p : mesh.primitives)
+		{
+			const size_t numAccessors = doc->accessors.size();
+			if (!valid(p.position, numAccessors) || !valid(p.normal, numAccessors) ||
+			    !valid(p.texCoord, numAccessors) || !valid(p.indices, numAccessors) ||
+			    !valid(p.material, doc->materials.size()))
+			{
+				return false;
+			}
+		}
+	}
+	// Nodes must form trees: each node has at most one parent, and scene
+	// roots have none, so the hierarchy can be walked without cycle checks.
+	std::vector<uint32_t> numParents(doc->nodes.size(), 0U);
+	for (const auto& node : doc->nodes)
+	{
+		if (!valid(node.mesh, doc->meshes.size())) { return false; }
+		for (uint32_t c : node.children)
+		{
+			if (c >= doc->nodes.size() || ++numParents[c] > 1) { return false; }
+		}
+	}
+	for (uint32_t n : doc->sceneNodes)
+	{
+		if (n >= doc->nodes.size() || numParents[n] != 0) { return false; }
+	}
+
+	return true;
+}
+
+
+
+/* interface */
+bool vtek::gltf_load(
+	const vtek::Directory* dir, std::string_view filename, vtek::GltfDocument* doc)
+{
+	vtek::FileMapping* mapping = vtek::file_map(dir, filename);
+	if (mapping == nullptr)
+	{
+		vtek_log_error("Failed to open glTF file {}!", filename);
+		return false;
+	}
+	doc->mappings.push_back(mapping);
+
+	const auto data = static_cast<const uint8_t*>(vtek::file_mapping_get_data(mapping));
+	const uint64_t size = vtek::file_mapping_get_size(mapping);
+
+	// GLB: 12-byte header, then a JSON chunk and an optional binary chunk,
+	// each with an 8-byte header of length and type.
+	const char* json = reinterpret_cast<const char*>(data);
+	uint64_t jsonSize = size;
+	const uint8_t* binChunk = nullptr;
+	uint64_t binChunkSize = 0UL;
+
+	if (size >= 12 && std::memcmp(data, "glTF", 4) == 0)
+	{
+		uint32_t header[3];
+		std::memcpy(header, data, sizeof(header));
+		if (header[1] != 2U || header[2] > size || size < 20)
+		{
+			vtek_log_error("Invalid or unsupported GLB file {}!", filename);
+			return false;
+		}
+
+		uint32_t chunk[2];
+		std::memcpy(chunk, data + 12, sizeof(chunk));
+		if (chunk[1] != 0x4E4F534AU || 20UL + chunk[0] > size) // "JSON"
+		{
+			vtek_log_error("Invalid GLB file {}, missing JSON chunk!", filename);
+			return false;
+		}
+		json = reinterpret_cast<const char*>(data + 20);
+		jsonSize = chunk[0];
+
+		const uint64_t binOffset = 20UL + ((chunk[0] + 3UL) & ~3UL);
+		if (binOffset + 8 <= size)
+		{
+			std::memcpy(chunk, data + binOffset, sizeof(chunk));
+			if (chunk[1] == 0x004E4942U && binOffset + 8 + chunk[0] <= size) // "BIN\0"
+			{
+				binChunk = data + binOffset + 8;
+				binChunkSize = chunk[0];
+			}
+		}
+	}
+
+	JsonValue root;
+	JsonParser parser(json, json + jsonSize);
+	if (!parser.parse(root) || !root.is_object())
+	{
+		vtek_log_error("Failed to parse glTF file {}!", filename);
+		return false;
+	}
+
+	const JsonValue* asset = root.find("asset");
+	const JsonValue* version = (asset != nullptr) ? asset->find("version") : nullptr;
+	if (version == nullptr || version->string.compare(0, 2, "2.") != 0)
+	{
+		vtek_log_error("glTF file {} is not version 2.x!", filename);
+		return false;
+	}
+
+	if (!load_buffers(dir, root, binChunk, binChunkSize, doc))
+	{
+		return false;
+	}
+
+	if (!parse_accessors(root, doc) || !parse_buffer_views(root, doc) ||
+	    !parse_meshes(root, doc) || !parse_nodes(root, doc) ||
+	    !parse_materials(root, doc) || !parse_scene(root, doc))
+	{
+		vtek_log_error("glTF file {} contains invalid indices or counts!", filename);
+		return false;
+	}
+
+	if (!validate_document(doc))
+	{
+		vtek_log_error("glTF file {} contains invalid references!", filename);
+		return false;
+	}
+
+	return true;
+}
+
+void vtek::gltf_release(vtek::GltfDocument* doc)
+{
+	for (auto mapping : doc->mappings)
+	{
+		vtek::file_unmap(mapping);
+	}
+	*doc = vtek::GltfDocument{};
+}
+
+uint32_t vtek::gltf_component_size(vtek::GltfComponentType type)
+{
+	switch (type)
+	{
+	case vtek::GltfComponentType::int8:
+	case vtek::GltfComponentType::uint8:   return 1U;
+	case vtek::GltfComponentType::int16:
+	case vtek::GltfComponentType::uint16:  return 2U;
+	case vtek::GltfComponentType::uint32:
+	case vtek::GltfComponentType::float32: return 4U;
+	default:                               return 0U;
+	}
+}
+
+const uint8_t* vtek::gltf_get_accessor_data(
+	const vtek::GltfDocument* doc, const vtek::GltfAccessor& accessor,
+	uint64_t* outStride)
+{
+	if (accessor.bufferView < 0 || accessor.sparse || accessor.count == 0)
+	{
+		return nullptr;
+	}
+
+	const vtek::GltfBufferView& view = doc->bufferViews[accessor.bufferView];
+	const uint64_t elementSize =
+		gltf_component_size(accessor.componentType) * accessor.numComponents;
+	const uint64_t stride = (view.byteStride != 0) ? view.byteStride : elementSize;
+
+	// The last element must end inside the buffer view
+	const uint64_t extent = accessor.byteOffset + stride * (accessor.count - 1) + elementSize;
+	if (extent > view.byteLength)
+	{
+		return nullptr;
+	}
+
+	*outStride = stride;
+	return doc->bufferData[view.buffer] + view.byteOffset + accessor.byteOffset;
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "vtek_fileio.hpp"
+#include "vtek_glm_includes.hpp"
+#include "vtek_models.hpp"
+
+
+namespace vtek
+{
+	// ====================== //
+	// === glTF 2.0 files === //
+	// ====================== //
+
+	// A minimal reader for glTF 2.0 files, both `.gltf` (JSON with external
+	// or base64-embedded buffers) and `.glb` (binary container). Only the
+	// parts needed for loading static models are read: scenes, nodes,
+	// meshes, accessors, buffer views, and materials. Buffer contents are
+	// not copied, but referenced inside memory-mapped files, so accessor
+	// data can be copied straight into staging memory.
+
+	// Accessor component types, as defined by the glTF specification
+	enum class GltfComponentType : uint32_t
+	{
+		int8 = 5120, uint8 = 5121, int16 = 5122, uint16 = 5123,
+		uint32 = 5125, float32 = 5126
+	};
+
+	struct GltfAccessor
+	{
+		int32_t bufferView {-1}; // -1 means all zeros, or sparse only
+		uint64_t byteOffset {0UL};
+		GltfComponentType componentType {GltfComponentType::float32};
+		uint32_t numComponents {1U}; // SCALAR = 1, VEC2 = 2, ..., MAT4 = 16
+		uint32_t count {0U};
+		bool normalized {false};
+		bool sparse {false};
+
+		// Required by the specification for POSITION accessors
+		bool hasBounds {false};
+		glm::vec3 min {0.0f};
+		glm::vec3 max {0.0f};
+	};
+
+	struct GltfBufferView
+	{
+		uint32_t buffer {0U};
+		uint64_t byteOffset {0UL};
+		uint64_t byteLength {0UL};
+		uint32_t byteStride {0U}; // 0 means tightly packed
+	};
+
+	// Mode 4 is a triangle list, which is the default
+	constexpr uint32_t kGltfModeTriangles = 4U;
+
+	struct GltfPrimitive
+	{
+		int32_t position {-1};
+		int32_t normal {-1};
+		int32_t texCoord {-1}; // TEXCOORD_0
+		int32_t indices {-1};
+		int32_t material {-1};
+		uint32_t mode {kGltfModeTriangles};
+	};
+
+	struct GltfMesh
+	{
+		std::vector<GltfPrimitive> primitives;
+	};
+
+	struct GltfNode
+	{
+		int32_t mesh {-1};
+		std::vector<uint32_t> children;
+		glm::mat4 transform {1.0f}; // local transform, from matrix or TRS
+	};
+
+	struct GltfDocument
+	{
+		std::vector<GltfAccessor> accessors;
+		std::vector<GltfBufferView> bufferViews;
+		std::vector<GltfMesh> meshes;
+		std::vector<GltfNode> nodes;
+		std::vector<uint32_t> sceneNodes; // root nodes of the default scene
+		std::vector<ModelMaterial> materials;
+
+		// Buffer contents, pointing into `mappings` or `embedded`
+		std::vector<const uint8_t*> bufferData;
+		std::vector<uint64_t> bufferSizes;
+
+		std::vector<FileMapping*> mappings;
+		std::vector<std::vector<uint8_t>> embedded;
+	};
+
+	// Parse the file and map its buffers. Returns false if the file is not
+	// valid glTF 2.0, or its buffers cannot be read. `gltf_release` must be
+	// called in either case.
+	bool gltf_load(const Directory* dir, std::string_view filename, GltfDocument* doc);
+	void gltf_release(GltfDocument* doc);
+
+	uint32_t gltf_component_size(GltfComponentType type);
+
+	// Pointer to the first element of an accessor, and the distance between
+	// elements in bytes, or nullptr if the accessor has no buffer view, is
+	// sparse, or is out of bounds of its buffer.
+	const uint8_t* gltf_get_accessor_data(
+		const GltfDocument* doc, const GltfAccessor& accessor, uint64_t* outStride);
+}
@@ -0,0 +1,176 @@
+#include "vtek_mesh_cache.hpp"
+
+#include "vtek_logging.hpp"
+
+// Standard
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+
+/* helper functions */
+static_assert(std::is_trivially_copyable_v<vtek::MeshCacheHeader>);
+
+static uint64_t align_up(uint64_t value, uint64_t alignment)
+{
+	return (value + alignment - 1) / alignment * alignment;
+}
+
+
+
+/* interface */
+uint64_t vtek::mesh_cache_hash(const void* data, uint64_t size, uint64_t seed)
+{
+	// FNV-1a style mixing on 8-byte words, which is fast enough to hash
+	// large source files in a fraction of the time it takes to parse them.
+	constexpr uint64_t kPrime = 0x100000001b3UL;
+	uint64_t hash = 0xcbf29ce484222325UL ^ seed;
+
+	const uint8_t* bytes = static_cast<const uint8_t*>(data);
+	uint64_t i = 0;
+	for (; i + 8 <= size; i += 8)
+	{
+		uint64_t word;
+		std::memcpy(&word, bytes + i, 8);
+		hash = (hash ^ word) * kPrime;
+		hash ^= hash >> 29;
+	}
+	for (; i < size; i++)
+	{
+		hash = (hash ^ bytes[i]) * kPrime;
+	}
+
+	return hash ^ size;
+}
+
+std::string vtek::mesh_cache_get_filename(
+	std::string_view sourceFilename, bool nextToSource,
+	uint64_t sourceHash, uint64_t optionsHash)
+{
+	if (nextToSource)
+	{
+		return std::string(sourceFilename) + ".vtekmesh";
+	}
+
+	char name[48];
+	std::snprintf(name, sizeof(name), "%016llx%016llx.vtekmesh",
+	              static_cast<unsigned long long>(sourceHash),
+	              static_cast<unsigned long long>(optionsHash));
+	return std::string(name);
+}
+
+bool vtek::mesh_cache_write(
+	const vtek::Directory* dir, std::string_view filename,
+	vtek::MeshCacheHeader header,
+	const void* const slotData[vtek::kMeshCacheNumSlots],
+	const uint64_t slotSizes[vtek::kMeshCacheNumSlots])
+{
+	uint64_t offset = align_up(sizeof(header), kMeshCacheSlotAlignment);
+	for (uint32_t i = 0; i < kMeshCacheNumSlots; i++)
+	{
+		header.slotOffsets[i] = (slotSizes[i] > 0) ? offset : 0UL;
+		header.slotSizes[i] = slotSizes[i];
+		offset = align_up(offset + slotSizes[i], kMeshCacheSlotAlignment);
+	}
+
+	// The cache file may be mapped by readers, e.g. by concurrent loads of
+	// the same model, so it is never rewritten in place. Instead a temporary
+	// file is written and then renamed over the cache file.
+	static std::atomic<uint32_t> sTempCounter {0U};
+	const std::string tempFilename = std::string(filename) + ".tmp"
+		+ std::to_string(sTempCounter.fetch_add(1U));
+
+	using FMFlag = vtek::FileModeFlag;
+	vtek::File* file = vtek::file_open(
+		dir, tempFilename, FMFlag::write | FMFlag::trunc | FMFlag::binary);
+	if (file == nullptr)
+	{
+		vtek_log_error("Failed to open mesh cache file {} for writing!", tempFilename);
+		return false;
+	}
+
+	bool success = vtek::file_write_data(file, &header, sizeof(header));
+	uint64_t written = sizeof(header);
+	const std::vector<char> padding(kMeshCacheSlotAlignment, 0);
+
+	for (uint32_t i = 0; i < kMeshCacheNumSlots && success; i++)
+	{
+		if (slotSizes[i] == 0) { continue; }
+
+		success &= vtek::file_write_data(
+			file, padding.data(), header.slotOffsets[i] - written);
+		success &= vtek::file_write_data(file, slotData[i], slotSizes[i]);
+		written = header.slotOffsets[i] + slotSizes[i];
+	}
+
+	vtek::file_close(file);
+	if (!success)
+	{
+		vtek_log_error("Failed to write mesh cache file {}!", tempFilename);
+	}
+	else
+	{
+		// May fail on some platforms while the cache file is mapped
+		success = vtek::file_rename(dir, tempFilename, filename);
+	}
+
+	if (!success)
+	{
+		std::error_code ec;
+		std::filesystem::remove(vtek::directory_get_path(dir, tempFilename), ec);
+	}
+
+	return success;
+}
+
+vtek::FileMapping* vtek::mesh_cache_open(
+	const vtek::Directory* dir, std::string_view filename,
+	uint64_t sourceHash, uint64_t optionsHash, vtek::MeshCacheHeader* outHeader)
+{
+	vtek::FileMapping* mapping = vtek::file_map(dir, filename);
+	if (mapping == nullptr) { return nullptr; }
+
+	const uint64_t size = vtek::file_mapping_get_size(mapping);
+	const auto data = static_cast<const uint8_t*>(vtek::file_mapping_get_data(mapping));
+
+	auto reject = [&](const char* reason) {
+		vtek_log_debug("Mesh cache file {} ignored: {}", filename, reason);
+		vtek::file_unmap(mapping);
+		return nullptr;
+	};
+
+	if (size < sizeof(vtek::MeshCacheHeader)) { return reject("too small"); }
+
+	vtek::MeshCacheHeader header;
+	std::memcpy(&header, data, sizeof(header));
+
+	const vtek::MeshCacheHeader reference{};
+	if (std::memcmp(header.magic, reference.magic, sizeof(header.magic)) != 0)
+	{
+		return reject("invalid file");
+	}
+	if (header.version != kMeshCacheVersion || header.headerSize != sizeof(header))
+	{
+		return reject("version mismatch");
+	}
+	if (header.sourceHash != sourceHash || header.optionsHash != optionsHash)
+	{
+		return reject("stale");
+	}
+	for (uint32_t i = 0; i < kMeshCacheNumSlots; i++)
+	{
+		// Written so that a corrupt header cannot overflow the sum
+		if (header.slotOffsets[i] > size ||
+		    header.slotSizes[i] > size - header.slotOffsets[i])
+		{
+			return reject("truncated");
+		}
+	}
+
+	*outHeader = header;
+	return mapping;
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "vtek_fileio.hpp"
+
+
+namespace vtek
+{
+	// ======================= //
+	// === Mesh cache file === //
+	// ======================= //
+
+	// A `.vtekmesh` file stores the processed (welded, optimized, and
+	// possibly quantized) buffer contents of a model, so that reloading it
+	// skips importing and processing the source file entirely.
+	//
+	// File layout:
+	//   [ MeshCacheHeader | slot 0 | slot 1 | ... ]
+	// where each slot is the exact contents of one GPU buffer, or other
+	// model data such as submeshes and materials, stored at an aligned
+	// offset so it can be copied directly from the mapped file.
+	//
+	// The file is stored in native byte order, and is rejected when the
+	// version, source hash, or options hash do not match.
+
+	constexpr uint32_t kMeshCacheVersion = 4U;
+	constexpr uint32_t kMeshCacheNumSlots = 6U;
+	constexpr uint64_t kMeshCacheSlotAlignment = 64UL;
+
+	struct MeshCacheHeader
+	{
+		char magic[8] {'V','T','E','K','M','E','S','H'};
+		uint32_t version {kMeshCacheVersion};
+		uint32_t headerSize {sizeof(MeshCacheHeader)};
+
+		uint64_t sourceHash {0UL};
+		uint64_t optionsHash {0UL};
+
+		// Model description, enums are stored as integers
+		uint32_t numVertices {0U};
+		uint32_t numIndices {0U};
+		uint32_t indexType {0U};
+		uint32_t vertexLayout {0U};
+		uint32_t vertexStride {0U};
+		uint32_t positionType {0U};
+		uint32_t normalType {0U};
+		uint32_t texCoordType {0U};
+		float boundsMin[3] {};
+		float boundsMax[3] {};
+		float dequantization[12] {};
+		uint64_t normalOffset {0UL};
+		uint64_t texCoordOffset {0UL};
+		uint64_t indexOffset {0UL};
+
+		// Location of each buffer's contents in the file, size 0 if unused
+		uint64_t slotOffsets[kMeshCacheNumSlots] {};
+		uint64_t slotSizes[kMeshCacheNumSlots] {};
+	};
+
+	// 64-bit hash for detecting changes to source files and load options.
+	uint64_t mesh_cache_hash(const void* data, uint64_t size, uint64_t seed = 0UL);
+
+	// Filename of the cache file. When stored next to the source this is
+	// "<filename>.vtekmesh", otherwise the name is derived from the hashes,
+	// so that several versions of the same source may coexist in a cache
+	// directory.
+	std::string mesh_cache_get_filename(
+		std::string_view sourceFilename, bool nextToSource,
+		uint64_t sourceHash, uint64_t optionsHash);
+
+	// Write the cache file. `header` should be filled out except for the
+	// slot offsets and sizes, which are computed from `slotSizes`.
+	bool mesh_cache_write(
+		const Directory* dir, std::string_view filename, MeshCacheHeader header,
+		const void* const slotData[kMeshCacheNumSlots],
+		const uint64_t slotSizes[kMeshCacheNumSlots]);
+
+	// Map a cache file, and validate it against the expected hashes. On
+	// success the header is returned through `outHeader`, and slot contents
+	// are at `file_mapping_get_data(mapping) + slotOffsets[i]`. Returns
+	// nullptr if the file does not exist, or is invalid or stale.
+	FileMapping* mesh_cache_open(
+		const Directory* dir, std::string_view filename,
+		uint64_t sourceHash, uint64_t optionsHash, MeshCacheHeader* outHeader);
+}
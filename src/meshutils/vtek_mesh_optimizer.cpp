@@ -0,0 +1,347 @@
+#include "vtek_mesh_optimizer.hpp"
+
+// Standard
+#include <algorithm>
+#include <numeric>
+
+
+/* helper functions */
+static constexpr uint32_t kInvalidVertex = UINT32_MAX;
+
+// For each vertex, the list of triangles it is part of
+struct TriangleAdjacency
+{
+	std::vector<uint32_t> counts;
+	std::vector<uint32_t> offsets;
+	std::vector<uint32_t> triangles;
+};
+
+static void build_adjacency(
+	TriangleAdjacency& adj, const uint32_t* indices, uint32_t numIndices,
+	uint32_t numVertices)
+{
+	adj.counts.assign(numVertices, 0U);
+	adj.offsets.assign(numVertices, 0U);
+	adj.triangles.resize(numIndices);
+
+	for (uint32_t i = 0; i < numIndices; i++)
+	{
+		adj.counts[indices[i]]++;
+	}
+
+	uint32_t offset = 0U;
+	for (uint32_t v = 0; v < numVertices; v++)
+	{
+		adj.offsets[v] = offset;
+		offset += adj.counts[v];
+	}
+
+	std::vector<uint32_t> fill = adj.offsets;
+	for (uint32_t i = 0; i < numIndices; i++)
+	{
+		adj.triangles[fill[indices[i]]++] = i / 3;
+	}
+}
+
+// The FIFO cache is simulated with timestamps. A vertex is in the cache if
+// fewer than `cacheSize` vertices have entered the cache since it did.
+// Flushing the cache is done by advancing the timestamp past `cacheSize`.
+struct CacheSimulation
+{
+	std::vector<uint32_t> cacheTime;
+	uint32_t timestamp {0U};
+	uint32_t cacheSize {0U};
+
+	CacheSimulation(uint32_t numVertices, uint32_t size)
+		: cacheTime(numVertices, 0U), timestamp(size + 1), cacheSize(size) {}
+
+	// Returns true on cache miss
+	bool access(uint32_t v)
+	{
+		if (timestamp - cacheTime[v] > cacheSize)
+		{
+			cacheTime[v] = timestamp++;
+			return true;
+		}
+		return false;
+	}
+
+	uint32_t access_triangle(const uint32_t* tri)
+	{
+		return access(tri[0]) + access(tri[1]) + access(tri[2]);
+	}
+
+	void flush() { timestamp += cacheSize + 1; }
+};
+
+static uint32_t tipsify_skip_dead_end(
+	const std::vector<uint32_t>& liveTriangles, std::vector<uint32_t>& deadEnd,
+	uint32_t& cursor, uint32_t numVertices)
+{
+	// Recently used vertices with triangles left
+	while (!deadEnd.empty())
+	{
+		uint32_t v = deadEnd.back();
+		deadEnd.pop_back();
+		if (liveTriangles[v] > 0) { return v; }
+	}
+
+	// Otherwise, continue through the input order
+	for (; cursor < numVertices; cursor++)
+	{
+		if (liveTriangles[cursor] > 0) { return cursor; }
+	}
+
+	return kInvalidVertex;
+}
+
+static uint32_t tipsify_next_vertex(
+	const std::vector<uint32_t>& candidates,
+	const std::vector<uint32_t>& liveTriangles,
+	const std::vector<uint32_t>& cacheTime, uint32_t timestamp,
+	uint32_t cacheSize)
+{
+	uint32_t best = kInvalidVertex;
+	int64_t bestPriority = -1;
+
+	for (uint32_t v : candidates)
+	{
+		if (liveTriangles[v] == 0) { continue; }
+
+		// Prefer the oldest vertex which will still be in the cache after
+		// fanning out all of its remaining triangles.
+		int64_t priority = 0;
+		uint32_t age = timestamp - cacheTime[v];
+		if (age + 2 * liveTriangles[v] <= cacheSize) { priority = age; }
+
+		if (priority > bestPriority)
+		{
+			best = v;
+			bestPriority = priority;
+		}
+	}
+
+	return best;
+}
+
+
+
+/* interface */
+void vtek::mesh_optimize_vertex_cache(
+	uint32_t* indices, uint32_t numIndices, uint32_t numVertices,
+	uint32_t cacheSize)
+{
+	const uint32_t numTriangles = numIndices / 3;
+	if (numTriangles < 2) { return; }
+
+	TriangleAdjacency adj;
+	build_adjacency(adj, indices, numIndices, numVertices);
+
+	std::vector<uint32_t> liveTriangles = adj.counts;
+	std::vector<bool> emitted(numTriangles, false);
+	std::vector<uint32_t> deadEnd;
+	std::vector<uint32_t> candidates;
+	std::vector<uint32_t> output;
+	output.reserve(numIndices);
+
+	CacheSimulation cache(numVertices, cacheSize);
+	uint32_t cursor = 0U;
+	uint32_t fanning = indices[0];
+
+	while (fanning != kInvalidVertex)
+	{
+		candidates.clear();
+
+		// Emit all remaining triangles around the fanning vertex
+		const uint32_t begin = adj.offsets[fanning];
+		const uint32_t end = begin + adj.counts[fanning];
+		for (uint32_t j = begin; j < end; j++)
+		{
+			uint32_t t = adj.triangles[j];
+			if (emitted[t]) { continue; }
+
+			for (uint32_t k = 0; k < 3; k++)
+			{
+				uint32_t v = indices[3 * t + k];
+				output.push_back(v);
+				deadEnd.push_back(v);
+				candidates.push_back(v);
+				liveTriangles[v]--;
+				cache.access(v);
+			}
+			emitted[t] = true;
+		}
+
+		fanning = tipsify_next_vertex(
+			candidates, liveTriangles, cache.cacheTime, cache.timestamp, cacheSize);
+		if (fanning == kInvalidVertex)
+		{
+			fanning = tipsify_skip_dead_end(
+				liveTriangles, deadEnd, cursor, numVertices);
+		}
+	}
+
+	std::copy(output.begin(), output.end(), indices);
+}
+
+void vtek::mesh_optimize_overdraw(
+	uint32_t* indices, uint32_t numIndices, const glm::vec3* positions,
+	uint32_t numVertices, uint32_t cacheSize, float threshold)
+{
+	const uint32_t numTriangles = numIndices / 3;
+	if (numTriangles < 2) { return; }
+
+	CacheSimulation cache(numVertices, cacheSize);
+
+	// 1) Hard boundaries, where a triangle misses the cache entirely. This
+	// is where the vertex cache optimization restarted from a dead end.
+	std::vector<uint32_t> hardClusters;
+	uint32_t inputMisses = 0U;
+	for (uint32_t t = 0; t < numTriangles; t++)
+	{
+		uint32_t misses = cache.access_triangle(indices + 3 * t);
+		if (t == 0 || misses == 3) { hardClusters.push_back(t); }
+		inputMisses += misses;
+	}
+	hardClusters.push_back(numTriangles);
+
+	// 2) Soft boundaries, splitting hard clusters further as long as the
+	// cache miss ratio up to the split stays within the threshold.
+	std::vector<uint32_t> clusters;
+	for (size_t c = 0; c + 1 < hardClusters.size(); c++)
+	{
+		const uint32_t start = hardClusters[c];
+		const uint32_t end = hardClusters[c + 1];
+
+		cache.flush();
+		uint32_t clusterMisses = 0U;
+		for (uint32_t t = start; t < end; t++)
+		{
+			clusterMisses += cache.access_triangle(indices + 3 * t);
+		}
+		const float clusterAcmr = static_cast<float>(clusterMisses) / (end - start);
+
+		clusters.push_back(start);
+		cache.flush();
+		uint32_t softStart = start;
+		uint32_t misses = 0U;
+		for (uint32_t t = start; t < end; t++)
+		{
+			misses += cache.access_triangle(indices + 3 * t);
+
+			const float acmr = static_cast<float>(misses) / (t - softStart + 1);
+			if (t + 1 < end && acmr <= threshold * clusterAcmr)
+			{
+				clusters.push_back(t + 1);
+				cache.flush();
+				softStart = t + 1;
+				misses = 0U;
+			}
+		}
+	}
+	clusters.push_back(numTriangles);
+
+	// 3) Sort clusters by how much they face away from the mesh centroid.
+	// Area-weighted centroids are used, and the length of the cross product
+	// is twice the triangle area.
+	const uint32_t numClusters = clusters.size() - 1;
+	std::vector<glm::vec3> clusterCentroids(numClusters, glm::vec3(0.0f));
+	std::vector<glm::vec3> clusterNormals(numClusters, glm::vec3(0.0f));
+	std::vector<float> clusterAreas(numClusters, 0.0f);
+	glm::vec3 meshCentroid(0.0f);
+	float meshArea = 0.0f;
+
+	for (uint32_t c = 0; c < numClusters; c++)
+	{
+		for (uint32_t t = clusters[c]; t < clusters[c + 1]; t++)
+		{
+			const glm::vec3& p0 = positions[indices[3 * t + 0]];
+			const glm::vec3& p1 = positions[indices[3 * t + 1]];
+			const glm::vec3& p2 = positions[indices[3 * t + 2]];
+
+			glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+			float area = glm::length(normal);
+			glm::vec3 centroid = (p0 + p1 + p2) * (area / 3.0f);
+
+			clusterCentroids[c] += centroid;
+			clusterNormals[c] += normal;
+			clusterAreas[c] += area;
+			meshCentroid += centroid;
+			meshArea += area;
+		}
+	}
+	if (meshArea > 0.0f) { meshCentroid /= meshArea; }
+
+	std::vector<float> sortKeys(numClusters, 0.0f);
+	for (uint32_t c = 0; c < numClusters; c++)
+	{
+		if (clusterAreas[c] <= 0.0f) { continue; }
+
+		glm::vec3 centroid = clusterCentroids[c] / clusterAreas[c];
+		float length = glm::length(clusterNormals[c]);
+		glm::vec3 normal = (length > 0.0f) ? clusterNormals[c] / length : glm::vec3(0.0f);
+
+		sortKeys[c] = glm::dot(centroid - meshCentroid, normal);
+	}
+
+	std::vector<uint32_t> order(numClusters);
+	std::iota(order.begin(), order.end(), 0U);
+	std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+		return sortKeys[a] > sortKeys[b];
+	});
+
+	std::vector<uint32_t> output;
+	output.reserve(numIndices);
+	for (uint32_t c : order)
+	{
+		output.insert(output.end(),
+		              indices + 3 * clusters[c], indices + 3 * clusters[c + 1]);
+	}
+
+	// Clusters are measured from a flushed cache, so reordering them loses
+	// any reuse across cluster boundaries in the input. Keep the input order
+	// if that costs more than the threshold allows.
+	CacheSimulation outputCache(numVertices, cacheSize);
+	uint32_t outputMisses = 0U;
+	for (uint32_t t = 0; t < numTriangles; t++)
+	{
+		outputMisses += outputCache.access_triangle(output.data() + 3 * t);
+	}
+	if (outputMisses > threshold * inputMisses) { return; }
+
+	std::copy(output.begin(), output.end(), indices);
+}
+
+uint32_t vtek::mesh_optimize_vertex_fetch(
+	uint32_t* indices, uint32_t numIndices, uint32_t numVertices,
+	std::vector<uint32_t>& outRemap)
+{
+	outRemap.assign(numVertices, kInvalidVertex);
+
+	uint32_t next = 0U;
+	for (uint32_t i = 0; i < numIndices; i++)
+	{
+		uint32_t& remapped = outRemap[indices[i]];
+		if (remapped == kInvalidVertex) { remapped = next++; }
+		indices[i] = remapped;
+	}
+
+	return next;
+}
+
+float vtek::mesh_compute_acmr(
+	const uint32_t* indices, uint32_t numIndices, uint32_t numVertices,
+	uint32_t cacheSize)
+{
+	const uint32_t numTriangles = numIndices / 3;
+	if (numTriangles == 0) { return 0.0f; }
+
+	CacheSimulation cache(numVertices, cacheSize);
+	uint32_t misses = 0U;
+	for (uint32_t t = 0; t < numTriangles; t++)
+	{
+		misses += cache.access_triangle(indices + 3 * t);
+	}
+
+	return static_cast<float>(misses) / numTriangles;
+}
@@ -163,6 +163,16 @@ static void createinfo_stagingbuffer(VmaAllocationCreateInfo* info)
 	info->preferredFlags = VK_MEMORY_PROPERTY_HOST_COHERENT_BIT; // TODO: ?
 }
 
+// A readback buffer, which the GPU writes into and the host reads from, should
+// reside in HOST_CACHED memory, since reading from uncached memory is very slow.
+// It may not be HOST_COHERENT, in which case it must be invalidated before reading.
+static void createinfo_readbackbuffer(VmaAllocationCreateInfo* info)
+{
+	info->usage = VMA_MEMORY_USAGE_AUTO;
+	info->flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT;
+	info->preferredFlags = VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+}
+
 static void createinfo_devicelocal(VmaAllocationCreateInfo* info)
 {
 	info->usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
@@ -182,7 +192,10 @@ bool vtek::allocator_buffer_create(
 	bufferInfo.usage = get_buffer_usage_flags(info->usageFlags);
 
 	VmaAllocationCreateInfo createInfo{};
-	if (info->requireHostVisibleStorage) {
+	if (info->requireHostVisibleStorage && info->preferHostCachedStorage) {
+		createinfo_readbackbuffer(&createInfo);
+	}
+	else if (info->requireHostVisibleStorage) {
 		createinfo_stagingbuffer(&createInfo);
 	}
 	else {
@@ -278,23 +291,38 @@ void vtek::allocator_buffer_flush(
 	}
 }
 
-bool vtek::allocator_image2d_create(
-	vtek::Allocator* allocator, const vtek::Image2DInfo* info,
-	vtek::Image2D* outImage)
+void vtek::allocator_buffer_invalidate(
+	vtek::Buffer* buffer, const vtek::BufferRegion* region)
 {
-	// 1) Fill `VkImageCreateInfo` struct
-	VkImageCreateInfo imageInfo{};
-	imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
-	imageInfo.pNext = nullptr;
-	imageInfo.flags = 0; // TODO: Optional `VkImageCreateFlagBits`
-	imageInfo.imageType = VK_IMAGE_TYPE_2D;
-	imageInfo.extent = { info->extent.width, info->extent.height, 1 };
-	imageInfo.arrayLayers = 1;
-	imageInfo.samples = vtek::get_multisample_count(info->multisampling);
-	imageInfo.usage = get_image_usage_flags(info->usageFlags);
+	VmaAllocator alloc = buffer->allocator->vmaHandle;
+
+	VkResult result = vmaInvalidateAllocation(
+		alloc, buffer->vmaHandle, region->offset, region->size);
+	if (result != VK_SUCCESS)
+	{
+		vtek_log_error("Failed to invalidate buffer from allocator -- {}",
+		               "device writes will likely not be visible!");
+	}
+}
+
+// Shared by all ways of creating 2D images. `queueIndices` must outlive
+// the create info, which points into it.
+static bool fill_image2d_createinfo(
+	const vtek::Image2DInfo* info, VkImageCreateInfo* imageInfo,
+	std::vector<uint32_t>& queueIndices)
+{
+	*imageInfo = VkImageCreateInfo{};
+	imageInfo->sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+	imageInfo->pNext = nullptr;
+	imageInfo->flags = 0; // TODO: Optional `VkImageCreateFlagBits`
+	imageInfo->imageType = VK_IMAGE_TYPE_2D;
+	imageInfo->extent = { info->extent.width, info->extent.height, 1 };
+	imageInfo->arrayLayers = 1;
+	imageInfo->samples = vtek::get_multisample_count(info->multisampling);
+	imageInfo->usage = get_image_usage_flags(info->usageFlags);
 
 	if (info->format != vtek::Format::undefined) {
-		imageInfo.format = vtek::get_format(info->format);
+		imageInfo->format = vtek::get_format(info->format);
 	}
 	else if (!info->supportedFormat.is_valid()) {
 		vtek_log_error("allocator_image2d_create(): {} -- {}",
@@ -303,47 +331,92 @@ bool vtek::allocator_image2d_create(
 		return false;
 	}
 	else {
-		imageInfo.format = info->supportedFormat.get_native();
+		imageInfo->format = info->supportedFormat.get_native();
 	}
 
 	if (info->useMipmaps) {
-		imageInfo.mipLevels = 4; // TODO: Perform proper calculation!
+		imageInfo->mipLevels = 4; // TODO: Perform proper calculation!
 	}
 	else {
-		imageInfo.mipLevels = 1;
+		imageInfo->mipLevels = 1;
 	}
 
 	if (info->initialLayout == vtek::ImageInitialLayout::preinitialized &&
 	    info->usageFlags.has_flag(vtek::ImageUsageFlag::transfer_dst))
 	{
-		imageInfo.tiling = VK_IMAGE_TILING_LINEAR;
-		imageInfo.initialLayout = VK_IMAGE_LAYOUT_PREINITIALIZED;
+		imageInfo->tiling = VK_IMAGE_TILING_LINEAR;
+		imageInfo->initialLayout = VK_IMAGE_LAYOUT_PREINITIALIZED;
 	}
 	else
 	{
-		imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
-		imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		imageInfo->tiling = VK_IMAGE_TILING_OPTIMAL;
+		imageInfo->initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
 	}
 
 	// Sharing mode, if the image is accessed by multiple queue families
-	std::vector<uint32_t> queueIndices;
+	queueIndices.clear();
 	if (info->sharingMode == vtek::ImageSharingMode::exclusive)
 	{
-		imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-		imageInfo.queueFamilyIndexCount = 0;
-		imageInfo.pQueueFamilyIndices = nullptr;
+		imageInfo->sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		imageInfo->queueFamilyIndexCount = 0;
+		imageInfo->pQueueFamilyIndices = nullptr;
 	}
 	else
 	{
-		imageInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+		imageInfo->sharingMode = VK_SHARING_MODE_CONCURRENT;
 		for (const auto* q : info->sharingQueues)
 		{
 			queueIndices.push_back(vtek::queue_get_family_index(q));
 		}
-		imageInfo.queueFamilyIndexCount = queueIndices.size();
-		imageInfo.pQueueFamilyIndices = queueIndices.data();
+		imageInfo->queueFamilyIndexCount = queueIndices.size();
+		imageInfo->pQueueFamilyIndices = queueIndices.data();
 	}
 
+	return true;
+}
+
+static void fill_image2d_state(
+	const VkImageCreateInfo* imageInfo, const vtek::Image2DInfo* info,
+	vtek::Image2D* outImage)
+{
+	outImage->extent = info->extent;
+	outImage->format = imageInfo->format;
+
+	// Layout tracking, starting from the image's initial layout
+	vtek::Format format = vtek::get_format_from_native(imageInfo->format);
+	switch (vtek::get_format_depth_stencil_test(format))
+	{
+	case vtek::FormatDepthStencilTest::depth:
+		outImage->aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+		break;
+	case vtek::FormatDepthStencilTest::stencil:
+		outImage->aspectMask = VK_IMAGE_ASPECT_STENCIL_BIT;
+		break;
+	case vtek::FormatDepthStencilTest::depth_and_stencil:
+		outImage->aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+		break;
+	default:
+		outImage->aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		break;
+	}
+	outImage->mipLevels = imageInfo->mipLevels;
+	outImage->arrayLayers = imageInfo->arrayLayers;
+
+	vtek::ImageSubresourceState initialState{};
+	initialState.layout = imageInfo->initialLayout;
+	outImage->subresourceStates.assign(
+		imageInfo->mipLevels * imageInfo->arrayLayers, initialState);
+}
+
+bool vtek::allocator_image2d_create(
+	vtek::Allocator* allocator, const vtek::Image2DInfo* info,
+	vtek::Image2D* outImage)
+{
+	// 1) Fill `VkImageCreateInfo` struct
+	VkImageCreateInfo imageInfo{};
+	std::vector<uint32_t> queueIndices;
+	if (!fill_image2d_createinfo(info, &imageInfo, queueIndices)) { return false; }
+
 	// 2) Fill `VmaAllocationCreateinfo` struct
 	VmaAllocationCreateInfo createInfo{};
 	createinfo_devicelocal(&createInfo); // NOTE: Device-local preference assumed!
@@ -365,9 +438,84 @@ bool vtek::allocator_image2d_create(
 
 	outImage->vulkanHandle = image;
 	outImage->vmaHandle = allocation;
-	outImage->extent = info->extent;
-	outImage->format = imageInfo.format;
 	outImage->allocator = allocator;
+	fill_image2d_state(&imageInfo, info, outImage);
+
+	return true;
+}
+
+bool vtek::allocator_image2d_get_memory_requirements(
+	vtek::Allocator* allocator, const vtek::Image2DInfo* info,
+	VkMemoryRequirements* outRequirements)
+{
+	VkImageCreateInfo imageInfo{};
+	std::vector<uint32_t> queueIndices;
+	if (!fill_image2d_createinfo(info, &imageInfo, queueIndices)) { return false; }
+
+	// Requirements are only known for an actual image, so create one
+	// without any memory bound to it.
+	VmaAllocatorInfo allocatorInfo{};
+	vmaGetAllocatorInfo(allocator->vmaHandle, &allocatorInfo);
+	VkDevice device = allocatorInfo.device;
+
+	VkImage image = VK_NULL_HANDLE;
+	if (vkCreateImage(device, &imageInfo, nullptr, &image) != VK_SUCCESS)
+	{
+		vtek_log_error("Failed to create 2D image for memory requirements!");
+		return false;
+	}
+	vkGetImageMemoryRequirements(device, image, outRequirements);
+	vkDestroyImage(device, image, nullptr);
+
+	return true;
+}
+
+VmaAllocation vtek::allocator_memory_allocate(
+	vtek::Allocator* allocator, const VkMemoryRequirements* requirements)
+{
+	VmaAllocationCreateInfo createInfo{};
+	createinfo_devicelocal(&createInfo);
+
+	VmaAllocation allocation = VK_NULL_HANDLE;
+	VkResult result = vmaAllocateMemory(
+		allocator->vmaHandle, requirements, &createInfo, &allocation, nullptr);
+	if (result != VK_SUCCESS)
+	{
+		vtek_log_error("Failed to allocate {} bytes of device memory with vma!",
+		               requirements->size);
+		return VK_NULL_HANDLE;
+	}
+
+	return allocation;
+}
+
+void vtek::allocator_memory_free(vtek::Allocator* allocator, VmaAllocation allocation)
+{
+	vmaFreeMemory(allocator->vmaHandle, allocation);
+}
+
+bool vtek::allocator_image2d_create_aliased(
+	vtek::Allocator* allocator, const vtek::Image2DInfo* info,
+	VmaAllocation allocation, uint64_t offset, vtek::Image2D* outImage)
+{
+	VkImageCreateInfo imageInfo{};
+	std::vector<uint32_t> queueIndices;
+	if (!fill_image2d_createinfo(info, &imageInfo, queueIndices)) { return false; }
+
+	VkImage image = VK_NULL_HANDLE;
+	VkResult result = vmaCreateAliasingImage2(
+		allocator->vmaHandle, allocation, offset, &imageInfo, &image);
+	if (result != VK_SUCCESS)
+	{
+		vtek_log_error("Failed to create aliased 2D image with vma!");
+		return false;
+	}
+
+	// The memory is owned by the caller, so the image must not free it
+	outImage->vulkanHandle = image;
+	outImage->vmaHandle = VK_NULL_HANDLE;
+	outImage->allocator = allocator;
+	fill_image2d_state(&imageInfo, info, outImage);
 
 	return true;
 }
@@ -0,0 +1,472 @@
+#include "vtek_vulkan.pch"
+#include "vtek_barrier_batch.hpp"
+
+#include "impl/vtek_device_functions.hpp"
+#include "impl/vtek_vma_helpers.hpp"
+#include "vtek_command_buffer.hpp"
+#include "vtek_device.hpp"
+#include "vtek_logging.hpp"
+
+#include <algorithm>
+#include <vector>
+
+
+/* struct implementation */
+struct vtek::BarrierBatch
+{
+	std::vector<VkImageMemoryBarrier2> imageBarriers;
+	std::vector<VkBufferMemoryBarrier2> bufferBarriers;
+
+	// nullptr if synchronization2 is not enabled
+	PFN_vkCmdPipelineBarrier2KHR cmdPipelineBarrier2 {nullptr};
+};
+
+
+
+/* helper functions */
+struct AccessInfo
+{
+	VkPipelineStageFlags2 stages;
+	VkAccessFlags2 access;
+	VkImageLayout layout;
+	bool write;
+};
+
+static AccessInfo get_access_info(vtek::ImageAccessType type)
+{
+	constexpr VkPipelineStageFlags2 kFragmentTests =
+		VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT |
+		VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT;
+	constexpr VkPipelineStageFlags2 kAllShaders =
+		VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT |
+		VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT |
+		VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+
+	switch (type)
+	{
+	case vtek::ImageAccessType::color_attachment_write:
+		return { VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+		         VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT |
+		         VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
+		         VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, true };
+	case vtek::ImageAccessType::depth_stencil_attachment_write:
+		return { kFragmentTests,
+		         VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT |
+		         VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+		         VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, true };
+	case vtek::ImageAccessType::depth_stencil_attachment_read:
+		return { kFragmentTests, VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT,
+		         VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL, false };
+	case vtek::ImageAccessType::vertex_shader_read:
+		return { VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT, VK_ACCESS_2_SHADER_READ_BIT,
+		         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, false };
+	case vtek::ImageAccessType::fragment_shader_read:
+		return { VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT, VK_ACCESS_2_SHADER_READ_BIT,
+		         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, false };
+	case vtek::ImageAccessType::compute_shader_read:
+		return { VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_READ_BIT,
+		         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, false };
+	case vtek::ImageAccessType::any_shader_read:
+		return { kAllShaders, VK_ACCESS_2_SHADER_READ_BIT,
+		         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, false };
+	case vtek::ImageAccessType::compute_shader_write:
+		return { VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+		         VK_ACCESS_2_SHADER_READ_BIT | VK_ACCESS_2_SHADER_WRITE_BIT,
+		         VK_IMAGE_LAYOUT_GENERAL, true };
+	case vtek::ImageAccessType::transfer_src:
+		return { VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_READ_BIT,
+		         VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, false };
+	case vtek::ImageAccessType::transfer_dst:
+		return { VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT,
+		         VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, true };
+	case vtek::ImageAccessType::present:
+		// Presentation engine reads are synchronized by semaphores
+		return { VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE,
+		         VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, false };
+	case vtek::ImageAccessType::general:
+	default:
+		return { VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+		         VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT,
+		         VK_IMAGE_LAYOUT_GENERAL, true };
+	}
+}
+
+static AccessInfo get_access_info(vtek::BufferAccessType type)
+{
+	constexpr VkPipelineStageFlags2 kAllShaders =
+		VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT |
+		VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT |
+		VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+	constexpr VkAccessFlags2 kShaderRead =
+		VK_ACCESS_2_UNIFORM_READ_BIT | VK_ACCESS_2_SHADER_READ_BIT;
+	constexpr VkImageLayout kNoLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+	switch (type)
+	{
+	case vtek::BufferAccessType::vertex_input_read:
+		return { VK_PIPELINE_STAGE_2_VERTEX_INPUT_BIT,
+		         VK_ACCESS_2_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_2_INDEX_READ_BIT,
+		         kNoLayout, false };
+	case vtek::BufferAccessType::indirect_read:
+		return { VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT,
+		         VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT, kNoLayout, false };
+	case vtek::BufferAccessType::vertex_shader_read:
+		return { VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT, kShaderRead, kNoLayout, false };
+	case vtek::BufferAccessType::fragment_shader_read:
+		return { VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT, kShaderRead, kNoLayout, false };
+	case vtek::BufferAccessType::compute_shader_read:
+		return { VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, kShaderRead, kNoLayout, false };
+	case vtek::BufferAccessType::any_shader_read:
+		return { kAllShaders, kShaderRead, kNoLayout, false };
+	case vtek::BufferAccessType::compute_shader_write:
+		return { VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+		         VK_ACCESS_2_SHADER_READ_BIT | VK_ACCESS_2_SHADER_WRITE_BIT,
+		         kNoLayout, true };
+	case vtek::BufferAccessType::transfer_src:
+		return { VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_READ_BIT,
+		         kNoLayout, false };
+	case vtek::BufferAccessType::transfer_dst:
+		return { VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT,
+		         kNoLayout, true };
+	case vtek::BufferAccessType::general:
+	default:
+		return { VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+		         VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT,
+		         kNoLayout, true };
+	}
+}
+
+// Compute the barrier needed for one subresource, and update its state.
+// Returns false if no barrier is needed.
+static bool make_barrier(
+	vtek::ImageSubresourceState& state, const AccessInfo& info,
+	bool discardContents, VkImageMemoryBarrier2* outBarrier)
+{
+	const bool layoutChange = (state.layout != info.layout);
+	VkImageMemoryBarrier2& b = *outBarrier;
+	b.oldLayout = discardContents ? VK_IMAGE_LAYOUT_UNDEFINED : state.layout;
+	b.newLayout = info.layout;
+	b.dstStageMask = info.stages;
+	b.dstAccessMask = info.access;
+
+	if (layoutChange || info.write)
+	{
+		// Wait for all previous accesses: write-after-write, write-after-read,
+		// and layout transitions, which both read and write the image.
+		b.srcStageMask = state.writeStages | state.readStages;
+		b.srcAccessMask = state.writeAccess;
+
+		if (info.write)
+		{
+			state.writeStages = info.stages;
+			state.writeAccess = info.access;
+			state.readStages = VK_PIPELINE_STAGE_2_NONE;
+		}
+		else
+		{
+			// Later readers in other stages must wait for the transition
+			state.writeStages = info.stages;
+			state.writeAccess = VK_ACCESS_2_NONE;
+			state.readStages = info.stages;
+		}
+		state.layout = info.layout;
+
+		// Nothing to wait for, and nothing to transition
+		return layoutChange || b.srcStageMask != VK_PIPELINE_STAGE_2_NONE;
+	}
+
+	// Read-after-read needs no barrier, and neither does a read after a
+	// write that has already been made visible to the reading stages.
+	const VkPipelineStageFlags2 newStages = info.stages & ~state.readStages;
+	state.readStages |= info.stages;
+	if (newStages == VK_PIPELINE_STAGE_2_NONE ||
+	    state.writeStages == VK_PIPELINE_STAGE_2_NONE)
+	{
+		return false;
+	}
+
+	// Read-after-write
+	b.srcStageMask = state.writeStages;
+	b.srcAccessMask = state.writeAccess;
+	b.dstStageMask = newStages;
+	return true;
+}
+
+// Same as above, but buffers have no layouts to transition.
+static bool make_barrier(
+	vtek::BufferAccessState& state, const AccessInfo& info,
+	VkBufferMemoryBarrier2* outBarrier)
+{
+	VkBufferMemoryBarrier2& b = *outBarrier;
+	b.dstStageMask = info.stages;
+	b.dstAccessMask = info.access;
+
+	if (info.write)
+	{
+		b.srcStageMask = state.writeStages | state.readStages;
+		b.srcAccessMask = state.writeAccess;
+
+		state.writeStages = info.stages;
+		state.writeAccess = info.access;
+		state.readStages = VK_PIPELINE_STAGE_2_NONE;
+
+		return b.srcStageMask != VK_PIPELINE_STAGE_2_NONE;
+	}
+
+	const VkPipelineStageFlags2 newStages = info.stages & ~state.readStages;
+	state.readStages |= info.stages;
+	if (newStages == VK_PIPELINE_STAGE_2_NONE ||
+	    state.writeStages == VK_PIPELINE_STAGE_2_NONE)
+	{
+		return false;
+	}
+
+	b.srcStageMask = state.writeStages;
+	b.srcAccessMask = state.writeAccess;
+	b.dstStageMask = newStages;
+	return true;
+}
+
+static bool same_barrier(const VkImageMemoryBarrier2& a, const VkImageMemoryBarrier2& b)
+{
+	return a.srcStageMask == b.srcStageMask && a.srcAccessMask == b.srcAccessMask &&
+		a.dstStageMask == b.dstStageMask && a.dstAccessMask == b.dstAccessMask &&
+		a.oldLayout == b.oldLayout && a.newLayout == b.newLayout;
+}
+
+static void flush_legacy(vtek::BarrierBatch* batch, VkCommandBuffer cmdBuf)
+{
+	// Without synchronization2, all barriers share one pair of stage masks.
+	// The stage and access bits used here all have legacy equivalents.
+	VkPipelineStageFlags srcStages = 0;
+	VkPipelineStageFlags dstStages = 0;
+	std::vector<VkImageMemoryBarrier> barriers;
+	barriers.reserve(batch->imageBarriers.size());
+	std::vector<VkBufferMemoryBarrier> bufferBarriers;
+	bufferBarriers.reserve(batch->bufferBarriers.size());
+
+	for (const auto& b2 : batch->imageBarriers)
+	{
+		srcStages |= static_cast<VkPipelineStageFlags>(b2.srcStageMask);
+		dstStages |= static_cast<VkPipelineStageFlags>(b2.dstStageMask);
+
+		VkImageMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		barrier.pNext = nullptr;
+		barrier.srcAccessMask = static_cast<VkAccessFlags>(b2.srcAccessMask);
+		barrier.dstAccessMask = static_cast<VkAccessFlags>(b2.dstAccessMask);
+		barrier.oldLayout = b2.oldLayout;
+		barrier.newLayout = b2.newLayout;
+		barrier.srcQueueFamilyIndex = b2.srcQueueFamilyIndex;
+		barrier.dstQueueFamilyIndex = b2.dstQueueFamilyIndex;
+		barrier.image = b2.image;
+		barrier.subresourceRange = b2.subresourceRange;
+		barriers.push_back(barrier);
+	}
+
+	for (const auto& b2 : batch->bufferBarriers)
+	{
+		srcStages |= static_cast<VkPipelineStageFlags>(b2.srcStageMask);
+		dstStages |= static_cast<VkPipelineStageFlags>(b2.dstStageMask);
+
+		VkBufferMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+		barrier.pNext = nullptr;
+		barrier.srcAccessMask = static_cast<VkAccessFlags>(b2.srcAccessMask);
+		barrier.dstAccessMask = static_cast<VkAccessFlags>(b2.dstAccessMask);
+		barrier.srcQueueFamilyIndex = b2.srcQueueFamilyIndex;
+		barrier.dstQueueFamilyIndex = b2.dstQueueFamilyIndex;
+		barrier.buffer = b2.buffer;
+		barrier.offset = b2.offset;
+		barrier.size = b2.size;
+		bufferBarriers.push_back(barrier);
+	}
+
+	if (srcStages == 0) { srcStages = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT; }
+	if (dstStages == 0) { dstStages = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT; }
+
+	vkCmdPipelineBarrier(
+		cmdBuf, srcStages, dstStages, 0, 0, nullptr,
+		static_cast<uint32_t>(bufferBarriers.size()), bufferBarriers.data(),
+		static_cast<uint32_t>(barriers.size()), barriers.data());
+}
+
+
+
+/* interface */
+bool vtek::image_access_is_write(vtek::ImageAccessType access)
+{
+	return get_access_info(access).write;
+}
+
+bool vtek::buffer_access_is_write(vtek::BufferAccessType access)
+{
+	return get_access_info(access).write;
+}
+
+vtek::BarrierBatch* vtek::barrier_batch_create(vtek::Device* device)
+{
+	auto batch = new vtek::BarrierBatch;
+	batch->cmdPipelineBarrier2 =
+		vtek::device_get_extension_functions(device)->cmdPipelineBarrier2;
+	batch->imageBarriers.reserve(16);
+	batch->bufferBarriers.reserve(16);
+
+	return batch;
+}
+
+void vtek::barrier_batch_destroy(vtek::BarrierBatch* batch)
+{
+	if (batch == nullptr) return;
+
+	if (vtek::barrier_batch_get_num_pending(batch) > 0U)
+	{
+		vtek_log_warn("Barrier batch destroyed with {} pending barriers!",
+		              vtek::barrier_batch_get_num_pending(batch));
+	}
+	delete batch;
+}
+
+void vtek::barrier_batch_image(
+	vtek::BarrierBatch* batch, vtek::Image2D* image, vtek::ImageAccessType access,
+	bool discardContents, const vtek::ImageSubresourceRange* range)
+{
+	vtek::ImageSubresourceRange fullRange{};
+	if (range == nullptr) { range = &fullRange; }
+
+	const uint32_t baseMip = range->baseMipLevel;
+	const uint32_t baseLayer = range->baseArrayLayer;
+	if (baseMip >= image->mipLevels || baseLayer >= image->arrayLayers)
+	{
+		vtek_log_error("Image subresource range out of bounds -- {}",
+		               "cannot add image barrier!");
+		return;
+	}
+	const uint32_t numMips = std::min(range->numMipLevels, image->mipLevels - baseMip);
+	const uint32_t numLayers = std::min(range->numArrayLayers, image->arrayLayers - baseLayer);
+
+	const AccessInfo info = get_access_info(access);
+
+	VkImageMemoryBarrier2 templ{};
+	templ.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+	templ.pNext = nullptr;
+	templ.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	templ.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	templ.image = image->vulkanHandle;
+	templ.subresourceRange.aspectMask = image->aspectMask;
+
+	// One barrier per subresource, merged with the previous barrier when
+	// the two are identical and cover adjacent layers of the same mip, or
+	// the same layers of adjacent mips. For the common case of an image
+	// in a uniform state, this produces a single barrier.
+	const size_t firstNew = batch->imageBarriers.size();
+	for (uint32_t mip = baseMip; mip < baseMip + numMips; mip++)
+	{
+		const size_t mipFirst = batch->imageBarriers.size();
+		for (uint32_t layer = baseLayer; layer < baseLayer + numLayers; layer++)
+		{
+			auto& state = image->subresourceStates[mip * image->arrayLayers + layer];
+
+			VkImageMemoryBarrier2 barrier = templ;
+			if (!make_barrier(state, info, discardContents, &barrier)) { continue; }
+			barrier.subresourceRange.baseMipLevel = mip;
+			barrier.subresourceRange.levelCount = 1;
+			barrier.subresourceRange.baseArrayLayer = layer;
+			barrier.subresourceRange.layerCount = 1;
+
+			if (batch->imageBarriers.size() > mipFirst)
+			{
+				auto& prev = batch->imageBarriers.back();
+				auto& pr = prev.subresourceRange;
+				if (same_barrier(prev, barrier) &&
+				    pr.baseArrayLayer + pr.layerCount == layer)
+				{
+					pr.layerCount++;
+					continue;
+				}
+			}
+			batch->imageBarriers.push_back(barrier);
+		}
+
+		// Merge a mip covered by a single barrier into the previous mip
+		if (batch->imageBarriers.size() == mipFirst + 1 && mipFirst > firstNew)
+		{
+			auto& prev = batch->imageBarriers[mipFirst - 1];
+			auto& curr = batch->imageBarriers[mipFirst];
+			auto& pr = prev.subresourceRange;
+			auto& cr = curr.subresourceRange;
+			if (same_barrier(prev, curr) &&
+			    pr.baseMipLevel + pr.levelCount == cr.baseMipLevel &&
+			    pr.baseArrayLayer == cr.baseArrayLayer && pr.layerCount == cr.layerCount)
+			{
+				pr.levelCount++;
+				batch->imageBarriers.pop_back();
+			}
+		}
+	}
+}
+
+void vtek::barrier_batch_buffer(
+	vtek::BarrierBatch* batch, vtek::Buffer* buffer, vtek::BufferAccessType access)
+{
+	VkBufferMemoryBarrier2 barrier{};
+	barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2;
+	barrier.pNext = nullptr;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.buffer = buffer->vulkanHandle;
+	barrier.offset = 0;
+	barrier.size = VK_WHOLE_SIZE;
+
+	if (make_barrier(buffer->accessState, get_access_info(access), &barrier))
+	{
+		batch->bufferBarriers.push_back(barrier);
+	}
+}
+
+void vtek::barrier_batch_flush(vtek::BarrierBatch* batch, vtek::CommandBuffer* commandBuffer)
+{
+	if (vtek::barrier_batch_get_num_pending(batch) == 0U) { return; }
+
+	VkCommandBuffer cmdBuf = vtek::command_buffer_get_handle(commandBuffer);
+
+	if (batch->cmdPipelineBarrier2 != nullptr)
+	{
+		VkDependencyInfo dependencyInfo{};
+		dependencyInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+		dependencyInfo.pNext = nullptr;
+		dependencyInfo.dependencyFlags = 0;
+		dependencyInfo.imageMemoryBarrierCount =
+			static_cast<uint32_t>(batch->imageBarriers.size());
+		dependencyInfo.pImageMemoryBarriers = batch->imageBarriers.data();
+		dependencyInfo.bufferMemoryBarrierCount =
+			static_cast<uint32_t>(batch->bufferBarriers.size());
+		dependencyInfo.pBufferMemoryBarriers = batch->bufferBarriers.data();
+
+		batch->cmdPipelineBarrier2(cmdBuf, &dependencyInfo);
+	}
+	else
+	{
+		flush_legacy(batch, cmdBuf);
+	}
+
+	batch->imageBarriers.clear();
+	batch->bufferBarriers.clear();
+}
+
+uint32_t vtek::barrier_batch_get_num_pending(vtek::BarrierBatch* batch)
+{
+	return static_cast<uint32_t>(
+		batch->imageBarriers.size() + batch->bufferBarriers.size());
+}
+
+void vtek::image2d_reset_tracked_state(vtek::Image2D* image)
+{
+	std::fill(image->subresourceStates.begin(), image->subresourceStates.end(),
+	          vtek::ImageSubresourceState{});
+}
+
+void vtek::buffer_reset_tracked_state(vtek::Buffer* buffer)
+{
+	buffer->accessState = vtek::BufferAccessState{};
+}
@@ -0,0 +1,395 @@
+#include "vtek_vulkan.pch"
+#include "vtek_bindless_table.hpp"
+
+#include "impl/vtek_descriptor_set_struct.hpp"
+#include "vtek_buffer.hpp"
+#include "vtek_descriptor_pool.hpp"
+#include "vtek_descriptor_set.hpp"
+#include "vtek_descriptor_set_layout.hpp"
+#include "vtek_device.hpp"
+#include "vtek_logging.hpp"
+#include "vtek_sampler.hpp"
+
+#include <algorithm>
+#include <vector>
+
+
+/* struct implementation */
+struct BindlessReleasedIndex
+{
+	uint32_t index {0U};
+	uint64_t frame {0UL};
+};
+
+// Index management for one of the descriptor arrays in the table
+struct BindlessArray
+{
+	uint32_t binding {0U};
+	uint32_t capacity {0U};
+
+	// Indices below this have been handed out at least once
+	uint32_t nextUnused {0U};
+	std::vector<uint32_t> freeList;
+	std::vector<BindlessReleasedIndex> released;
+
+	// For each index below `nextUnused`, if it is currently registered.
+	// Guards against releasing an index twice, which would put it on the
+	// free list twice and hand it out to two resources.
+	std::vector<bool> inUse;
+};
+
+struct vtek::BindlessTable
+{
+	vtek::DescriptorPool* pool {nullptr};
+	vtek::DescriptorSetLayout* layout {nullptr};
+	vtek::DescriptorSet* set {nullptr};
+
+	BindlessArray images {};
+	BindlessArray samplers {};
+	BindlessArray buffers {};
+
+	uint64_t frameCounter {0UL};
+	uint32_t numFramesInFlight {1U};
+};
+
+
+
+/* helper functions */
+static constexpr uint32_t kImageBinding = 0U;
+static constexpr uint32_t kSamplerBinding = 1U;
+static constexpr uint32_t kBufferBinding = 2U;
+
+static uint32_t acquire_index(BindlessArray& array)
+{
+	if (!array.freeList.empty())
+	{
+		uint32_t index = array.freeList.back();
+		array.freeList.pop_back();
+		array.inUse[index] = true;
+		return index;
+	}
+	if (array.nextUnused < array.capacity)
+	{
+		array.inUse.push_back(true);
+		return array.nextUnused++;
+	}
+
+	return vtek::kBindlessInvalidIndex;
+}
+
+static void release_index(BindlessArray& array, uint32_t index, uint64_t frame)
+{
+	if (index >= array.nextUnused)
+	{
+		vtek_log_error("Bindless index {} was never registered -- {}", index,
+		               "cannot release!");
+		return;
+	}
+	if (!array.inUse[index])
+	{
+		vtek_log_error("Bindless index {} was already released -- {}", index,
+		               "cannot release!");
+		return;
+	}
+
+	array.inUse[index] = false;
+	array.released.push_back({ index, frame });
+}
+
+static void recycle_indices(
+	BindlessArray& array, uint64_t frame, uint32_t numFramesInFlight)
+{
+	auto it = std::remove_if(
+		array.released.begin(), array.released.end(),
+		[&](const BindlessReleasedIndex& r) {
+			if (frame - r.frame < numFramesInFlight) { return false; }
+			array.freeList.push_back(r.index);
+			return true;
+		});
+	array.released.erase(it, array.released.end());
+}
+
+static void add_write(
+	vtek::DescriptorSet* set, uint32_t binding, uint32_t index,
+	VkDescriptorType type)
+{
+	VkWriteDescriptorSet writeSet{};
+	writeSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	writeSet.pNext = nullptr;
+	writeSet.dstSet = set->vulkanHandle;
+	writeSet.dstBinding = binding;
+	writeSet.dstArrayElement = index;
+	writeSet.descriptorCount = 1;
+	writeSet.descriptorType = type;
+	writeSet.pImageInfo = nullptr;
+	writeSet.pBufferInfo = nullptr;
+	writeSet.pTexelBufferView = nullptr;
+
+	if (type == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER)
+	{
+		writeSet.pBufferInfo = &(set->bufferInfos.back());
+	}
+	else
+	{
+		writeSet.pImageInfo = &(set->imageInfos.back());
+	}
+
+	set->writeDescriptors.emplace_back(writeSet);
+}
+
+static void clamp_to_device_limits(
+	vtek::BindlessTableInfo& info, vtek::Device* device)
+{
+#if defined(VK_VERSION_1_2)
+	VkPhysicalDeviceDescriptorIndexingProperties indexingProps{};
+	indexingProps.sType =
+		VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES;
+	indexingProps.pNext = nullptr;
+
+	VkPhysicalDeviceProperties2 props{};
+	props.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+	props.pNext = &indexingProps;
+
+	vkGetPhysicalDeviceProperties2(
+		vtek::device_get_physical_handle(device), &props);
+
+	auto clamp = [](uint32_t& value, uint32_t limit, const char* name) {
+		if (value > limit)
+		{
+			vtek_log_warn("Bindless table: {} clamped from {} to device limit {}",
+			              name, value, limit);
+			value = limit;
+		}
+	};
+	// The bindings are update-after-bind and visible to all stages, so the
+	// per-stage and the per-set update-after-bind limits apply. The regular
+	// limits only count sets from pools without update-after-bind.
+	const auto& ip = indexingProps;
+
+	clamp(info.maxSampledImages, ip.maxPerStageDescriptorUpdateAfterBindSampledImages,
+	      "maxSampledImages");
+	clamp(info.maxSampledImages, ip.maxDescriptorSetUpdateAfterBindSampledImages,
+	      "maxSampledImages");
+
+	clamp(info.maxSamplers, ip.maxPerStageDescriptorUpdateAfterBindSamplers,
+	      "maxSamplers");
+	clamp(info.maxSamplers, ip.maxDescriptorSetUpdateAfterBindSamplers,
+	      "maxSamplers");
+
+	clamp(info.maxStorageBuffers, ip.maxPerStageDescriptorUpdateAfterBindStorageBuffers,
+	      "maxStorageBuffers");
+	clamp(info.maxStorageBuffers, ip.maxDescriptorSetUpdateAfterBindStorageBuffers,
+	      "maxStorageBuffers");
+
+	// All three bindings count towards the per-stage resource limit
+	const uint32_t maxResources = ip.maxPerStageUpdateAfterBindResources;
+	uint32_t total = info.maxSampledImages + info.maxSamplers + info.maxStorageBuffers;
+	if (total > maxResources)
+	{
+		vtek_log_warn("Bindless table: {} descriptors exceed device limit {} -- {}",
+		              total, maxResources, "clamping sampled images");
+		const uint32_t others = info.maxSamplers + info.maxStorageBuffers;
+		info.maxSampledImages = (maxResources > others) ? maxResources - others : 1U;
+	}
+#endif
+}
+
+
+
+/* interface */
+vtek::BindlessTable* vtek::bindless_table_create(
+	const vtek::BindlessTableInfo* info, vtek::Device* device)
+{
+	if (!vtek::device_get_bindless_support(device))
+	{
+		vtek_log_error("Device was not created with bindless support -- {}",
+		               "cannot create bindless table!");
+		return nullptr;
+	}
+
+	vtek::BindlessTableInfo sizes = *info;
+	clamp_to_device_limits(sizes, device);
+	sizes.maxSampledImages = std::max(1U, sizes.maxSampledImages);
+	sizes.maxSamplers = std::max(1U, sizes.maxSamplers);
+	sizes.maxStorageBuffers = std::max(1U, sizes.maxStorageBuffers);
+
+	auto table = new vtek::BindlessTable;
+	table->images = { kImageBinding, sizes.maxSampledImages };
+	table->samplers = { kSamplerBinding, sizes.maxSamplers };
+	table->buffers = { kBufferBinding, sizes.maxStorageBuffers };
+	table->numFramesInFlight = std::max(1U, info->numFramesInFlight);
+
+	// Descriptor pool, big enough for exactly one set
+	vtek::DescriptorPoolInfo poolInfo{};
+	poolInfo.allowIndividualFree = false;
+	poolInfo.allowUpdateAfterBind = true;
+	poolInfo.descriptorTypes = {
+		{ vtek::DescriptorType::sampled_image, sizes.maxSampledImages },
+		{ vtek::DescriptorType::sampler, sizes.maxSamplers },
+		{ vtek::DescriptorType::storage_buffer, sizes.maxStorageBuffers }
+	};
+	table->pool = vtek::descriptor_pool_create(&poolInfo, device);
+	if (table->pool == nullptr)
+	{
+		vtek_log_error("Failed to create descriptor pool for bindless table!");
+		delete table;
+		return nullptr;
+	}
+
+	// Descriptor set layout
+	vtek::DescriptorSetLayoutInfo layoutInfo{};
+	auto add_binding = [&](vtek::DescriptorType type, uint32_t binding, uint32_t count) {
+		vtek::DescriptorLayoutBinding b{};
+		b.type = type;
+		b.binding = binding;
+		b.shaderStages = info->shaderStages;
+		b.count = count;
+		b.updateAfterBind = true;
+		b.partiallyBound = true;
+		layoutInfo.bindings.push_back(b);
+	};
+	add_binding(vtek::DescriptorType::sampled_image, kImageBinding, sizes.maxSampledImages);
+	add_binding(vtek::DescriptorType::sampler, kSamplerBinding, sizes.maxSamplers);
+	add_binding(vtek::DescriptorType::storage_buffer, kBufferBinding, sizes.maxStorageBuffers);
+
+	table->layout = vtek::descriptor_set_layout_create(&layoutInfo, device);
+	if (table->layout == nullptr)
+	{
+		vtek_log_error("Failed to create descriptor set layout for bindless table!");
+		vtek::bindless_table_destroy(table, device);
+		return nullptr;
+	}
+
+	table->set = vtek::descriptor_pool_alloc_set(table->pool, table->layout, device);
+	if (table->set == nullptr)
+	{
+		vtek_log_error("Failed to allocate descriptor set for bindless table!");
+		vtek::bindless_table_destroy(table, device);
+		return nullptr;
+	}
+
+	return table;
+}
+
+void vtek::bindless_table_destroy(vtek::BindlessTable* table, vtek::Device* device)
+{
+	if (table == nullptr) return;
+
+	// The set is returned to the pool when the pool is destroyed
+	delete table->set;
+	table->set = nullptr;
+
+	vtek::descriptor_set_layout_destroy(table->layout, device);
+	table->layout = nullptr;
+	vtek::descriptor_pool_destroy(table->pool, device);
+	table->pool = nullptr;
+
+	delete table;
+}
+
+vtek::DescriptorSetLayout* vtek::bindless_table_get_layout(vtek::BindlessTable* table)
+{
+	return table->layout;
+}
+
+vtek::DescriptorSet* vtek::bindless_table_get_set(vtek::BindlessTable* table)
+{
+	return table->set;
+}
+
+void vtek::bindless_table_begin_frame(vtek::BindlessTable* table)
+{
+	table->frameCounter++;
+
+	const uint64_t frame = table->frameCounter;
+	const uint32_t num = table->numFramesInFlight;
+	recycle_indices(table->images, frame, num);
+	recycle_indices(table->samplers, frame, num);
+	recycle_indices(table->buffers, frame, num);
+}
+
+void vtek::bindless_table_update(vtek::BindlessTable* table, vtek::Device* device)
+{
+	if (table->set->writeDescriptors.empty()) { return; }
+
+	vtek::descriptor_set_update(table->set, device);
+}
+
+uint32_t vtek::bindless_table_register_image(
+	vtek::BindlessTable* table, vtek::Image2D* image, vtek::ImageLayout layout)
+{
+	uint32_t index = acquire_index(table->images);
+	if (index == vtek::kBindlessInvalidIndex)
+	{
+		vtek_log_error("Bindless table is full -- cannot register image!");
+		return index;
+	}
+
+	VkDescriptorImageInfo imageInfo{};
+	imageInfo.imageLayout = vtek::get_image_layout(layout);
+	imageInfo.imageView = vtek::image2d_get_view_handle(image);
+	imageInfo.sampler = VK_NULL_HANDLE;
+	table->set->imageInfos.emplace_back(imageInfo);
+
+	add_write(table->set, kImageBinding, index, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE);
+
+	return index;
+}
+
+uint32_t vtek::bindless_table_register_sampler(
+	vtek::BindlessTable* table, vtek::Sampler* sampler)
+{
+	uint32_t index = acquire_index(table->samplers);
+	if (index == vtek::kBindlessInvalidIndex)
+	{
+		vtek_log_error("Bindless table is full -- cannot register sampler!");
+		return index;
+	}
+
+	VkDescriptorImageInfo imageInfo{};
+	imageInfo.imageLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	imageInfo.imageView = VK_NULL_HANDLE;
+	imageInfo.sampler = vtek::sampler_get_handle(sampler);
+	table->set->imageInfos.emplace_back(imageInfo);
+
+	add_write(table->set, kSamplerBinding, index, VK_DESCRIPTOR_TYPE_SAMPLER);
+
+	return index;
+}
+
+uint32_t vtek::bindless_table_register_storage_buffer(
+	vtek::BindlessTable* table, vtek::Buffer* buffer)
+{
+	uint32_t index = acquire_index(table->buffers);
+	if (index == vtek::kBindlessInvalidIndex)
+	{
+		vtek_log_error("Bindless table is full -- cannot register storage buffer!");
+		return index;
+	}
+
+	VkDescriptorBufferInfo bufferInfo{};
+	bufferInfo.buffer = vtek::buffer_get_handle(buffer);
+	bufferInfo.offset = 0;
+	bufferInfo.range = VK_WHOLE_SIZE;
+	table->set->bufferInfos.emplace_back(bufferInfo);
+
+	add_write(table->set, kBufferBinding, index, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+
+	return index;
+}
+
+void vtek::bindless_table_release_image(vtek::BindlessTable* table, uint32_t index)
+{
+	release_index(table->images, index, table->frameCounter);
+}
+
+void vtek::bindless_table_release_sampler(vtek::BindlessTable* table, uint32_t index)
+{
+	release_index(table->samplers, index, table->frameCounter);
+}
+
+void vtek::bindless_table_release_storage_buffer(
+	vtek::BindlessTable* table, uint32_t index)
+{
+	release_index(table->buffers, index, table->frameCounter);
+}
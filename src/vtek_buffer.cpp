@@ -161,6 +161,11 @@ void vtek::buffer_destroy(std::vector<Buffer*>& buffers)
 	buffers.clear();
 }
 
+bool vtek::buffer_is_host_visible(vtek::Buffer* buffer)
+{
+	return buffer->memoryProperties.has_flag(vtek::MemoryProperty::host_visible);
+}
+
 VkBuffer vtek::buffer_get_handle(const vtek::Buffer* buffer)
 {
 	return buffer->vulkanHandle;
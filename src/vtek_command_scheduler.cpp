@@ -134,6 +134,9 @@ void vtek::command_scheduler_destroy(
 vtek::CommandBuffer* vtek::command_scheduler_begin_transfer(
 	vtek::CommandScheduler* scheduler, vtek::Device* device)
 {
+	// Command pools must be externally synchronized
+	std::lock_guard<std::mutex> lock(scheduler->mutex);
+
 	vtek::CommandBuffer* buffer = vtek::command_pool_alloc_buffer(
 		scheduler->transferPool, vtek::CommandBufferUsage::primary, device);
 	if (buffer == nullptr)
@@ -168,6 +171,7 @@ bool vtek::command_scheduler_submit_transfer(
 	// TODO: Wait for fence?
 	// TODO: -- or force synchronous?
 	vtek::SubmitInfo submitInfo{};
+	std::lock_guard<std::mutex> lock(scheduler->mutex);
 
 	if (!vtek::queue_submit(scheduler->transferQueue, buffer, &submitInfo))
 	{
@@ -186,6 +190,84 @@ bool vtek::command_scheduler_submit_transfer(
 	return true;
 }
 
+bool vtek::command_scheduler_submit_transfer_async(
+	vtek::CommandScheduler* scheduler, vtek::CommandBuffer* buffer,
+	vtek::TransferSubmission* outSubmission, vtek::Device* device)
+{
+	if (!vtek::command_buffer_end(buffer))
+	{
+		vtek_log_error(
+			"Failed to end recording on single-use transfer command buffer!");
+		return false;
+	}
+
+	VkDevice dev = vtek::device_get_handle(device);
+	VkFenceCreateInfo fenceInfo{};
+	fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+	fenceInfo.pNext = nullptr;
+	fenceInfo.flags = 0U; // unsignaled
+
+	VkFence fence = VK_NULL_HANDLE;
+	if (vkCreateFence(dev, &fenceInfo, nullptr, &fence) != VK_SUCCESS)
+	{
+		vtek_log_error("Failed to create fence for single-use transfer command buffer!");
+		return false;
+	}
+
+	vtek::SubmitInfo submitInfo{};
+	submitInfo.SetPostSignalFence(fence);
+	std::lock_guard<std::mutex> lock(scheduler->mutex);
+
+	if (!vtek::queue_submit(scheduler->transferQueue, buffer, &submitInfo))
+	{
+		vtek_log_error("Failed to submit single-use transfer command buffer!");
+		vkDestroyFence(dev, fence, nullptr);
+		vtek::command_pool_free_buffer(scheduler->transferPool, buffer, device);
+		return false;
+	}
+
+	outSubmission->commandBuffer = buffer;
+	outSubmission->fence = fence;
+
+	return true;
+}
+
+bool vtek::command_scheduler_transfer_is_complete(
+	const vtek::TransferSubmission* submission, vtek::Device* device)
+{
+	VkDevice dev = vtek::device_get_handle(device);
+	return vkGetFenceStatus(dev, submission->fence) == VK_SUCCESS;
+}
+
+bool vtek::command_scheduler_wait_transfer(
+	vtek::CommandScheduler* scheduler, vtek::TransferSubmission* submission,
+	vtek::Device* device)
+{
+	if (submission->fence == VK_NULL_HANDLE) { return false; }
+
+	VkDevice dev = vtek::device_get_handle(device);
+	VkResult result = vkWaitForFences(
+		dev, 1, &submission->fence, VK_TRUE, UINT64_MAX);
+	if (result != VK_SUCCESS)
+	{
+		vtek_log_error("Failed to wait for single-use transfer command buffer!");
+	}
+
+	// NOTE: On device loss the command buffer is no longer pending, so it
+	// is always safe to free it here.
+	vkDestroyFence(dev, submission->fence, nullptr);
+	{
+		std::lock_guard<std::mutex> lock(scheduler->mutex);
+		vtek::command_pool_free_buffer(
+			scheduler->transferPool, submission->commandBuffer, device);
+	}
+
+	submission->fence = VK_NULL_HANDLE;
+	submission->commandBuffer = nullptr;
+
+	return result == VK_SUCCESS;
+}
+
 vtek::Queue* vtek::command_scheduler_get_transfer_queue(
 	vtek::CommandScheduler* scheduler)
 {
@@ -1,16 +1,69 @@
 #include "vtek_vulkan.pch"
 #include "vtek_commands.hpp"
 
+#include "impl/vtek_descriptor_set_struct.hpp"
+#include "impl/vtek_device_functions.hpp"
 #include "impl/vtek_queue_struct.hpp"
+#include "impl/vtek_vma_helpers.hpp"
 #include "vtek_buffer.hpp"
 #include "vtek_command_buffer.hpp"
 #include "vtek_descriptor_set.hpp"
 #include "vtek_format_support.hpp"
 #include "vtek_graphics_pipeline.hpp"
 #include "vtek_image.hpp"
+#include "vtek_logging.hpp"
 #include "vtek_push_constants.hpp"
 
 
+/* helper functions */
+static void push_descriptor_set(
+	vtek::CommandBuffer* commandBuffer, VkPipelineBindPoint bindPoint,
+	VkPipelineLayout pipelineLayout, uint32_t set, vtek::DescriptorSet* writes,
+	vtek::Device* device)
+{
+	auto funcs = vtek::device_get_extension_functions(device);
+	if (funcs->cmdPushDescriptorSet == nullptr)
+	{
+		vtek_log_error("Push descriptor extension not enabled -- {}",
+		               "cannot push descriptor set!");
+		return;
+	}
+	if (writes->writeDescriptors.empty()) { return; }
+
+	auto cmdBuf = vtek::command_buffer_get_handle(commandBuffer);
+	funcs->cmdPushDescriptorSet(
+		cmdBuf, bindPoint, pipelineLayout, set,
+		writes->writeDescriptors.size(), writes->writeDescriptors.data());
+
+	// Descriptor data is copied into the command buffer, so we can clear
+	writes->writeDescriptors.clear();
+	writes->bufferInfos.clear();
+	writes->imageInfos.clear();
+}
+
+static void push_descriptor_set_with_template(
+	vtek::CommandBuffer* commandBuffer,
+	vtek::DescriptorUpdateTemplate* updateTemplate,
+	VkPipelineLayout pipelineLayout, uint32_t set,
+	const vtek::DescriptorTemplateSlot* data, vtek::Device* device)
+{
+	auto funcs = vtek::device_get_extension_functions(device);
+	if (funcs->cmdPushDescriptorSetWithTemplate == nullptr)
+	{
+		vtek_log_error("Push descriptor extension not enabled -- {}",
+		               "cannot push descriptor set!");
+		return;
+	}
+
+	auto cmdBuf = vtek::command_buffer_get_handle(commandBuffer);
+	funcs->cmdPushDescriptorSetWithTemplate(
+		cmdBuf, vtek::descriptor_update_template_get_handle(updateTemplate),
+		pipelineLayout, set, data);
+}
+
+
+
+
 void vtek::cmd_image_layout_transition(
 	vtek::CommandBuffer* commandBuffer,
 	const vtek::ImageLayoutTransitionCmdInfo* info)
@@ -70,6 +123,13 @@ void vtek::cmd_image_layout_transition(
 
 	vkCmdPipelineBarrier(
 		cmdBuf, srcStage, dstStage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+	// Keep the image's tracked state in sync, see `BarrierBatch`
+	vtek::ImageSubresourceState& state = info->image->subresourceStates[0];
+	state.layout = barrier.newLayout;
+	state.writeStages = dstStage;
+	state.writeAccess = VK_ACCESS_2_NONE;
+	state.readStages = dstStage;
 }
 
 void vtek::cmd_bind_graphics_pipeline(
@@ -140,6 +200,20 @@ void vtek::cmd_push_constant_graphics(
 	vkCmdPushConstants(cmdBuf, pipLayout, stageFlags, 0, size, data);
 }
 
+void vtek::cmd_push_constant_graphics(
+	vtek::CommandBuffer* commandBuffer, vtek::GraphicsPipeline* pipeline,
+	const void* data, uint32_t size,
+	vtek::EnumBitmask<vtek::ShaderStageGraphics> stages)
+{
+	auto cmdBuf = vtek::command_buffer_get_handle(commandBuffer);
+	auto pipLayout = vtek::graphics_pipeline_get_layout(pipeline);
+
+	VkShaderStageFlags stageFlags =
+		vtek::get_shader_stage_flags_graphics(stages);
+
+	vkCmdPushConstants(cmdBuf, pipLayout, stageFlags, 0, size, data);
+}
+
 void vtek::cmd_bind_vertex_buffer(
 	vtek::CommandBuffer* commandBuffer, vtek::Buffer* buffer, uint64_t offset)
 {
@@ -149,6 +223,42 @@ void vtek::cmd_bind_vertex_buffer(
 	vkCmdBindVertexBuffers(cmdBuf, 0, 1, buffers, offsets);
 }
 
+void vtek::cmd_bind_vertex_buffers(
+	vtek::CommandBuffer* commandBuffer, uint32_t firstBinding,
+	const vtek::Buffer* const* buffers, const uint64_t* offsets, uint32_t numBuffers)
+{
+	// Vulkan guarantees at least 16 vertex input bindings, and few devices
+	// support more than 32.
+	constexpr uint32_t kMaxBindings = 32U;
+	if (numBuffers > kMaxBindings)
+	{
+		vtek_log_error("Cannot bind more than {} vertex buffers at once!", kMaxBindings);
+		return;
+	}
+	if (numBuffers == 0U) { return; }
+
+	VkBuffer handles[kMaxBindings];
+	VkDeviceSize vkOffsets[kMaxBindings];
+	for (uint32_t i = 0; i < numBuffers; i++)
+	{
+		handles[i] = vtek::buffer_get_handle(buffers[i]);
+		vkOffsets[i] = (offsets != nullptr) ? static_cast<VkDeviceSize>(offsets[i]) : 0UL;
+	}
+
+	auto cmdBuf = vtek::command_buffer_get_handle(commandBuffer);
+	vkCmdBindVertexBuffers(cmdBuf, firstBinding, numBuffers, handles, vkOffsets);
+}
+
+void vtek::cmd_bind_index_buffer(
+	vtek::CommandBuffer* commandBuffer, const vtek::Buffer* buffer, uint64_t offset,
+	vtek::IndexType indexType)
+{
+	auto cmdBuf = vtek::command_buffer_get_handle(commandBuffer);
+	vkCmdBindIndexBuffer(
+		cmdBuf, vtek::buffer_get_handle(buffer),
+		static_cast<VkDeviceSize>(offset), vtek::get_index_type(indexType));
+}
+
 void vtek::cmd_bind_descriptor_set_graphics(
 	vtek::CommandBuffer* commandBuffer, vtek::GraphicsPipeline* pipeline,
 	vtek::DescriptorSet* descriptorSet)
@@ -161,9 +271,159 @@ void vtek::cmd_bind_descriptor_set_graphics(
 		&descrSet, 0, nullptr); // NOTE: Dynamic offset unused
 }
 
+void vtek::cmd_bind_descriptor_set_graphics(
+	vtek::CommandBuffer* commandBuffer, vtek::GraphicsPipeline* pipeline,
+	vtek::DescriptorSet* descriptorSet,
+	const uint32_t* dynamicOffsets, uint32_t numDynamicOffsets)
+{
+	auto cmdBuf = vtek::command_buffer_get_handle(commandBuffer);
+	VkDescriptorSet descrSet = vtek::descriptor_set_get_handle(descriptorSet);
+	VkPipelineLayout pipLayout = vtek::graphics_pipeline_get_layout(pipeline);
+	vkCmdBindDescriptorSets(
+		cmdBuf, VK_PIPELINE_BIND_POINT_GRAPHICS, pipLayout, 0, 1,
+		&descrSet, numDynamicOffsets, dynamicOffsets);
+}
+
+void vtek::cmd_bind_descriptor_set_graphics(
+	vtek::CommandBuffer* commandBuffer, vtek::GraphicsPipeline* pipeline,
+	uint32_t set, vtek::DescriptorSet* descriptorSet,
+	const uint32_t* dynamicOffsets, uint32_t numDynamicOffsets)
+{
+	auto cmdBuf = vtek::command_buffer_get_handle(commandBuffer);
+	VkDescriptorSet descrSet = vtek::descriptor_set_get_handle(descriptorSet);
+	VkPipelineLayout pipLayout = vtek::graphics_pipeline_get_layout(pipeline);
+	vkCmdBindDescriptorSets(
+		cmdBuf, VK_PIPELINE_BIND_POINT_GRAPHICS, pipLayout, set, 1,
+		&descrSet, numDynamicOffsets, dynamicOffsets);
+}
+
+void vtek::cmd_push_descriptor_set_graphics(
+	vtek::CommandBuffer* commandBuffer, vtek::GraphicsPipeline* pipeline,
+	uint32_t set, vtek::DescriptorSet* writes, vtek::Device* device)
+{
+	push_descriptor_set(
+		commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+		vtek::graphics_pipeline_get_layout(pipeline), set, writes, device);
+}
+
+void vtek::cmd_push_descriptor_set_with_template_graphics(
+	vtek::CommandBuffer* commandBuffer,
+	vtek::DescriptorUpdateTemplate* updateTemplate,
+	vtek::GraphicsPipeline* pipeline, uint32_t set,
+	const vtek::DescriptorTemplateSlot* data, vtek::Device* device)
+{
+	push_descriptor_set_with_template(
+		commandBuffer, updateTemplate,
+		vtek::graphics_pipeline_get_layout(pipeline), set, data, device);
+}
+
+void vtek::cmd_push_descriptor_set_compute(
+	vtek::CommandBuffer* commandBuffer, VkPipelineLayout pipelineLayout,
+	uint32_t set, vtek::DescriptorSet* writes, vtek::Device* device)
+{
+	push_descriptor_set(
+		commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE,
+		pipelineLayout, set, writes, device);
+}
+
+void vtek::cmd_push_descriptor_set_with_template_compute(
+	vtek::CommandBuffer* commandBuffer,
+	vtek::DescriptorUpdateTemplate* updateTemplate,
+	VkPipelineLayout pipelineLayout, uint32_t set,
+	const vtek::DescriptorTemplateSlot* data, vtek::Device* device)
+{
+	push_descriptor_set_with_template(
+		commandBuffer, updateTemplate, pipelineLayout, set, data, device);
+}
+
 void vtek::cmd_draw_vertices(
 	vtek::CommandBuffer* commandBuffer, uint32_t numVertices)
 {
 	auto cmdBuf = vtek::command_buffer_get_handle(commandBuffer);
 	vkCmdDraw(cmdBuf, numVertices, 1, 0, 0);
 }
+
+void vtek::cmd_draw_indexed(
+	vtek::CommandBuffer* commandBuffer, uint32_t numIndices,
+	uint32_t firstIndex, int32_t vertexOffset)
+{
+	auto cmdBuf = vtek::command_buffer_get_handle(commandBuffer);
+	vkCmdDrawIndexed(cmdBuf, numIndices, 1, firstIndex, vertexOffset, 0);
+}
+
+void vtek::cmd_draw_vertices_instanced(
+	vtek::CommandBuffer* commandBuffer, uint32_t numVertices, uint32_t numInstances,
+	uint32_t firstVertex, uint32_t firstInstance)
+{
+	auto cmdBuf = vtek::command_buffer_get_handle(commandBuffer);
+	vkCmdDraw(cmdBuf, numVertices, numInstances, firstVertex, firstInstance);
+}
+
+void vtek::cmd_draw_indexed_instanced(
+	vtek::CommandBuffer* commandBuffer, uint32_t numIndices, uint32_t numInstances,
+	uint32_t firstIndex, int32_t vertexOffset, uint32_t firstInstance)
+{
+	auto cmdBuf = vtek::command_buffer_get_handle(commandBuffer);
+	vkCmdDrawIndexed(
+		cmdBuf, numIndices, numInstances, firstIndex, vertexOffset, firstInstance);
+}
+
+void vtek::cmd_draw_indirect(
+	vtek::CommandBuffer* commandBuffer, const vtek::Buffer* buffer, uint64_t offset,
+	uint32_t drawCount, uint32_t stride)
+{
+	auto cmdBuf = vtek::command_buffer_get_handle(commandBuffer);
+	vkCmdDrawIndirect(
+		cmdBuf, vtek::buffer_get_handle(buffer),
+		static_cast<VkDeviceSize>(offset), drawCount, stride);
+}
+
+void vtek::cmd_draw_indexed_indirect(
+	vtek::CommandBuffer* commandBuffer, const vtek::Buffer* buffer, uint64_t offset,
+	uint32_t drawCount, uint32_t stride)
+{
+	auto cmdBuf = vtek::command_buffer_get_handle(commandBuffer);
+	vkCmdDrawIndexedIndirect(
+		cmdBuf, vtek::buffer_get_handle(buffer),
+		static_cast<VkDeviceSize>(offset), drawCount, stride);
+}
+
+void vtek::cmd_draw_indirect_count(
+	vtek::CommandBuffer* commandBuffer, const vtek::Buffer* buffer, uint64_t offset,
+	const vtek::Buffer* countBuffer, uint64_t countOffset, uint32_t maxDrawCount,
+	uint32_t stride, vtek::Device* device)
+{
+	auto funcs = vtek::device_get_extension_functions(device);
+	if (funcs->cmdDrawIndirectCount == nullptr)
+	{
+		vtek_log_error("Draw indirect count extension not enabled -- {}",
+		               "cannot draw indirect with count buffer!");
+		return;
+	}
+
+	auto cmdBuf = vtek::command_buffer_get_handle(commandBuffer);
+	funcs->cmdDrawIndirectCount(
+		cmdBuf, vtek::buffer_get_handle(buffer), static_cast<VkDeviceSize>(offset),
+		vtek::buffer_get_handle(countBuffer), static_cast<VkDeviceSize>(countOffset),
+		maxDrawCount, stride);
+}
+
+void vtek::cmd_draw_indexed_indirect_count(
+	vtek::CommandBuffer* commandBuffer, const vtek::Buffer* buffer, uint64_t offset,
+	const vtek::Buffer* countBuffer, uint64_t countOffset, uint32_t maxDrawCount,
+	uint32_t stride, vtek::Device* device)
+{
+	auto funcs = vtek::device_get_extension_functions(device);
+	if (funcs->cmdDrawIndexedIndirectCount == nullptr)
+	{
+		vtek_log_error("Draw indirect count extension not enabled -- {}",
+		               "cannot draw indirect with count buffer!");
+		return;
+	}
+
+	auto cmdBuf = vtek::command_buffer_get_handle(commandBuffer);
+	funcs->cmdDrawIndexedIndirectCount(
+		cmdBuf, vtek::buffer_get_handle(buffer), static_cast<VkDeviceSize>(offset),
+		vtek::buffer_get_handle(countBuffer), static_cast<VkDeviceSize>(countOffset),
+		maxDrawCount, stride);
+}
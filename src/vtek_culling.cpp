@@ -0,0 +1,354 @@
+#include "vtek_vulkan.pch"
+#include "vtek_culling.hpp"
+
+#include "vtek_camera.hpp"
+
+#include <algorithm>
+#include <thread>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define VTEK_CULLING_AVX
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define VTEK_CULLING_SSE
+#endif
+
+
+/* helper functions */
+static glm::vec4 normalize_plane(const glm::vec4& plane)
+{
+	return plane / glm::length(glm::vec3(plane));
+}
+
+// Branchless, since visibility is close to random from one object to the
+// next, and mispredicted branches would cost more than the plane tests.
+template<uint32_t kLanes>
+static uint32_t* append_visible(uint32_t* out, uint32_t base, uint32_t bits)
+{
+	for (uint32_t k = 0; k < kLanes; k++)
+	{
+		*out = base + k;
+		out += (bits >> k) & 1U;
+	}
+	return out;
+}
+
+// The kernels test the range [begin, end), write the visible indices to
+// `out`, which has room for the entire range, and return the count.
+// Scalar code handles the remainder that does not fill a SIMD register.
+static uint32_t cull_spheres_range(
+	const vtek::Frustum* frustum, const vtek::CullingSpheres* spheres,
+	uint32_t begin, uint32_t end, uint32_t* out)
+{
+	uint32_t* const outBegin = out;
+	const glm::vec4* planes = frustum->planes;
+	const float* sx = spheres->x.data();
+	const float* sy = spheres->y.data();
+	const float* sz = spheres->z.data();
+	const float* sr = spheres->radius.data();
+	uint32_t i = begin;
+
+#if defined(VTEK_CULLING_AVX)
+	for (; i + 8 <= end; i += 8)
+	{
+		const __m256 x = _mm256_loadu_ps(sx + i);
+		const __m256 y = _mm256_loadu_ps(sy + i);
+		const __m256 z = _mm256_loadu_ps(sz + i);
+		const __m256 negRadius = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(sr + i));
+
+		__m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+		for (int p = 0; p < 6; p++)
+		{
+			__m256 d = _mm256_add_ps(
+				_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(planes[p].x), x),
+				              _mm256_mul_ps(_mm256_set1_ps(planes[p].y), y)),
+				_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(planes[p].z), z),
+				              _mm256_set1_ps(planes[p].w)));
+			inside = _mm256_and_ps(inside, _mm256_cmp_ps(d, negRadius, _CMP_GE_OQ));
+		}
+		out = append_visible<8>(out, i, static_cast<uint32_t>(_mm256_movemask_ps(inside)));
+	}
+#elif defined(VTEK_CULLING_SSE)
+	for (; i + 4 <= end; i += 4)
+	{
+		const __m128 x = _mm_loadu_ps(sx + i);
+		const __m128 y = _mm_loadu_ps(sy + i);
+		const __m128 z = _mm_loadu_ps(sz + i);
+		const __m128 negRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(sr + i));
+
+		__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+		for (int p = 0; p < 6; p++)
+		{
+			__m128 d = _mm_add_ps(
+				_mm_add_ps(_mm_mul_ps(_mm_set1_ps(planes[p].x), x),
+				           _mm_mul_ps(_mm_set1_ps(planes[p].y), y)),
+				_mm_add_ps(_mm_mul_ps(_mm_set1_ps(planes[p].z), z),
+				           _mm_set1_ps(planes[p].w)));
+			inside = _mm_and_ps(inside, _mm_cmpge_ps(d, negRadius));
+		}
+		out = append_visible<4>(out, i, static_cast<uint32_t>(_mm_movemask_ps(inside)));
+	}
+#endif
+
+	for (; i < end; i++)
+	{
+		vtek::BoundingSphere sphere { glm::vec3(sx[i], sy[i], sz[i]), sr[i] };
+		if (vtek::frustum_test_sphere(frustum, sphere)) { *out++ = i; }
+	}
+
+	return static_cast<uint32_t>(out - outBegin);
+}
+
+// Boxes are tested in center-extent form: the box is outside a plane if
+// its center is further behind the plane than the projected extent.
+static uint32_t cull_boxes_range(
+	const vtek::Frustum* frustum, const vtek::CullingBoxes* boxes,
+	uint32_t begin, uint32_t end, uint32_t* out)
+{
+	uint32_t* const outBegin = out;
+	const glm::vec4* planes = frustum->planes;
+	uint32_t i = begin;
+
+#if defined(VTEK_CULLING_AVX)
+	const __m256 half = _mm256_set1_ps(0.5f);
+	for (; i + 8 <= end; i += 8)
+	{
+		const __m256 minX = _mm256_loadu_ps(boxes->minX.data() + i);
+		const __m256 minY = _mm256_loadu_ps(boxes->minY.data() + i);
+		const __m256 minZ = _mm256_loadu_ps(boxes->minZ.data() + i);
+		const __m256 maxX = _mm256_loadu_ps(boxes->maxX.data() + i);
+		const __m256 maxY = _mm256_loadu_ps(boxes->maxY.data() + i);
+		const __m256 maxZ = _mm256_loadu_ps(boxes->maxZ.data() + i);
+		const __m256 cx = _mm256_mul_ps(_mm256_add_ps(minX, maxX), half);
+		const __m256 cy = _mm256_mul_ps(_mm256_add_ps(minY, maxY), half);
+		const __m256 cz = _mm256_mul_ps(_mm256_add_ps(minZ, maxZ), half);
+		const __m256 ex = _mm256_mul_ps(_mm256_sub_ps(maxX, minX), half);
+		const __m256 ey = _mm256_mul_ps(_mm256_sub_ps(maxY, minY), half);
+		const __m256 ez = _mm256_mul_ps(_mm256_sub_ps(maxZ, minZ), half);
+
+		__m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+		for (int p = 0; p < 6; p++)
+		{
+			const glm::vec4& pl = planes[p];
+			__m256 d = _mm256_add_ps(
+				_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(pl.x), cx),
+				              _mm256_mul_ps(_mm256_set1_ps(pl.y), cy)),
+				_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(pl.z), cz),
+				              _mm256_set1_ps(pl.w)));
+			__m256 r = _mm256_add_ps(
+				_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(glm::abs(pl.x)), ex),
+				              _mm256_mul_ps(_mm256_set1_ps(glm::abs(pl.y)), ey)),
+				_mm256_mul_ps(_mm256_set1_ps(glm::abs(pl.z)), ez));
+			inside = _mm256_and_ps(
+				inside, _mm256_cmp_ps(_mm256_add_ps(d, r), _mm256_setzero_ps(), _CMP_GE_OQ));
+		}
+		out = append_visible<8>(out, i, static_cast<uint32_t>(_mm256_movemask_ps(inside)));
+	}
+#elif defined(VTEK_CULLING_SSE)
+	const __m128 half = _mm_set1_ps(0.5f);
+	for (; i + 4 <= end; i += 4)
+	{
+		const __m128 minX = _mm_loadu_ps(boxes->minX.data() + i);
+		const __m128 minY = _mm_loadu_ps(boxes->minY.data() + i);
+		const __m128 minZ = _mm_loadu_ps(boxes->minZ.data() + i);
+		const __m128 maxX = _mm_loadu_ps(boxes->maxX.data() + i);
+		const __m128 maxY = _mm_loadu_ps(boxes->maxY.data() + i);
+		const __m128 maxZ = _mm_loadu_ps(boxes->maxZ.data() + i);
+		const __m128 cx = _mm_mul_ps(_mm_add_ps(minX, maxX), half);
+		const __m128 cy = _mm_mul_ps(_mm_add_ps(minY, maxY), half);
+		const __m128 cz = _mm_mul_ps(_mm_add_ps(minZ, maxZ), half);
+		const __m128 ex = _mm_mul_ps(_mm_sub_ps(maxX, minX), half);
+		const __m128 ey = _mm_mul_ps(_mm_sub_ps(maxY, minY), half);
+		const __m128 ez = _mm_mul_ps(_mm_sub_ps(maxZ, minZ), half);
+
+		__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+		for (int p = 0; p < 6; p++)
+		{
+			const glm::vec4& pl = planes[p];
+			__m128 d = _mm_add_ps(
+				_mm_add_ps(_mm_mul_ps(_mm_set1_ps(pl.x), cx),
+				           _mm_mul_ps(_mm_set1_ps(pl.y), cy)),
+				_mm_add_ps(_mm_mul_ps(_mm_set1_ps(pl.z), cz),
+				           _mm_set1_ps(pl.w)));
+			__m128 r = _mm_add_ps(
+				_mm_add_ps(_mm_mul_ps(_mm_set1_ps(glm::abs(pl.x)), ex),
+				           _mm_mul_ps(_mm_set1_ps(glm::abs(pl.y)), ey)),
+				_mm_mul_ps(_mm_set1_ps(glm::abs(pl.z)), ez));
+			inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(d, r), _mm_setzero_ps()));
+		}
+		out = append_visible<4>(out, i, static_cast<uint32_t>(_mm_movemask_ps(inside)));
+	}
+#endif
+
+	for (; i < end; i++)
+	{
+		vtek::BoundingBox box {
+			glm::vec3(boxes->minX[i], boxes->minY[i], boxes->minZ[i]),
+			glm::vec3(boxes->maxX[i], boxes->maxY[i], boxes->maxZ[i])
+		};
+		if (vtek::frustum_test_box(frustum, box)) { *out++ = i; }
+	}
+
+	return static_cast<uint32_t>(out - outBegin);
+}
+
+// Split [0, count) into chunks, one per thread. Each chunk writes its
+// results at its own offset in `outVisible`, and the results are then
+// compacted in order. Chunks are a multiple of 8, to keep SIMD loops full.
+template<typename Kernel>
+static uint32_t cull_parallel(
+	uint32_t count, uint32_t numThreads, std::vector<uint32_t>& outVisible,
+	Kernel&& kernel)
+{
+	// Starting a thread costs about as much as culling many thousand objects
+	constexpr uint32_t kMinPerThread = 32768U;
+	numThreads = std::max(1U, std::min(numThreads, count / kMinPerThread));
+
+	outVisible.resize(count);
+	if (numThreads == 1)
+	{
+		outVisible.resize(kernel(0U, count, outVisible.data()));
+		return static_cast<uint32_t>(outVisible.size());
+	}
+
+	const uint32_t chunk = ((count + numThreads - 1) / numThreads + 7U) & ~7U;
+	std::vector<uint32_t> numVisible(numThreads, 0U);
+	std::vector<std::thread> threads;
+	for (uint32_t t = 1; t < numThreads; t++)
+	{
+		const uint32_t begin = std::min(count, t * chunk);
+		const uint32_t end = std::min(count, begin + chunk);
+		threads.emplace_back([&kernel, &numVisible, &outVisible, t, begin, end]() {
+			numVisible[t] = kernel(begin, end, outVisible.data() + begin);
+		});
+	}
+	numVisible[0] = kernel(0U, std::min(count, chunk), outVisible.data());
+
+	uint32_t total = numVisible[0];
+	for (uint32_t t = 1; t < numThreads; t++)
+	{
+		threads[t - 1].join();
+
+		const uint32_t* src = outVisible.data() + std::min(count, t * chunk);
+		std::copy(src, src + numVisible[t], outVisible.data() + total);
+		total += numVisible[t];
+	}
+	outVisible.resize(total);
+
+	return total;
+}
+
+
+
+/* interface */
+vtek::BoundingBox vtek::bounding_box_transform(
+	const vtek::BoundingBox& box, const glm::mat4& m)
+{
+	// Arvo's method: each output axis is the sum of the smallest and
+	// largest contributions of each input axis.
+	glm::vec3 bmin(m[3]);
+	glm::vec3 bmax(m[3]);
+	for (int c = 0; c < 3; c++)
+	{
+		glm::vec3 a = glm::vec3(m[c]) * box.min[c];
+		glm::vec3 b = glm::vec3(m[c]) * box.max[c];
+		bmin += glm::min(a, b);
+		bmax += glm::max(a, b);
+	}
+
+	return { bmin, bmax };
+}
+
+vtek::BoundingSphere vtek::bounding_sphere_transform(
+	const vtek::BoundingSphere& sphere, const glm::mat4& m)
+{
+	float scale2 = std::max({
+		glm::dot(glm::vec3(m[0]), glm::vec3(m[0])),
+		glm::dot(glm::vec3(m[1]), glm::vec3(m[1])),
+		glm::dot(glm::vec3(m[2]), glm::vec3(m[2]))
+	});
+
+	return { glm::vec3(m * glm::vec4(sphere.center, 1.0f)),
+	         sphere.radius * glm::sqrt(scale2) };
+}
+
+vtek::Frustum vtek::frustum_extract(const glm::mat4& viewProjection)
+{
+	// Gribb & Hartmann: the planes are sums and differences of the rows of
+	// the matrix. glm is column-major, so row i is (m[0][i], .., m[3][i]).
+	const glm::mat4 t = glm::transpose(viewProjection);
+
+	vtek::Frustum frustum;
+	frustum.planes[0] = normalize_plane(t[3] + t[0]); // left
+	frustum.planes[1] = normalize_plane(t[3] - t[0]); // right
+	frustum.planes[2] = normalize_plane(t[3] + t[1]); // bottom
+	frustum.planes[3] = normalize_plane(t[3] - t[1]); // top
+	frustum.planes[4] = normalize_plane(t[2]);        // near, depth in [0, 1]
+	frustum.planes[5] = normalize_plane(t[3] - t[2]); // far
+
+	return frustum;
+}
+
+vtek::Frustum vtek::frustum_extract(vtek::Camera* camera)
+{
+	const glm::mat4* view = vtek::camera_get_view_matrix(camera);
+	const glm::mat4* projection = vtek::camera_get_projection_matrix(camera);
+
+	return vtek::frustum_extract((*projection) * (*view));
+}
+
+bool vtek::frustum_test_sphere(
+	const vtek::Frustum* frustum, const vtek::BoundingSphere& sphere)
+{
+	for (const glm::vec4& plane : frustum->planes)
+	{
+		if (glm::dot(glm::vec3(plane), sphere.center) + plane.w < -sphere.radius)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool vtek::frustum_test_box(const vtek::Frustum* frustum, const vtek::BoundingBox& box)
+{
+	const glm::vec3 center = (box.min + box.max) * 0.5f;
+	const glm::vec3 extent = (box.max - box.min) * 0.5f;
+
+	for (const glm::vec4& plane : frustum->planes)
+	{
+		const glm::vec3 normal(plane);
+		float d = glm::dot(normal, center) + plane.w;
+		float r = glm::dot(glm::abs(normal), extent);
+		if (d + r < 0.0f)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+uint32_t vtek::frustum_cull_spheres(
+	const vtek::Frustum* frustum, const vtek::CullingSpheres* spheres,
+	std::vector<uint32_t>& outVisible, uint32_t numThreads)
+{
+	return cull_parallel(
+		spheres->size(), numThreads, outVisible,
+		[frustum, spheres](uint32_t begin, uint32_t end, uint32_t* out) {
+			return cull_spheres_range(frustum, spheres, begin, end, out);
+		});
+}
+
+uint32_t vtek::frustum_cull_boxes(
+	const vtek::Frustum* frustum, const vtek::CullingBoxes* boxes,
+	std::vector<uint32_t>& outVisible, uint32_t numThreads)
+{
+	return cull_parallel(
+		boxes->size(), numThreads, outVisible,
+		[frustum, boxes](uint32_t begin, uint32_t end, uint32_t* out) {
+			return cull_boxes_range(frustum, boxes, begin, end, out);
+		});
+}
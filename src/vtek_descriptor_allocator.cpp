@@ -0,0 +1,460 @@
+#include "vtek_vulkan.pch"
+#include "vtek_descriptor_allocator.hpp"
+
+#include "impl/vtek_descriptor_set_layout_struct.hpp"
+#include "impl/vtek_descriptor_set_struct.hpp"
+#include "vtek_descriptor_set_layout.hpp"
+#include "vtek_device.hpp"
+#include "vtek_logging.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <optional>
+
+
+/* struct implementation */
+struct DescriptorTypeRatio
+{
+	VkDescriptorType type;
+	float ratio {0.0f};
+};
+
+struct DescriptorTypeCount
+{
+	VkDescriptorType type;
+	uint64_t count {0UL};
+};
+
+struct DescriptorAllocatorPool
+{
+	VkDescriptorPool vulkanHandle {VK_NULL_HANDLE};
+	uint32_t maxSets {0U};
+};
+
+struct DescriptorAllocatorFrame
+{
+	// Pools used by this frame, where the last one is currently allocated from.
+	std::vector<DescriptorAllocatorPool> usedPools;
+	std::vector<vtek::DescriptorSet*> sets;
+
+	// Usage observed since the frame was last reset.
+	uint32_t numSets {0U};
+	std::vector<DescriptorTypeCount> typeCounts;
+};
+
+struct vtek::DescriptorAllocator
+{
+	std::vector<DescriptorAllocatorFrame> frames;
+	std::vector<DescriptorAllocatorPool> freePools;
+	uint32_t numPools {0U};
+
+	// Descriptor set objects are recycled between frames, so that
+	// allocating transient sets does not hit the heap every frame.
+	std::vector<vtek::DescriptorSet*> spareSets;
+
+	// Starts out as the initial guess, which remains a floor under the
+	// ratios observed later on.
+	std::vector<DescriptorTypeRatio> ratios;
+
+	uint32_t setsPerPool {0U};
+	uint32_t maxSetsPerPool {0U};
+	float growthFactor {1.0f};
+	float safetyMargin {0.0f};
+
+	VkDescriptorPoolCreateFlags poolFlags {0U};
+};
+
+
+
+/* helper functions */
+static uint32_t apply_margin(float value, float margin)
+{
+	return std::max(1U, static_cast<uint32_t>(std::ceil(value * (1.0f + margin))));
+}
+
+// The pool always has room for at least one set of `layout`, even if the
+// layout uses descriptor types that have not been observed before.
+static bool create_pool(
+	vtek::DescriptorAllocator* allocator, const vtek::DescriptorSetLayout* layout,
+	VkDevice dev, DescriptorAllocatorPool* outPool)
+{
+	const uint32_t numSets = allocator->setsPerPool;
+
+	std::vector<VkDescriptorPoolSize> poolSizes;
+	for (const auto& r : allocator->ratios)
+	{
+		uint32_t count = apply_margin(r.ratio * numSets, allocator->safetyMargin);
+		poolSizes.push_back({ r.type, count });
+	}
+
+	std::vector<VkDescriptorPoolSize> layoutSizes;
+	for (const auto& binding : layout->bindings)
+	{
+		auto it = std::find_if(
+			layoutSizes.begin(), layoutSizes.end(),
+			[&](const VkDescriptorPoolSize& p) { return p.type == binding.descriptorType; });
+
+		if (it == layoutSizes.end())
+		{
+			layoutSizes.push_back({ binding.descriptorType, binding.descriptorCount });
+		}
+		else
+		{
+			it->descriptorCount += binding.descriptorCount;
+		}
+	}
+	for (const auto& size : layoutSizes)
+	{
+		auto it = std::find_if(
+			poolSizes.begin(), poolSizes.end(),
+			[&](const VkDescriptorPoolSize& p) { return p.type == size.type; });
+
+		if (it == poolSizes.end())
+		{
+			poolSizes.push_back(size);
+		}
+		else
+		{
+			it->descriptorCount = std::max(it->descriptorCount, size.descriptorCount);
+		}
+	}
+
+	VkDescriptorPoolCreateInfo createInfo{};
+	createInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	createInfo.pNext = nullptr;
+	createInfo.flags = allocator->poolFlags;
+	createInfo.maxSets = apply_margin(numSets, allocator->safetyMargin);
+	createInfo.poolSizeCount = poolSizes.size();
+	createInfo.pPoolSizes = poolSizes.data();
+
+	VkDescriptorPool pool = VK_NULL_HANDLE;
+	VkResult result = vkCreateDescriptorPool(dev, &createInfo, nullptr, &pool);
+	if (result != VK_SUCCESS)
+	{
+		vtek_log_error("Failed to create descriptor pool for allocator!");
+		return false;
+	}
+
+	outPool->vulkanHandle = pool;
+	outPool->maxSets = createInfo.maxSets;
+	allocator->numPools++;
+
+	return true;
+}
+
+static void grow_sets_per_pool(vtek::DescriptorAllocator* allocator)
+{
+	float grown = std::ceil(allocator->setsPerPool * allocator->growthFactor);
+	allocator->setsPerPool = std::min(
+		allocator->maxSetsPerPool, static_cast<uint32_t>(grown));
+}
+
+static bool grab_pool(
+	vtek::DescriptorAllocator* allocator, const vtek::DescriptorSetLayout* layout,
+	VkDevice dev, bool allowRecycled, DescriptorAllocatorPool* outPool)
+{
+	if (allowRecycled && !allocator->freePools.empty())
+	{
+		*outPool = allocator->freePools.back();
+		allocator->freePools.pop_back();
+		return true;
+	}
+
+	return create_pool(allocator, layout, dev, outPool);
+}
+
+static void record_usage(
+	DescriptorAllocatorFrame& frame, const vtek::DescriptorSetLayout* layout)
+{
+	frame.numSets++;
+
+	for (const auto& binding : layout->bindings)
+	{
+		auto it = std::find_if(
+			frame.typeCounts.begin(), frame.typeCounts.end(),
+			[&](const DescriptorTypeCount& c) {
+				return c.type == binding.descriptorType; });
+
+		if (it == frame.typeCounts.end())
+		{
+			frame.typeCounts.push_back({ binding.descriptorType, 0UL });
+			it = frame.typeCounts.end() - 1;
+		}
+
+		it->count += binding.descriptorCount;
+	}
+}
+
+static void update_ratios(
+	vtek::DescriptorAllocator* allocator, const DescriptorAllocatorFrame& frame)
+{
+	if (frame.numSets == 0U) { return; }
+
+	// Ratios only ever go up, so that pools sized from one frame's usage
+	// do not come up short when the next frame looks a bit different. This
+	// also keeps types from the initial guess which were not used yet.
+	for (const auto& c : frame.typeCounts)
+	{
+		float ratio = static_cast<float>(c.count) / frame.numSets;
+
+		auto it = std::find_if(
+			allocator->ratios.begin(), allocator->ratios.end(),
+			[&](const DescriptorTypeRatio& r) { return r.type == c.type; });
+
+		if (it == allocator->ratios.end())
+		{
+			allocator->ratios.push_back({ c.type, ratio });
+		}
+		else
+		{
+			it->ratio = std::max(it->ratio, ratio);
+		}
+	}
+
+	// If a frame needed more sets than fit into one pool, make new pools
+	// big enough to hold a whole frame.
+	if (frame.numSets > allocator->setsPerPool)
+	{
+		allocator->setsPerPool =
+			std::min(allocator->maxSetsPerPool, frame.numSets);
+	}
+}
+
+static void reset_frame(
+	vtek::DescriptorAllocator* allocator, DescriptorAllocatorFrame& frame,
+	VkDevice dev)
+{
+	update_ratios(allocator, frame);
+
+	constexpr VkDescriptorPoolResetFlags flags = 0; // reserved for future use
+
+	for (auto& pool : frame.usedPools)
+	{
+		// Pools that are now too small for a full frame are destroyed instead
+		// of recycled, so that we converge towards one pool per frame.
+		if (pool.maxSets < allocator->setsPerPool)
+		{
+			vkDestroyDescriptorPool(dev, pool.vulkanHandle, nullptr);
+			allocator->numPools--;
+			continue;
+		}
+
+		vkResetDescriptorPool(dev, pool.vulkanHandle, flags);
+		allocator->freePools.push_back(pool);
+	}
+	frame.usedPools.clear();
+
+	for (auto set : frame.sets)
+	{
+		set->vulkanHandle = VK_NULL_HANDLE;
+		set->bufferInfos.clear();
+		set->imageInfos.clear();
+		set->writeDescriptors.clear();
+		allocator->spareSets.push_back(set);
+	}
+	frame.sets.clear();
+
+	frame.numSets = 0U;
+	frame.typeCounts.clear();
+}
+
+
+
+/* interface */
+vtek::DescriptorAllocator* vtek::descriptor_allocator_create(
+	const vtek::DescriptorAllocatorInfo* info, vtek::Device* device)
+{
+	if (info->numFrames == 0U)
+	{
+		vtek_log_error("Descriptor allocator must have at least 1 frame!");
+		return nullptr;
+	}
+	if (info->initialSetsPerPool == 0U ||
+	    info->maxSetsPerPool < info->initialSetsPerPool)
+	{
+		vtek_log_error("Invalid pool sizes -- {}",
+		               "cannot create descriptor allocator!");
+		return nullptr;
+	}
+
+	auto allocator = new vtek::DescriptorAllocator;
+	allocator->frames.resize(info->numFrames);
+	allocator->setsPerPool = info->initialSetsPerPool;
+	allocator->maxSetsPerPool = info->maxSetsPerPool;
+	allocator->growthFactor = std::max(1.0f, info->growthFactor);
+	allocator->safetyMargin = std::max(0.0f, info->safetyMargin);
+
+	if (info->allowUpdateAfterBind)
+	{
+		allocator->poolFlags |= VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+	}
+
+	std::vector<vtek::DescriptorAllocatorRatio> typeRatios = info->typeRatios;
+	if (typeRatios.empty())
+	{
+		typeRatios = {
+			{ vtek::DescriptorType::uniform_buffer, 2.0f },
+			{ vtek::DescriptorType::combined_image_sampler, 2.0f },
+			{ vtek::DescriptorType::storage_buffer, 1.0f },
+			{ vtek::DescriptorType::storage_image, 0.5f }
+		};
+	}
+
+	for (const auto& r : typeRatios)
+	{
+		std::optional<VkDescriptorType> typeOpt =
+			vtek::get_descriptor_type(r.type, device);
+		if (!typeOpt.has_value())
+		{
+			vtek_log_error("Failed to get descriptor type -- {}",
+			               "cannot create descriptor allocator!");
+			delete allocator;
+			return nullptr;
+		}
+
+		allocator->ratios.push_back({ typeOpt.value(), r.ratio });
+	}
+
+	return allocator;
+}
+
+void vtek::descriptor_allocator_destroy(
+	vtek::DescriptorAllocator* allocator, vtek::Device* device)
+{
+	if (allocator == nullptr) return;
+
+	VkDevice dev = vtek::device_get_handle(device);
+
+	for (auto& frame : allocator->frames)
+	{
+		for (auto& pool : frame.usedPools)
+		{
+			vkDestroyDescriptorPool(dev, pool.vulkanHandle, nullptr);
+		}
+		for (auto set : frame.sets)
+		{
+			delete set;
+		}
+	}
+	for (auto& pool : allocator->freePools)
+	{
+		vkDestroyDescriptorPool(dev, pool.vulkanHandle, nullptr);
+	}
+	for (auto set : allocator->spareSets)
+	{
+		delete set;
+	}
+
+	delete allocator;
+}
+
+vtek::DescriptorSet* vtek::descriptor_allocator_alloc_set(
+	vtek::DescriptorAllocator* allocator, vtek::DescriptorSetLayout* layout,
+	uint32_t frameIndex, vtek::Device* device)
+{
+	if (frameIndex >= allocator->frames.size())
+	{
+		vtek_log_error("Frame index {} out of range -- {}", frameIndex,
+		               "cannot allocate descriptor set!");
+		return nullptr;
+	}
+
+	VkDevice dev = vtek::device_get_handle(device);
+	DescriptorAllocatorFrame& frame = allocator->frames[frameIndex];
+
+	VkDescriptorSetAllocateInfo allocInfo{};
+	allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	allocInfo.descriptorSetCount = 1;
+	allocInfo.pSetLayouts = &layout->vulkanHandle;
+
+	VkDescriptorSet descSet = VK_NULL_HANDLE;
+	VkResult result = VK_ERROR_OUT_OF_POOL_MEMORY;
+
+	if (!frame.usedPools.empty())
+	{
+		allocInfo.descriptorPool = frame.usedPools.back().vulkanHandle;
+		result = vkAllocateDescriptorSets(dev, &allocInfo, &descSet);
+
+		// A frame overflowing its pool means that pools are too small
+		if (result == VK_ERROR_OUT_OF_POOL_MEMORY || result == VK_ERROR_FRAGMENTED_POOL)
+		{
+			grow_sets_per_pool(allocator);
+		}
+	}
+
+	// First try a recycled pool, and if that is too small, try a new pool
+	// sized from the current ratios and the layout. Any other error is not
+	// recoverable here.
+	for (int attempt = 0;
+	     attempt < 2 && (result == VK_ERROR_OUT_OF_POOL_MEMORY ||
+	                     result == VK_ERROR_FRAGMENTED_POOL);
+	     attempt++)
+	{
+		DescriptorAllocatorPool pool{};
+		if (!grab_pool(allocator, layout, dev, attempt == 0, &pool))
+		{
+			vtek_log_error("Failed to get a new descriptor pool -- {}",
+			               "cannot allocate descriptor set!");
+			return nullptr;
+		}
+		frame.usedPools.push_back(pool);
+
+		allocInfo.descriptorPool = pool.vulkanHandle;
+		result = vkAllocateDescriptorSets(dev, &allocInfo, &descSet);
+	}
+
+	if (result != VK_SUCCESS)
+	{
+		vtek_log_error("Failed to allocate descriptor set from allocator!");
+		return nullptr;
+	}
+
+	vtek::DescriptorSet* set = nullptr;
+	if (!allocator->spareSets.empty())
+	{
+		set = allocator->spareSets.back();
+		allocator->spareSets.pop_back();
+	}
+	else
+	{
+		set = new vtek::DescriptorSet;
+	}
+	set->vulkanHandle = descSet;
+
+	frame.sets.push_back(set);
+	record_usage(frame, layout);
+
+	return set;
+}
+
+void vtek::descriptor_allocator_reset_frame(
+	vtek::DescriptorAllocator* allocator, uint32_t frameIndex,
+	vtek::Device* device)
+{
+	if (frameIndex >= allocator->frames.size())
+	{
+		vtek_log_error("Frame index {} out of range -- {}", frameIndex,
+		               "cannot reset descriptor allocator frame!");
+		return;
+	}
+
+	VkDevice dev = vtek::device_get_handle(device);
+	reset_frame(allocator, allocator->frames[frameIndex], dev);
+}
+
+void vtek::descriptor_allocator_reset(
+	vtek::DescriptorAllocator* allocator, vtek::Device* device)
+{
+	VkDevice dev = vtek::device_get_handle(device);
+
+	for (auto& frame : allocator->frames)
+	{
+		reset_frame(allocator, frame, dev);
+	}
+}
+
+uint32_t vtek::descriptor_allocator_get_num_pools(
+	vtek::DescriptorAllocator* allocator)
+{
+	return allocator->numPools;
+}
@@ -74,7 +74,10 @@ vtek::DescriptorPool* vtek::descriptor_pool_create(
 	}
 
 	// Maximum number of descriptor sets that CAN be allocated from the pool.
-	// TODO: Should we add margin for safety?
+	// NOTE: Every set holds at least one descriptor, so this is already an
+	// upper bound and no extra margin is needed. When the number of sets is
+	// not known up front, use a `DescriptorAllocator` instead, which sizes
+	// its pools from observed usage plus a safety margin.
 	createInfo.maxSets = maxSets;
 
 	// An array of `VkDescriptorPoolSize` structures, each containing a
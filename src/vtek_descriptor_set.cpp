@@ -20,6 +20,19 @@ VkDescriptorSet vtek::descriptor_set_get_handle(const vtek::DescriptorSet* set)
 	return set->vulkanHandle;
 }
 
+vtek::DescriptorSet* vtek::descriptor_set_create_push()
+{
+	// The Vulkan handle is ignored for push descriptors
+	return new vtek::DescriptorSet;
+}
+
+void vtek::descriptor_set_destroy_push(vtek::DescriptorSet* set)
+{
+	if (set == nullptr) return;
+
+	delete set;
+}
+
 void vtek::descriptor_set_update(
 	vtek::DescriptorSet* set, vtek::Device* device)
 {
@@ -31,6 +44,36 @@ void vtek::descriptor_set_update(
 
 	set->writeDescriptors.clear();
 	set->bufferInfos.clear();
+	set->imageInfos.clear();
+}
+
+void vtek::descriptor_set_update_batch(
+	const std::vector<vtek::DescriptorSet*>& sets, vtek::Device* device)
+{
+	VkDevice dev = vtek::device_get_handle(device);
+
+	// The write structures point into each set's own buffer/image infos,
+	// which stay in place until the sets are cleared below.
+	size_t numWrites = 0;
+	for (auto set : sets) { numWrites += set->writeDescriptors.size(); }
+	if (numWrites == 0) { return; }
+
+	std::vector<VkWriteDescriptorSet> writes;
+	writes.reserve(numWrites);
+	for (auto set : sets)
+	{
+		writes.insert(writes.end(),
+		              set->writeDescriptors.begin(), set->writeDescriptors.end());
+	}
+
+	vkUpdateDescriptorSets(dev, writes.size(), writes.data(), 0, nullptr);
+
+	for (auto set : sets)
+	{
+		set->writeDescriptors.clear();
+		set->bufferInfos.clear();
+		set->imageInfos.clear();
+	}
 }
 
 
@@ -130,18 +173,58 @@ bool vtek::descriptor_set_bind_storage_buffer()
 	return false;
 }
 
-bool vtek::descriptor_set_bind_uniform_buffer_dynamic()
+bool vtek::descriptor_set_bind_uniform_buffer_dynamic(
+	vtek::DescriptorSet* set, uint32_t binding,
+	vtek::Buffer* buffer, vtek::UniformBufferType type)
 {
-	vtek_log_error("vtek::descriptor_set_bind_uniform_buffer_dynamic(): {}",
-	               "Not implemented!");
-	return false;
+	VkDescriptorBufferInfo bufferInfo{};
+	bufferInfo.buffer = vtek::buffer_get_handle(buffer);
+	bufferInfo.offset = 0; // dynamic offset is added when binding the set
+	bufferInfo.range = vtek::get_uniform_buffer_size(type);
+	set->bufferInfos.emplace_back(bufferInfo);
+
+	VkWriteDescriptorSet writeSet{};
+	writeSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	writeSet.pNext = nullptr;
+	writeSet.dstSet = set->vulkanHandle;
+	writeSet.dstBinding = binding;
+	writeSet.dstArrayElement = 0;
+	writeSet.descriptorCount = 1;
+	writeSet.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+	writeSet.pImageInfo = nullptr;
+	writeSet.pBufferInfo = &(set->bufferInfos.back());
+	writeSet.pTexelBufferView = nullptr;
+
+	set->writeDescriptors.emplace_back(writeSet);
+
+	return true;
 }
 
-bool vtek::descriptor_set_bind_storage_buffer_dynamic()
+bool vtek::descriptor_set_bind_storage_buffer_dynamic(
+	vtek::DescriptorSet* set, uint32_t binding,
+	vtek::Buffer* buffer, uint64_t range)
 {
-	vtek_log_error("vtek::descriptor_set_bind_storage_buffer_dynamic(): {}",
-	               "Not implemented!");
-	return false;
+	VkDescriptorBufferInfo bufferInfo{};
+	bufferInfo.buffer = vtek::buffer_get_handle(buffer);
+	bufferInfo.offset = 0; // dynamic offset is added when binding the set
+	bufferInfo.range = range;
+	set->bufferInfos.emplace_back(bufferInfo);
+
+	VkWriteDescriptorSet writeSet{};
+	writeSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	writeSet.pNext = nullptr;
+	writeSet.dstSet = set->vulkanHandle;
+	writeSet.dstBinding = binding;
+	writeSet.dstArrayElement = 0;
+	writeSet.descriptorCount = 1;
+	writeSet.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+	writeSet.pImageInfo = nullptr;
+	writeSet.pBufferInfo = &(set->bufferInfos.back());
+	writeSet.pTexelBufferView = nullptr;
+
+	set->writeDescriptors.emplace_back(writeSet);
+
+	return true;
 }
 
 bool vtek::descriptor_set_bind_input_attachment()
@@ -1,17 +1,11 @@
 #include "vtek_vulkan.pch"
 #include "vtek_descriptor_set_layout.hpp"
 
+#include "impl/vtek_descriptor_set_layout_struct.hpp"
 #include "vtek_device.hpp"
 #include "vtek_logging.hpp"
 
 
-/* struct implementation */
-struct vtek::DescriptorSetLayout
-{
-	VkDescriptorSetLayout vulkanHandle {VK_NULL_HANDLE};
-};
-
-
 
 /* interface */
 vtek::DescriptorSetLayout* vtek::descriptor_set_layout_create(
@@ -24,6 +18,7 @@ vtek::DescriptorSetLayout* vtek::descriptor_set_layout_create(
 
 		// Check for "updateAfterBind" support requested
 	bool updateAfterBind = false;
+	bool partiallyBound = false;
 
 	std::vector<VkDescriptorSetLayoutBinding> bindings;
 
@@ -31,6 +26,7 @@ vtek::DescriptorSetLayout* vtek::descriptor_set_layout_create(
 	{
 		const vtek::DescriptorLayoutBinding& bindRef = info->bindings[i];
 		updateAfterBind |= bindRef.updateAfterBind;
+		partiallyBound |= bindRef.partiallyBound;
 
 		std::optional<VkDescriptorType> type =
 			vtek::get_descriptor_type(bindRef.type, device);
@@ -73,6 +69,36 @@ vtek::DescriptorSetLayout* vtek::descriptor_set_layout_create(
 	createInfo.pNext = nullptr;
 	createInfo.flags = 0U; // TODO: ?
 
+	if (info->pushDescriptor)
+	{
+		if (!vtek::device_get_enabled_extensions(device)->pushDescriptor)
+		{
+			vtek_log_error("Push descriptor extension not enabled -- {}",
+			               "cannot create descriptor set layout!");
+			delete layout;
+			return nullptr;
+		}
+		if (updateAfterBind)
+		{
+			vtek_log_error("Push descriptors cannot be update-after-bind -- {}",
+			               "cannot create descriptor set layout!");
+			delete layout;
+			return nullptr;
+		}
+		for (const auto& binding : bindings)
+		{
+			if (binding.descriptorType == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC ||
+			    binding.descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC)
+			{
+				vtek_log_error("Push descriptors cannot be dynamic buffers -- {}",
+				               "cannot create descriptor set layout!");
+				delete layout;
+				return nullptr;
+			}
+		}
+		createInfo.flags |= VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR;
+	}
+
 	// Check if we can create a descriptor set layout that supports the
 	// "updateAfterBind" feature. This includes creating an array with
 	// binding flags, one for each descriptor binding.
@@ -82,7 +108,7 @@ vtek::DescriptorSetLayout* vtek::descriptor_set_layout_create(
 
 	auto vv = vtek::device_get_vulkan_version(device);
 
-	if (updateAfterBind && (vv.major() > 1 || vv.minor() >= 2))
+	if ((updateAfterBind || partiallyBound) && (vv.major() > 1 || vv.minor() >= 2))
 	{
 		for (uint32_t i = 0; i < info->bindings.size(); i++)
 		{
@@ -93,6 +119,10 @@ vtek::DescriptorSetLayout* vtek::descriptor_set_layout_create(
 			{
 				flags |= VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT;
 			}
+			if (bindRef.partiallyBound)
+			{
+				flags |= VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT;
+			}
 
 			bindingFlags.push_back(flags);
 		}
@@ -104,8 +134,26 @@ vtek::DescriptorSetLayout* vtek::descriptor_set_layout_create(
 		bindingFlagsInfo.pBindingFlags = bindingFlags.data();
 
 		createInfo.pNext = &bindingFlagsInfo;
-		createInfo.flags
-			|= VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+		if (updateAfterBind)
+		{
+			createInfo.flags
+				|= VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+		}
+	}
+	else if (partiallyBound)
+	{
+		vtek_log_error("Partially bound descriptors require Vulkan >= 1.2 -- {}",
+		               "cannot create descriptor set layout!");
+		delete layout;
+		return nullptr;
+	}
+#else
+	if (partiallyBound)
+	{
+		vtek_log_error("Partially bound descriptors require Vulkan >= 1.2 -- {}",
+		               "cannot create descriptor set layout!");
+		delete layout;
+		return nullptr;
 	}
 #endif
 
@@ -121,6 +169,8 @@ vtek::DescriptorSetLayout* vtek::descriptor_set_layout_create(
 		return nullptr;
 	}
 
+	layout->bindings = std::move(bindings);
+
 	return layout;
 }
 
@@ -0,0 +1,272 @@
+#include "vtek_vulkan.pch"
+#include "vtek_descriptor_update_template.hpp"
+
+#include "impl/vtek_descriptor_set_struct.hpp"
+#include "vtek_buffer.hpp"
+#include "vtek_descriptor_set.hpp"
+#include "vtek_descriptor_type.hpp"
+#include "vtek_device.hpp"
+#include "vtek_graphics_pipeline.hpp"
+#include "vtek_logging.hpp"
+#include "vtek_sampler.hpp"
+
+#include <cstddef>
+#include <optional>
+
+
+/* struct implementation */
+struct TemplateBindingRange
+{
+	uint32_t binding {0U};
+	uint32_t firstSlot {0U};
+	uint32_t count {0U};
+};
+
+struct vtek::DescriptorUpdateTemplate
+{
+	VkDescriptorUpdateTemplate vulkanHandle {VK_NULL_HANDLE};
+
+	uint32_t numSlots {0U};
+	std::vector<TemplateBindingRange> ranges;
+};
+
+
+
+/* helper functions */
+static bool has_template_support(vtek::Device* device)
+{
+#if defined(VK_VERSION_1_1)
+	auto vv = vtek::device_get_vulkan_version(device);
+	return vv.major() > 1 || vv.minor() >= 1;
+#else
+	return false;
+#endif
+}
+
+// When `pipelineLayout` is non-null a push-descriptor template is created,
+// otherwise a regular template for updating descriptor sets of `layout`.
+static vtek::DescriptorUpdateTemplate* create_template(
+	const vtek::DescriptorSetLayoutInfo* info, vtek::DescriptorSetLayout* layout,
+	VkPipelineLayout pipelineLayout, VkPipelineBindPoint bindPoint, uint32_t set,
+	vtek::Device* device)
+{
+	if (!has_template_support(device))
+	{
+		vtek_log_error("Descriptor update templates require Vulkan >= 1.1!");
+		return nullptr;
+	}
+
+#if defined(VK_VERSION_1_1)
+	auto updateTemplate = new vtek::DescriptorUpdateTemplate;
+
+	std::vector<VkDescriptorUpdateTemplateEntry> entries;
+	uint32_t slot = 0U;
+
+	for (const auto& bindRef : info->bindings)
+	{
+		if (bindRef.type == vtek::DescriptorType::inline_uniform_block ||
+		    bindRef.type == vtek::DescriptorType::acceleration_structure)
+		{
+			vtek_log_error(
+				"Descriptor type not supported by update templates -- {}",
+				"cannot create descriptor update template!");
+			delete updateTemplate;
+			return nullptr;
+		}
+
+		std::optional<VkDescriptorType> type =
+			vtek::get_descriptor_type(bindRef.type, device);
+		if (!type.has_value())
+		{
+			vtek_log_error("Invalid descriptor type -- {}",
+			               "cannot create descriptor update template!");
+			delete updateTemplate;
+			return nullptr;
+		}
+
+		VkDescriptorUpdateTemplateEntry entry{};
+		entry.dstBinding = bindRef.binding;
+		entry.dstArrayElement = 0U;
+		entry.descriptorCount = bindRef.count;
+		entry.descriptorType = type.value();
+		entry.offset = slot * sizeof(vtek::DescriptorTemplateSlot);
+		entry.stride = sizeof(vtek::DescriptorTemplateSlot);
+		entries.push_back(entry);
+
+		updateTemplate->ranges.push_back({ bindRef.binding, slot, bindRef.count });
+		slot += bindRef.count;
+	}
+	updateTemplate->numSlots = slot;
+
+	VkDescriptorUpdateTemplateCreateInfo createInfo{};
+	createInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_UPDATE_TEMPLATE_CREATE_INFO;
+	createInfo.pNext = nullptr;
+	createInfo.flags = 0U; // reserved for future use
+	createInfo.descriptorUpdateEntryCount = entries.size();
+	createInfo.pDescriptorUpdateEntries = entries.data();
+	if (pipelineLayout == VK_NULL_HANDLE)
+	{
+		createInfo.templateType = VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_DESCRIPTOR_SET;
+		createInfo.descriptorSetLayout = vtek::descriptor_set_layout_get_handle(layout);
+		// NOTE: The remaining members are only used for push descriptors.
+		createInfo.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+		createInfo.pipelineLayout = VK_NULL_HANDLE;
+		createInfo.set = 0U;
+	}
+	else
+	{
+		createInfo.templateType =
+			VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_PUSH_DESCRIPTORS_KHR;
+		createInfo.descriptorSetLayout = VK_NULL_HANDLE; // ignored
+		createInfo.pipelineBindPoint = bindPoint;
+		createInfo.pipelineLayout = pipelineLayout;
+		createInfo.set = set;
+	}
+
+	VkDevice dev = vtek::device_get_handle(device);
+	VkResult result = vkCreateDescriptorUpdateTemplate(
+		dev, &createInfo, nullptr, &updateTemplate->vulkanHandle);
+	if (result != VK_SUCCESS)
+	{
+		vtek_log_error("Failed to create descriptor update template!");
+		delete updateTemplate;
+		return nullptr;
+	}
+
+	return updateTemplate;
+#else
+	return nullptr;
+#endif
+}
+
+
+
+/* interface */
+vtek::DescriptorUpdateTemplate* vtek::descriptor_update_template_create(
+	const vtek::DescriptorSetLayoutInfo* info, vtek::DescriptorSetLayout* layout,
+	vtek::Device* device)
+{
+	return create_template(
+		info, layout, VK_NULL_HANDLE, VK_PIPELINE_BIND_POINT_GRAPHICS, 0U, device);
+}
+
+vtek::DescriptorUpdateTemplate* vtek::descriptor_update_template_create_push(
+	const vtek::DescriptorSetLayoutInfo* info, vtek::GraphicsPipeline* pipeline,
+	uint32_t set, vtek::Device* device)
+{
+	if (!info->pushDescriptor)
+	{
+		vtek_log_error("Layout info is not marked as `pushDescriptor` -- {}",
+		               "cannot create push descriptor update template!");
+		return nullptr;
+	}
+
+	return create_template(
+		info, nullptr, vtek::graphics_pipeline_get_layout(pipeline),
+		VK_PIPELINE_BIND_POINT_GRAPHICS, set, device);
+}
+
+vtek::DescriptorUpdateTemplate* vtek::descriptor_update_template_create_push_compute(
+	const vtek::DescriptorSetLayoutInfo* info, VkPipelineLayout pipelineLayout,
+	uint32_t set, vtek::Device* device)
+{
+	if (!info->pushDescriptor)
+	{
+		vtek_log_error("Layout info is not marked as `pushDescriptor` -- {}",
+		               "cannot create push descriptor update template!");
+		return nullptr;
+	}
+
+	return create_template(
+		info, nullptr, pipelineLayout, VK_PIPELINE_BIND_POINT_COMPUTE, set, device);
+}
+
+void vtek::descriptor_update_template_destroy(
+	vtek::DescriptorUpdateTemplate* updateTemplate, vtek::Device* device)
+{
+	if (updateTemplate == nullptr) return;
+
+#if defined(VK_VERSION_1_1)
+	VkDevice dev = vtek::device_get_handle(device);
+	vkDestroyDescriptorUpdateTemplate(dev, updateTemplate->vulkanHandle, nullptr);
+#endif
+	updateTemplate->vulkanHandle = VK_NULL_HANDLE;
+
+	delete updateTemplate;
+}
+
+VkDescriptorUpdateTemplate vtek::descriptor_update_template_get_handle(
+	const vtek::DescriptorUpdateTemplate* updateTemplate)
+{
+	return updateTemplate->vulkanHandle;
+}
+
+uint32_t vtek::descriptor_update_template_get_num_slots(
+	const vtek::DescriptorUpdateTemplate* updateTemplate)
+{
+	return updateTemplate->numSlots;
+}
+
+uint32_t vtek::descriptor_update_template_get_slot(
+	const vtek::DescriptorUpdateTemplate* updateTemplate,
+	uint32_t binding, uint32_t arrayElement)
+{
+	for (const auto& range : updateTemplate->ranges)
+	{
+		if (range.binding == binding && arrayElement < range.count)
+		{
+			return range.firstSlot + arrayElement;
+		}
+	}
+
+	return UINT32_MAX;
+}
+
+void vtek::descriptor_template_slot_set_buffer(
+	vtek::DescriptorTemplateSlot* slot, vtek::Buffer* buffer,
+	uint64_t offset, uint64_t range)
+{
+	slot->buffer.buffer = vtek::buffer_get_handle(buffer);
+	slot->buffer.offset = offset;
+	slot->buffer.range = range;
+}
+
+void vtek::descriptor_template_slot_set_image(
+	vtek::DescriptorTemplateSlot* slot, vtek::Sampler* sampler,
+	vtek::Image2D* image, vtek::ImageLayout imageLayout)
+{
+	slot->image.sampler =
+		(sampler != nullptr) ? vtek::sampler_get_handle(sampler) : VK_NULL_HANDLE;
+	slot->image.imageView =
+		(image != nullptr) ? vtek::image2d_get_view_handle(image) : VK_NULL_HANDLE;
+	slot->image.imageLayout = vtek::get_image_layout(imageLayout);
+}
+
+void vtek::descriptor_set_update_with_template(
+	vtek::DescriptorSet* set, vtek::DescriptorUpdateTemplate* updateTemplate,
+	const vtek::DescriptorTemplateSlot* data, vtek::Device* device)
+{
+#if defined(VK_VERSION_1_1)
+	VkDevice dev = vtek::device_get_handle(device);
+	vkUpdateDescriptorSetWithTemplate(
+		dev, set->vulkanHandle, updateTemplate->vulkanHandle, data);
+#endif
+}
+
+void vtek::descriptor_sets_update_with_template(
+	const std::vector<vtek::DescriptorSet*>& sets,
+	vtek::DescriptorUpdateTemplate* updateTemplate,
+	const vtek::DescriptorTemplateSlot* data, vtek::Device* device)
+{
+#if defined(VK_VERSION_1_1)
+	VkDevice dev = vtek::device_get_handle(device);
+	const uint32_t numSlots = updateTemplate->numSlots;
+
+	for (size_t i = 0; i < sets.size(); i++)
+	{
+		vkUpdateDescriptorSetWithTemplate(
+			dev, sets[i]->vulkanHandle, updateTemplate->vulkanHandle,
+			data + i * numSlots);
+	}
+#endif
+}
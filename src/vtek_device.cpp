@@ -1,6 +1,7 @@
 #include "vtek_vulkan.pch"
 #include "vtek_device.hpp"
 
+#include "impl/vtek_device_functions.hpp"
 #include "impl/vtek_init.hpp"
 #include "vtek_allocator.hpp"
 #include "vtek_command_scheduler.hpp"
@@ -42,6 +43,11 @@ struct vtek::Device
 
 	vtek::Allocator* allocator {nullptr};
 	vtek::CommandScheduler* scheduler {nullptr};
+
+	bool bindlessSupport {false};
+	bool timelineSemaphoreSupport {false};
+
+	vtek::DeviceExtensionFunctions extensionFunctions {};
 };
 
 
@@ -576,6 +582,55 @@ static void set_extensions_enabled(
 	auto support = vtek::physical_device_get_extension_support(physicalDevice);
 	device->enabledExtensions.swapchain = support->swapchain;
 	device->enabledExtensions.dynamicRendering = support->dynamicRendering;
+	device->enabledExtensions.pushDescriptor = support->pushDescriptor;
+	device->enabledExtensions.drawIndirectCount = support->drawIndirectCount;
+	device->enabledExtensions.synchronization2 = support->synchronization2;
+}
+
+static void load_extension_functions(vtek::Device* device)
+{
+	VkDevice dev = device->vulkanHandle;
+	auto& funcs = device->extensionFunctions;
+
+	if (device->enabledExtensions.pushDescriptor)
+	{
+		funcs.cmdPushDescriptorSet = reinterpret_cast<PFN_vkCmdPushDescriptorSetKHR>(
+			vkGetDeviceProcAddr(dev, "vkCmdPushDescriptorSetKHR"));
+		funcs.cmdPushDescriptorSetWithTemplate =
+			reinterpret_cast<PFN_vkCmdPushDescriptorSetWithTemplateKHR>(
+				vkGetDeviceProcAddr(dev, "vkCmdPushDescriptorSetWithTemplateKHR"));
+		if (funcs.cmdPushDescriptorSet == nullptr)
+		{
+			vtek_log_error("Failed to load push descriptor function pointers!");
+			device->enabledExtensions.pushDescriptor = false;
+		}
+	}
+
+	if (device->enabledExtensions.drawIndirectCount)
+	{
+		funcs.cmdDrawIndirectCount = reinterpret_cast<PFN_vkCmdDrawIndirectCountKHR>(
+			vkGetDeviceProcAddr(dev, "vkCmdDrawIndirectCountKHR"));
+		funcs.cmdDrawIndexedIndirectCount =
+			reinterpret_cast<PFN_vkCmdDrawIndexedIndirectCountKHR>(
+				vkGetDeviceProcAddr(dev, "vkCmdDrawIndexedIndirectCountKHR"));
+		if (funcs.cmdDrawIndirectCount == nullptr ||
+		    funcs.cmdDrawIndexedIndirectCount == nullptr)
+		{
+			vtek_log_error("Failed to load draw indirect count function pointers!");
+			device->enabledExtensions.drawIndirectCount = false;
+		}
+	}
+
+	if (device->enabledExtensions.synchronization2)
+	{
+		funcs.cmdPipelineBarrier2 = reinterpret_cast<PFN_vkCmdPipelineBarrier2KHR>(
+			vkGetDeviceProcAddr(dev, "vkCmdPipelineBarrier2KHR"));
+		if (funcs.cmdPipelineBarrier2 == nullptr)
+		{
+			vtek_log_error("Failed to load synchronization2 function pointers!");
+			device->enabledExtensions.synchronization2 = false;
+		}
+	}
 }
 
 static void get_msaa_limits(
@@ -602,15 +657,107 @@ static void get_msaa_limits(
 	device->msaaStencilLimit = get_max(stencil);
 }
 
+#if defined(VK_VERSION_1_2)
+static bool has_bindless_support(const vtek::PhysicalDevice* physicalDevice)
+{
+	auto props = vtek::physical_device_get_properties(physicalDevice);
+	vtek::VulkanVersion vv(props->apiVersion);
+	if (vv.major() == 1 && vv.minor() < 2)
+	{
+		vtek_log_error("Bindless texture support requires Vulkan >= 1.2!");
+		return false;
+	}
+
+	VkPhysicalDeviceDescriptorIndexingFeatures indexingFeatures{};
+	indexingFeatures.sType =
+		VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES;
+	indexingFeatures.pNext = nullptr;
+
+	VkPhysicalDeviceFeatures2 supported{};
+	supported.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+	supported.pNext = &indexingFeatures;
+
+	vkGetPhysicalDeviceFeatures2(
+		vtek::physical_device_get_handle(physicalDevice), &supported);
+
+	bool support = true;
+	if (!indexingFeatures.runtimeDescriptorArray)
+	{
+		vtek_log_error("runtimeDescriptorArray feature required but not supported");
+		support = false;
+	}
+	if (!indexingFeatures.descriptorBindingPartiallyBound)
+	{
+		vtek_log_error("descriptorBindingPartiallyBound feature required but not supported");
+		support = false;
+	}
+	if (!indexingFeatures.shaderSampledImageArrayNonUniformIndexing)
+	{
+		vtek_log_error("shaderSampledImageArrayNonUniformIndexing feature required but not supported");
+		support = false;
+	}
+	if (!indexingFeatures.shaderStorageBufferArrayNonUniformIndexing)
+	{
+		vtek_log_error("shaderStorageBufferArrayNonUniformIndexing feature required but not supported");
+		support = false;
+	}
+	if (!indexingFeatures.descriptorBindingSampledImageUpdateAfterBind)
+	{
+		vtek_log_error("descriptorBindingSampledImageUpdateAfterBind feature required but not supported");
+		support = false;
+	}
+	if (!indexingFeatures.descriptorBindingStorageBufferUpdateAfterBind)
+	{
+		vtek_log_error("descriptorBindingStorageBufferUpdateAfterBind feature required but not supported");
+		support = false;
+	}
+
+	return support;
+}
+
+static bool has_timeline_semaphore_support(const vtek::PhysicalDevice* physicalDevice)
+{
+	auto props = vtek::physical_device_get_properties(physicalDevice);
+	vtek::VulkanVersion vv(props->apiVersion);
+	if (vv.major() == 1 && vv.minor() < 2) { return false; }
+
+	VkPhysicalDeviceTimelineSemaphoreFeatures timelineFeatures{};
+	timelineFeatures.sType =
+		VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES;
+	timelineFeatures.pNext = nullptr;
+
+	VkPhysicalDeviceFeatures2 supported{};
+	supported.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+	supported.pNext = &timelineFeatures;
+
+	vkGetPhysicalDeviceFeatures2(
+		vtek::physical_device_get_handle(physicalDevice), &supported);
+
+	return timelineFeatures.timelineSemaphore == VK_TRUE;
+}
+#endif
+
 static bool use_descriptor_indexing_features(
 	VkPhysicalDeviceDescriptorIndexingFeatures* indexingFeatures,
-	const vtek::PhysicalDevice* physicalDevice)
+	const vtek::PhysicalDevice* physicalDevice, bool bindless)
 {
+	// Bindless resources are large, partially bound descriptor arrays that
+	// are updated while bound, and indexed non-uniformly from shaders.
+	if (bindless)
+	{
+		indexingFeatures->runtimeDescriptorArray = true;
+		indexingFeatures->descriptorBindingPartiallyBound = true;
+		indexingFeatures->shaderSampledImageArrayNonUniformIndexing = true;
+		indexingFeatures->shaderStorageBufferArrayNonUniformIndexing = true;
+		indexingFeatures->descriptorBindingSampledImageUpdateAfterBind = true;
+		indexingFeatures->descriptorBindingStorageBufferUpdateAfterBind = true;
+	}
+
 	auto required =
 		vtek::physical_device_get_update_after_bind_features(physicalDevice);
 	if (required.empty())
 	{
-		return false;
+		return bindless;
 	}
 
 	using UABFeature = vtek::UpdateAfterBindFeature;
@@ -696,16 +843,62 @@ vtek::Device* vtek::device_create(
 		createInfo.pNext = &dynRenderInfo;
 	};
 
+	// Add synchronization2
+	VkPhysicalDeviceSynchronization2FeaturesKHR sync2Info{};
+	if (supportedExtensions->synchronization2)
+	{
+		sync2Info.sType =
+			VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES_KHR;
+		sync2Info.pNext = const_cast<void*>(createInfo.pNext);
+		sync2Info.synchronization2 = VK_TRUE;
+
+		createInfo.pNext = &sync2Info;
+	}
+
 	// Descriptor indexing support: update-after-bind
 #if defined(VK_VERSION_1_2)
+	// Bindless texture support: descriptor indexing with partially bound arrays
+	if (info->enableBindlessTextureSupport)
+	{
+		if (!has_bindless_support(physicalDevice))
+		{
+			vtek_log_error("Bindless texture support requested but not {}",
+			               "supported -- Device creation cannot proceed.");
+			delete device;
+			return nullptr;
+		}
+		device->bindlessSupport = true;
+	}
+
 	VkPhysicalDeviceDescriptorIndexingFeatures indexingFeatures{};
-	if (use_descriptor_indexing_features(&indexingFeatures, physicalDevice))
+	if (use_descriptor_indexing_features(
+		    &indexingFeatures, physicalDevice, device->bindlessSupport))
 	{
 		indexingFeatures.sType =
 			VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES;
 		indexingFeatures.pNext = const_cast<void*>(createInfo.pNext);
 		createInfo.pNext = &indexingFeatures;
 	}
+
+	// Timeline semaphores, used by the swapchain for frame synchronization
+	VkPhysicalDeviceTimelineSemaphoreFeatures timelineInfo{};
+	if (has_timeline_semaphore_support(physicalDevice))
+	{
+		timelineInfo.sType =
+			VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES;
+		timelineInfo.pNext = const_cast<void*>(createInfo.pNext);
+		timelineInfo.timelineSemaphore = VK_TRUE;
+
+		createInfo.pNext = &timelineInfo;
+		device->timelineSemaphoreSupport = true;
+	}
+#else
+	if (info->enableBindlessTextureSupport)
+	{
+		vtek_log_error("Bindless texture support requires Vulkan >= 1.2!");
+		delete device;
+		return nullptr;
+	}
 #endif
 
 	// Set the actual Vulkan API version.
@@ -725,14 +918,6 @@ vtek::Device* vtek::device_create(
 		device->vulkanVersion = physDevVersion;
 	}
 
-	// Bindless texture support---------------------- (Added for legacy reasons)
-	if (info->enableBindlessTextureSupport)
-	{
-		vtek_log_error("Bindless texture support untested/not implemented");
-		delete device;
-		return nullptr;
-	}
-
 	// Validation layers
 	if (vtek::instance_get_validation_enabled(instance))
 	{
@@ -759,6 +944,7 @@ vtek::Device* vtek::device_create(
 
 	// Set extensions as enabled
 	set_extensions_enabled(device, physicalDevice);
+	load_extension_functions(device);
 
 	// Set features enabled, which is what was _required_ when picking physical device
 	device->enabledFeatures =
@@ -895,6 +1081,22 @@ vtek::CommandScheduler* vtek::device_get_command_scheduler(
 	return device->scheduler;
 }
 
+bool vtek::device_get_bindless_support(const vtek::Device* device)
+{
+	return device->bindlessSupport;
+}
+
+bool vtek::device_get_timeline_semaphore_support(const vtek::Device* device)
+{
+	return device->timelineSemaphoreSupport;
+}
+
+const vtek::DeviceExtensionFunctions* vtek::device_get_extension_functions(
+	const vtek::Device* device)
+{
+	return &device->extensionFunctions;
+}
+
 vtek::Queue* vtek::device_get_graphics_queue(vtek::Device* device)
 {
 	return (device->graphicsQueue.vulkanHandle == VK_NULL_HANDLE)
@@ -9,6 +9,14 @@
 #include <unordered_map>
 #include <vector>
 
+#if defined(__unix__) || defined(__APPLE__)
+#define VTEK_FILEIO_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 namespace fs = std::filesystem;
 
 
@@ -27,6 +35,15 @@ struct vtek::File
 	// TODO: Store a filename? `std::string filename;`, which is _not_ the entire path!
 };
 
+struct vtek::FileMapping
+{
+	const void* data {nullptr};
+	uint64_t size {0UL};
+#if !defined(VTEK_FILEIO_MMAP)
+	std::vector<char> fallbackBuffer;
+#endif
+};
+
 
 
 /* hashing of fileio structs (for memory pools) */
@@ -280,6 +297,19 @@ bool vtek::file_exists(const vtek::Directory* dir, std::string_view filename)
 	return fs::exists(p, ec);
 }
 
+bool vtek::file_rename(
+	const vtek::Directory* dir, std::string_view from, std::string_view to)
+{
+	std::error_code ec;
+	fs::rename(dir->handle/from, dir->handle/to, ec);
+	if (ec)
+	{
+		vtek_log_error("Failed to rename file {} to {}: {}", from, to, ec.message());
+		return false;
+	}
+	return true;
+}
+
 vtek::File* vtek::file_open(
 	const vtek::Directory* dir, std::string_view filename, vtek::FileModeFlags flags)
 {
@@ -297,13 +327,14 @@ vtek::File* vtek::file_open(
 
 	std::error_code ec; // Added so fs::<...> will not throw!
 
-	// The path exists
+	// The path exists, unless the file will be created by writing to it
 	auto path = dir->handle/filename;
-	if (!fs::exists(path, ec)) { return nullptr; }
+	const bool exists = fs::exists(path, ec);
+	if (!exists && !(flags & vtek::FileModeFlag::write)) { return nullptr; }
 
 	// The file is a regular file
 	auto entry = fs::directory_entry(path, ec);
-	if (!entry.is_regular_file(ec)) return nullptr;
+	if (exists && !entry.is_regular_file(ec)) return nullptr;
 
 	// Allocate the file
 	const uint64_t id = sMemoryPool->file_id++;
@@ -355,9 +386,91 @@ bool vtek::file_read_into_buffer(vtek::File* file, std::vector<char>& buffer)
 	return true;
 }
 
+bool vtek::file_write_data(vtek::File* file, const void* data, uint64_t size)
+{
+	file->handle.write(static_cast<const char*>(data), size);
+	if (!file->handle.good())
+	{
+		vtek_log_error("Failed to write {} bytes to file!", size);
+		return false;
+	}
+
+	file->size += size;
+	return true;
+}
+
 bool vtek::file_read_line_accum(
 	vtek::File* file, std::vector<char>& accumBuffer, std::vector<char>& line)
 {
 	vtek_log_fatal("vtek::file_read_line_accum - not implemented!");
 	return false;
 }
+
+vtek::FileMapping* vtek::file_map(
+	const vtek::Directory* dir, std::string_view filename)
+{
+	std::error_code ec; // Added so fs::<...> will not throw!
+	auto path = dir->handle/filename;
+	if (!fs::is_regular_file(path, ec)) { return nullptr; }
+
+#if defined(VTEK_FILEIO_MMAP)
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0) { return nullptr; }
+
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size == 0)
+	{
+		close(fd);
+		return nullptr;
+	}
+
+	void* data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd); // the mapping keeps its own reference to the file
+	if (data == MAP_FAILED)
+	{
+		vtek_log_error("Failed to memory-map file \"{}\"", path.c_str());
+		return nullptr;
+	}
+
+	auto mapping = new vtek::FileMapping;
+	mapping->data = data;
+	mapping->size = static_cast<uint64_t>(st.st_size);
+	return mapping;
+#else
+	std::ifstream stream(path, std::ios::in | std::ios::binary);
+	if (!stream.is_open()) { return nullptr; }
+
+	auto mapping = new vtek::FileMapping;
+	mapping->fallbackBuffer.resize(fs::file_size(path, ec));
+	stream.read(mapping->fallbackBuffer.data(), mapping->fallbackBuffer.size());
+	if (mapping->fallbackBuffer.empty() || !stream.good())
+	{
+		delete mapping;
+		return nullptr;
+	}
+
+	mapping->data = mapping->fallbackBuffer.data();
+	mapping->size = mapping->fallbackBuffer.size();
+	return mapping;
+#endif
+}
+
+void vtek::file_unmap(vtek::FileMapping* mapping)
+{
+	if (mapping == nullptr) { return; }
+
+#if defined(VTEK_FILEIO_MMAP)
+	munmap(const_cast<void*>(mapping->data), mapping->size);
+#endif
+	delete mapping;
+}
+
+const void* vtek::file_mapping_get_data(const vtek::FileMapping* mapping)
+{
+	return mapping->data;
+}
+
+uint64_t vtek::file_mapping_get_size(const vtek::FileMapping* mapping)
+{
+	return mapping->size;
+}
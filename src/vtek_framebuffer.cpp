@@ -2,6 +2,7 @@
 #include "vtek_framebuffer.hpp"
 
 #include "impl/vtek_queue_struct.hpp"
+#include "vtek_barrier_batch.hpp"
 #include "vtek_command_buffer.hpp"
 #include "vtek_device.hpp"
 #include "vtek_image.hpp"
@@ -29,6 +30,7 @@ struct vtek::Framebuffer
 	glm::uvec2 resolution {1,1};
 	uint32_t graphicsQueueFamilyIndex {0};
 	bool dynamicRenderingOnly {false};
+	vtek::BarrierBatch* barriers {nullptr};
 	// TODO: Attachments can have had explicit queue ownership transfers!
 };
 
@@ -165,98 +167,6 @@ static bool create_vulkan_framebuffer_handle(
 	return result == VK_SUCCESS;
 }
 
-static void color_memory_barrier_begin(
-	VkCommandBuffer cmdBuf, FramebufferAttachment& attachment,
-	uint32_t srcQueueFamilyIndex, uint32_t dstQueueFamilyIndex)
-{
-	// Transition from whatever (probably present src) to color attachment
-	VkImageMemoryBarrier barrier{};
-	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-	barrier.pNext = nullptr;
-	barrier.srcAccessMask = 0;
-	barrier.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-	barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-	barrier.newLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-	// TODO: Attachments can have had explicit queue ownership transfers!
-	barrier.srcQueueFamilyIndex = srcQueueFamilyIndex;
-	barrier.dstQueueFamilyIndex = dstQueueFamilyIndex;
-	barrier.image = vtek::image2d_get_handle(attachment.image);
-	barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-	barrier.subresourceRange.baseMipLevel = 0;
-	barrier.subresourceRange.levelCount = 1;
-	barrier.subresourceRange.baseArrayLayer = 0;
-	barrier.subresourceRange.layerCount = 1;
-
-	vkCmdPipelineBarrier(
-		cmdBuf, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
-		VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, 0, 0, nullptr,
-		0, nullptr, 1, &barrier);
-}
-
-static void color_memory_barrier_end(
-	VkCommandBuffer cmdBuf, FramebufferAttachment& attachment,
-	uint32_t srcQueueFamilyIndex, uint32_t dstQueueFamilyIndex)
-{
-	// Transition from color attachment to read something
-	VkImageMemoryBarrier barrier{};
-	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-	barrier.pNext = nullptr;
-	barrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-	barrier.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT;
-	barrier.oldLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-	barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-	// TODO: Attachments can have had explicit queue ownership transfers!
-	barrier.srcQueueFamilyIndex = srcQueueFamilyIndex;
-	barrier.dstQueueFamilyIndex = dstQueueFamilyIndex;
-	barrier.image = vtek::image2d_get_handle(attachment.image);
-	barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-	barrier.subresourceRange.baseMipLevel = 0;
-	barrier.subresourceRange.levelCount = 1;
-	barrier.subresourceRange.baseArrayLayer = 0;
-	barrier.subresourceRange.layerCount = 1;
-
-	vkCmdPipelineBarrier(
-		cmdBuf, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-		VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, 0, 0, nullptr,
-		0, nullptr, 1, &barrier);
-}
-
-static void depth_stencil_memory_barrier_begin(
-	VkCommandBuffer cmdBuf, FramebufferAttachment& attachment,
-	uint32_t srcQueueFamilyIndex, uint32_t dstQueueFamilyIndex)
-{
-	VkImageMemoryBarrier barrier{};
-	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-	barrier.pNext = nullptr;
-	barrier.srcAccessMask = 0;
-	barrier.dstAccessMask
-		= VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-	barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-	barrier.newLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-	// TODO: Attachments can have had explicit queue ownership transfers!
-	barrier.srcQueueFamilyIndex = srcQueueFamilyIndex;
-	barrier.dstQueueFamilyIndex = dstQueueFamilyIndex;
-	barrier.image = vtek::image2d_get_handle(attachment.image);
-	barrier.subresourceRange.aspectMask = 0;
-	if (attachment.supportedFormat.has_depth()) {
-		barrier.subresourceRange.aspectMask |= VK_IMAGE_ASPECT_DEPTH_BIT;
-	}
-	if (attachment.supportedFormat.has_stencil()) {
-		barrier.subresourceRange.aspectMask |= VK_IMAGE_ASPECT_STENCIL_BIT;
-	}
-	barrier.subresourceRange.baseMipLevel = 0;
-	barrier.subresourceRange.levelCount = 1;
-	barrier.subresourceRange.baseArrayLayer = 0;
-	barrier.subresourceRange.layerCount = 1;
-
-	const VkPipelineStageFlags srcStageMask = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-	const VkPipelineStageFlags dstStageMask
-		= VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-
-	vkCmdPipelineBarrier(
-		cmdBuf, srcStageMask, dstStageMask, 0, 0, nullptr, 0, nullptr, 1, &barrier);
-}
-
 
 
 /* interface */
@@ -388,6 +298,7 @@ vtek::Framebuffer* vtek::framebuffer_create(
 	framebuffer->resolution = info->resolution;
 	vtek::Queue* graphicsQueue = vtek::device_get_graphics_queue(device);
 	framebuffer->graphicsQueueFamilyIndex = graphicsQueue->familyIndex;
+	framebuffer->barriers = vtek::barrier_batch_create(device);
 
 	//
 	// DONE: For dynamic rendering only, no vkFramebuffer can be created!
@@ -447,6 +358,9 @@ void vtek::framebuffer_destroy(
 		framebuffer->depthStencilAttachment = {};
 	}
 
+	vtek::barrier_batch_destroy(framebuffer->barriers);
+	framebuffer->barriers = nullptr;
+
 	if (framebuffer->handle != VK_NULL_HANDLE)
 	{
 		auto dev = vtek::device_get_handle(device);
@@ -486,24 +400,35 @@ bool vtek::framebuffer_dynamic_rendering_begin(
 
 	auto cmdBuf = vtek::command_buffer_get_handle(commandBuffer);
 
-	// TODO: Transition for each color attachment
-	std::vector<VkRenderingAttachmentInfo> colorAttachmentInfos{};
+	// Transition all attachments with a single barrier command. Previous
+	// contents are discarded, since attachments are cleared on load.
+	// TODO: Attachments can have had explicit queue ownership transfers!
+	const bool useDepth = framebuffer->useDepth;
+	const bool useStencil = framebuffer->useStencil;
+	for (auto& att : framebuffer->colorAttachments)
+	{
+		vtek::barrier_batch_image(
+			framebuffer->barriers, att.image,
+			vtek::ImageAccessType::color_attachment_write, true);
+	}
+	if (useDepth || useStencil)
+	{
+		vtek::barrier_batch_image(
+			framebuffer->barriers, framebuffer->depthStencilAttachment.image,
+			vtek::ImageAccessType::depth_stencil_attachment_write, true);
+	}
+	vtek::barrier_batch_flush(framebuffer->barriers, commandBuffer);
 
 	// Create attachment info structs for each color attachment
+	std::vector<VkRenderingAttachmentInfo> colorAttachmentInfos{};
 	for (auto& att : framebuffer->colorAttachments)
 	{
-		// Image memory barrier for each color attachment
-		// TODO: Attachments can have had explicit queue ownership transfers!
-		uint32_t queueFamilyIndex = framebuffer->graphicsQueueFamilyIndex;
-		color_memory_barrier_begin(
-			cmdBuf, att, queueFamilyIndex, queueFamilyIndex);
-
 		// Color attachment info for dynamic rendering
 		VkRenderingAttachmentInfo attachInfo{};
 		attachInfo.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
 		attachInfo.pNext = nullptr;
 		attachInfo.imageView = vtek::image2d_get_view_handle(att.image);
-		attachInfo.imageLayout = VK_IMAGE_LAYOUT_ATTACHMENT_OPTIMAL;
+		attachInfo.imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 		// TODO: Multisampled framebuffer
 		attachInfo.resolveMode = VK_RESOLVE_MODE_NONE;
 		attachInfo.resolveImageView = VK_NULL_HANDLE;
@@ -532,18 +457,9 @@ bool vtek::framebuffer_dynamic_rendering_begin(
 
 	// Create attachment info for depth/stencil attachment if such exists
 	VkRenderingAttachmentInfo depthStencilAttachmentInfo{};
-	const bool useDepth = framebuffer->useDepth;
-	const bool useStencil = framebuffer->useStencil;
-
 	if (useDepth || useStencil)
 	{
 		auto& att = framebuffer->depthStencilAttachment;
-
-		// TODO: Attachments can have had explicit queue ownership transfers!
-		uint32_t queueFamilyIndex = framebuffer->graphicsQueueFamilyIndex;
-		depth_stencil_memory_barrier_begin(
-			cmdBuf, att, queueFamilyIndex, queueFamilyIndex);
-
 		VkRenderingAttachmentInfo& info = depthStencilAttachmentInfo;
 
 		info.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
@@ -590,16 +506,15 @@ void vtek::framebuffer_dynamic_rendering_end(
 	// before a layout transition is executed."
 	// NOTE: This probably means we need a fence!?
 
-	std::vector<VkRenderingAttachmentInfo> colorAttachmentInfos{};
-
-	// Transition attachments into read
+	// Transition color attachments into read, with a single barrier command
+	// TODO: Attachments can have had explicit queue ownership transfers!
 	for (auto& att : framebuffer->colorAttachments)
 	{
-		// Image memory barrier for each color attachment
-		// TODO: Attachments can have had explicit queue ownership transfers!
-		uint32_t queueFamilyIndex = framebuffer->graphicsQueueFamilyIndex;
-		color_memory_barrier_end(cmdBuf, att, queueFamilyIndex, queueFamilyIndex);
+		vtek::barrier_batch_image(
+			framebuffer->barriers, att.image,
+			vtek::ImageAccessType::fragment_shader_read);
 	}
+	vtek::barrier_batch_flush(framebuffer->barriers, commandBuffer);
 }
 
 std::vector<vtek::Format> vtek::framebuffer_get_color_formats(
@@ -643,6 +558,12 @@ std::vector<vtek::Image2D*> vtek::framebuffer_get_color_images(
 	return images; // RVO
 }
 
+vtek::Image2D* vtek::framebuffer_get_depth_stencil_image(
+	vtek::Framebuffer* framebuffer)
+{
+	return framebuffer->depthStencilAttachment.image;
+}
+
 void vtek::framebuffer_set_clear_color(
 	vtek::Framebuffer* framebuffer, uint32_t attachmentIndex,
 	vtek::ClearValue clearValue)
@@ -0,0 +1,283 @@
+#include "vtek_vulkan.pch"
+#include "vtek_geometry_arena.hpp"
+
+#include "vtek_buffer.hpp"
+#include "vtek_logging.hpp"
+
+#include <cstring>
+#include <mutex>
+
+
+/* struct implementation */
+struct vtek::GeometryArena
+{
+	vtek::Buffer* vertexBuffer {nullptr};
+	vtek::Buffer* normalBuffer {nullptr};
+	vtek::Buffer* texCoordBuffer {nullptr};
+	vtek::Buffer* indexBuffer {nullptr};
+
+	// Virtual blocks measured in vertices and indices, not bytes
+	VmaVirtualBlock vertexBlock {VK_NULL_HANDLE};
+	VmaVirtualBlock indexBlock {VK_NULL_HANDLE};
+	std::mutex mutex;
+
+	vtek::IndexType indexType {vtek::IndexType::uint32};
+	vtek::VertexAttributeType positionType {vtek::VertexAttributeType::vec3};
+	vtek::VertexAttributeType normalType {vtek::VertexAttributeType::vec3};
+	vtek::VertexAttributeType texCoordType {vtek::VertexAttributeType::vec2};
+};
+
+
+
+/* helper functions */
+// Virtual allocations are opaque handles, which are a pointer or a 64-bit
+// integer depending on platform, and are stored as integers in ranges.
+static uint64_t to_range_handle(VmaVirtualAllocation allocation)
+{
+	static_assert(sizeof(VmaVirtualAllocation) <= sizeof(uint64_t));
+	uint64_t handle = 0UL;
+	std::memcpy(&handle, &allocation, sizeof(allocation));
+	return handle;
+}
+
+static VmaVirtualAllocation from_range_handle(uint64_t handle)
+{
+	VmaVirtualAllocation allocation;
+	std::memcpy(&allocation, &handle, sizeof(allocation));
+	return allocation;
+}
+
+static vtek::Buffer* create_arena_buffer(
+	uint64_t size, vtek::EnumBitmask<vtek::BufferUsageFlag> usage,
+	bool allowStorageBuffer, vtek::Device* device)
+{
+	vtek::BufferInfo bufferInfo{};
+	bufferInfo.size = size;
+	bufferInfo.writePolicy = vtek::BufferWritePolicy::write_once;
+	bufferInfo.usageFlags = usage;
+	bufferInfo.usageFlags.add_flag(vtek::BufferUsageFlag::transfer_dst);
+	if (allowStorageBuffer)
+	{
+		bufferInfo.usageFlags.add_flag(vtek::BufferUsageFlag::storage_buffer);
+	}
+
+	return vtek::buffer_create(&bufferInfo, device);
+}
+
+static void destroy_arena(vtek::GeometryArena* arena)
+{
+	vtek::Buffer* buffers[] = {
+		arena->vertexBuffer, arena->normalBuffer,
+		arena->texCoordBuffer, arena->indexBuffer
+	};
+	for (auto buffer : buffers)
+	{
+		if (buffer != nullptr) { vtek::buffer_destroy(buffer); }
+	}
+
+	if (arena->vertexBlock != VK_NULL_HANDLE)
+	{
+		vmaDestroyVirtualBlock(arena->vertexBlock);
+	}
+	if (arena->indexBlock != VK_NULL_HANDLE)
+	{
+		vmaDestroyVirtualBlock(arena->indexBlock);
+	}
+
+	delete arena;
+}
+
+
+
+/* interface */
+vtek::GeometryArena* vtek::geometry_arena_create(
+	const vtek::GeometryArenaInfo* info, vtek::Device* device)
+{
+	if (info->maxVertices == 0U || info->maxIndices == 0U)
+	{
+		vtek_log_error("Geometry arena must have non-zero capacity!");
+		return nullptr;
+	}
+
+	auto arena = new vtek::GeometryArena;
+	arena->indexType = info->indexType;
+	arena->positionType = info->positionType;
+	arena->normalType = info->normalType;
+	arena->texCoordType = info->texCoordType;
+
+	VmaVirtualBlockCreateInfo blockInfo{};
+	blockInfo.size = info->maxVertices;
+	VkResult vertexResult = vmaCreateVirtualBlock(&blockInfo, &arena->vertexBlock);
+	blockInfo.size = info->maxIndices;
+	VkResult indexResult = vmaCreateVirtualBlock(&blockInfo, &arena->indexBlock);
+	if (vertexResult != VK_SUCCESS || indexResult != VK_SUCCESS)
+	{
+		vtek_log_error("Failed to create virtual blocks for geometry arena!");
+		destroy_arena(arena);
+		return nullptr;
+	}
+
+	using BUFlag = vtek::BufferUsageFlag;
+	const uint64_t maxVertices = info->maxVertices;
+	const uint32_t indexSize = (info->indexType == vtek::IndexType::uint16)
+		? sizeof(uint16_t) : sizeof(uint32_t);
+
+	arena->vertexBuffer = create_arena_buffer(
+		maxVertices * vtek::vertex_attribute_get_size(info->positionType),
+		BUFlag::vertex_buffer, info->allowStorageBuffer, device);
+	if (info->normals)
+	{
+		arena->normalBuffer = create_arena_buffer(
+			maxVertices * vtek::vertex_attribute_get_size(info->normalType),
+			BUFlag::vertex_buffer, info->allowStorageBuffer, device);
+	}
+	if (info->textureCoordinates)
+	{
+		arena->texCoordBuffer = create_arena_buffer(
+			maxVertices * vtek::vertex_attribute_get_size(info->texCoordType),
+			BUFlag::vertex_buffer, info->allowStorageBuffer, device);
+	}
+	arena->indexBuffer = create_arena_buffer(
+		uint64_t{info->maxIndices} * indexSize,
+		BUFlag::index_buffer, info->allowStorageBuffer, device);
+
+	if (arena->vertexBuffer == nullptr || arena->indexBuffer == nullptr ||
+	    (info->normals && arena->normalBuffer == nullptr) ||
+	    (info->textureCoordinates && arena->texCoordBuffer == nullptr))
+	{
+		vtek_log_error("Failed to create buffers for geometry arena!");
+		destroy_arena(arena);
+		return nullptr;
+	}
+
+	return arena;
+}
+
+void vtek::geometry_arena_destroy(vtek::GeometryArena* arena)
+{
+	if (arena == nullptr) return;
+
+	if (!vmaIsVirtualBlockEmpty(arena->vertexBlock) ||
+	    !vmaIsVirtualBlockEmpty(arena->indexBlock))
+	{
+		vtek_log_error("Geometry arena destroyed with live allocations!");
+		vmaClearVirtualBlock(arena->vertexBlock);
+		vmaClearVirtualBlock(arena->indexBlock);
+	}
+
+	destroy_arena(arena);
+}
+
+bool vtek::geometry_arena_allocate(
+	vtek::GeometryArena* arena, uint32_t numVertices, uint32_t numIndices,
+	vtek::GeometryArenaRange* outRange)
+{
+	if (numVertices == 0U || numIndices == 0U)
+	{
+		vtek_log_error("Cannot allocate empty range from geometry arena!");
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock(arena->mutex);
+
+	VmaVirtualAllocationCreateInfo allocInfo{};
+	allocInfo.size = numVertices;
+	VmaVirtualAllocation vertexAllocation;
+	VkDeviceSize vertexOffset;
+	if (vmaVirtualAllocate(arena->vertexBlock, &allocInfo, &vertexAllocation,
+	                       &vertexOffset) != VK_SUCCESS)
+	{
+		vtek_log_error("Geometry arena out of space for {} vertices!", numVertices);
+		return false;
+	}
+
+	allocInfo.size = numIndices;
+	VmaVirtualAllocation indexAllocation;
+	VkDeviceSize indexOffset;
+	if (vmaVirtualAllocate(arena->indexBlock, &allocInfo, &indexAllocation,
+	                       &indexOffset) != VK_SUCCESS)
+	{
+		vtek_log_error("Geometry arena out of space for {} indices!", numIndices);
+		vmaVirtualFree(arena->vertexBlock, vertexAllocation);
+		return false;
+	}
+
+	outRange->baseVertex = static_cast<uint32_t>(vertexOffset);
+	outRange->numVertices = numVertices;
+	outRange->firstIndex = static_cast<uint32_t>(indexOffset);
+	outRange->numIndices = numIndices;
+	outRange->vertexAllocation = to_range_handle(vertexAllocation);
+	outRange->indexAllocation = to_range_handle(indexAllocation);
+
+	return true;
+}
+
+void vtek::geometry_arena_free(vtek::GeometryArena* arena, vtek::GeometryArenaRange* range)
+{
+	if (range->vertexAllocation == 0UL && range->indexAllocation == 0UL) return;
+
+	std::lock_guard<std::mutex> lock(arena->mutex);
+	vmaVirtualFree(arena->vertexBlock, from_range_handle(range->vertexAllocation));
+	vmaVirtualFree(arena->indexBlock, from_range_handle(range->indexAllocation));
+
+	*range = vtek::GeometryArenaRange{};
+}
+
+vtek::Buffer* vtek::geometry_arena_get_vertex_buffer(vtek::GeometryArena* arena)
+{
+	return arena->vertexBuffer;
+}
+
+vtek::Buffer* vtek::geometry_arena_get_normal_buffer(vtek::GeometryArena* arena)
+{
+	return arena->normalBuffer;
+}
+
+vtek::Buffer* vtek::geometry_arena_get_texcoord_buffer(vtek::GeometryArena* arena)
+{
+	return arena->texCoordBuffer;
+}
+
+vtek::Buffer* vtek::geometry_arena_get_index_buffer(vtek::GeometryArena* arena)
+{
+	return arena->indexBuffer;
+}
+
+vtek::IndexType vtek::geometry_arena_get_index_type(vtek::GeometryArena* arena)
+{
+	return arena->indexType;
+}
+
+vtek::VertexAttributeType vtek::geometry_arena_get_position_type(vtek::GeometryArena* arena)
+{
+	return arena->positionType;
+}
+
+vtek::VertexAttributeType vtek::geometry_arena_get_normal_type(vtek::GeometryArena* arena)
+{
+	return arena->normalType;
+}
+
+vtek::VertexAttributeType vtek::geometry_arena_get_texcoord_type(vtek::GeometryArena* arena)
+{
+	return arena->texCoordType;
+}
+
+vtek::GeometryArenaStats vtek::geometry_arena_get_stats(vtek::GeometryArena* arena)
+{
+	std::lock_guard<std::mutex> lock(arena->mutex);
+
+	VmaDetailedStatistics vertexStats{};
+	VmaDetailedStatistics indexStats{};
+	vmaCalculateVirtualBlockStatistics(arena->vertexBlock, &vertexStats);
+	vmaCalculateVirtualBlockStatistics(arena->indexBlock, &indexStats);
+
+	vtek::GeometryArenaStats stats{};
+	stats.numAllocations = vertexStats.statistics.allocationCount;
+	stats.usedVertices = static_cast<uint32_t>(vertexStats.statistics.allocationBytes);
+	stats.usedIndices = static_cast<uint32_t>(indexStats.statistics.allocationBytes);
+	stats.largestFreeVertexRange = static_cast<uint32_t>(vertexStats.unusedRangeSizeMax);
+	stats.largestFreeIndexRange = static_cast<uint32_t>(indexStats.unusedRangeSizeMax);
+
+	return stats;
+}
@@ -0,0 +1,327 @@
+#include "vtek_vulkan.pch"
+#include "vtek_gpu_profiler.hpp"
+
+#include "vtek_command_buffer.hpp"
+#include "vtek_device.hpp"
+#include "vtek_logging.hpp"
+#include "vtek_queue.hpp"
+
+#include <algorithm>
+#include <unordered_map>
+
+
+/* struct implementation */
+struct RecordedScope
+{
+	uint32_t scope;
+	uint32_t depth;
+	uint32_t query; // begin timestamp, followed by end timestamp
+};
+
+struct FrameQueries
+{
+	VkQueryPool pool {VK_NULL_HANDLE};
+	std::vector<RecordedScope> recorded;
+	uint32_t numQueries {0U};
+};
+
+struct ScopeHistory
+{
+	std::string name;
+	uint32_t depth {0U};
+	float lastMs {0.0f};
+	std::vector<float> samples; // ring buffer
+	uint32_t next {0U};
+	uint32_t count {0U};
+};
+
+struct vtek::GpuProfiler
+{
+	VkDevice device {VK_NULL_HANDLE};
+	std::vector<FrameQueries> frames;
+	uint32_t maxQueriesPerFrame {0U};
+	uint32_t historyLength {0U};
+
+	// Converts timestamp ticks into nanoseconds
+	double timestampPeriod {1.0};
+	uint64_t timestampMask {UINT64_MAX};
+
+	// Frame being recorded, and the stack of open scopes in it. Scopes
+	// which did not fit in the query pool are pushed as `UINT32_MAX`.
+	uint32_t currentFrame {UINT32_MAX};
+	std::vector<uint32_t> openScopes;
+
+	std::unordered_map<std::string, uint32_t> scopeIndices;
+	std::vector<ScopeHistory> scopes;
+	float frameTimeMs {0.0f};
+
+	// Results and accumulated times, reused between frames
+	std::vector<uint64_t> results;
+	std::vector<float> frameScopeMs;
+};
+
+
+
+/* helper functions */
+static void read_results(vtek::GpuProfiler* profiler, FrameQueries& frame)
+{
+	if (frame.numQueries == 0U) { return; }
+
+	// Each result is followed by its availability, so queries that are not
+	// available, e.g. of scopes that were never ended, are skipped.
+	profiler->results.assign(frame.numQueries * 2, 0UL);
+	vkGetQueryPoolResults(
+		profiler->device, frame.pool, 0, frame.numQueries,
+		profiler->results.size() * sizeof(uint64_t), profiler->results.data(),
+		2 * sizeof(uint64_t), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+
+	auto& frameMs = profiler->frameScopeMs;
+	frameMs.assign(profiler->scopes.size(), -1.0f);
+	float frameTime = 0.0f;
+
+	for (const auto& rec : frame.recorded)
+	{
+		const uint64_t* begin = &profiler->results[rec.query * 2];
+		const uint64_t* end = &profiler->results[(rec.query + 1) * 2];
+		if (begin[1] == 0UL || end[1] == 0UL) { continue; }
+
+		const uint64_t ticks = (end[0] - begin[0]) & profiler->timestampMask;
+		const float ms = static_cast<float>(ticks * profiler->timestampPeriod * 1e-6);
+
+		frameMs[rec.scope] = std::max(frameMs[rec.scope], 0.0f) + ms;
+		profiler->scopes[rec.scope].depth = rec.depth;
+		if (rec.depth == 0U) { frameTime += ms; }
+	}
+
+	for (uint32_t i = 0; i < profiler->scopes.size(); i++)
+	{
+		if (frameMs[i] < 0.0f) { continue; }
+
+		ScopeHistory& history = profiler->scopes[i];
+		history.lastMs = frameMs[i];
+		history.samples[history.next] = frameMs[i];
+		history.next = (history.next + 1) % profiler->historyLength;
+		history.count = std::min(history.count + 1, profiler->historyLength);
+	}
+	profiler->frameTimeMs = frameTime;
+}
+
+static void write_timestamp(
+	vtek::GpuProfiler* profiler, vtek::CommandBuffer* commandBuffer,
+	VkPipelineStageFlagBits stage, uint32_t query)
+{
+	VkCommandBuffer cmdBuf = vtek::command_buffer_get_handle(commandBuffer);
+	FrameQueries& frame = profiler->frames[profiler->currentFrame];
+
+	vkCmdWriteTimestamp(cmdBuf, stage, frame.pool, query);
+}
+
+
+
+/* interface */
+vtek::GpuProfiler* vtek::gpu_profiler_create(
+	const vtek::GpuProfilerInfo* info, vtek::Device* device)
+{
+	if (info->numFrames == 0U || info->maxScopesPerFrame == 0U || info->historyLength == 0U)
+	{
+		vtek_log_error("GPU profiler must have non-zero frame count, {}",
+		               "scope count, and history length!");
+		return nullptr;
+	}
+
+	// Timestamps are only valid for queue families with valid bits
+	VkPhysicalDevice physDev = vtek::device_get_physical_handle(device);
+	uint32_t familyIndex =
+		vtek::queue_get_family_index(vtek::device_get_graphics_queue(device));
+
+	uint32_t numFamilies = 0;
+	vkGetPhysicalDeviceQueueFamilyProperties(physDev, &numFamilies, nullptr);
+	std::vector<VkQueueFamilyProperties> families(numFamilies);
+	vkGetPhysicalDeviceQueueFamilyProperties(physDev, &numFamilies, families.data());
+
+	const uint32_t validBits = families[familyIndex].timestampValidBits;
+	if (validBits == 0U)
+	{
+		vtek_log_error("Graphics queue does not support timestamps -- {}",
+		               "cannot create GPU profiler!");
+		return nullptr;
+	}
+
+	auto profiler = new vtek::GpuProfiler;
+	profiler->device = vtek::device_get_handle(device);
+	profiler->maxQueriesPerFrame = info->maxScopesPerFrame * 2;
+	profiler->historyLength = info->historyLength;
+	profiler->timestampPeriod =
+		vtek::device_get_physical_properties(device)->limits.timestampPeriod;
+	profiler->timestampMask =
+		(validBits >= 64U) ? UINT64_MAX : ((uint64_t{1} << validBits) - 1);
+
+	VkQueryPoolCreateInfo createInfo{};
+	createInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+	createInfo.pNext = nullptr;
+	createInfo.flags = 0;
+	createInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+	createInfo.queryCount = profiler->maxQueriesPerFrame;
+	createInfo.pipelineStatistics = 0;
+
+	profiler->frames.resize(info->numFrames);
+	for (auto& frame : profiler->frames)
+	{
+		VkResult result = vkCreateQueryPool(
+			profiler->device, &createInfo, nullptr, &frame.pool);
+		if (result != VK_SUCCESS)
+		{
+			vtek_log_error("Failed to create timestamp query pool!");
+			vtek::gpu_profiler_destroy(profiler);
+			return nullptr;
+		}
+		frame.recorded.reserve(info->maxScopesPerFrame);
+	}
+
+	return profiler;
+}
+
+void vtek::gpu_profiler_destroy(vtek::GpuProfiler* profiler)
+{
+	if (profiler == nullptr) return;
+
+	for (auto& frame : profiler->frames)
+	{
+		if (frame.pool != VK_NULL_HANDLE)
+		{
+			vkDestroyQueryPool(profiler->device, frame.pool, nullptr);
+		}
+	}
+	profiler->frames.clear();
+
+	delete profiler;
+}
+
+void vtek::gpu_profiler_begin_frame(
+	vtek::GpuProfiler* profiler, vtek::CommandBuffer* commandBuffer, uint32_t frameIndex)
+{
+	if (frameIndex >= profiler->frames.size())
+	{
+		vtek_log_error("GPU profiler frame index {} out of range!", frameIndex);
+		frameIndex = frameIndex % profiler->frames.size();
+	}
+	if (!profiler->openScopes.empty())
+	{
+		vtek_log_warn("GPU profiler: {} scopes were not ended in the previous frame!",
+		              profiler->openScopes.size());
+		profiler->openScopes.clear();
+	}
+
+	FrameQueries& frame = profiler->frames[frameIndex];
+	read_results(profiler, frame);
+
+	VkCommandBuffer cmdBuf = vtek::command_buffer_get_handle(commandBuffer);
+	vkCmdResetQueryPool(cmdBuf, frame.pool, 0, profiler->maxQueriesPerFrame);
+
+	frame.recorded.clear();
+	frame.numQueries = 0U;
+	profiler->currentFrame = frameIndex;
+}
+
+void vtek::cmd_profile_begin(
+	vtek::CommandBuffer* commandBuffer, vtek::GpuProfiler* profiler, std::string_view name)
+{
+	if (profiler->currentFrame == UINT32_MAX)
+	{
+		vtek_log_error("GPU profiler: gpu_profiler_begin_frame() not called -- {}",
+		               "cannot begin scope!");
+		return;
+	}
+
+	FrameQueries& frame = profiler->frames[profiler->currentFrame];
+	if (frame.numQueries + 2 > profiler->maxQueriesPerFrame)
+	{
+		profiler->openScopes.push_back(UINT32_MAX);
+		return;
+	}
+
+	std::string key(name);
+	auto it = profiler->scopeIndices.find(key);
+	uint32_t scope;
+	if (it != profiler->scopeIndices.end())
+	{
+		scope = it->second;
+	}
+	else
+	{
+		scope = static_cast<uint32_t>(profiler->scopes.size());
+		profiler->scopeIndices.emplace(key, scope);
+		profiler->scopes.emplace_back();
+		profiler->scopes.back().name = std::move(key);
+		profiler->scopes.back().samples.assign(profiler->historyLength, 0.0f);
+	}
+
+	const uint32_t query = frame.numQueries;
+	frame.numQueries += 2;
+	frame.recorded.push_back(
+		{ scope, static_cast<uint32_t>(profiler->openScopes.size()), query });
+	profiler->openScopes.push_back(query);
+
+	write_timestamp(profiler, commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, query);
+}
+
+void vtek::cmd_profile_end(vtek::CommandBuffer* commandBuffer, vtek::GpuProfiler* profiler)
+{
+	if (profiler->openScopes.empty())
+	{
+		vtek_log_error("GPU profiler: No open scope -- cannot end scope!");
+		return;
+	}
+
+	const uint32_t query = profiler->openScopes.back();
+	profiler->openScopes.pop_back();
+	if (query == UINT32_MAX) { return; }
+
+	write_timestamp(profiler, commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, query + 1);
+}
+
+std::vector<vtek::GpuProfileStats> vtek::gpu_profiler_get_stats(vtek::GpuProfiler* profiler)
+{
+	std::vector<vtek::GpuProfileStats> stats;
+	stats.reserve(profiler->scopes.size());
+
+	for (const auto& history : profiler->scopes)
+	{
+		vtek::GpuProfileStats s{};
+		s.name = history.name;
+		s.depth = history.depth;
+		s.lastMs = history.lastMs;
+		s.numSamples = history.count;
+
+		if (history.count > 0U)
+		{
+			auto first = history.samples.begin();
+			auto last = first + history.count;
+			float sum = 0.0f;
+			for (auto it = first; it != last; ++it) { sum += *it; }
+
+			s.averageMs = sum / history.count;
+			s.minMs = *std::min_element(first, last);
+			s.maxMs = *std::max_element(first, last);
+		}
+		stats.push_back(std::move(s));
+	}
+
+	return stats; // RVO
+}
+
+float vtek::gpu_profiler_get_frame_time_ms(vtek::GpuProfiler* profiler)
+{
+	return profiler->frameTimeMs;
+}
+
+void vtek::gpu_profiler_reset_stats(vtek::GpuProfiler* profiler)
+{
+	for (auto& history : profiler->scopes)
+	{
+		history.lastMs = 0.0f;
+		history.next = 0U;
+		history.count = 0U;
+	}
+	profiler->frameTimeMs = 0.0f;
+}
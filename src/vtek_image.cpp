@@ -303,6 +303,43 @@ vtek::Image2D* vtek::image2d_create(
 	return image;
 }
 
+vtek::Image2D* vtek::image2d_create_aliased(
+	const vtek::Image2DInfo* info, VmaAllocation allocation, uint64_t offset,
+	vtek::Device* device)
+{
+	vtek::Allocator* allocator = vtek::device_get_allocator(device);
+	if (allocator == nullptr)
+	{
+		vtek_log_error("Device does not have a default allocator -- {}",
+		               "cannot create aliased image!");
+		return nullptr;
+	}
+
+	auto image = new vtek::Image2D;
+	if (!vtek::allocator_image2d_create_aliased(allocator, info, allocation, offset, image))
+	{
+		vtek_log_error("Failed to create aliased 2D image!");
+		delete image;
+		return nullptr;
+	}
+
+	if (info->createImageView)
+	{
+		VkImageView view = create_image2d_view(image, &info->imageViewInfo, device);
+		if (view == VK_NULL_HANDLE)
+		{
+			vtek_log_error("Image view creation failed -- cannot return image!");
+			vtek::allocator_image2d_destroy(image);
+			delete image;
+			return nullptr;
+		}
+
+		image->viewHandle = view;
+	}
+
+	return image;
+}
+
 void vtek::image2d_destroy(vtek::Image2D* image, vtek::Device* device)
 {
 	if (image == nullptr) { return; }
@@ -0,0 +1,277 @@
+#include "vtek_vulkan.pch"
+#include "vtek_indirect_draw_buffer.hpp"
+
+#include "impl/vtek_vma_helpers.hpp"
+#include "vtek_buffer.hpp"
+#include "vtek_device.hpp"
+#include "vtek_logging.hpp"
+#include "vtek_models.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+
+/* struct implementation */
+struct vtek::IndirectDrawBuffer
+{
+	vtek::Buffer* buffer {nullptr};
+	uint8_t* mappedPtr {nullptr};
+
+	uint64_t regionSize {0UL};
+	uint32_t numFrames {0U};
+	uint32_t maxDraws {0U};
+	uint32_t stride {0U};
+	bool indexed {true};
+
+	// Start of the current frame's region, and number of draws in it
+	uint64_t regionOffset {0UL};
+	uint32_t numDraws {0U};
+};
+
+
+
+/* helper functions */
+// The draw count is placed first in each region, padded so the commands
+// start at an offset suitable for any of the draw command types.
+static constexpr uint64_t kCommandsOffset = 16UL;
+
+static uint64_t align_up(uint64_t value, uint64_t alignment)
+{
+	return (value + alignment - 1) / alignment * alignment;
+}
+
+static bool has_capacity(vtek::IndirectDrawBuffer* draws, uint32_t numCommands)
+{
+	if (draws->numDraws + uint64_t{numCommands} > draws->maxDraws)
+	{
+		vtek_log_error("Indirect draw buffer is full for this frame ({} draws) -- {}",
+		               draws->maxDraws, "cannot add draw commands!");
+		return false;
+	}
+	return true;
+}
+
+static uint8_t* get_write_pointer(vtek::IndirectDrawBuffer* draws)
+{
+	return draws->mappedPtr + draws->regionOffset + kCommandsOffset +
+		uint64_t{draws->numDraws} * draws->stride;
+}
+
+
+
+/* interface */
+vtek::IndirectDrawBuffer* vtek::indirect_draw_buffer_create(
+	const vtek::IndirectDrawBufferInfo* info, vtek::Device* device)
+{
+	if (info->numFrames == 0U || info->maxDraws == 0U)
+	{
+		vtek_log_error("Indirect draw buffer must have non-zero size and frame count!");
+		return nullptr;
+	}
+
+	const uint32_t stride = info->indexed
+		? sizeof(VkDrawIndexedIndirectCommand) : sizeof(VkDrawIndirectCommand);
+
+	uint64_t alignment = kCommandsOffset;
+	if (info->allowStorageBuffer)
+	{
+		auto limits = vtek::device_get_physical_properties(device)->limits;
+		alignment = std::max<uint64_t>(
+			alignment, limits.minStorageBufferOffsetAlignment);
+	}
+
+	const uint64_t regionSize = align_up(
+		kCommandsOffset + uint64_t{info->maxDraws} * stride, alignment);
+
+	vtek::BufferInfo bufferInfo{};
+	bufferInfo.size = regionSize * info->numFrames;
+	bufferInfo.requireHostVisibleStorage = true;
+	bufferInfo.disallowInternalStagingBuffer = true;
+	bufferInfo.writePolicy = vtek::BufferWritePolicy::overwrite_often;
+	bufferInfo.usageFlags = vtek::BufferUsageFlag::indirect_buffer;
+	if (info->allowStorageBuffer)
+	{
+		bufferInfo.usageFlags.add_flag(vtek::BufferUsageFlag::storage_buffer);
+	}
+
+	auto draws = new vtek::IndirectDrawBuffer;
+	draws->buffer = vtek::buffer_create(&bufferInfo, device);
+	if (draws->buffer == nullptr)
+	{
+		vtek_log_error("Failed to create buffer for indirect draws!");
+		delete draws;
+		return nullptr;
+	}
+
+	// The buffer stays mapped for its entire lifetime
+	draws->mappedPtr = static_cast<uint8_t*>(
+		vtek::allocator_buffer_map(draws->buffer));
+	if (draws->mappedPtr == nullptr)
+	{
+		vtek_log_error("Failed to map indirect draw buffer!");
+		vtek::buffer_destroy(draws->buffer);
+		delete draws;
+		return nullptr;
+	}
+
+	draws->regionSize = regionSize;
+	draws->numFrames = info->numFrames;
+	draws->maxDraws = info->maxDraws;
+	draws->stride = stride;
+	draws->indexed = info->indexed;
+
+	return draws;
+}
+
+void vtek::indirect_draw_buffer_destroy(vtek::IndirectDrawBuffer* draws)
+{
+	if (draws == nullptr) return;
+
+	if (draws->mappedPtr != nullptr)
+	{
+		vtek::allocator_buffer_unmap(draws->buffer);
+		draws->mappedPtr = nullptr;
+	}
+	vtek::buffer_destroy(draws->buffer);
+	draws->buffer = nullptr;
+
+	delete draws;
+}
+
+vtek::Buffer* vtek::indirect_draw_buffer_get_buffer(vtek::IndirectDrawBuffer* draws)
+{
+	return draws->buffer;
+}
+
+void vtek::indirect_draw_buffer_begin_frame(
+	vtek::IndirectDrawBuffer* draws, uint32_t frameIndex)
+{
+	if (frameIndex >= draws->numFrames)
+	{
+		vtek_log_error("Indirect draw buffer frame index {} out of range!", frameIndex);
+		frameIndex = frameIndex % draws->numFrames;
+	}
+
+	draws->regionOffset = draws->regionSize * frameIndex;
+	draws->numDraws = 0U;
+}
+
+bool vtek::indirect_draw_buffer_add(
+	vtek::IndirectDrawBuffer* draws, const VkDrawIndirectCommand& command)
+{
+	if (draws->indexed)
+	{
+		vtek_log_error("Indirect draw buffer was created for indexed draws -- {}",
+		               "cannot add non-indexed draw command!");
+		return false;
+	}
+	if (!has_capacity(draws, 1U)) { return false; }
+
+	std::memcpy(get_write_pointer(draws), &command, sizeof(command));
+	draws->numDraws++;
+
+	return true;
+}
+
+bool vtek::indirect_draw_buffer_add_indexed(
+	vtek::IndirectDrawBuffer* draws, const VkDrawIndexedIndirectCommand& command)
+{
+	return vtek::indirect_draw_buffer_add_indexed(draws, &command, 1U);
+}
+
+bool vtek::indirect_draw_buffer_add_indexed(
+	vtek::IndirectDrawBuffer* draws, const VkDrawIndexedIndirectCommand* commands,
+	uint32_t numCommands)
+{
+	if (!draws->indexed)
+	{
+		vtek_log_error("Indirect draw buffer was created for non-indexed draws -- {}",
+		               "cannot add indexed draw command!");
+		return false;
+	}
+	if (!has_capacity(draws, numCommands)) { return false; }
+
+	std::memcpy(get_write_pointer(draws), commands,
+	            uint64_t{numCommands} * sizeof(VkDrawIndexedIndirectCommand));
+	draws->numDraws += numCommands;
+
+	return true;
+}
+
+bool vtek::indirect_draw_buffer_add_model(
+	vtek::IndirectDrawBuffer* draws, vtek::Model* model,
+	uint32_t numInstances, uint32_t firstInstance)
+{
+	if (!vtek::model_is_ready(model))
+	{
+		vtek_log_error("Model is not loaded -- cannot add indirect draws for it!");
+		return false;
+	}
+
+	const uint32_t numSubmeshes = vtek::model_get_num_submeshes(model);
+	const vtek::ModelSubmesh* submeshes = vtek::model_get_submeshes(model);
+	if (!has_capacity(draws, std::max(numSubmeshes, 1U))) { return false; }
+
+	// Models without submesh information are drawn in one piece
+	if (numSubmeshes == 0U)
+	{
+		VkDrawIndexedIndirectCommand command{};
+		command.indexCount = vtek::model_get_num_indices(model);
+		command.instanceCount = numInstances;
+		command.firstIndex = vtek::model_get_first_index(model);
+		command.vertexOffset = static_cast<int32_t>(vtek::model_get_base_vertex(model));
+		command.firstInstance = firstInstance;
+		return vtek::indirect_draw_buffer_add_indexed(draws, command);
+	}
+
+	// Written straight into mapped memory, which is never read back
+	auto dst = reinterpret_cast<VkDrawIndexedIndirectCommand*>(get_write_pointer(draws));
+	for (uint32_t i = 0; i < numSubmeshes; i++)
+	{
+		VkDrawIndexedIndirectCommand command{};
+		command.indexCount = submeshes[i].numIndices;
+		command.instanceCount = numInstances;
+		command.firstIndex = submeshes[i].firstIndex;
+		command.vertexOffset = submeshes[i].vertexOffset;
+		command.firstInstance = firstInstance;
+		std::memcpy(dst + i, &command, sizeof(command));
+	}
+	draws->numDraws += numSubmeshes;
+
+	return true;
+}
+
+void vtek::indirect_draw_buffer_flush(vtek::IndirectDrawBuffer* draws)
+{
+	std::memcpy(draws->mappedPtr + draws->regionOffset,
+	            &draws->numDraws, sizeof(uint32_t));
+
+	auto memProps = draws->buffer->memoryProperties;
+	if (memProps.has_flag(vtek::MemoryProperty::host_coherent)) { return; }
+
+	vtek::BufferRegion region{
+		draws->regionOffset,
+		kCommandsOffset + uint64_t{draws->numDraws} * draws->stride
+	};
+	vtek::allocator_buffer_flush(draws->buffer, &region);
+}
+
+uint64_t vtek::indirect_draw_buffer_get_offset(vtek::IndirectDrawBuffer* draws)
+{
+	return draws->regionOffset + kCommandsOffset;
+}
+
+uint64_t vtek::indirect_draw_buffer_get_count_offset(vtek::IndirectDrawBuffer* draws)
+{
+	return draws->regionOffset;
+}
+
+uint32_t vtek::indirect_draw_buffer_get_num_draws(vtek::IndirectDrawBuffer* draws)
+{
+	return draws->numDraws;
+}
+
+uint32_t vtek::indirect_draw_buffer_get_stride(vtek::IndirectDrawBuffer* draws)
+{
+	return draws->stride;
+}
@@ -0,0 +1,186 @@
+#include "vtek_vulkan.pch"
+#include "vtek_instance_buffer.hpp"
+
+#include "impl/vtek_vma_helpers.hpp"
+#include "vtek_buffer.hpp"
+#include "vtek_device.hpp"
+#include "vtek_logging.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+
+/* struct implementation */
+struct vtek::InstanceBuffer
+{
+	vtek::Buffer* buffer {nullptr};
+	uint8_t* mappedPtr {nullptr};
+
+	uint64_t regionSize {0UL};
+	uint32_t instanceSize {0U};
+	uint32_t maxInstances {0U};
+	uint32_t numFrames {0U};
+
+	// Start of the current frame's region, and number of instances in it
+	uint64_t regionOffset {0UL};
+	uint32_t numInstances {0U};
+};
+
+
+
+/* helper functions */
+static uint64_t align_up(uint64_t value, uint64_t alignment)
+{
+	return (value + alignment - 1) / alignment * alignment;
+}
+
+
+
+/* interface */
+vtek::InstanceBuffer* vtek::instance_buffer_create(
+	const vtek::InstanceBufferInfo* info, vtek::Device* device)
+{
+	if (info->numFrames == 0U || info->maxInstances == 0U || info->instanceSize == 0U)
+	{
+		vtek_log_error("Instance buffer must have non-zero size and frame count!");
+		return nullptr;
+	}
+
+	// Regions are bound as vertex buffers at their offsets, so only need
+	// 16-byte alignment, unless also bound as storage buffers.
+	uint64_t alignment = 16UL;
+	if (info->allowStorageBuffer)
+	{
+		auto limits = vtek::device_get_physical_properties(device)->limits;
+		alignment = std::max<uint64_t>(
+			alignment, limits.minStorageBufferOffsetAlignment);
+	}
+
+	const uint64_t regionSize = align_up(
+		uint64_t{info->maxInstances} * info->instanceSize, alignment);
+
+	vtek::BufferInfo bufferInfo{};
+	bufferInfo.size = regionSize * info->numFrames;
+	bufferInfo.requireHostVisibleStorage = true;
+	bufferInfo.disallowInternalStagingBuffer = true;
+	bufferInfo.writePolicy = vtek::BufferWritePolicy::overwrite_often;
+	bufferInfo.usageFlags = vtek::BufferUsageFlag::vertex_buffer;
+	if (info->allowStorageBuffer)
+	{
+		bufferInfo.usageFlags.add_flag(vtek::BufferUsageFlag::storage_buffer);
+	}
+
+	auto instances = new vtek::InstanceBuffer;
+	instances->buffer = vtek::buffer_create(&bufferInfo, device);
+	if (instances->buffer == nullptr)
+	{
+		vtek_log_error("Failed to create buffer for instance data!");
+		delete instances;
+		return nullptr;
+	}
+
+	// The buffer stays mapped for its entire lifetime
+	instances->mappedPtr = static_cast<uint8_t*>(
+		vtek::allocator_buffer_map(instances->buffer));
+	if (instances->mappedPtr == nullptr)
+	{
+		vtek_log_error("Failed to map instance buffer!");
+		vtek::buffer_destroy(instances->buffer);
+		delete instances;
+		return nullptr;
+	}
+
+	instances->regionSize = regionSize;
+	instances->instanceSize = info->instanceSize;
+	instances->maxInstances = info->maxInstances;
+	instances->numFrames = info->numFrames;
+
+	return instances;
+}
+
+void vtek::instance_buffer_destroy(vtek::InstanceBuffer* instances)
+{
+	if (instances == nullptr) return;
+
+	if (instances->mappedPtr != nullptr)
+	{
+		vtek::allocator_buffer_unmap(instances->buffer);
+		instances->mappedPtr = nullptr;
+	}
+	vtek::buffer_destroy(instances->buffer);
+	instances->buffer = nullptr;
+
+	delete instances;
+}
+
+vtek::Buffer* vtek::instance_buffer_get_buffer(vtek::InstanceBuffer* instances)
+{
+	return instances->buffer;
+}
+
+void vtek::instance_buffer_begin_frame(
+	vtek::InstanceBuffer* instances, uint32_t frameIndex)
+{
+	if (frameIndex >= instances->numFrames)
+	{
+		vtek_log_error("Instance buffer frame index {} out of range!", frameIndex);
+		frameIndex = frameIndex % instances->numFrames;
+	}
+
+	instances->regionOffset = instances->regionSize * frameIndex;
+	instances->numInstances = 0U;
+}
+
+bool vtek::instance_buffer_push(
+	vtek::InstanceBuffer* instances, const void* data, uint32_t numInstances,
+	uint32_t* outFirstInstance)
+{
+	void* dst = vtek::instance_buffer_allocate(instances, numInstances, outFirstInstance);
+	if (dst == nullptr) { return false; }
+
+	std::memcpy(dst, data, uint64_t{numInstances} * instances->instanceSize);
+	return true;
+}
+
+void* vtek::instance_buffer_allocate(
+	vtek::InstanceBuffer* instances, uint32_t numInstances, uint32_t* outFirstInstance)
+{
+	if (instances->numInstances + uint64_t{numInstances} > instances->maxInstances)
+	{
+		vtek_log_error("Instance buffer is full for this frame ({} instances) -- {}",
+		               instances->maxInstances, "cannot push instance data!");
+		return nullptr;
+	}
+
+	uint8_t* dst = instances->mappedPtr + instances->regionOffset +
+		uint64_t{instances->numInstances} * instances->instanceSize;
+
+	*outFirstInstance = instances->numInstances;
+	instances->numInstances += numInstances;
+
+	return dst;
+}
+
+void vtek::instance_buffer_flush(vtek::InstanceBuffer* instances)
+{
+	if (instances->numInstances == 0U) { return; }
+
+	auto memProps = instances->buffer->memoryProperties;
+	if (memProps.has_flag(vtek::MemoryProperty::host_coherent)) { return; }
+
+	vtek::BufferRegion region{
+		instances->regionOffset,
+		uint64_t{instances->numInstances} * instances->instanceSize
+	};
+	vtek::allocator_buffer_flush(instances->buffer, &region);
+}
+
+uint64_t vtek::instance_buffer_get_offset(vtek::InstanceBuffer* instances)
+{
+	return instances->regionOffset;
+}
+
+uint32_t vtek::instance_buffer_get_num_instances(vtek::InstanceBuffer* instances)
+{
+	return instances->numInstances;
+}
@@ -1,7 +1,14 @@
 #include "vtek_vulkan.pch"
 #include "vtek_models.hpp"
 
+#include "meshutils/vtek_gltf.hpp"
+#include "meshutils/vtek_mesh_cache.hpp"
+#include "meshutils/vtek_mesh_optimizer.hpp"
 #include "vtek_buffer.hpp"
+#include "vtek_command_buffer.hpp"
+#include "vtek_command_scheduler.hpp"
+#include "vtek_device.hpp"
+#include "vtek_geometry_arena.hpp"
 #include "vtek_logging.hpp"
 
 // ASSIMP (git submodule)
@@ -14,175 +21,1953 @@
 #include "assimp/GltfMaterial.h"
 #include "assimp/StringUtils.h"
 
+// GLM
+#include <glm/gtc/packing.hpp>
+
 // STANDARD
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cmath>
+#include <condition_variable>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <numeric>
+#include <thread>
+#include <tuple>
 #include <vector>
 
 
-/* struct implementation */
-struct vtek::Model
-{
-	std::vector<glm::vec3> vertices;
-	std::vector<glm::vec3> normals;
-	std::vector<glm::vec2> texCoords;
+/* struct implementation */
+struct vtek::Model
+{
+	std::vector<glm::vec3> vertices;
+	std::vector<glm::vec3> normals;
+	std::vector<glm::vec2> texCoords;
+	std::vector<uint32_t> indices;
+
+	uint32_t numVertices {0U};
+	uint32_t numIndices {0U};
+	vtek::IndexType indexType {vtek::IndexType::uint32};
+
+	vtek::ModelVertexLayout vertexLayout {vtek::ModelVertexLayout::separate_buffers};
+	uint32_t vertexStride {sizeof(glm::vec3)};
+	uint64_t normalOffset {0UL};
+	uint64_t texCoordOffset {0UL};
+	uint64_t indexOffset {0UL};
+
+	vtek::VertexAttributeType positionType {vtek::VertexAttributeType::vec3};
+	vtek::VertexAttributeType normalType {vtek::VertexAttributeType::vec3};
+	vtek::VertexAttributeType texCoordType {vtek::VertexAttributeType::vec2};
+	vtek::ModelDequantization dequantization {};
+
+	// Untransformed vertex extents, used for quantization
+	glm::vec3 boundsMin {0.0f};
+	glm::vec3 boundsMax {0.0f};
+
+	// Union of the submesh bounds, in model space
+	vtek::BoundingBox boundingBox {};
+	vtek::BoundingSphere boundingSphere {};
+
+	std::vector<vtek::ModelSubmesh> submeshes;
+	std::vector<vtek::ModelMaterial> materials;
+
+	// With `single_allocation` layout these all point to the same buffer
+	vtek::Buffer* vertexBuffer {nullptr};
+	vtek::Buffer* normalBuffer {nullptr};
+	vtek::Buffer* texCoordBuffer {nullptr};
+	vtek::Buffer* indexBuffer {nullptr};
+
+	// When loaded into a geometry arena, the buffers above belong to the
+	// arena, and the model owns only its range.
+	vtek::GeometryArena* arena {nullptr};
+	vtek::GeometryArenaRange arenaRange {};
+
+	// Asynchronous loading, see `model_load_async`
+	std::thread loadThread;
+	std::mutex loadMutex;
+	std::condition_variable loadCondition;
+	std::atomic<vtek::ModelLoadState> loadState {vtek::ModelLoadState::ready};
+};
+
+
+
+/* helper functions */
+// Output location of a mesh in the model's vertex and index arrays
+struct MeshExtractRange
+{
+	const aiMesh* mesh {nullptr};
+	uint32_t baseVertex {0U};
+	uint32_t firstIndex {0U};
+	uint32_t numIndices {0U};
+};
+
+// Run `func(i)` for each i in [0, count), distributed over worker threads.
+template<typename Func>
+static void parallel_for(uint32_t count, Func&& func)
+{
+	const uint32_t numThreads = std::min(
+		count, std::max(1U, std::thread::hardware_concurrency()));
+	if (numThreads <= 1)
+	{
+		for (uint32_t i = 0; i < count; i++) { func(i); }
+		return;
+	}
+
+	std::atomic<uint32_t> next {0U};
+	auto worker = [&]() {
+		for (uint32_t i = next++; i < count; i = next++) { func(i); }
+	};
+
+	std::vector<std::thread> threads;
+	for (uint32_t t = 1; t < numThreads; t++) { threads.emplace_back(worker); }
+	worker();
+	for (auto& thread : threads) { thread.join(); }
+}
+
+template<typename T>
+static void permute_vertex_attribute(
+	std::vector<T>& attribute, uint32_t baseVertex,
+	const std::vector<uint32_t>& remap)
+{
+	if (attribute.empty()) { return; } // not loaded
+
+	T* data = attribute.data() + baseVertex;
+	std::vector<T> scratch(data, data + remap.size());
+	for (uint32_t i = 0; i < remap.size(); i++)
+	{
+		data[remap[i]] = scratch[i];
+	}
+}
+
+// Optimizations are done per mesh, on mesh-local indices, since the vertex
+// data for each mesh is stored contiguously from `baseVertex`.
+static void optimize_mesh(
+	vtek::Model* model, const vtek::ModelInfo* info, const MeshExtractRange& range)
+{
+	uint32_t* indices = model->indices.data() + range.firstIndex;
+	const uint32_t numVertices = range.mesh->mNumVertices;
+	const uint32_t numIndices = range.numIndices;
+	const uint32_t cacheSize = info->vertexCacheSize;
+	if (numIndices == 0) { return; }
+
+	if (info->optimizeVertexCache || info->optimizeOverdraw)
+	{
+		float acmr = vtek::mesh_compute_acmr(
+			indices, numIndices, numVertices, cacheSize);
+
+		vtek::mesh_optimize_vertex_cache(
+			indices, numIndices, numVertices, cacheSize);
+
+		if (info->optimizeOverdraw)
+		{
+			vtek::mesh_optimize_overdraw(
+				indices, numIndices, model->vertices.data() + range.baseVertex,
+				numVertices, cacheSize, info->overdrawThreshold);
+		}
+
+		vtek_log_debug("Model mesh vertex cache optimized, ACMR: {} -> {}", acmr,
+		               vtek::mesh_compute_acmr(
+			               indices, numIndices, numVertices, cacheSize));
+	}
+
+	if (info->optimizeVertexFetch)
+	{
+		std::vector<uint32_t> remap;
+		uint32_t numUsed = vtek::mesh_optimize_vertex_fetch(
+			indices, numIndices, numVertices, remap);
+
+		// Unreferenced vertices are moved to the end, since the vertex
+		// ranges of all meshes are fixed up front.
+		for (auto& r : remap)
+		{
+			if (r == UINT32_MAX) { r = numUsed++; }
+		}
+
+		permute_vertex_attribute(model->vertices, range.baseVertex, remap);
+		permute_vertex_attribute(model->normals, range.baseVertex, remap);
+		permute_vertex_attribute(model->texCoords, range.baseVertex, remap);
+	}
+}
+
+// Copy the vertex data of a mesh into the preallocated model arrays, which
+// is thread-safe since the ranges of different meshes never overlap.
+static void extract_mesh(
+	vtek::Model* model, const vtek::ModelInfo* info, const MeshExtractRange& range)
+{
+	static_assert(sizeof(aiVector3D) == sizeof(glm::vec3),
+	              "Assimp must be built with single-precision floats!");
+
+	const aiMesh* mesh = range.mesh;
+	const uint32_t numVertices = mesh->mNumVertices;
+	const uint32_t baseVertex = range.baseVertex;
+
+	// aiVector3D and glm::vec3 have identical layouts, so positions and
+	// normals are copied in bulk. Arrays for attributes not present in this
+	// mesh, but in other meshes of the model, are left zero-initialized.
+	std::memcpy(model->vertices.data() + baseVertex, mesh->mVertices,
+	            sizeof(glm::vec3) * numVertices);
+
+	if (!model->normals.empty() && mesh->HasNormals())
+	{
+		std::memcpy(model->normals.data() + baseVertex, mesh->mNormals,
+		            sizeof(glm::vec3) * numVertices);
+	}
+	if (!model->texCoords.empty() && mesh->HasTextureCoords(0))
+	{
+		const aiVector3D* src = mesh->mTextureCoords[0];
+		glm::vec2* dst = model->texCoords.data() + baseVertex;
+		for (uint32_t i = 0; i < numVertices; i++)
+		{
+			dst[i] = glm::vec2(src[i].x, src[i].y);
+		}
+	}
+
+	// Faces are guaranteed to be triangles by `aiProcess_Triangulate`, except
+	// for points and lines which we skip.
+	uint32_t* indices = model->indices.data() + range.firstIndex;
+	uint32_t n = 0U;
+	for (unsigned int i = 0; i < mesh->mNumFaces; i++)
+	{
+		const aiFace& face = mesh->mFaces[i];
+		if (face.mNumIndices != 3) { continue; }
+
+		indices[n++] = face.mIndices[0];
+		indices[n++] = face.mIndices[1];
+		indices[n++] = face.mIndices[2];
+	}
+
+	optimize_mesh(model, info, range);
+
+	// Indices are local to each mesh, and are kept that way for separate
+	// submeshes, which are drawn with a vertex offset instead.
+	if (info->separateSubmeshes) { return; }
+
+	for (uint32_t i = 0; i < range.numIndices; i++)
+	{
+		indices[i] += baseVertex;
+	}
+}
+
+static uint32_t count_triangle_indices(const aiMesh* mesh)
+{
+	uint32_t count = 0U;
+	for (unsigned int i = 0; i < mesh->mNumFaces; i++)
+	{
+		if (mesh->mFaces[i].mNumIndices == 3) { count += 3; }
+	}
+	return count;
+}
+
+// A mesh referenced by a node in the scene, which becomes a submesh
+struct MeshReference
+{
+	uint32_t rangeIndex {0U};
+	glm::mat4 transform {1.0f};
+};
+
+static glm::mat4 get_node_transform(const aiMatrix4x4& m)
+{
+	// Assimp matrices are row-major, glm matrices are column-major
+	return glm::mat4(m.a1, m.b1, m.c1, m.d1,
+	                 m.a2, m.b2, m.c2, m.d2,
+	                 m.a3, m.b3, m.c3, m.d3,
+	                 m.a4, m.b4, m.c4, m.d4);
+}
+
+// With `shareMeshes`, each mesh gets a single range no matter how many
+// nodes reference it, and `meshRanges` maps mesh indices to ranges.
+static void collect_scene_meshes(
+	const aiScene* scene, const aiNode* node, const glm::mat4& parentTransform,
+	bool shareMeshes, std::vector<uint32_t>& meshRanges,
+	std::vector<MeshExtractRange>& meshes, std::vector<MeshReference>& references)
+{
+	const glm::mat4 transform =
+		parentTransform * get_node_transform(node->mTransformation);
+
+	// A node contains 0..x meshes, each of which we add to the model
+	for (unsigned int i = 0; i < node->mNumMeshes; i++)
+	{
+		uint32_t& rangeIndex = meshRanges[node->mMeshes[i]];
+		if (!shareMeshes || rangeIndex == UINT32_MAX)
+		{
+			const aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
+			rangeIndex = static_cast<uint32_t>(meshes.size());
+			meshes.push_back({ mesh, 0U, 0U, count_triangle_indices(mesh) });
+		}
+		references.push_back({ rangeIndex, transform });
+	}
+
+	// Recurse on each child node
+	for (unsigned int i = 0; i < node->mNumChildren; i++)
+	{
+		collect_scene_meshes(scene, node->mChildren[i], transform, shareMeshes,
+		                     meshRanges, meshes, references);
+	}
+}
+
+static std::string get_texture_path(
+	const aiMaterial* material, aiTextureType type, unsigned int index = 0)
+{
+	aiString path;
+	if (material->GetTextureCount(type) <= index ||
+	    material->GetTexture(type, index, &path) != AI_SUCCESS)
+	{
+		return std::string();
+	}
+
+	return std::string(path.C_Str());
+}
+
+static void load_materials(vtek::Model* model, const aiScene* scene)
+{
+	model->materials.resize(scene->mNumMaterials);
+	for (unsigned int i = 0; i < scene->mNumMaterials; i++)
+	{
+		const aiMaterial* src = scene->mMaterials[i];
+		vtek::ModelMaterial& dst = model->materials[i];
+
+		aiString name;
+		if (src->Get(AI_MATKEY_NAME, name) == AI_SUCCESS)
+		{
+			dst.name = name.C_Str();
+		}
+
+		// Metallic-roughness properties as stored by glTF, with fallback to
+		// the diffuse color of older formats such as obj.
+		aiColor4D color;
+		if (src->Get(AI_MATKEY_BASE_COLOR, color) == AI_SUCCESS ||
+		    src->Get(AI_MATKEY_COLOR_DIFFUSE, color) == AI_SUCCESS)
+		{
+			dst.baseColorFactor = glm::vec4(color.r, color.g, color.b, color.a);
+		}
+		aiColor3D emissive;
+		if (src->Get(AI_MATKEY_COLOR_EMISSIVE, emissive) == AI_SUCCESS)
+		{
+			dst.emissiveFactor = glm::vec3(emissive.r, emissive.g, emissive.b);
+		}
+		src->Get(AI_MATKEY_METALLIC_FACTOR, dst.metallicFactor);
+		src->Get(AI_MATKEY_ROUGHNESS_FACTOR, dst.roughnessFactor);
+
+		int twoSided = 0;
+		if (src->Get(AI_MATKEY_TWOSIDED, twoSided) == AI_SUCCESS)
+		{
+			dst.doubleSided = (twoSided != 0);
+		}
+
+		auto texture = [&dst](vtek::ModelTextureType type) -> std::string& {
+			return dst.textures[static_cast<uint32_t>(type)];
+		};
+		using TT = vtek::ModelTextureType;
+
+		texture(TT::base_color) = get_texture_path(src, aiTextureType_BASE_COLOR);
+		if (texture(TT::base_color).empty())
+		{
+			texture(TT::base_color) = get_texture_path(src, aiTextureType_DIFFUSE);
+		}
+		texture(TT::normal) = get_texture_path(src, aiTextureType_NORMALS);
+		texture(TT::metallic_roughness) = get_texture_path(
+			src, AI_MATKEY_GLTF_PBRMETALLICROUGHNESS_METALLICROUGHNESS_TEXTURE);
+		if (texture(TT::metallic_roughness).empty())
+		{
+			texture(TT::metallic_roughness) = get_texture_path(src, aiTextureType_METALNESS);
+		}
+		// Assimp's glTF importer stores occlusion textures as lightmaps
+		texture(TT::occlusion) = get_texture_path(src, aiTextureType_AMBIENT_OCCLUSION);
+		if (texture(TT::occlusion).empty())
+		{
+			texture(TT::occlusion) = get_texture_path(src, aiTextureType_LIGHTMAP);
+		}
+		texture(TT::emissive) = get_texture_path(src, aiTextureType_EMISSIVE);
+	}
+}
+
+// Bounds of the submesh's vertices after the node transform. The sphere is
+// centered on the box, which is cheap and usually close to the optimum.
+static void compute_submesh_bounds(
+	const vtek::Model* model, vtek::ModelSubmesh& submesh)
+{
+	const glm::vec3* vertices = model->vertices.data() + submesh.firstVertex;
+	const glm::mat4& m = submesh.transform;
+
+	glm::vec3 bmin = glm::vec3(m * glm::vec4(vertices[0], 1.0f));
+	glm::vec3 bmax = bmin;
+	for (uint32_t i = 1; i < submesh.numVertices; i++)
+	{
+		const glm::vec3 v = glm::vec3(m * glm::vec4(vertices[i], 1.0f));
+		bmin = glm::min(bmin, v);
+		bmax = glm::max(bmax, v);
+	}
+
+	const glm::vec3 center = 0.5f * (bmin + bmax);
+	float radiusSq = 0.0f;
+	for (uint32_t i = 0; i < submesh.numVertices; i++)
+	{
+		const glm::vec3 d = glm::vec3(m * glm::vec4(vertices[i], 1.0f)) - center;
+		radiusSq = std::max(radiusSq, glm::dot(d, d));
+	}
+
+	submesh.boundingBox = { bmin, bmax };
+	submesh.boundingSphere = { center, std::sqrt(radiusSq) };
+}
+
+// Model bounds enclosing all submesh bounds. Also used after loading from
+// the mesh cache, where submeshes are stored with their bounds.
+static void compute_model_bounds(vtek::Model* model)
+{
+	if (model->submeshes.empty())
+	{
+		model->boundingBox = {};
+		model->boundingSphere = {};
+		return;
+	}
+
+	vtek::BoundingBox box = model->submeshes[0].boundingBox;
+	for (const auto& submesh : model->submeshes)
+	{
+		box.min = glm::min(box.min, submesh.boundingBox.min);
+		box.max = glm::max(box.max, submesh.boundingBox.max);
+	}
+
+	const glm::vec3 center = 0.5f * (box.min + box.max);
+	float radius = 0.0f;
+	for (const auto& submesh : model->submeshes)
+	{
+		const vtek::BoundingSphere& s = submesh.boundingSphere;
+		radius = std::max(radius, glm::distance(center, s.center) + s.radius);
+	}
+
+	model->boundingBox = box;
+	model->boundingSphere = { center, radius };
+}
+
+// Two-pass extraction: first the node tree is walked to compute where each
+// mesh goes in the model arrays, which are allocated once. Then all meshes
+// are converted in parallel, directly into their ranges.
+static void load_scene(
+	vtek::Model* model, const aiScene* scene, const vtek::ModelInfo* info)
+{
+	std::vector<MeshExtractRange> meshes;
+	std::vector<MeshReference> references;
+	std::vector<uint32_t> meshRanges(scene->mNumMeshes, UINT32_MAX);
+	collect_scene_meshes(scene, scene->mRootNode, glm::mat4(1.0f),
+	                     info->separateSubmeshes, meshRanges, meshes, references);
+
+	uint32_t numVertices = 0U;
+	uint32_t numIndices = 0U;
+	bool normals = false;
+	bool texCoords = false;
+	for (auto& range : meshes)
+	{
+		range.baseVertex = numVertices;
+		range.firstIndex = numIndices;
+		numVertices += range.mesh->mNumVertices;
+		numIndices += range.numIndices;
+
+		normals |= range.mesh->HasNormals();
+		texCoords |= range.mesh->HasTextureCoords(0);
+	}
+
+	model->vertices.resize(numVertices);
+	if (normals && info->loadNormals) { model->normals.resize(numVertices); }
+	if (texCoords && info->loadTextureCoordinates) { model->texCoords.resize(numVertices); }
+	model->indices.resize(numIndices);
+
+	// Largest meshes first, for better load balancing
+	std::vector<uint32_t> order(meshes.size());
+	std::iota(order.begin(), order.end(), 0U);
+	std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+		return meshes[a].numIndices > meshes[b].numIndices;
+	});
+
+	parallel_for(static_cast<uint32_t>(order.size()), [&](uint32_t i) {
+		extract_mesh(model, info, meshes[order[i]]);
+	});
+
+	// One submesh for each node's reference to a mesh
+	model->submeshes.clear();
+	model->submeshes.reserve(references.size());
+	for (const auto& ref : references)
+	{
+		const MeshExtractRange& range = meshes[ref.rangeIndex];
+		if (range.numIndices == 0) { continue; } // points and lines only
+
+		vtek::ModelSubmesh submesh{};
+		submesh.firstIndex = range.firstIndex;
+		submesh.numIndices = range.numIndices;
+		submesh.vertexOffset =
+			info->separateSubmeshes ? static_cast<int32_t>(range.baseVertex) : 0;
+		submesh.firstVertex = range.baseVertex;
+		submesh.numVertices = range.mesh->mNumVertices;
+		submesh.materialIndex = range.mesh->mMaterialIndex;
+		submesh.transform = ref.transform;
+		model->submeshes.push_back(submesh);
+	}
+
+	parallel_for(static_cast<uint32_t>(model->submeshes.size()), [&](uint32_t i) {
+		compute_submesh_bounds(model, model->submeshes[i]);
+	});
+
+	load_materials(model, scene);
+}
+
+// 16-bit indices when possible, leaving 0xFFFF for primitive restart.
+// With separate submeshes the indices are local to each submesh, so this
+// depends on the largest submesh rather than the whole model.
+// Models in a geometry arena use the index type of the arena.
+static void build_index_data(vtek::Model* model, std::vector<uint8_t>& out)
+{
+	const size_t numIndices = model->indices.size();
+	const uint32_t maxIndex =
+		*std::max_element(model->indices.begin(), model->indices.end());
+	const bool forceUint32 = model->arena != nullptr &&
+		vtek::geometry_arena_get_index_type(model->arena) == vtek::IndexType::uint32;
+
+	if (maxIndex < 0xFFFF && !forceUint32)
+	{
+		model->indexType = vtek::IndexType::uint16;
+		out.resize(sizeof(uint16_t) * numIndices);
+		uint16_t* dst = reinterpret_cast<uint16_t*>(out.data());
+		for (size_t i = 0; i < numIndices; i++)
+		{
+			dst[i] = static_cast<uint16_t>(model->indices[i]);
+		}
+	}
+	else
+	{
+		model->indexType = vtek::IndexType::uint32;
+		out.resize(sizeof(uint32_t) * numIndices);
+		std::memcpy(out.data(), model->indices.data(), out.size());
+	}
+}
+
+static void compute_bounds(vtek::Model* model)
+{
+	model->boundsMin = model->vertices[0];
+	model->boundsMax = model->vertices[0];
+	for (const auto& v : model->vertices)
+	{
+		model->boundsMin = glm::min(model->boundsMin, v);
+		model->boundsMax = glm::max(model->boundsMax, v);
+	}
+}
+
+// Vertex attribute data, converted to the format which is uploaded
+struct VertexStream
+{
+	std::vector<uint8_t> data;
+	uint32_t elementSize {0U};
+
+	bool empty() const { return data.empty(); }
+};
+
+template<typename T>
+static void stream_write(VertexStream& stream, size_t index, const T& value)
+{
+	std::memcpy(stream.data.data() + index * stream.elementSize, &value, sizeof(T));
+}
+
+// Maps each component from [min, max] to [0, 1]. Returns the extent, which
+// is 1 for components where the range is empty, to keep the mapping valid.
+template<typename V>
+static V compute_unorm_extent(const std::vector<V>& values, V& outMin)
+{
+	V vmin = values[0];
+	V vmax = values[0];
+	for (const auto& v : values)
+	{
+		vmin = glm::min(vmin, v);
+		vmax = glm::max(vmax, v);
+	}
+
+	V extent = vmax - vmin;
+	for (int i = 0; i < V::length(); i++)
+	{
+		if (extent[i] <= 0.0f) { extent[i] = 1.0f; }
+	}
+
+	outMin = vmin;
+	return extent;
+}
+
+static glm::vec2 octahedral_encode(glm::vec3 n)
+{
+	// Zero-length normals, e.g. from degenerate triangles, would be NaN
+	const float length = glm::abs(n.x) + glm::abs(n.y) + glm::abs(n.z);
+	if (length == 0.0f) { return glm::vec2(0.0f); }
+
+	n /= length;
+	glm::vec2 p(n.x, n.y);
+	if (n.z < 0.0f)
+	{
+		glm::vec2 signs(p.x >= 0.0f ? 1.0f : -1.0f, p.y >= 0.0f ? 1.0f : -1.0f);
+		p = (1.0f - glm::abs(glm::vec2(p.y, p.x))) * signs;
+	}
+	return p;
+}
+
+static void build_position_stream(
+	vtek::Model* model, vtek::ModelPositionFormat format, VertexStream& stream)
+{
+	using VAT = vtek::VertexAttributeType;
+	const size_t numVertices = model->vertices.size();
+	auto& deq = model->dequantization;
+
+	switch (format)
+	{
+	case vtek::ModelPositionFormat::float16:
+		// The 4th component is padding, since 3-component 16-bit vertex
+		// formats are not guaranteed to be supported.
+		model->positionType = VAT::vec4_half;
+		stream.elementSize = 4 * sizeof(uint16_t);
+		stream.data.resize(stream.elementSize * numVertices);
+		for (size_t i = 0; i < numVertices; i++)
+		{
+			const glm::vec3& v = model->vertices[i];
+			glm::u16vec4 q(glm::packHalf1x16(v.x), glm::packHalf1x16(v.y),
+			               glm::packHalf1x16(v.z), glm::packHalf1x16(1.0f));
+			stream_write(stream, i, q);
+		}
+		break;
+
+	case vtek::ModelPositionFormat::unorm16:
+	{
+		glm::vec3 vmin;
+		glm::vec3 extent = compute_unorm_extent(model->vertices, vmin);
+		deq.positionScale = glm::vec4(extent, 1.0f);
+		deq.positionOffset = glm::vec4(vmin, 0.0f);
+
+		model->positionType = VAT::vec4_unorm16;
+		stream.elementSize = 4 * sizeof(uint16_t);
+		stream.data.resize(stream.elementSize * numVertices);
+		for (size_t i = 0; i < numVertices; i++)
+		{
+			glm::vec3 v = (model->vertices[i] - vmin) / extent;
+			glm::u16vec4 q(glm::packUnorm1x16(v.x), glm::packUnorm1x16(v.y),
+			               glm::packUnorm1x16(v.z), glm::packUnorm1x16(1.0f));
+			stream_write(stream, i, q);
+		}
+		break;
+	}
+
+	case vtek::ModelPositionFormat::float32:
+	default:
+		model->positionType = VAT::vec3;
+		stream.elementSize = sizeof(glm::vec3);
+		stream.data.resize(stream.elementSize * numVertices);
+		std::memcpy(stream.data.data(), model->vertices.data(), stream.data.size());
+		break;
+	}
+}
+
+static void build_normal_stream(
+	vtek::Model* model, vtek::ModelNormalFormat format, VertexStream& stream)
+{
+	using VAT = vtek::VertexAttributeType;
+	const size_t numVertices = model->normals.size();
+	if (numVertices == 0 || numVertices != model->vertices.size()) { return; }
+
+	switch (format)
+	{
+	case vtek::ModelNormalFormat::octahedral_snorm16:
+		model->normalType = VAT::vec2_snorm16;
+		stream.elementSize = 2 * sizeof(int16_t);
+		stream.data.resize(stream.elementSize * numVertices);
+		for (size_t i = 0; i < numVertices; i++)
+		{
+			glm::vec2 p = octahedral_encode(model->normals[i]);
+			glm::u16vec2 q(glm::packSnorm1x16(p.x), glm::packSnorm1x16(p.y));
+			stream_write(stream, i, q);
+		}
+		break;
+
+	case vtek::ModelNormalFormat::octahedral_snorm8:
+		model->normalType = VAT::vec2_snorm8;
+		stream.elementSize = 2 * sizeof(int8_t);
+		stream.data.resize(stream.elementSize * numVertices);
+		for (size_t i = 0; i < numVertices; i++)
+		{
+			glm::vec2 p = octahedral_encode(model->normals[i]);
+			glm::u8vec2 q(glm::packSnorm1x8(p.x), glm::packSnorm1x8(p.y));
+			stream_write(stream, i, q);
+		}
+		break;
+
+	case vtek::ModelNormalFormat::float32:
+	default:
+		model->normalType = VAT::vec3;
+		stream.elementSize = sizeof(glm::vec3);
+		stream.data.resize(stream.elementSize * numVertices);
+		std::memcpy(stream.data.data(), model->normals.data(), stream.data.size());
+		break;
+	}
+}
+
+static void build_texcoord_stream(
+	vtek::Model* model, vtek::ModelTexCoordFormat format, VertexStream& stream)
+{
+	using VAT = vtek::VertexAttributeType;
+	const size_t numVertices = model->texCoords.size();
+	if (numVertices == 0 || numVertices != model->vertices.size()) { return; }
+	auto& deq = model->dequantization;
+
+	switch (format)
+	{
+	case vtek::ModelTexCoordFormat::unorm16:
+	{
+		// Relative to the UV range, since UVs may be outside [0, 1] when
+		// textures are repeated.
+		glm::vec2 vmin;
+		glm::vec2 extent = compute_unorm_extent(model->texCoords, vmin);
+		deq.texCoordScale = extent;
+		deq.texCoordOffset = vmin;
+
+		model->texCoordType = VAT::vec2_unorm16;
+		stream.elementSize = 2 * sizeof(uint16_t);
+		stream.data.resize(stream.elementSize * numVertices);
+		for (size_t i = 0; i < numVertices; i++)
+		{
+			glm::vec2 v = (model->texCoords[i] - vmin) / extent;
+			glm::u16vec2 q(glm::packUnorm1x16(v.x), glm::packUnorm1x16(v.y));
+			stream_write(stream, i, q);
+		}
+		break;
+	}
+
+	case vtek::ModelTexCoordFormat::float32:
+	default:
+		model->texCoordType = VAT::vec2;
+		stream.elementSize = sizeof(glm::vec2);
+		stream.data.resize(stream.elementSize * numVertices);
+		std::memcpy(stream.data.data(), model->texCoords.data(), stream.data.size());
+		break;
+	}
+}
+
+// CPU-side contents of each GPU buffer of a model, ready for upload, and
+// the submeshes and materials. This is also what is stored in the mesh cache.
+enum ModelBufferSlot : uint32_t
+{
+	kSlotVertex = 0, kSlotNormal = 1, kSlotTexCoord = 2, kSlotIndex = 3,
+	kSlotSubmeshes = 4, kSlotMaterials = 5
+};
+constexpr uint32_t kNumBufferSlots = 4U; // slots which are uploaded
+
+struct ModelBufferData
+{
+	std::vector<uint8_t> slots[vtek::kMeshCacheNumSlots];
+};
+
+static void build_interleaved_data(
+	vtek::Model* model, const VertexStream* streams, std::vector<uint8_t>& out)
+{
+	// Attribute offsets and the stride are padded to 4 bytes, as is
+	// required by many drivers, e.g. after an `octahedral_snorm8` normal.
+	uint32_t offsets[3];
+	uint32_t stride = 0U;
+	for (int i = 0; i < 3; i++)
+	{
+		offsets[i] = stride;
+		stride += vtek::vertex_attribute_align(streams[i].elementSize);
+	}
+
+	// [ position, normal, texcoord, position, normal, texcoord, ... ]
+	const size_t numVertices = model->vertices.size();
+	out.assign(stride * numVertices, 0);
+	for (size_t v = 0; v < numVertices; v++)
+	{
+		uint8_t* dst = out.data() + v * stride;
+		for (int i = 0; i < 3; i++)
+		{
+			const uint32_t size = streams[i].elementSize;
+			if (size == 0) { continue; }
+
+			std::memcpy(dst + offsets[i], streams[i].data.data() + v * size, size);
+		}
+	}
+
+	model->vertexStride = stride;
+}
+
+static void build_single_data(
+	vtek::Model* model, const VertexStream* streams,
+	const std::vector<uint8_t>& indexData, std::vector<uint8_t>& out)
+{
+	// Each stream is aligned, which satisfies the alignment of any vertex
+	// attribute format as well as the index type.
+	constexpr uint64_t kAlignment = 16UL;
+	auto align = [](uint64_t offset) {
+		return (offset + kAlignment - 1) & ~(kAlignment - 1);
+	};
+
+	// [ positions | normals | texcoords | indices ]
+	uint64_t size = streams[0].data.size();
+	if (!streams[1].empty())
+	{
+		model->normalOffset = align(size);
+		size = model->normalOffset + streams[1].data.size();
+	}
+	if (!streams[2].empty())
+	{
+		model->texCoordOffset = align(size);
+		size = model->texCoordOffset + streams[2].data.size();
+	}
+	model->indexOffset = align(size);
+	size = model->indexOffset + indexData.size();
+
+	out.assign(size, 0);
+	std::memcpy(out.data(), streams[0].data.data(), streams[0].data.size());
+	if (!streams[1].empty())
+	{
+		std::memcpy(out.data() + model->normalOffset,
+		            streams[1].data.data(), streams[1].data.size());
+	}
+	if (!streams[2].empty())
+	{
+		std::memcpy(out.data() + model->texCoordOffset,
+		            streams[2].data.data(), streams[2].data.size());
+	}
+	std::memcpy(out.data() + model->indexOffset, indexData.data(), indexData.size());
+
+	model->vertexStride = streams[0].elementSize;
+}
+
+// Materials are stored as a fixed-size record followed by the strings, in
+// the order: name, textures.
+struct CachedMaterial
+{
+	float baseColorFactor[4];
+	float emissiveFactor[3];
+	float metallicFactor;
+	float roughnessFactor;
+	uint32_t doubleSided;
+	uint32_t stringLengths[1 + vtek::kModelNumTextureTypes];
+};
+
+static void serialize_materials(
+	const std::vector<vtek::ModelMaterial>& materials, std::vector<uint8_t>& out)
+{
+	for (const auto& mat : materials)
+	{
+		const std::string* strings[1 + vtek::kModelNumTextureTypes];
+		strings[0] = &mat.name;
+		for (uint32_t t = 0; t < vtek::kModelNumTextureTypes; t++)
+		{
+			strings[1 + t] = &mat.textures[t];
+		}
+
+		CachedMaterial cached{};
+		std::memcpy(cached.baseColorFactor, &mat.baseColorFactor, sizeof(cached.baseColorFactor));
+		std::memcpy(cached.emissiveFactor, &mat.emissiveFactor, sizeof(cached.emissiveFactor));
+		cached.metallicFactor = mat.metallicFactor;
+		cached.roughnessFactor = mat.roughnessFactor;
+		cached.doubleSided = mat.doubleSided ? 1U : 0U;
+		for (uint32_t i = 0; i < 1 + vtek::kModelNumTextureTypes; i++)
+		{
+			cached.stringLengths[i] = static_cast<uint32_t>(strings[i]->size());
+		}
+
+		const auto record = reinterpret_cast<const uint8_t*>(&cached);
+		out.insert(out.end(), record, record + sizeof(cached));
+		for (const std::string* str : strings)
+		{
+			out.insert(out.end(), str->begin(), str->end());
+		}
+	}
+}
+
+static bool deserialize_materials(
+	const uint8_t* data, uint64_t size, std::vector<vtek::ModelMaterial>& out)
+{
+	uint64_t offset = 0UL;
+	while (offset < size)
+	{
+		if (offset + sizeof(CachedMaterial) > size) { return false; }
+
+		CachedMaterial cached;
+		std::memcpy(&cached, data + offset, sizeof(cached));
+		offset += sizeof(cached);
+
+		vtek::ModelMaterial mat;
+		std::memcpy(&mat.baseColorFactor, cached.baseColorFactor, sizeof(cached.baseColorFactor));
+		std::memcpy(&mat.emissiveFactor, cached.emissiveFactor, sizeof(cached.emissiveFactor));
+		mat.metallicFactor = cached.metallicFactor;
+		mat.roughnessFactor = cached.roughnessFactor;
+		mat.doubleSided = (cached.doubleSided != 0U);
+
+		for (uint32_t i = 0; i < 1 + vtek::kModelNumTextureTypes; i++)
+		{
+			const uint32_t length = cached.stringLengths[i];
+			if (offset + length > size) { return false; }
+
+			std::string& str = (i == 0) ? mat.name : mat.textures[i - 1];
+			str.assign(reinterpret_cast<const char*>(data + offset), length);
+			offset += length;
+		}
+
+		out.push_back(std::move(mat));
+	}
+
+	return true;
+}
+
+static void build_buffer_data(
+	vtek::Model* model, const vtek::ModelInfo* info, ModelBufferData& out)
+{
+	compute_bounds(model);
+
+	// Convert the attributes into their (possibly quantized) GPU formats
+	VertexStream streams[3];
+	build_position_stream(model, info->positionFormat, streams[0]);
+	if (info->loadNormals)
+	{
+		build_normal_stream(model, info->normalFormat, streams[1]);
+	}
+	if (info->loadTextureCoordinates)
+	{
+		build_texcoord_stream(model, info->texCoordFormat, streams[2]);
+	}
+
+	std::vector<uint8_t> indexData;
+	build_index_data(model, indexData);
+
+	model->vertexLayout = info->vertexLayout;
+	switch (info->vertexLayout)
+	{
+	case vtek::ModelVertexLayout::interleaved:
+		build_interleaved_data(model, streams, out.slots[kSlotVertex]);
+		out.slots[kSlotIndex] = std::move(indexData);
+		break;
+
+	case vtek::ModelVertexLayout::single_allocation:
+		build_single_data(model, streams, indexData, out.slots[kSlotVertex]);
+		break;
+
+	case vtek::ModelVertexLayout::separate_buffers:
+	default:
+		model->vertexStride = streams[0].elementSize;
+		out.slots[kSlotVertex] = std::move(streams[0].data);
+		out.slots[kSlotNormal] = std::move(streams[1].data);
+		out.slots[kSlotTexCoord] = std::move(streams[2].data);
+		out.slots[kSlotIndex] = std::move(indexData);
+		break;
+	}
+
+	// Not uploaded, only stored in the mesh cache
+	auto& submeshData = out.slots[kSlotSubmeshes];
+	submeshData.resize(sizeof(vtek::ModelSubmesh) * model->submeshes.size());
+	std::memcpy(submeshData.data(), model->submeshes.data(), submeshData.size());
+	serialize_materials(model->materials, out.slots[kSlotMaterials]);
+}
+
+// All buffer contents of a model are recorded into one single-use transfer
+// command buffer, which is submitted once and waited on with a fence,
+// instead of one synchronous transfer for each buffer.
+struct ModelUpload
+{
+	vtek::CommandScheduler* scheduler {nullptr};
+	vtek::CommandBuffer* commandBuffer {nullptr};
+	std::vector<vtek::Buffer*> stagingBuffers;
+};
+
+static bool upload_begin(ModelUpload& upload, vtek::Device* device)
+{
+	upload.scheduler = vtek::device_get_command_scheduler(device);
+	upload.commandBuffer =
+		vtek::command_scheduler_begin_transfer(upload.scheduler, device);
+
+	return upload.commandBuffer != nullptr;
+}
+
+// Source data of a buffer, which may be gathered from several ranges that
+// are placed back-to-back, e.g. buffer views of a glTF file.
+struct UploadRange
+{
+	const void* data {nullptr};
+	uint64_t size {0UL};
+};
+
+static uint64_t get_upload_size(const std::vector<UploadRange>& ranges)
+{
+	uint64_t size = 0UL;
+	for (const auto& range : ranges) { size += range.size; }
+	return size;
+}
+
+static bool write_ranges(
+	vtek::Buffer* buffer, uint64_t offset, const std::vector<UploadRange>& ranges,
+	vtek::Device* device)
+{
+	for (const auto& range : ranges)
+	{
+		vtek::BufferRegion region {
+			.offset = offset,
+			.size = range.size
+		};
+		void* src = const_cast<void*>(range.data); // only read from
+
+		if (!vtek::buffer_write_data(buffer, src, &region, device))
+		{
+			return false;
+		}
+		offset += range.size;
+	}
+
+	return true;
+}
+
+// Write the ranges back-to-back into `buffer`, starting at `dstOffset`.
+static bool upload_record(
+	ModelUpload& upload, vtek::Buffer* buffer, uint64_t dstOffset,
+	const std::vector<UploadRange>& ranges, vtek::Device* device)
+{
+	// Host-visible memory, e.g. on integrated GPUs, is written directly
+	if (vtek::buffer_is_host_visible(buffer))
+	{
+		return write_ranges(buffer, dstOffset, ranges, device);
+	}
+
+	const uint64_t size = get_upload_size(ranges);
+	vtek::BufferInfo stagingInfo{};
+	stagingInfo.size = size;
+	stagingInfo.requireHostVisibleStorage = true;
+	stagingInfo.disallowInternalStagingBuffer = true;
+	stagingInfo.usageFlags = vtek::BufferUsageFlag::transfer_src;
+
+	vtek::Buffer* staging = vtek::buffer_create(&stagingInfo, device);
+	if (staging == nullptr)
+	{
+		vtek_log_error("Failed to create staging buffer for model upload!");
+		return false;
+	}
+	upload.stagingBuffers.push_back(staging);
+
+	if (!write_ranges(staging, 0UL, ranges, device))
+	{
+		return false;
+	}
+
+	VkBufferCopy copyRegion{};
+	copyRegion.srcOffset = 0;
+	copyRegion.dstOffset = dstOffset;
+	copyRegion.size = size;
+	vkCmdCopyBuffer(
+		vtek::command_buffer_get_handle(upload.commandBuffer),
+		vtek::buffer_get_handle(staging), vtek::buffer_get_handle(buffer),
+		1, &copyRegion);
+
+	return true;
+}
+
+// Submit and wait for completion. The command buffer is submitted even if
+// recording failed part-way, since that is the only way to release it, so
+// the destination buffers must stay alive until this returns.
+static bool upload_end(ModelUpload& upload, vtek::Device* device)
+{
+	vtek::TransferSubmission submission{};
+	bool success = vtek::command_scheduler_submit_transfer_async(
+		upload.scheduler, upload.commandBuffer, &submission, device);
+	if (success)
+	{
+		success = vtek::command_scheduler_wait_transfer(
+			upload.scheduler, &submission, device);
+	}
+	upload.commandBuffer = nullptr;
+
+	for (auto staging : upload.stagingBuffers)
+	{
+		vtek::buffer_destroy(staging);
+	}
+	upload.stagingBuffers.clear();
+
+	return success;
+}
+
+static vtek::Buffer* create_model_buffer(
+	const std::vector<UploadRange>& ranges,
+	vtek::EnumBitmask<vtek::BufferUsageFlag> usage, ModelUpload& upload,
+	vtek::Device* device)
+{
+	vtek::BufferInfo bufferInfo{};
+	bufferInfo.size = get_upload_size(ranges);
+	bufferInfo.writePolicy = vtek::BufferWritePolicy::write_once;
+	bufferInfo.usageFlags = usage;
+	bufferInfo.usageFlags.add_flag(vtek::BufferUsageFlag::transfer_dst);
+
+	vtek::Buffer* buffer = vtek::buffer_create(&bufferInfo, device);
+	if (buffer == nullptr)
+	{
+		return nullptr;
+	}
+
+	if (!upload_record(upload, buffer, 0UL, ranges, device))
+	{
+		vtek_log_error("Failed to write data to model buffer!");
+		vtek::buffer_destroy(buffer);
+		return nullptr;
+	}
+
+	return buffer;
+}
+
+// Models in a geometry arena are uploaded into a range of the arena's
+// buffers, which the model does not own. The vertex formats and the index
+// type must match those of the arena. Submeshes are offset to the range, so
+// they are drawn the same way as for models with their own buffers.
+static bool create_arena_buffers(
+	vtek::Model* model, const std::vector<UploadRange> slots[kNumBufferSlots],
+	vtek::Device* device)
+{
+	vtek::GeometryArena* arena = model->arena;
+	vtek::Buffer* buffers[kNumBufferSlots] = {
+		vtek::geometry_arena_get_vertex_buffer(arena),
+		vtek::geometry_arena_get_normal_buffer(arena),
+		vtek::geometry_arena_get_texcoord_buffer(arena),
+		vtek::geometry_arena_get_index_buffer(arena)
+	};
+	const vtek::IndexType indexType = vtek::geometry_arena_get_index_type(arena);
+	const uint32_t elementSizes[kNumBufferSlots] = {
+		vtek::vertex_attribute_get_size(vtek::geometry_arena_get_position_type(arena)),
+		vtek::vertex_attribute_get_size(vtek::geometry_arena_get_normal_type(arena)),
+		vtek::vertex_attribute_get_size(vtek::geometry_arena_get_texcoord_type(arena)),
+		(indexType == vtek::IndexType::uint16) ? 2U : 4U
+	};
+
+	const bool hasNormals = !slots[kSlotNormal].empty();
+	const bool hasTexCoords = !slots[kSlotTexCoord].empty();
+	if (model->positionType != vtek::geometry_arena_get_position_type(arena) ||
+	    (hasNormals && (buffers[kSlotNormal] == nullptr ||
+	     model->normalType != vtek::geometry_arena_get_normal_type(arena))) ||
+	    (hasTexCoords && (buffers[kSlotTexCoord] == nullptr ||
+	     model->texCoordType != vtek::geometry_arena_get_texcoord_type(arena))))
+	{
+		vtek_log_error("Model vertex formats do not match the geometry arena!");
+		return false;
+	}
+	if (model->indexType != indexType)
+	{
+		vtek_log_error("Model requires 32-bit indices, but geometry arena has 16-bit!");
+		return false;
+	}
+
+	const uint64_t numVertices =
+		get_upload_size(slots[kSlotVertex]) / elementSizes[kSlotVertex];
+	const uint64_t numIndices =
+		get_upload_size(slots[kSlotIndex]) / elementSizes[kSlotIndex];
+	vtek::GeometryArenaRange& range = model->arenaRange;
+	if (!vtek::geometry_arena_allocate(
+		    arena, static_cast<uint32_t>(numVertices),
+		    static_cast<uint32_t>(numIndices), &range))
+	{
+		return false;
+	}
+
+	ModelUpload upload;
+	if (!upload_begin(upload, device))
+	{
+		vtek_log_error("Failed to begin model upload!");
+		return false;
+	}
+
+	bool success = true;
+	for (uint32_t i = 0; i < kNumBufferSlots && success; i++)
+	{
+		if (slots[i].empty()) { continue; }
+
+		const uint64_t first = (i == kSlotIndex) ? range.firstIndex : range.baseVertex;
+		success = upload_record(upload, buffers[i], first * elementSizes[i], slots[i], device);
+	}
+	if (!upload_end(upload, device) || !success)
+	{
+		vtek_log_error("Failed to upload model to geometry arena!");
+		return false;
+	}
+
+	model->vertexBuffer = buffers[kSlotVertex];
+	model->normalBuffer = hasNormals ? buffers[kSlotNormal] : nullptr;
+	model->texCoordBuffer = hasTexCoords ? buffers[kSlotTexCoord] : nullptr;
+	model->indexBuffer = buffers[kSlotIndex];
+
+	for (auto& submesh : model->submeshes)
+	{
+		submesh.firstIndex += range.firstIndex;
+		submesh.vertexOffset += static_cast<int32_t>(range.baseVertex);
+		submesh.firstVertex += range.baseVertex;
+	}
+
+	return true;
+}
+
+// Create a GPU buffer for each non-empty slot, and upload the contents in a
+// single transfer. The data pointers may point into the mesh cache file
+// mapping, so the data is copied straight into staging memory. On failure
+// the caller must destroy the buffers that were created.
+static bool create_buffers(
+	vtek::Model* model, const std::vector<UploadRange> slots[kNumBufferSlots],
+	vtek::Device* device)
+{
+	if (model->arena != nullptr)
+	{
+		return create_arena_buffers(model, slots, device);
+	}
+
+	using BUFlag = vtek::BufferUsageFlag;
+	vtek::Buffer** buffers[kNumBufferSlots] = {
+		&model->vertexBuffer, &model->normalBuffer,
+		&model->texCoordBuffer, &model->indexBuffer
+	};
+	const char* names[kNumBufferSlots] = {
+		"vertices", "normals", "texcoords", "indices"
+	};
+	const bool single = model->vertexLayout == vtek::ModelVertexLayout::single_allocation;
+
+	ModelUpload upload;
+	if (!upload_begin(upload, device))
+	{
+		vtek_log_error("Failed to begin model upload!");
+		return false;
+	}
+
+	bool success = true;
+	for (uint32_t i = 0; i < kNumBufferSlots && success; i++)
+	{
+		if (get_upload_size(slots[i]) == 0) { continue; }
+
+		vtek::EnumBitmask<BUFlag> usage =
+			(i == kSlotIndex) ? BUFlag::index_buffer : BUFlag::vertex_buffer;
+		if (single) { usage.add_flag(BUFlag::index_buffer); }
+
+		*buffers[i] = create_model_buffer(slots[i], usage, upload, device);
+		if (*buffers[i] == nullptr)
+		{
+			vtek_log_error("Failed to create model buffer for {}!", names[i]);
+			success = false;
+		}
+	}
+
+	if (!upload_end(upload, device))
+	{
+		vtek_log_error("Failed to upload model buffers!");
+		success = false;
+	}
+
+	if (single)
+	{
+		// Offsets are non-zero only for attributes that were stored
+		if (model->normalOffset > 0) { model->normalBuffer = model->vertexBuffer; }
+		if (model->texCoordOffset > 0) { model->texCoordBuffer = model->vertexBuffer; }
+		model->indexBuffer = model->vertexBuffer;
+	}
+
+	return success;
+}
+
+static bool create_buffers(
+	vtek::Model* model, const void* const data[kNumBufferSlots],
+	const uint64_t sizes[kNumBufferSlots], vtek::Device* device)
+{
+	std::vector<UploadRange> slots[kNumBufferSlots];
+	for (uint32_t i = 0; i < kNumBufferSlots; i++)
+	{
+		if (sizes[i] > 0) { slots[i].push_back({ data[i], sizes[i] }); }
+	}
+
+	return create_buffers(model, slots, device);
+}
+
+
+static uint64_t hash_model_options(const vtek::ModelInfo* info)
+{
+	// Every option which affects the processed buffer contents
+	const bool forceUint32Indices = info->geometryArena != nullptr &&
+		vtek::geometry_arena_get_index_type(info->geometryArena) == vtek::IndexType::uint32;
+	uint32_t options[8] = {
+		(info->loadNormals ? 0x01U : 0U) |
+		(info->loadTextureCoordinates ? 0x02U : 0U) |
+		(info->flipUVs ? 0x04U : 0U) |
+		(info->optimizeVertexCache ? 0x08U : 0U) |
+		(info->optimizeOverdraw ? 0x10U : 0U) |
+		(info->optimizeVertexFetch ? 0x20U : 0U) |
+		(info->separateSubmeshes ? 0x40U : 0U) |
+		(forceUint32Indices ? 0x80U : 0U),
+		0U, // overdraw threshold, below
+		info->vertexCacheSize,
+		static_cast<uint32_t>(info->vertexLayout),
+		static_cast<uint32_t>(info->positionFormat),
+		static_cast<uint32_t>(info->normalFormat),
+		static_cast<uint32_t>(info->texCoordFormat),
+		vtek::kMeshCacheVersion
+	};
+	std::memcpy(&options[1], &info->overdrawThreshold, sizeof(float));
+
+	return vtek::mesh_cache_hash(options, sizeof(options));
+}
+
+static uint64_t hash_source_file(
+	const vtek::Directory* directory, std::string_view filename)
+{
+	vtek::FileMapping* mapping = vtek::file_map(directory, filename);
+	if (mapping == nullptr) { return 0UL; }
+
+	uint64_t hash = vtek::mesh_cache_hash(
+		vtek::file_mapping_get_data(mapping), vtek::file_mapping_get_size(mapping));
+	vtek::file_unmap(mapping);
+
+	return hash;
+}
+
+static_assert(sizeof(vtek::ModelDequantization) ==
+              sizeof(vtek::MeshCacheHeader::dequantization));
+
+static void fill_cache_header(const vtek::Model* model, vtek::MeshCacheHeader& h)
+{
+	h.numVertices = model->numVertices;
+	h.numIndices = model->numIndices;
+	h.indexType = static_cast<uint32_t>(model->indexType);
+	h.vertexLayout = static_cast<uint32_t>(model->vertexLayout);
+	h.vertexStride = model->vertexStride;
+	h.positionType = static_cast<uint32_t>(model->positionType);
+	h.normalType = static_cast<uint32_t>(model->normalType);
+	h.texCoordType = static_cast<uint32_t>(model->texCoordType);
+	std::memcpy(h.boundsMin, &model->boundsMin, sizeof(h.boundsMin));
+	std::memcpy(h.boundsMax, &model->boundsMax, sizeof(h.boundsMax));
+	std::memcpy(h.dequantization, &model->dequantization, sizeof(h.dequantization));
+	h.normalOffset = model->normalOffset;
+	h.texCoordOffset = model->texCoordOffset;
+	h.indexOffset = model->indexOffset;
+}
+
+static void apply_cache_header(vtek::Model* model, const vtek::MeshCacheHeader& h)
+{
+	using VAT = vtek::VertexAttributeType;
+	model->numVertices = h.numVertices;
+	model->numIndices = h.numIndices;
+	model->indexType = static_cast<vtek::IndexType>(h.indexType);
+	model->vertexLayout = static_cast<vtek::ModelVertexLayout>(h.vertexLayout);
+	model->vertexStride = h.vertexStride;
+	model->positionType = static_cast<VAT>(h.positionType);
+	model->normalType = static_cast<VAT>(h.normalType);
+	model->texCoordType = static_cast<VAT>(h.texCoordType);
+	std::memcpy(&model->boundsMin, h.boundsMin, sizeof(h.boundsMin));
+	std::memcpy(&model->boundsMax, h.boundsMax, sizeof(h.boundsMax));
+	std::memcpy(&model->dequantization, h.dequantization, sizeof(h.dequantization));
+	model->normalOffset = h.normalOffset;
+	model->texCoordOffset = h.texCoordOffset;
+	model->indexOffset = h.indexOffset;
+}
+
+// The buffer slots must match the element counts and formats of the header,
+// since these are trusted when binding and drawing the buffers. Normals and
+// texture coordinates are optional, so their sizes may also be 0.
+static bool validate_cache_sizes(const vtek::MeshCacheHeader& h)
+{
+	using VAT = vtek::VertexAttributeType;
+	const uint64_t* sizes = h.slotSizes;
+	const uint64_t numVertices = h.numVertices;
+	const uint64_t numIndices = h.numIndices;
+
+	uint64_t indexSize = 0UL;
+	switch (static_cast<vtek::IndexType>(h.indexType))
+	{
+	case vtek::IndexType::uint16: indexSize = sizeof(uint16_t); break;
+	case vtek::IndexType::uint32: indexSize = sizeof(uint32_t); break;
+	default: return false;
+	}
+
+	const uint64_t positionSize =
+		vtek::vertex_attribute_get_size(static_cast<VAT>(h.positionType));
+	const uint64_t normalSize =
+		vtek::vertex_attribute_get_size(static_cast<VAT>(h.normalType));
+	const uint64_t texCoordSize =
+		vtek::vertex_attribute_get_size(static_cast<VAT>(h.texCoordType));
+	if (positionSize == 0 || normalSize == 0 || texCoordSize == 0) { return false; }
+
+	auto optional = [numVertices](uint64_t size, uint64_t elementSize) {
+		return size == 0 || size == numVertices * elementSize;
+	};
+
+	switch (static_cast<vtek::ModelVertexLayout>(h.vertexLayout))
+	{
+	case vtek::ModelVertexLayout::separate_buffers:
+		return h.vertexStride == positionSize &&
+			sizes[kSlotVertex] == numVertices * positionSize &&
+			optional(sizes[kSlotNormal], normalSize) &&
+			optional(sizes[kSlotTexCoord], texCoordSize) &&
+			sizes[kSlotIndex] == numIndices * indexSize;
+
+	case vtek::ModelVertexLayout::interleaved:
+		return h.vertexStride >= positionSize &&
+			h.vertexStride <= vtek::vertex_attribute_align(positionSize) +
+				vtek::vertex_attribute_align(normalSize) +
+				vtek::vertex_attribute_align(texCoordSize) &&
+			sizes[kSlotVertex] == numVertices * h.vertexStride &&
+			sizes[kSlotNormal] == 0 && sizes[kSlotTexCoord] == 0 &&
+			sizes[kSlotIndex] == numIndices * indexSize;
+
+	case vtek::ModelVertexLayout::single_allocation:
+	{
+		// [ positions | normals | texcoords | indices ], offsets 0 if absent
+		uint64_t end = numVertices * positionSize;
+		if (h.normalOffset > 0)
+		{
+			if (h.normalOffset < end || h.normalOffset > sizes[kSlotVertex]) { return false; }
+			end = h.normalOffset + numVertices * normalSize;
+		}
+		if (h.texCoordOffset > 0)
+		{
+			if (h.texCoordOffset < end || h.texCoordOffset > sizes[kSlotVertex]) { return false; }
+			end = h.texCoordOffset + numVertices * texCoordSize;
+		}
+		return h.vertexStride == positionSize && h.indexOffset >= end &&
+			h.indexOffset <= sizes[kSlotVertex] &&
+			sizes[kSlotVertex] - h.indexOffset == numIndices * indexSize &&
+			sizes[kSlotNormal] == 0 && sizes[kSlotTexCoord] == 0 &&
+			sizes[kSlotIndex] == 0;
+	}
+
+	default:
+		return false;
+	}
+}
+
+static void destroy_model_buffers(vtek::Model* model, vtek::Device* device)
+{
+	if (model->arena != nullptr)
+	{
+		vtek::geometry_arena_free(model->arena, &model->arenaRange);
+		model->vertexBuffer = nullptr;
+		model->normalBuffer = nullptr;
+		model->texCoordBuffer = nullptr;
+		model->indexBuffer = nullptr;
+		return;
+	}
+
+	if (model->vertexLayout == vtek::ModelVertexLayout::single_allocation)
+	{
+		model->normalBuffer = nullptr;
+		model->texCoordBuffer = nullptr;
+		model->indexBuffer = nullptr;
+	}
+
+	if (model->vertexBuffer != nullptr)
+	{
+		vtek::buffer_destroy(model->vertexBuffer);
+		model->vertexBuffer = nullptr;
+	}
+	if (model->normalBuffer != nullptr)
+	{
+		vtek::buffer_destroy(model->normalBuffer);
+		model->normalBuffer = nullptr;
+	}
+	if (model->texCoordBuffer != nullptr)
+	{
+		vtek::buffer_destroy(model->texCoordBuffer);
+		model->texCoordBuffer = nullptr;
+	}
+	if (model->indexBuffer != nullptr)
+	{
+		vtek::buffer_destroy(model->indexBuffer);
+		model->indexBuffer = nullptr;
+	}
+}
+
+// The processed vertex data is only kept until uploaded
+static void release_vertex_data(vtek::Model* model)
+{
+	model->vertices.clear();
+	model->normals.clear();
+	model->texCoords.clear();
+	model->indices.clear();
+}
+
+enum class CacheLoadResult
+{
+	miss, loaded, failed
+};
+
+static CacheLoadResult load_from_mesh_cache(
+	vtek::Model* model, const vtek::Directory* directory, std::string_view filename,
+	uint64_t sourceHash, uint64_t optionsHash, vtek::Device* device)
+{
+	vtek::MeshCacheHeader header;
+	vtek::FileMapping* mapping = vtek::mesh_cache_open(
+		directory, filename, sourceHash, optionsHash, &header);
+	if (mapping == nullptr) { return CacheLoadResult::miss; }
+
+	// Submeshes and materials are read first, since they are validated
+	const auto base = static_cast<const uint8_t*>(vtek::file_mapping_get_data(mapping));
+	const uint64_t submeshSize = header.slotSizes[kSlotSubmeshes];
+	if (!validate_cache_sizes(header) ||
+	    submeshSize % sizeof(vtek::ModelSubmesh) != 0 ||
+	    !deserialize_materials(base + header.slotOffsets[kSlotMaterials],
+	                           header.slotSizes[kSlotMaterials], model->materials))
+	{
+		vtek_log_debug("Mesh cache file {} ignored: {}", filename, "invalid data");
+		model->materials.clear();
+		vtek::file_unmap(mapping);
+		return CacheLoadResult::miss;
+	}
+	model->submeshes.resize(submeshSize / sizeof(vtek::ModelSubmesh));
+	std::memcpy(model->submeshes.data(), base + header.slotOffsets[kSlotSubmeshes],
+	            submeshSize);
+
+	apply_cache_header(model, header);
+	compute_model_bounds(model);
+
+	// Buffer contents are copied straight from the mapped file
+	const void* data[vtek::kMeshCacheNumSlots];
+	for (uint32_t i = 0; i < vtek::kMeshCacheNumSlots; i++)
+	{
+		data[i] = base + header.slotOffsets[i];
+	}
+
+	bool success = create_buffers(model, data, header.slotSizes, device);
+	vtek::file_unmap(mapping);
+	if (!success)
+	{
+		vtek_log_error("Failed to create buffers from mesh cache {}!", filename);
+		destroy_model_buffers(model, device);
+		return CacheLoadResult::failed;
+	}
+
+	vtek_log_debug("Loaded model from mesh cache {}", filename);
+	return CacheLoadResult::loaded;
+}
+
+// ======================== //
+// === glTF direct path === //
+// ======================== //
+
+// glTF files are loaded without Assimp when the accessors already match the
+// model's vertex formats, so buffer views are copied straight from the file
+// mapping into staging memory. Anything else falls back to Assimp.
+enum class GltfLoadResult
+{
+	unsupported, loaded, failed
+};
+
+static bool is_gltf_file(std::string_view filename)
+{
+	auto endsWith = [filename](std::string_view ext) {
+		if (filename.size() < ext.size()) { return false; }
+		auto tail = filename.substr(filename.size() - ext.size());
+		return std::equal(tail.begin(), tail.end(), ext.begin(), [](char a, char b) {
+			return std::tolower(static_cast<unsigned char>(a)) == b;
+		});
+	};
+	return endsWith(".gltf") || endsWith(".glb");
+}
+
+// Only the default layout matches glTF's tightly packed attribute streams,
+// and indices are relative to each primitive's vertices, as with
+// `separateSubmeshes`. Any processing of the vertex data requires Assimp.
+static bool is_gltf_direct_supported(const vtek::ModelInfo* info)
+{
+	return info->separateSubmeshes && !info->flipUVs &&
+		info->vertexLayout == vtek::ModelVertexLayout::separate_buffers &&
+		info->positionFormat == vtek::ModelPositionFormat::float32 &&
+		info->normalFormat == vtek::ModelNormalFormat::float32 &&
+		info->texCoordFormat == vtek::ModelTexCoordFormat::float32 &&
+		!info->optimizeVertexCache && !info->optimizeOverdraw &&
+		!info->optimizeVertexFetch;
+}
+
+// Vertex data of one or more primitives which share the same accessors
+struct GltfVertexRange
+{
+	int32_t position {-1};
+	int32_t normal {-1};
+	int32_t texCoord {-1};
+	uint32_t baseVertex {0U};
+	uint32_t numVertices {0U};
+};
+
+// Indices of one primitive, which may also be shared
+struct GltfIndexRange
+{
+	int32_t indices {-1};
+	uint32_t vertexRange {0U};
+	uint32_t firstIndex {0U};
+	uint32_t numIndices {0U};
+};
+
+struct GltfModelBuilder
+{
+	const vtek::GltfDocument* doc {nullptr};
+	bool loadNormals {false};
+	bool loadTexCoords {false};
+
+	std::vector<GltfVertexRange> vertexRanges;
+	std::vector<GltfIndexRange> indexRanges;
+	std::map<std::tuple<int32_t, int32_t, int32_t>, uint32_t> vertexRangeLookup;
+	std::map<std::pair<int32_t, uint32_t>, uint32_t> indexRangeLookup;
+	// Index range for each primitive, as [mesh][primitive]
+	std::vector<std::vector<uint32_t>> primitiveRanges;
+
+	std::vector<UploadRange> slots[kNumBufferSlots];
+	// Indices which must be widened to the model's index type
+	std::vector<std::vector<uint8_t>> convertedIndices;
+};
+
+// Tightly packed accessor data of the expected type, or nullptr
+static const uint8_t* get_packed_data(
+	const vtek::GltfDocument* doc, int32_t accessorIndex,
+	vtek::GltfComponentType componentType, uint32_t numComponents)
+{
+	const vtek::GltfAccessor& accessor = doc->accessors[accessorIndex];
+	if (accessor.componentType != componentType ||
+	    accessor.numComponents != numComponents || accessor.normalized)
+	{
+		return nullptr;
+	}
+
+	uint64_t stride = 0UL;
+	const uint8_t* data = vtek::gltf_get_accessor_data(doc, accessor, &stride);
+	const uint64_t elementSize = vtek::gltf_component_size(componentType) * numComponents;
+
+	return (stride == elementSize) ? data : nullptr;
+}
+
+// Largest index of an accessor with tightly packed unsigned indices
+static uint32_t get_gltf_max_index(
+	const uint8_t* data, vtek::GltfComponentType type, uint32_t count)
+{
+	uint32_t maxIndex = 0U;
+	for (uint32_t i = 0; i < count; i++)
+	{
+		uint32_t index = 0U;
+		switch (type)
+		{
+		case vtek::GltfComponentType::uint8:
+			index = data[i];
+			break;
+		case vtek::GltfComponentType::uint16:
+		{
+			uint16_t v;
+			std::memcpy(&v, data + 2 * i, 2);
+			index = v;
+			break;
+		}
+		default:
+			std::memcpy(&index, data + 4 * i, 4);
+			break;
+		}
+		maxIndex = std::max(maxIndex, index);
+	}
+	return maxIndex;
+}
+
+// An attribute must be present in either all or no primitives, and the
+// returned flag tells which. Returns false if neither is the case.
+static bool check_gltf_attribute(
+	const vtek::GltfDocument* doc, int32_t vtek::GltfPrimitive::* attribute,
+	uint32_t numComponents, bool* outPresent)
+{
+	bool any = false;
+	bool all = true;
+	for (const auto& mesh : doc->meshes)
+	{
+		for (const auto& primitive : mesh.primitives)
+		{
+			const int32_t accessor = primitive.*attribute;
+			if (accessor < 0) { all = false; continue; }
+
+			any = true;
+			if (get_packed_data(doc, accessor, vtek::GltfComponentType::float32,
+			                    numComponents) == nullptr)
+			{
+				return false;
+			}
+		}
+	}
+
+	*outPresent = any;
+	return all || !any;
+}
+
+// Lay out the vertex and index ranges of all primitives, sharing ranges
+// between primitives that reference the same accessors.
+static bool build_gltf_ranges(GltfModelBuilder& b, vtek::Model* model)
+{
+	const vtek::GltfDocument* doc = b.doc;
+	uint32_t numVertices = 0U;
+	uint32_t numIndices = 0U;
+	bool uint32Indices = false;
+
+	for (const auto& mesh : doc->meshes)
+	{
+		b.primitiveRanges.emplace_back();
+		for (const auto& p : mesh.primitives)
+		{
+			if (p.mode != vtek::kGltfModeTriangles || p.position < 0 || p.indices < 0)
+			{
+				return false;
+			}
+
+			const int32_t normal = b.loadNormals ? p.normal : -1;
+			const int32_t texCoord = b.loadTexCoords ? p.texCoord : -1;
+
+			auto [vr, newVertices] = b.vertexRangeLookup.try_emplace(
+				{ p.position, normal, texCoord },
+				static_cast<uint32_t>(b.vertexRanges.size()));
+			if (newVertices)
+			{
+				const uint32_t count = doc->accessors[p.position].count;
+				if ((normal >= 0 && doc->accessors[normal].count != count) ||
+				    (texCoord >= 0 && doc->accessors[texCoord].count != count))
+				{
+					return false;
+				}
+
+				b.vertexRanges.push_back({ p.position, normal, texCoord, numVertices, count });
+				numVertices += count;
+			}
+			const uint32_t vertexRange = vr->second;
 
-	uint32_t numVertices {0U};
+			auto [ir, newIndices] = b.indexRangeLookup.try_emplace(
+				{ p.indices, vertexRange }, static_cast<uint32_t>(b.indexRanges.size()));
+			if (newIndices)
+			{
+				const vtek::GltfAccessor& accessor = doc->accessors[p.indices];
+				uint64_t stride = 0UL;
+				const uint8_t* data = vtek::gltf_get_accessor_data(doc, accessor, &stride);
+				if (accessor.numComponents != 1 || data == nullptr ||
+				    stride != vtek::gltf_component_size(accessor.componentType) ||
+				    accessor.componentType == vtek::GltfComponentType::int8 ||
+				    accessor.componentType == vtek::GltfComponentType::int16 ||
+				    accessor.componentType == vtek::GltfComponentType::float32)
+				{
+					return false;
+				}
 
-	vtek::Buffer* vertexBuffer {nullptr};
-	vtek::Buffer* normalBuffer {nullptr};
-	vtek::Buffer* texCoordBuffer {nullptr};
-	vtek::Buffer* indexBuffer {nullptr}; // TODO: Next item is to try this instead!
-};
+				// Indices are uploaded as they are, so an index beyond the
+				// primitive's vertices would be fetched out of bounds on the
+				// GPU. Such files are left to Assimp.
+				const uint32_t primitiveVertices = b.vertexRanges[vertexRange].numVertices;
+				if (get_gltf_max_index(data, accessor.componentType, accessor.count) >=
+				    primitiveVertices)
+				{
+					vtek_log_warn("glTF primitive has indices beyond its {} vertices",
+					              primitiveVertices);
+					return false;
+				}
+				uint32Indices |= accessor.componentType == vtek::GltfComponentType::uint32;
 
+				b.indexRanges.push_back({ p.indices, vertexRange, numIndices, accessor.count });
+				numIndices += accessor.count;
+			}
+			b.primitiveRanges.back().push_back(ir->second);
+		}
+	}
 
+	if (numIndices == 0) { return false; }
+	if (model->arena != nullptr)
+	{
+		uint32Indices |= vtek::geometry_arena_get_index_type(model->arena) ==
+			vtek::IndexType::uint32;
+	}
 
-/* helper functions */
-static void load_scene_mesh(
-	vtek::Model* model, aiMesh* mesh, const vtek::ModelInfo* info)
+	model->numVertices = numVertices;
+	model->numIndices = numIndices;
+	model->indexType = uint32Indices ? vtek::IndexType::uint32 : vtek::IndexType::uint16;
+	return true;
+}
+
+// Buffer contents point straight into the glTF buffers. Only indices of a
+// smaller type than the model's index type are converted, e.g. 16-bit
+// indices of a primitive in a model which also has 32-bit indices.
+static void build_gltf_upload(GltfModelBuilder& b, const vtek::Model* model)
 {
-	//bool vertices = true; // REVIEW: Why would we ever _not_ want to load vertex positions!
-	bool normals = mesh->HasNormals() && info->loadNormals;
-	bool texCoords = mesh->HasTextureCoords(0) && info->loadTextureCoordinates;
-	//bool tangents = false; // TODO: Needs an implementation of normal mapping!
+	const vtek::GltfDocument* doc = b.doc;
+	using CT = vtek::GltfComponentType;
 
-	for (unsigned int i = 0; i < mesh->mNumVertices; i++)
+	for (const auto& range : b.vertexRanges)
 	{
-		model->vertices.push_back(glm::vec3(
-			mesh->mVertices[i].x, mesh->mVertices[i].y, mesh->mVertices[i].z));
+		b.slots[kSlotVertex].push_back({
+			get_packed_data(doc, range.position, CT::float32, 3),
+			sizeof(glm::vec3) * range.numVertices });
 
-		if (normals)
+		if (range.normal >= 0)
 		{
-			model->normals.push_back(glm::vec3(
-				mesh->mNormals[i].x, mesh->mNormals[i].y, mesh->mNormals[i].z));
+			b.slots[kSlotNormal].push_back({
+				get_packed_data(doc, range.normal, CT::float32, 3),
+				sizeof(glm::vec3) * range.numVertices });
 		}
-		if (texCoords)
+		if (range.texCoord >= 0)
 		{
-			model->texCoords.push_back(glm::vec2(
-				mesh->mTextureCoords[0][i].x, mesh->mTextureCoords[0][i].y));
+			b.slots[kSlotTexCoord].push_back({
+				get_packed_data(doc, range.texCoord, CT::float32, 2),
+				sizeof(glm::vec2) * range.numVertices });
 		}
 	}
-}
 
-static void load_scene_node(
-	vtek::Model* model, const aiScene* scene, aiNode* node,
-	const vtek::ModelInfo* info)
-{
-	// A node contains 0..x meshes, each of which we add to the model
-	for (unsigned int i = 0; i < node->mNumMeshes; i++)
-	{
-		aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
-		load_scene_mesh(model, mesh, info);
-		// NEXT: Load materials
-	}
+	const bool uint32Indices = model->indexType == vtek::IndexType::uint32;
+	const CT indexType = uint32Indices ? CT::uint32 : CT::uint16;
+	const uint64_t indexSize = uint32Indices ? sizeof(uint32_t) : sizeof(uint16_t);
 
-	// Recurse on each child node
-	for (unsigned int i = 0; i < node->mNumChildren; i++)
+	for (const auto& range : b.indexRanges)
 	{
-		load_scene_node(model, scene, node->mChildren[i], info);
+		const vtek::GltfAccessor& accessor = doc->accessors[range.indices];
+		uint64_t stride = 0UL;
+		const uint8_t* src = vtek::gltf_get_accessor_data(doc, accessor, &stride);
+
+		if (accessor.componentType == indexType)
+		{
+			b.slots[kSlotIndex].push_back({ src, indexSize * range.numIndices });
+			continue;
+		}
+
+		b.convertedIndices.emplace_back(indexSize * range.numIndices);
+		uint8_t* dst = b.convertedIndices.back().data();
+		for (uint32_t i = 0; i < range.numIndices; i++)
+		{
+			uint32_t index = 0U;
+			if (accessor.componentType == CT::uint8) { index = src[i]; }
+			else { uint16_t v; std::memcpy(&v, src + 2 * i, 2); index = v; }
+
+			if (uint32Indices) { std::memcpy(dst + 4 * i, &index, 4); }
+			else { const uint16_t v = static_cast<uint16_t>(index); std::memcpy(dst + 2 * i, &v, 2); }
+		}
+		b.slots[kSlotIndex].push_back({ dst, indexSize * range.numIndices });
 	}
 }
 
-static bool create_buffers(
-	vtek::Model* model, const vtek::ModelInfo* info, vtek::Device* device)
+// Bounds from the accessor's min and max, which glTF requires for positions
+static vtek::BoundingBox get_gltf_bounds(
+	const vtek::GltfDocument* doc, const GltfVertexRange& range)
 {
-	// Positions
-	vtek::BufferInfo bufferInfo{};
-	bufferInfo.size = sizeof(glm::vec3) * model->vertices.size();
-	bufferInfo.writePolicy = vtek::BufferWritePolicy::write_once;
-
-	using BUFlag = vtek::BufferUsageFlag;
-	bufferInfo.usageFlags = BUFlag::transfer_dst | BUFlag::vertex_buffer;
-
-	model->vertexBuffer = vtek::buffer_create(&bufferInfo, device);
-	if (model->vertexBuffer == nullptr)
+	const vtek::GltfAccessor& accessor = doc->accessors[range.position];
+	if (accessor.hasBounds)
 	{
-		vtek_log_error("Failed to create vertex buffer for model vertices!");
-		return false;
+		return { accessor.min, accessor.max };
 	}
 
-	vtek::BufferRegion region {
-		.offset = 0,
-		.size = bufferInfo.size
-	};
-	// TODO: We could do `vtek::buffer_write_data(buffers[], void* data[], region[], device)` ?
-	// TODO: This is a REALLY good todo! :)
-	if (!vtek::buffer_write_data(
-		    model->vertexBuffer, model->vertices.data(), &region, device))
+	const uint8_t* data = get_packed_data(
+		doc, range.position, vtek::GltfComponentType::float32, 3);
+	glm::vec3 v;
+	std::memcpy(&v, data, sizeof(v));
+	vtek::BoundingBox box { v, v };
+	for (uint32_t i = 1; i < range.numVertices; i++)
 	{
-		vtek_log_error("Failed to write data to model vertex buffer!");
-		return false;
+		std::memcpy(&v, data + sizeof(v) * i, sizeof(v));
+		box.min = glm::min(box.min, v);
+		box.max = glm::max(box.max, v);
 	}
+	return box;
+}
 
-	// Normals
-	if (info->loadNormals && model->normals.size() > 0)
+// The node hierarchy is validated to be a tree by `gltf_load`
+static void add_gltf_submeshes(
+	GltfModelBuilder& b, vtek::Model* model, uint32_t nodeIndex,
+	const glm::mat4& parentTransform, uint32_t defaultMaterial)
+{
+	const vtek::GltfNode& node = b.doc->nodes[nodeIndex];
+	const glm::mat4 transform = parentTransform * node.transform;
+
+	if (node.mesh >= 0)
 	{
-		model->normalBuffer = vtek::buffer_create(&bufferInfo, device);
-		if (model->normalBuffer == nullptr)
+		const auto& primitives = b.doc->meshes[node.mesh].primitives;
+		for (size_t i = 0; i < primitives.size(); i++)
 		{
-			vtek_log_error("Failed to create vertex buffer for model normals!");
-			return false;
-		}
+			const GltfIndexRange& ir = b.indexRanges[b.primitiveRanges[node.mesh][i]];
+			const GltfVertexRange& vr = b.vertexRanges[ir.vertexRange];
 
-		if (!vtek::buffer_write_data(
-			    model->normalBuffer, model->normals.data(), &region, device))
-		{
-			vtek_log_error("Failed to write data to model normal buffer!");
-			return false;
-		}
-	}
+			vtek::ModelSubmesh submesh{};
+			submesh.firstIndex = ir.firstIndex;
+			submesh.numIndices = ir.numIndices;
+			submesh.vertexOffset = static_cast<int32_t>(vr.baseVertex);
+			submesh.firstVertex = vr.baseVertex;
+			submesh.numVertices = vr.numVertices;
+			submesh.materialIndex = (primitives[i].material >= 0)
+				? static_cast<uint32_t>(primitives[i].material) : defaultMaterial;
+			submesh.transform = transform;
 
-	// Texture coordinates
-	if (info->loadTextureCoordinates && model->texCoords.size() > 0)
-	{
-		bufferInfo.size = sizeof(glm::vec2) * model->vertices.size();
-		model->texCoordBuffer = vtek::buffer_create(&bufferInfo, device);
-		if (model->texCoordBuffer == nullptr)
-		{
-			vtek_log_error("Failed to create vertex buffer for model texcoords!");
-			return false;
-		}
+			const vtek::BoundingBox box = get_gltf_bounds(b.doc, vr);
+			const vtek::BoundingSphere sphere {
+				0.5f * (box.min + box.max), 0.5f * glm::length(box.max - box.min)
+			};
+			submesh.boundingBox = vtek::bounding_box_transform(box, transform);
+			submesh.boundingSphere = vtek::bounding_sphere_transform(sphere, transform);
 
-		region.size = bufferInfo.size;
-		if (!vtek::buffer_write_data(
-			    model->texCoordBuffer, model->texCoords.data(), &region, device))
-		{
-			vtek_log_error("Failed to write data to model texcoord buffer!");
-			return false;
+			model->submeshes.push_back(submesh);
 		}
 	}
 
-	return true;
+	for (uint32_t child : node.children)
+	{
+		add_gltf_submeshes(b, model, child, transform, defaultMaterial);
+	}
 }
 
-static void destroy_model_buffers(vtek::Model* model, vtek::Device* device)
+static GltfLoadResult load_gltf_direct(
+	vtek::Model* model, const vtek::ModelInfo* info,
+	const vtek::Directory* directory, std::string_view filename,
+	vtek::Device* device)
 {
-	if (model->vertexBuffer != nullptr)
+	vtek::GltfDocument doc;
+	if (!vtek::gltf_load(directory, filename, &doc))
 	{
-		vtek::buffer_destroy(model->vertexBuffer);
-		model->vertexBuffer = nullptr;
+		vtek::gltf_release(&doc);
+		return GltfLoadResult::unsupported; // let Assimp report the error
 	}
-	if (model->normalBuffer != nullptr)
+
+	GltfModelBuilder builder;
+	builder.doc = &doc;
+	bool hasPositions = false;
+	const bool supported =
+		check_gltf_attribute(&doc, &vtek::GltfPrimitive::position, 3, &hasPositions) &&
+		hasPositions &&
+		(!info->loadNormals || check_gltf_attribute(
+			&doc, &vtek::GltfPrimitive::normal, 3, &builder.loadNormals)) &&
+		(!info->loadTextureCoordinates || check_gltf_attribute(
+			&doc, &vtek::GltfPrimitive::texCoord, 2, &builder.loadTexCoords));
+
+	// Nothing is written to the model until the file is known to be supported
+	if (!supported || !build_gltf_ranges(builder, model))
 	{
-		vtek::buffer_destroy(model->normalBuffer);
-		model->normalBuffer = nullptr;
+		vtek::gltf_release(&doc);
+		return GltfLoadResult::unsupported;
 	}
-	if (model->texCoordBuffer != nullptr)
+
+	// Primitives without a material use the glTF default material
+	model->materials = doc.materials;
+	const uint32_t defaultMaterial = static_cast<uint32_t>(model->materials.size());
+	bool needsDefault = false;
+	for (const auto& mesh : doc.meshes)
 	{
-		vtek::buffer_destroy(model->texCoordBuffer);
-		model->texCoordBuffer = nullptr;
+		for (const auto& p : mesh.primitives) { needsDefault |= p.material < 0; }
+	}
+	if (needsDefault)
+	{
+		model->materials.emplace_back();
+		model->materials.back().name = "default";
 	}
-}
 
+	for (uint32_t node : doc.sceneNodes)
+	{
+		add_gltf_submeshes(builder, model, node, glm::mat4(1.0f), defaultMaterial);
+	}
+	compute_model_bounds(model);
 
+	build_gltf_upload(builder, model);
+	bool success = create_buffers(model, builder.slots, device);
+	vtek::gltf_release(&doc);
 
-/* models interface */
-vtek::Model* vtek::model_load_obj(
-	const vtek::ModelInfo* info, vtek::Directory* directory,
-	std::string_view filename, vtek::Device* device)
-{
-	Assimp::Importer importer;
+	if (!success)
+	{
+		vtek_log_error("Failed to create buffers for glTF model {}!", filename);
+		destroy_model_buffers(model, device);
+		return GltfLoadResult::failed;
+	}
 
-	// Usage flags for Assimp:
+	vtek_log_debug("Loaded glTF model {} without conversion", filename);
+	return GltfLoadResult::loaded;
+}
 
+static unsigned int get_import_flags(const vtek::ModelInfo* info)
+{
+	// Usage flags for Assimp:
 	unsigned int read_flags = 0;
 	// models should probably always be triangulated if they aren't already
 	// NOTE: Assimp's built-in triangulation doesn't handle polygons that are
@@ -190,8 +1975,10 @@ vtek::Model* vtek::model_load_obj(
 	// before importing.
 	read_flags |= aiProcess_Triangulate;
 
-	// Save some space
-	//read_flags |= aiProcess_JoinIdenticalVertices;
+	// Weld identical vertices, so that the model can be drawn indexed.
+	// This typically shrinks vertex data by a factor 3-6, and allows the
+	// post-transform vertex cache to be utilized.
+	read_flags |= aiProcess_JoinIdenticalVertices;
 
 	// NOTE: Optional UV-flip, might not be needed for Vulkan!
 	if (info->flipUVs) { read_flags |= aiProcess_FlipUVs; }
@@ -208,45 +1995,236 @@ vtek::Model* vtek::model_load_obj(
 	// NOTE: If left-handed coordinate system is needed (e.g. DirectX).
 	//read_flags |= aiProcess_ConvertToLeftHanded;
 
+	return read_flags;
+}
+
+// The entire loading process, from either the source file or the mesh cache
+// into `model`. For asynchronous loads this runs on the worker thread, so
+// it must not touch anything but the model and thread-safe vtek objects.
+static bool load_model(
+	vtek::Model* model, const vtek::ModelInfo* info,
+	const vtek::Directory* directory, std::string_view filename,
+	vtek::Device* device)
+{
 	if (!vtek::file_exists(directory, filename))
 	{
 		vtek_log_error("Cannot load model from obj - file does not exist!");
-		return nullptr;
+		return false;
+	}
+
+	model->arena = info->geometryArena;
+	if (model->arena != nullptr &&
+	    info->vertexLayout != vtek::ModelVertexLayout::separate_buffers)
+	{
+		vtek_log_error("Models in a geometry arena must use separate buffers layout!");
+		return false;
+	}
+
+	// glTF binary data needs neither Assimp nor the mesh cache, if the
+	// accessor layouts match the requested formats
+	if (is_gltf_file(filename) && is_gltf_direct_supported(info))
+	{
+		GltfLoadResult result =
+			load_gltf_direct(model, info, directory, filename, device);
+		if (result != GltfLoadResult::unsupported)
+		{
+			return result == GltfLoadResult::loaded;
+		}
+		vtek_log_debug("glTF model {} requires conversion, using Assimp", filename);
+	}
+
+	// Look for an up-to-date mesh cache file, which bypasses Assimp
+	uint64_t sourceHash = 0UL;
+	uint64_t optionsHash = 0UL;
+	const vtek::Directory* cacheDirectory = nullptr;
+	std::string cacheFilename;
+	if (info->useMeshCache)
+	{
+		sourceHash = hash_source_file(directory, filename);
+		optionsHash = hash_model_options(info);
+		cacheDirectory = (info->meshCacheDirectory != nullptr)
+			? info->meshCacheDirectory : directory;
+		cacheFilename = vtek::mesh_cache_get_filename(
+			filename, info->meshCacheDirectory == nullptr, sourceHash, optionsHash);
+
+		CacheLoadResult cached = load_from_mesh_cache(
+			model, cacheDirectory, cacheFilename, sourceHash, optionsHash, device);
+		if (cached != CacheLoadResult::miss)
+		{
+			return cached == CacheLoadResult::loaded;
+		}
 	}
 
+	Assimp::Importer importer;
 	std::string path = vtek::directory_get_path(directory, filename);
-	const aiScene* scene = importer.ReadFile(path, read_flags);
+	const aiScene* scene = importer.ReadFile(path, get_import_flags(info));
 	if (scene == nullptr || scene->mRootNode == nullptr ||
 	    (scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE))
 	{
 		vtek_log_error("Failed to load scene with assimp: {}",
 		               importer.GetErrorString());
-		return nullptr;
+		return false;
 	}
 
-	auto model = new vtek::Model;
-	// TODO: Pre-routine where we allocate space for all mesh data!
-	// TODO: This will remove need for std::vector reallocations!
-	load_scene_node(model, scene, scene->mRootNode, info);
-	if (!create_buffers(model, info, device))
+	load_scene(model, scene, info);
+	compute_model_bounds(model);
+	if (model->indices.empty())
+	{
+		vtek_log_error("Loaded model contains no triangles!");
+		release_vertex_data(model);
+		return false;
+	}
+
+	ModelBufferData bufferData;
+	build_buffer_data(model, info, bufferData);
+
+	const void* data[vtek::kMeshCacheNumSlots];
+	uint64_t sizes[vtek::kMeshCacheNumSlots];
+	for (uint32_t i = 0; i < vtek::kMeshCacheNumSlots; i++)
+	{
+		data[i] = bufferData.slots[i].data();
+		sizes[i] = bufferData.slots[i].size();
+	}
+
+	if (!create_buffers(model, data, sizes, device))
 	{
 		vtek_log_error("Failed to create buffers for loaded model!");
 		destroy_model_buffers(model, device);
+		release_vertex_data(model);
+		return false;
+	}
+
+	model->numVertices = model->vertices.size();
+	model->numIndices = model->indices.size();
+
+	if (info->useMeshCache)
+	{
+		vtek::MeshCacheHeader header{};
+		header.sourceHash = sourceHash;
+		header.optionsHash = optionsHash;
+		fill_cache_header(model, header);
+
+		if (!vtek::mesh_cache_write(cacheDirectory, cacheFilename, header, data, sizes))
+		{
+			vtek_log_warn("Failed to write mesh cache file for model!");
+		}
+	}
+
+	release_vertex_data(model);
+
+	return true;
+}
+
+static void set_load_state(vtek::Model* model, vtek::ModelLoadState state)
+{
+	{
+		std::lock_guard<std::mutex> lock(model->loadMutex);
+		model->loadState = state;
+	}
+	model->loadCondition.notify_all();
+}
+
+
+
+/* models interface */
+vtek::Model* vtek::model_load_obj(
+	const vtek::ModelInfo* info, vtek::Directory* directory,
+	std::string_view filename, vtek::Device* device)
+{
+	auto model = new vtek::Model;
+	if (!load_model(model, info, directory, filename, device))
+	{
 		delete model;
 		return nullptr;
 	}
 
-	model->numVertices = model->vertices.size();
-	model->vertices.clear();
-	model->normals.clear();
+	return model;
+}
+
+vtek::Model* vtek::model_load_scene(
+	const vtek::ModelInfo* info, vtek::Directory* directory,
+	std::string_view filename, vtek::Device* device)
+{
+	vtek::ModelInfo sceneInfo = *info;
+	sceneInfo.separateSubmeshes = true;
+
+	return vtek::model_load_obj(&sceneInfo, directory, filename, device);
+}
+
+vtek::Model* vtek::model_load_gltf(
+	const vtek::ModelInfo* info, vtek::Directory* directory,
+	std::string_view filename, vtek::Device* device)
+{
+	if (!is_gltf_file(filename))
+	{
+		vtek_log_error("Cannot load model {} as glTF - not a .gltf or .glb file!", filename);
+		return nullptr;
+	}
+
+	vtek::ModelInfo sceneInfo = *info;
+	sceneInfo.separateSubmeshes = true;
+	if (!is_gltf_direct_supported(&sceneInfo))
+	{
+		vtek_log_debug("Model options for {} require conversion, using Assimp", filename);
+	}
+
+	return vtek::model_load_obj(&sceneInfo, directory, filename, device);
+}
+
+vtek::Model* vtek::model_load_async(
+	const vtek::ModelInfo* info, vtek::Directory* directory,
+	std::string_view filename, vtek::Device* device,
+	vtek::ModelLoadCallback callback)
+{
+	auto model = new vtek::Model;
+	model->loadState = vtek::ModelLoadState::loading;
+
+	// The info and filename are copied, since the caller's copies may be
+	// gone before the worker thread gets to use them.
+	model->loadThread = std::thread(
+		[model, info = *info, directory, name = std::string(filename), device,
+		 callback = std::move(callback)]() {
+			bool success = load_model(model, &info, directory, name, device);
+			set_load_state(model, success
+			               ? vtek::ModelLoadState::ready
+			               : vtek::ModelLoadState::failed);
+
+			if (callback) { callback(model, success); }
+		});
 
 	return model;
 }
 
+vtek::ModelLoadState vtek::model_get_load_state(vtek::Model* model)
+{
+	return model->loadState.load();
+}
+
+bool vtek::model_is_ready(vtek::Model* model)
+{
+	return model->loadState.load() == vtek::ModelLoadState::ready;
+}
+
+bool vtek::model_wait(vtek::Model* model)
+{
+	std::unique_lock<std::mutex> lock(model->loadMutex);
+	model->loadCondition.wait(lock, [model]() {
+		return model->loadState.load() != vtek::ModelLoadState::loading;
+	});
+
+	return model->loadState.load() == vtek::ModelLoadState::ready;
+}
+
 void vtek::model_destroy(vtek::Model* model, vtek::Device* device)
 {
 	if (model == nullptr) { return; }
 
+	// An asynchronous load cannot be cancelled, so wait for it to finish
+	if (model->loadThread.joinable())
+	{
+		model->loadThread.join();
+	}
+
 	destroy_model_buffers(model, device);
 	delete model;
 }
@@ -270,3 +2248,105 @@ uint32_t vtek::model_get_num_vertices(vtek::Model* model)
 {
 	return model->numVertices;
 }
+
+const vtek::Buffer* vtek::model_get_index_buffer(vtek::Model* model)
+{
+	return model->indexBuffer;
+}
+
+uint32_t vtek::model_get_num_indices(vtek::Model* model)
+{
+	return model->numIndices;
+}
+
+vtek::IndexType vtek::model_get_index_type(vtek::Model* model)
+{
+	return model->indexType;
+}
+
+vtek::ModelVertexLayout vtek::model_get_vertex_layout(vtek::Model* model)
+{
+	return model->vertexLayout;
+}
+
+uint32_t vtek::model_get_vertex_stride(vtek::Model* model)
+{
+	return model->vertexStride;
+}
+
+uint64_t vtek::model_get_normal_offset(vtek::Model* model)
+{
+	return model->normalOffset;
+}
+
+uint64_t vtek::model_get_texcoord_offset(vtek::Model* model)
+{
+	return model->texCoordOffset;
+}
+
+uint64_t vtek::model_get_index_offset(vtek::Model* model)
+{
+	return model->indexOffset;
+}
+
+vtek::VertexAttributeType vtek::model_get_position_type(vtek::Model* model)
+{
+	return model->positionType;
+}
+
+vtek::VertexAttributeType vtek::model_get_normal_type(vtek::Model* model)
+{
+	return model->normalType;
+}
+
+vtek::VertexAttributeType vtek::model_get_texcoord_type(vtek::Model* model)
+{
+	return model->texCoordType;
+}
+
+const vtek::ModelDequantization* vtek::model_get_dequantization(vtek::Model* model)
+{
+	return &model->dequantization;
+}
+
+uint32_t vtek::model_get_num_submeshes(vtek::Model* model)
+{
+	return static_cast<uint32_t>(model->submeshes.size());
+}
+
+const vtek::ModelSubmesh* vtek::model_get_submeshes(vtek::Model* model)
+{
+	return model->submeshes.data();
+}
+
+uint32_t vtek::model_get_num_materials(vtek::Model* model)
+{
+	return static_cast<uint32_t>(model->materials.size());
+}
+
+const vtek::ModelMaterial* vtek::model_get_material(vtek::Model* model, uint32_t index)
+{
+	if (index >= model->materials.size()) { return nullptr; }
+
+	return &model->materials[index];
+}
+
+const vtek::BoundingBox* vtek::model_get_bounding_box(vtek::Model* model)
+{
+	return &model->boundingBox;
+}
+
+const vtek::BoundingSphere* vtek::model_get_bounding_sphere(vtek::Model* model)
+{
+	return &model->boundingSphere;
+}
+
+uint32_t vtek::model_get_base_vertex(vtek::Model* model)
+{
+	return model->arenaRange.baseVertex;
+}
+
+uint32_t vtek::model_get_first_index(vtek::Model* model)
+{
+	return model->arenaRange.firstIndex;
+}
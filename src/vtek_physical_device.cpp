@@ -278,6 +278,49 @@ static bool has_required_extension_support(
 		support->dynamicRendering = true;
 	}
 
+	// push descriptors
+	if (info->requirePushDescriptors)
+	{
+		bool hasPushDescriptor = my_find_if(VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME);
+		if (!hasPushDescriptor)
+		{
+			vtek_log_error("Push descriptor extension not supported!");
+			return false;
+		}
+		requiredExtRef.push_back(VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME);
+
+		support->pushDescriptor = true;
+	}
+
+	// draw indirect count
+	if (info->requireDrawIndirectCount)
+	{
+		bool hasDrawIndirectCount =
+			my_find_if(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+		if (!hasDrawIndirectCount)
+		{
+			vtek_log_error("Draw indirect count extension not supported!");
+			return false;
+		}
+		requiredExtRef.push_back(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+
+		support->drawIndirectCount = true;
+	}
+
+	// synchronization2
+	if (info->requireSynchronization2)
+	{
+		bool hasSync2 = my_find_if(VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME);
+		if (!hasSync2)
+		{
+			vtek_log_error("Synchronization2 extension not supported!");
+			return false;
+		}
+		requiredExtRef.push_back(VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME);
+
+		support->synchronization2 = true;
+	}
+
 	// NEXT: More extension checks may be added here..
 
 	return true;
@@ -0,0 +1,299 @@
+#include "vtek_vulkan.pch"
+#include "vtek_query_pool.hpp"
+
+#include "vtek_command_buffer.hpp"
+#include "vtek_device.hpp"
+#include "vtek_logging.hpp"
+
+#include <vector>
+
+
+/* struct implementation */
+struct vtek::QueryPool
+{
+	VkQueryPool vulkanHandle {VK_NULL_HANDLE};
+	VkDevice device {VK_NULL_HANDLE};
+	vtek::QueryType type {vtek::QueryType::occlusion};
+	vtek::EnumBitmask<vtek::PipelineStatisticFlag> pipelineStatistics {0U};
+	bool preciseSupported {false};
+
+	uint32_t numQueries {0U};
+	uint32_t numFrames {0U};
+	uint32_t numValues {1U}; // per query, more than one for pipeline statistics
+
+	// Frame being recorded, and which frames have had their range reset,
+	// since results may only be read from queries that have been reset.
+	uint32_t currentFrame {UINT32_MAX};
+	std::vector<bool> frameReset;
+
+	// Results of the frame read back last, and the raw results including
+	// availability, reused between frames.
+	std::vector<uint64_t> results;
+	std::vector<bool> available;
+	std::vector<uint64_t> readback;
+};
+
+
+
+/* helper functions */
+using QType = vtek::QueryType;
+
+static VkQueryType get_query_type(vtek::QueryType type)
+{
+	switch (type)
+	{
+	case QType::occlusion:           return VK_QUERY_TYPE_OCCLUSION;
+	case QType::pipeline_statistics: return VK_QUERY_TYPE_PIPELINE_STATISTICS;
+	case QType::timestamp:           return VK_QUERY_TYPE_TIMESTAMP;
+	default:
+		vtek_log_error("vtek_query_pool.cpp: Invalid query type!");
+		return VK_QUERY_TYPE_OCCLUSION;
+	}
+}
+
+static uint32_t count_bits(uint32_t mask)
+{
+	uint32_t count = 0U;
+	for (; mask != 0U; mask &= mask - 1) { count++; }
+	return count;
+}
+
+static bool validate_query(vtek::QueryPool* pool, uint32_t query, const char* func)
+{
+	if (pool->currentFrame == UINT32_MAX)
+	{
+		vtek_log_error("{}(): query_pool_begin_frame() not called!", func);
+		return false;
+	}
+	if (query >= pool->numQueries)
+	{
+		vtek_log_error("{}(): Query index {} out of range!", func, query);
+		return false;
+	}
+	return true;
+}
+
+
+
+/* interface */
+vtek::QueryPool* vtek::query_pool_create(
+	const vtek::QueryPoolInfo* info, vtek::Device* device)
+{
+	if (info->numQueries == 0U || info->numFrames == 0U)
+	{
+		vtek_log_error("Query pool must have non-zero query and frame count!");
+		return nullptr;
+	}
+
+	const VkPhysicalDeviceFeatures* features = vtek::device_get_enabled_features(device);
+	if (info->type == QType::pipeline_statistics)
+	{
+		if (!features->pipelineStatisticsQuery)
+		{
+			vtek_log_error("pipelineStatisticsQuery feature not enabled -- {}",
+			               "cannot create pipeline statistics query pool!");
+			return nullptr;
+		}
+		if (info->pipelineStatistics.empty())
+		{
+			vtek_log_error("No pipeline statistics specified -- {}",
+			               "cannot create pipeline statistics query pool!");
+			return nullptr;
+		}
+	}
+
+	auto pool = new vtek::QueryPool;
+	pool->device = vtek::device_get_handle(device);
+	pool->type = info->type;
+	pool->preciseSupported = features->occlusionQueryPrecise;
+	pool->numQueries = info->numQueries;
+	pool->numFrames = info->numFrames;
+
+	VkQueryPoolCreateInfo createInfo{};
+	createInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+	createInfo.pNext = nullptr;
+	createInfo.flags = 0;
+	createInfo.queryType = get_query_type(info->type);
+	createInfo.queryCount = info->numQueries * info->numFrames;
+	createInfo.pipelineStatistics = 0;
+
+	if (info->type == QType::pipeline_statistics)
+	{
+		// The flags have the same values as the Vulkan bits
+		pool->pipelineStatistics = info->pipelineStatistics;
+		createInfo.pipelineStatistics = info->pipelineStatistics.get();
+		pool->numValues = count_bits(info->pipelineStatistics.get());
+	}
+
+	VkResult result = vkCreateQueryPool(
+		pool->device, &createInfo, nullptr, &pool->vulkanHandle);
+	if (result != VK_SUCCESS)
+	{
+		vtek_log_error("Failed to create query pool!");
+		delete pool;
+		return nullptr;
+	}
+
+	pool->frameReset.assign(info->numFrames, false);
+	pool->results.assign(info->numQueries * pool->numValues, 0UL);
+	pool->available.assign(info->numQueries, false);
+
+	return pool;
+}
+
+void vtek::query_pool_destroy(vtek::QueryPool* pool)
+{
+	if (pool == nullptr) return;
+
+	vkDestroyQueryPool(pool->device, pool->vulkanHandle, nullptr);
+	pool->vulkanHandle = VK_NULL_HANDLE;
+
+	delete pool;
+}
+
+void vtek::query_pool_begin_frame(
+	vtek::QueryPool* pool, vtek::CommandBuffer* commandBuffer, uint32_t frameIndex)
+{
+	if (frameIndex >= pool->numFrames)
+	{
+		vtek_log_error("Query pool frame index {} out of range!", frameIndex);
+		frameIndex = frameIndex % pool->numFrames;
+	}
+
+	const uint32_t firstQuery = frameIndex * pool->numQueries;
+
+	// Each query's values are followed by its availability. Queries that
+	// were not recorded in the frame stay unavailable after the reset.
+	if (pool->frameReset[frameIndex])
+	{
+		const uint32_t stride = pool->numValues + 1;
+		pool->readback.assign(pool->numQueries * stride, 0UL);
+		vkGetQueryPoolResults(
+			pool->device, pool->vulkanHandle, firstQuery, pool->numQueries,
+			pool->readback.size() * sizeof(uint64_t), pool->readback.data(),
+			stride * sizeof(uint64_t),
+			VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+
+		for (uint32_t q = 0; q < pool->numQueries; q++)
+		{
+			const uint64_t* src = &pool->readback[q * stride];
+			pool->available[q] = (src[pool->numValues] != 0UL);
+			if (!pool->available[q]) { continue; }
+
+			for (uint32_t v = 0; v < pool->numValues; v++)
+			{
+				pool->results[q * pool->numValues + v] = src[v];
+			}
+		}
+	}
+
+	VkCommandBuffer cmdBuf = vtek::command_buffer_get_handle(commandBuffer);
+	vkCmdResetQueryPool(cmdBuf, pool->vulkanHandle, firstQuery, pool->numQueries);
+
+	pool->frameReset[frameIndex] = true;
+	pool->currentFrame = frameIndex;
+}
+
+void vtek::cmd_begin_query(
+	vtek::CommandBuffer* commandBuffer, vtek::QueryPool* pool, uint32_t query,
+	bool precise)
+{
+	if (!validate_query(pool, query, "cmd_begin_query")) { return; }
+	if (pool->type == QType::timestamp)
+	{
+		vtek_log_error("cmd_begin_query(): {}",
+		               "Timestamp queries are written with cmd_write_timestamp()!");
+		return;
+	}
+
+	VkQueryControlFlags flags = 0;
+	if (precise && pool->type == QType::occlusion)
+	{
+		if (pool->preciseSupported) { flags |= VK_QUERY_CONTROL_PRECISE_BIT; }
+		else
+		{
+			vtek_log_warn("occlusionQueryPrecise feature not enabled -- {}",
+			              "query will not be precise!");
+		}
+	}
+
+	VkCommandBuffer cmdBuf = vtek::command_buffer_get_handle(commandBuffer);
+	vkCmdBeginQuery(
+		cmdBuf, pool->vulkanHandle, pool->currentFrame * pool->numQueries + query, flags);
+}
+
+void vtek::cmd_end_query(
+	vtek::CommandBuffer* commandBuffer, vtek::QueryPool* pool, uint32_t query)
+{
+	if (!validate_query(pool, query, "cmd_end_query")) { return; }
+	if (pool->type == QType::timestamp) { return; }
+
+	VkCommandBuffer cmdBuf = vtek::command_buffer_get_handle(commandBuffer);
+	vkCmdEndQuery(cmdBuf, pool->vulkanHandle, pool->currentFrame * pool->numQueries + query);
+}
+
+void vtek::cmd_write_timestamp(
+	vtek::CommandBuffer* commandBuffer, vtek::QueryPool* pool, uint32_t query)
+{
+	if (!validate_query(pool, query, "cmd_write_timestamp")) { return; }
+	if (pool->type != QType::timestamp)
+	{
+		vtek_log_error("cmd_write_timestamp(): Query pool is not a timestamp pool!");
+		return;
+	}
+
+	VkCommandBuffer cmdBuf = vtek::command_buffer_get_handle(commandBuffer);
+	vkCmdWriteTimestamp(
+		cmdBuf, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, pool->vulkanHandle,
+		pool->currentFrame * pool->numQueries + query);
+}
+
+bool vtek::query_pool_get_result(vtek::QueryPool* pool, uint32_t query, uint64_t* outResult)
+{
+	if (query >= pool->numQueries || !pool->available[query]) { return false; }
+
+	*outResult = pool->results[query * pool->numValues];
+	return true;
+}
+
+bool vtek::query_pool_get_pipeline_statistics(
+	vtek::QueryPool* pool, uint32_t query, vtek::PipelineStatistics* outStatistics)
+{
+	if (pool->type != QType::pipeline_statistics)
+	{
+		vtek_log_error("Query pool is not a pipeline statistics pool!");
+		return false;
+	}
+	if (query >= pool->numQueries || !pool->available[query]) { return false; }
+
+	// Same order as the flags
+	uint64_t* fields[] = {
+		&outStatistics->inputAssemblyVertices,
+		&outStatistics->inputAssemblyPrimitives,
+		&outStatistics->vertexShaderInvocations,
+		&outStatistics->geometryShaderInvocations,
+		&outStatistics->geometryShaderPrimitives,
+		&outStatistics->clippingInvocations,
+		&outStatistics->clippingPrimitives,
+		&outStatistics->fragmentShaderInvocations,
+		&outStatistics->tessellationControlShaderPatches,
+		&outStatistics->tessellationEvaluationShaderInvocations,
+		&outStatistics->computeShaderInvocations
+	};
+
+	*outStatistics = vtek::PipelineStatistics{};
+	const uint64_t* values = &pool->results[query * pool->numValues];
+	const uint32_t mask = pool->pipelineStatistics.get();
+	uint32_t v = 0U;
+	for (uint32_t bit = 0; bit < 11; bit++)
+	{
+		if (mask & (1U << bit)) { *fields[bit] = values[v++]; }
+	}
+
+	return true;
+}
+
+uint32_t vtek::query_pool_get_num_queries(vtek::QueryPool* pool)
+{
+	return pool->numQueries;
+}
@@ -33,6 +33,7 @@ uint32_t vtek::queue_get_family_index(const vtek::Queue* queue)
 
 void vtek::queue_wait_idle(const vtek::Queue* queue)
 {
+	std::lock_guard<std::mutex> lock(*queue->mutex);
 	vkQueueWaitIdle(queue->vulkanHandle);
 }
 
@@ -62,9 +63,19 @@ bool vtek::queue_submit(
 {
 	VkCommandBuffer buf = vtek::command_buffer_get_handle(commandBuffer);
 
+	// Values of timeline semaphores, one for each semaphore
+	const VkTimelineSemaphoreSubmitInfo timelineInfo = {
+		.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
+		.pNext = nullptr,
+		.waitSemaphoreValueCount = submitInfo->NumWaitSemaphores(),
+		.pWaitSemaphoreValues = submitInfo->WaitSemaphoreValues(),
+		.signalSemaphoreValueCount = submitInfo->NumSignalSemaphores(),
+		.pSignalSemaphoreValues = submitInfo->SignalSemaphoreValues()
+	};
+
 	const VkSubmitInfo info = {
 		.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
-		.pNext = nullptr,
+		.pNext = submitInfo->HasTimelineValues() ? &timelineInfo : nullptr,
 		.waitSemaphoreCount = submitInfo->NumWaitSemaphores(),
 		.pWaitSemaphores = submitInfo->WaitSemaphores(),
 		.pWaitDstStageMask = submitInfo->WaitPipelineStages(),
@@ -74,7 +85,14 @@ bool vtek::queue_submit(
 		.pSignalSemaphores = submitInfo->SignalSemaphores()
 	};
 
+	std::lock_guard<std::mutex> lock(*queue->mutex);
 	VkResult result = vkQueueSubmit(
 		queue->vulkanHandle, 1, &info, submitInfo->PostSignalFence());
 	return result == VK_SUCCESS;
 }
+
+VkResult vtek::queue_present(vtek::Queue* queue, const VkPresentInfoKHR* presentInfo)
+{
+	std::lock_guard<std::mutex> lock(*queue->mutex);
+	return vkQueuePresentKHR(queue->vulkanHandle, presentInfo);
+}
@@ -0,0 +1,656 @@
+#include "vtek_vulkan.pch"
+#include "vtek_render_graph.hpp"
+
+#include "impl/vtek_vma_helpers.hpp"
+#include "vtek_device.hpp"
+#include "vtek_framebuffer.hpp"
+#include "vtek_image.hpp"
+#include "vtek_logging.hpp"
+
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+/* struct implementation */
+struct GraphResource
+{
+	vtek::Image2D* image {nullptr};
+	vtek::Buffer* buffer {nullptr};
+	bool transient {false};
+
+	// Transient images only
+	vtek::RenderGraphImageInfo info {};
+	vtek::EnumBitmask<vtek::ImageUsageFlag> usageFlags {0U};
+	uint32_t firstPass {vtek::kRenderGraphInvalidId};
+	uint32_t lastPass {vtek::kRenderGraphInvalidId};
+	VkMemoryRequirements requirements {};
+	uint64_t offset {0UL};
+	bool placed {false};
+
+	// Transients sharing memory with this one
+	std::vector<uint32_t> aliases;
+};
+
+struct GraphAccess
+{
+	uint32_t resource;
+	vtek::ImageAccessType imageAccess;
+	vtek::BufferAccessType bufferAccess;
+	bool write;
+
+	// Image usage of every access that was merged into this one, since the
+	// merged access type alone does not tell, see `add_access`.
+	vtek::EnumBitmask<vtek::ImageUsageFlag> imageUsage {0U};
+
+	// Attachments of a framebuffer, transitioned by the framebuffer itself
+	bool external;
+};
+
+struct GraphPass
+{
+	std::string name;
+	vtek::RenderGraphExecuteFn fn;
+	std::vector<GraphAccess> accesses;
+	bool sideEffects {false};
+	bool culled {false};
+};
+
+struct vtek::RenderGraph
+{
+	vtek::Device* device {nullptr};
+	vtek::BarrierBatch* barriers {nullptr};
+
+	std::vector<GraphResource> resources;
+	std::unordered_map<const void*, uint32_t> imported;
+	std::vector<GraphPass> passes;
+
+	VmaAllocation transientMemory {VK_NULL_HANDLE};
+	bool compiled {false};
+	vtek::RenderGraphStats stats {};
+};
+
+
+
+/* helper functions */
+using IAType = vtek::ImageAccessType;
+using IUFlag = vtek::ImageUsageFlag;
+
+static uint64_t align_up(uint64_t value, uint64_t alignment)
+{
+	return (value + alignment - 1) / alignment * alignment;
+}
+
+static IUFlag get_image_usage(vtek::ImageAccessType access)
+{
+	switch (access)
+	{
+	case IAType::color_attachment_write:
+		return IUFlag::color_attachment;
+	case IAType::depth_stencil_attachment_write:
+	case IAType::depth_stencil_attachment_read:
+		return IUFlag::depth_stencil_attachment;
+	case IAType::vertex_shader_read:
+	case IAType::fragment_shader_read:
+	case IAType::compute_shader_read:
+	case IAType::any_shader_read:
+		return IUFlag::sampled;
+	case IAType::transfer_src:
+		return IUFlag::transfer_src;
+	case IAType::transfer_dst:
+		return IUFlag::transfer_dst;
+	case IAType::compute_shader_write:
+	case IAType::general:
+	default:
+		return IUFlag::storage;
+	}
+}
+
+static vtek::Image2DInfo get_transient_image_info(const GraphResource& res)
+{
+	vtek::Image2DInfo info{};
+	info.extent = res.info.extent;
+	info.supportedFormat = res.info.supportedFormat;
+	info.usageFlags = res.usageFlags;
+	info.multisampling = res.info.multisampling;
+	info.createImageView = true;
+
+	// Sampled depth/stencil views may only include one aspect
+	const auto& format = res.info.supportedFormat;
+	if (format.has_depth())
+	{
+		info.imageViewInfo.aspectFlags = vtek::ImageAspectFlag::depth;
+		if (format.has_stencil() && !res.usageFlags.has_flag(IUFlag::sampled))
+		{
+			info.imageViewInfo.aspectFlags.add_flag(vtek::ImageAspectFlag::stencil);
+		}
+	}
+	else if (format.has_stencil())
+	{
+		info.imageViewInfo.aspectFlags = vtek::ImageAspectFlag::stencil;
+	}
+	else
+	{
+		info.imageViewInfo.aspectFlags = vtek::ImageAspectFlag::color;
+	}
+
+	return info;
+}
+
+static bool lifetimes_overlap(const GraphResource& a, const GraphResource& b)
+{
+	return a.firstPass <= b.lastPass && b.firstPass <= a.lastPass;
+}
+
+static bool memory_overlaps(const GraphResource& a, const GraphResource& b)
+{
+	return a.offset < b.offset + b.requirements.size &&
+		b.offset < a.offset + a.requirements.size;
+}
+
+static bool validate_pass(vtek::RenderGraph* graph, uint32_t pass, const char* func)
+{
+	if (pass >= graph->passes.size())
+	{
+		vtek_log_error("{}(): Invalid render graph pass id {}!", func, pass);
+		return false;
+	}
+	if (graph->compiled)
+	{
+		vtek_log_error("{}(): Render graph is already compiled -- {}", func,
+		               "call render_graph_reset() before changing it!");
+		return false;
+	}
+	return true;
+}
+
+static void add_access(GraphPass& pass, const GraphAccess& access)
+{
+	// Barriers for the same resource may not be batched together, so a
+	// pass accessing a resource in different ways falls back to general.
+	for (auto& a : pass.accesses)
+	{
+		if (a.resource != access.resource) { continue; }
+
+		if (a.imageAccess != access.imageAccess ||
+		    a.bufferAccess != access.bufferAccess)
+		{
+			a.imageAccess = IAType::general;
+			a.bufferAccess = vtek::BufferAccessType::general;
+		}
+		a.imageUsage.add_flag(get_image_usage(access.imageAccess));
+		a.write = a.write || access.write;
+		a.external = a.external && access.external;
+		return;
+	}
+	pass.accesses.push_back(access);
+	pass.accesses.back().imageUsage = get_image_usage(access.imageAccess);
+}
+
+// Greedy placement, largest first: each transient goes at the lowest
+// offset where it does not overlap any placed transient which is alive
+// at the same time. Returns the total size.
+static uint64_t place_transients(
+	std::vector<GraphResource>& resources, const std::vector<uint32_t>& transients,
+	VkMemoryRequirements* outRequirements)
+{
+	std::vector<uint32_t> order = transients;
+	std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+		return resources[a].requirements.size > resources[b].requirements.size;
+	});
+
+	uint64_t totalSize = 0UL;
+	uint64_t alignment = 1UL;
+	uint32_t memoryTypeBits = UINT32_MAX;
+	std::vector<uint32_t> placed;
+	std::vector<uint64_t> candidates;
+
+	for (uint32_t t : order)
+	{
+		GraphResource& res = resources[t];
+		if ((memoryTypeBits & res.requirements.memoryTypeBits) == 0U)
+		{
+			// Incompatible memory type, so the image gets its own allocation
+			continue;
+		}
+
+		candidates.assign(1, 0UL);
+		for (uint32_t p : placed)
+		{
+			const GraphResource& other = resources[p];
+			candidates.push_back(align_up(
+				other.offset + other.requirements.size, res.requirements.alignment));
+		}
+		std::sort(candidates.begin(), candidates.end());
+
+		for (uint64_t offset : candidates)
+		{
+			res.offset = offset;
+			bool fits = true;
+			for (uint32_t p : placed)
+			{
+				const GraphResource& other = resources[p];
+				if (lifetimes_overlap(res, other) && memory_overlaps(res, other))
+				{
+					fits = false;
+					break;
+				}
+			}
+			if (fits) { break; }
+		}
+
+		res.placed = true;
+		placed.push_back(t);
+		memoryTypeBits &= res.requirements.memoryTypeBits;
+		alignment = std::max(alignment, res.requirements.alignment);
+		totalSize = std::max(totalSize, res.offset + res.requirements.size);
+	}
+
+	outRequirements->size = totalSize;
+	outRequirements->alignment = alignment;
+	outRequirements->memoryTypeBits = memoryTypeBits;
+
+	return totalSize;
+}
+
+static void destroy_transients(vtek::RenderGraph* graph)
+{
+	for (auto& res : graph->resources)
+	{
+		if (!res.transient || res.image == nullptr) { continue; }
+
+		vtek::image2d_destroy(res.image, graph->device);
+		res.image = nullptr;
+	}
+
+	if (graph->transientMemory != VK_NULL_HANDLE)
+	{
+		vtek::Allocator* allocator = vtek::device_get_allocator(graph->device);
+		vtek::allocator_memory_free(allocator, graph->transientMemory);
+		graph->transientMemory = VK_NULL_HANDLE;
+	}
+}
+
+// The first use of a transient image must wait for the last uses of the
+// transients it shares memory with, so their stages are merged into its
+// tracked state before the barrier is made.
+static void merge_alias_states(vtek::RenderGraph* graph, GraphResource& res)
+{
+	vtek::ImageSubresourceState aliasState{};
+	for (uint32_t a : res.aliases)
+	{
+		const vtek::Image2D* alias = graph->resources[a].image;
+		for (const auto& state : alias->subresourceStates)
+		{
+			aliasState.writeStages |= state.writeStages | state.readStages;
+			aliasState.writeAccess |= state.writeAccess;
+		}
+	}
+
+	for (auto& state : res.image->subresourceStates)
+	{
+		state.writeStages |= aliasState.writeStages;
+		state.writeAccess |= aliasState.writeAccess;
+	}
+}
+
+
+
+/* interface */
+vtek::RenderGraph* vtek::render_graph_create(vtek::Device* device)
+{
+	auto graph = new vtek::RenderGraph;
+	graph->device = device;
+	graph->barriers = vtek::barrier_batch_create(device);
+
+	return graph;
+}
+
+void vtek::render_graph_destroy(vtek::RenderGraph* graph)
+{
+	if (graph == nullptr) return;
+
+	destroy_transients(graph);
+	vtek::barrier_batch_destroy(graph->barriers);
+	graph->barriers = nullptr;
+
+	delete graph;
+}
+
+void vtek::render_graph_reset(vtek::RenderGraph* graph)
+{
+	destroy_transients(graph);
+
+	graph->resources.clear();
+	graph->imported.clear();
+	graph->passes.clear();
+	graph->compiled = false;
+	graph->stats = vtek::RenderGraphStats{};
+}
+
+uint32_t vtek::render_graph_import_image(vtek::RenderGraph* graph, vtek::Image2D* image)
+{
+	auto it = graph->imported.find(image);
+	if (it != graph->imported.end()) { return it->second; }
+
+	const uint32_t id = static_cast<uint32_t>(graph->resources.size());
+	graph->resources.emplace_back();
+	graph->resources.back().image = image;
+	graph->imported.emplace(image, id);
+
+	return id;
+}
+
+uint32_t vtek::render_graph_import_buffer(vtek::RenderGraph* graph, vtek::Buffer* buffer)
+{
+	auto it = graph->imported.find(buffer);
+	if (it != graph->imported.end()) { return it->second; }
+
+	const uint32_t id = static_cast<uint32_t>(graph->resources.size());
+	graph->resources.emplace_back();
+	graph->resources.back().buffer = buffer;
+	graph->imported.emplace(buffer, id);
+
+	return id;
+}
+
+uint32_t vtek::render_graph_create_image(
+	vtek::RenderGraph* graph, const vtek::RenderGraphImageInfo* info)
+{
+	if (info->extent.width == 0U || info->extent.height == 0U ||
+	    !info->supportedFormat.is_valid())
+	{
+		vtek_log_error("Invalid extent or format -- {}",
+		               "cannot create render graph image!");
+		return vtek::kRenderGraphInvalidId;
+	}
+
+	const uint32_t id = static_cast<uint32_t>(graph->resources.size());
+	graph->resources.emplace_back();
+	graph->resources.back().transient = true;
+	graph->resources.back().info = *info;
+
+	return id;
+}
+
+uint32_t vtek::render_graph_add_pass(
+	vtek::RenderGraph* graph, std::string_view name, vtek::RenderGraphExecuteFn fn)
+{
+	if (graph->compiled)
+	{
+		vtek_log_error("Render graph is already compiled -- cannot add pass!");
+		return vtek::kRenderGraphInvalidId;
+	}
+
+	graph->passes.emplace_back();
+	graph->passes.back().name = name;
+	graph->passes.back().fn = std::move(fn);
+
+	return static_cast<uint32_t>(graph->passes.size() - 1);
+}
+
+void vtek::render_graph_pass_use_image(
+	vtek::RenderGraph* graph, uint32_t pass, uint32_t image,
+	vtek::ImageAccessType access)
+{
+	if (!validate_pass(graph, pass, "render_graph_pass_use_image")) { return; }
+	if (image >= graph->resources.size() || graph->resources[image].buffer != nullptr)
+	{
+		vtek_log_error("Invalid render graph image id {} -- cannot use in pass \"{}\"!",
+		               image, graph->passes[pass].name);
+		return;
+	}
+
+	GraphAccess a{};
+	a.resource = image;
+	a.imageAccess = access;
+	a.bufferAccess = vtek::BufferAccessType::general;
+	a.write = vtek::image_access_is_write(access);
+	a.external = false;
+	add_access(graph->passes[pass], a);
+}
+
+void vtek::render_graph_pass_use_buffer(
+	vtek::RenderGraph* graph, uint32_t pass, uint32_t buffer,
+	vtek::BufferAccessType access)
+{
+	if (!validate_pass(graph, pass, "render_graph_pass_use_buffer")) { return; }
+	if (buffer >= graph->resources.size() || graph->resources[buffer].buffer == nullptr)
+	{
+		vtek_log_error("Invalid render graph buffer id {} -- cannot use in pass \"{}\"!",
+		               buffer, graph->passes[pass].name);
+		return;
+	}
+
+	GraphAccess a{};
+	a.resource = buffer;
+	a.imageAccess = IAType::general;
+	a.bufferAccess = access;
+	a.write = vtek::buffer_access_is_write(access);
+	a.external = false;
+	add_access(graph->passes[pass], a);
+}
+
+void vtek::render_graph_pass_use_framebuffer(
+	vtek::RenderGraph* graph, uint32_t pass, vtek::Framebuffer* framebuffer)
+{
+	if (!validate_pass(graph, pass, "render_graph_pass_use_framebuffer")) { return; }
+
+	GraphAccess a{};
+	a.bufferAccess = vtek::BufferAccessType::general;
+	a.write = true;
+	a.external = true;
+
+	for (auto image : vtek::framebuffer_get_color_images(framebuffer))
+	{
+		a.resource = vtek::render_graph_import_image(graph, image);
+		a.imageAccess = IAType::color_attachment_write;
+		add_access(graph->passes[pass], a);
+	}
+
+	vtek::Image2D* depthStencil = vtek::framebuffer_get_depth_stencil_image(framebuffer);
+	if (depthStencil != nullptr)
+	{
+		a.resource = vtek::render_graph_import_image(graph, depthStencil);
+		a.imageAccess = IAType::depth_stencil_attachment_write;
+		add_access(graph->passes[pass], a);
+	}
+}
+
+void vtek::render_graph_pass_set_side_effects(vtek::RenderGraph* graph, uint32_t pass)
+{
+	if (!validate_pass(graph, pass, "render_graph_pass_set_side_effects")) { return; }
+
+	graph->passes[pass].sideEffects = true;
+}
+
+bool vtek::render_graph_compile(vtek::RenderGraph* graph)
+{
+	if (graph->compiled)
+	{
+		vtek_log_warn("Render graph is already compiled!");
+		return true;
+	}
+
+	auto& resources = graph->resources;
+	auto& passes = graph->passes;
+	auto& stats = graph->stats;
+	stats = vtek::RenderGraphStats{};
+	stats.numPasses = static_cast<uint32_t>(passes.size());
+
+	// 1) Cull passes, walking backwards. A pass is kept if it has side
+	// effects, or writes something a kept pass uses. Transients written by
+	// a kept pass are also needed, since the write may be partial.
+	std::vector<bool> needed(resources.size(), false);
+	for (auto it = passes.rbegin(); it != passes.rend(); ++it)
+	{
+		GraphPass& pass = *it;
+		bool keep = pass.sideEffects;
+		for (const auto& a : pass.accesses)
+		{
+			if (a.write && (!resources[a.resource].transient || needed[a.resource]))
+			{
+				keep = true;
+			}
+		}
+
+		pass.culled = !keep;
+		if (pass.culled)
+		{
+			stats.numCulledPasses++;
+			continue;
+		}
+		for (const auto& a : pass.accesses) { needed[a.resource] = true; }
+	}
+
+	// 2) Lifetimes and usage of transients, over the kept passes
+	for (uint32_t p = 0; p < passes.size(); p++)
+	{
+		if (passes[p].culled) { continue; }
+
+		for (const auto& a : passes[p].accesses)
+		{
+			GraphResource& res = resources[a.resource];
+			if (!res.transient) { continue; }
+
+			if (res.firstPass == vtek::kRenderGraphInvalidId) { res.firstPass = p; }
+			res.lastPass = p;
+			res.usageFlags = res.usageFlags.get() | a.imageUsage.get();
+		}
+	}
+
+	// 3) Memory requirements
+	vtek::Allocator* allocator = vtek::device_get_allocator(graph->device);
+	std::vector<uint32_t> transients;
+	for (uint32_t r = 0; r < resources.size(); r++)
+	{
+		GraphResource& res = resources[r];
+		if (!res.transient || res.firstPass == vtek::kRenderGraphInvalidId) { continue; }
+
+		vtek::Image2DInfo imageInfo = get_transient_image_info(res);
+		if (!vtek::allocator_image2d_get_memory_requirements(
+			    allocator, &imageInfo, &res.requirements))
+		{
+			vtek_log_error("Failed to get memory requirements -- {}",
+			               "cannot compile render graph!");
+			return false;
+		}
+		transients.push_back(r);
+		stats.memoryWithoutAliasing += res.requirements.size;
+	}
+	stats.numTransientImages = static_cast<uint32_t>(transients.size());
+
+	// 4) Place transients in a single allocation
+	VkMemoryRequirements requirements{};
+	stats.transientMemoryBytes = place_transients(resources, transients, &requirements);
+	if (requirements.size > 0UL)
+	{
+		graph->transientMemory = vtek::allocator_memory_allocate(allocator, &requirements);
+		if (graph->transientMemory == VK_NULL_HANDLE)
+		{
+			vtek_log_error("Failed to allocate transient memory -- {}",
+			               "cannot compile render graph!");
+			return false;
+		}
+	}
+
+	// 5) Create images, bound to the shared memory where possible
+	for (uint32_t t : transients)
+	{
+		GraphResource& res = resources[t];
+		vtek::Image2DInfo imageInfo = get_transient_image_info(res);
+		if (res.placed)
+		{
+			res.image = vtek::image2d_create_aliased(
+				&imageInfo, graph->transientMemory, res.offset, graph->device);
+		}
+		else
+		{
+			res.image = vtek::image2d_create(&imageInfo, graph->device);
+			stats.transientMemoryBytes += res.requirements.size;
+		}
+
+		if (res.image == nullptr)
+		{
+			vtek_log_error("Failed to create transient image -- {}",
+			               "cannot compile render graph!");
+			destroy_transients(graph);
+			return false;
+		}
+
+		for (uint32_t other : transients)
+		{
+			if (other != t && res.placed && resources[other].placed &&
+			    memory_overlaps(res, resources[other]))
+			{
+				res.aliases.push_back(other);
+			}
+		}
+	}
+
+	graph->compiled = true;
+	return true;
+}
+
+void vtek::render_graph_execute(vtek::RenderGraph* graph, vtek::CommandBuffer* commandBuffer)
+{
+	if (!graph->compiled)
+	{
+		vtek_log_error("Render graph is not compiled -- cannot execute!");
+		return;
+	}
+
+	for (uint32_t p = 0; p < graph->passes.size(); p++)
+	{
+		GraphPass& pass = graph->passes[p];
+		if (pass.culled) { continue; }
+
+		for (const auto& a : pass.accesses)
+		{
+			if (a.external) { continue; }
+
+			GraphResource& res = graph->resources[a.resource];
+			if (res.buffer != nullptr)
+			{
+				vtek::barrier_batch_buffer(graph->barriers, res.buffer, a.bufferAccess);
+				continue;
+			}
+
+			// Transients are undefined at the start of their lifetime
+			const bool firstUse = res.transient && res.firstPass == p;
+			if (firstUse) { merge_alias_states(graph, res); }
+
+			vtek::barrier_batch_image(graph->barriers, res.image, a.imageAccess, firstUse);
+		}
+		vtek::barrier_batch_flush(graph->barriers, commandBuffer);
+
+		if (pass.fn) { pass.fn(commandBuffer); }
+	}
+}
+
+vtek::Image2D* vtek::render_graph_get_image(vtek::RenderGraph* graph, uint32_t image)
+{
+	if (image >= graph->resources.size()) { return nullptr; }
+
+	return graph->resources[image].image;
+}
+
+vtek::Buffer* vtek::render_graph_get_buffer(vtek::RenderGraph* graph, uint32_t buffer)
+{
+	if (buffer >= graph->resources.size()) { return nullptr; }
+
+	return graph->resources[buffer].buffer;
+}
+
+bool vtek::render_graph_pass_is_culled(vtek::RenderGraph* graph, uint32_t pass)
+{
+	if (pass >= graph->passes.size()) { return true; }
+
+	return graph->passes[pass].culled;
+}
+
+vtek::RenderGraphStats vtek::render_graph_get_stats(vtek::RenderGraph* graph)
+{
+	return graph->stats;
+}
@@ -0,0 +1,374 @@
+#include "vtek_vulkan.pch"
+#include "vtek_render_queue.hpp"
+
+#include "vtek_commands.hpp"
+#include "vtek_graphics_pipeline.hpp"
+#include "vtek_logging.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+
+/* struct implementation */
+struct SortEntry
+{
+	uint64_t key;
+	uint32_t index;
+};
+
+struct vtek::RenderQueue
+{
+	std::vector<vtek::RenderQueueDraw> draws;
+	std::vector<uint32_t> pushOffsets;
+	std::vector<uint8_t> pushData;
+
+	std::vector<SortEntry> entries;
+	std::vector<SortEntry> scratch;
+	bool sorted {true};
+
+	vtek::RenderQueueStats stats {};
+};
+
+
+
+/* helper functions */
+static constexpr uint32_t kPassShift = 60U;
+static constexpr uint32_t kPipelineShift = 48U;
+static constexpr uint32_t kDescriptorSetShift = 36U;
+static constexpr uint32_t kMaterialShift = 24U;
+static constexpr uint64_t kIdMask = 0xFFFUL;
+static constexpr uint64_t kPassMask = 0xFUL;
+static constexpr uint32_t kDepthMax = 0xFFFFFFU;
+
+// Below this, the constant cost of the histograms outweighs a comparison sort
+static constexpr size_t kRadixSortThreshold = 64;
+
+static void radix_sort(std::vector<SortEntry>& entries, std::vector<SortEntry>& scratch)
+{
+	const size_t count = entries.size();
+	scratch.resize(count);
+
+	// Histograms for all eight digits, computed in a single pass
+	uint32_t histograms[8][256] = {};
+	for (const auto& entry : entries)
+	{
+		for (uint32_t d = 0; d < 8; d++)
+		{
+			histograms[d][(entry.key >> (d * 8)) & 0xFF]++;
+		}
+	}
+
+	SortEntry* src = entries.data();
+	SortEntry* dst = scratch.data();
+	for (uint32_t d = 0; d < 8; d++)
+	{
+		uint32_t* histogram = histograms[d];
+
+		// Skip digits that are equal for all keys, which is most of them
+		// when only a few fields of the key are in use.
+		const uint32_t firstDigit = (src[0].key >> (d * 8)) & 0xFF;
+		if (histogram[firstDigit] == count) { continue; }
+
+		uint32_t offset = 0U;
+		for (uint32_t i = 0; i < 256; i++)
+		{
+			uint32_t n = histogram[i];
+			histogram[i] = offset;
+			offset += n;
+		}
+
+		for (size_t i = 0; i < count; i++)
+		{
+			uint32_t digit = (src[i].key >> (d * 8)) & 0xFF;
+			dst[histogram[digit]++] = src[i];
+		}
+		std::swap(src, dst);
+	}
+
+	if (src != entries.data())
+	{
+		std::memcpy(entries.data(), src, count * sizeof(SortEntry));
+	}
+}
+
+static bool same_vertex_buffers(const vtek::RenderQueueDraw& a, const vtek::RenderQueueDraw& b)
+{
+	if (a.numVertexBuffers != b.numVertexBuffers) { return false; }
+	for (uint32_t i = 0; i < a.numVertexBuffers; i++)
+	{
+		if (a.vertexBuffers[i] != b.vertexBuffers[i] ||
+		    a.vertexOffsets[i] != b.vertexOffsets[i]) { return false; }
+	}
+	return true;
+}
+
+static bool same_descriptor_set(const vtek::RenderQueueDraw& a, const vtek::RenderQueueDraw& b)
+{
+	if (a.descriptorSet != b.descriptorSet ||
+	    a.numDynamicOffsets != b.numDynamicOffsets) { return false; }
+	for (uint32_t i = 0; i < a.numDynamicOffsets; i++)
+	{
+		if (a.dynamicOffsets[i] != b.dynamicOffsets[i]) { return false; }
+	}
+	return true;
+}
+
+static void record_range(
+	vtek::RenderQueue* queue, vtek::CommandBuffer* commandBuffer,
+	size_t begin, size_t end)
+{
+	auto& stats = queue->stats;
+
+	// State bound by the previous draw in this range. Nothing is assumed
+	// to be bound at the start, since the command buffer may have been
+	// used for other commands in between.
+	const vtek::RenderQueueDraw* prev = nullptr;
+	VkPipelineLayout boundLayout = VK_NULL_HANDLE;
+
+	for (size_t i = begin; i < end; i++)
+	{
+		const uint32_t index = queue->entries[i].index;
+		const vtek::RenderQueueDraw& draw = queue->draws[index];
+
+		// Pipeline
+		if (prev == nullptr || draw.pipeline != prev->pipeline)
+		{
+			vtek::cmd_bind_graphics_pipeline(commandBuffer, draw.pipeline);
+			stats.pipelineBinds++;
+		}
+		else { stats.bindsSkipped++; }
+
+		// Descriptor sets are disturbed when the pipeline layout changes
+		VkPipelineLayout layout = vtek::graphics_pipeline_get_layout(draw.pipeline);
+		const bool layoutChanged = (layout != boundLayout);
+		boundLayout = layout;
+
+		if (draw.descriptorSet != nullptr)
+		{
+			if (layoutChanged || !same_descriptor_set(draw, *prev))
+			{
+				vtek::cmd_bind_descriptor_set_graphics(
+					commandBuffer, draw.pipeline, 0U, draw.descriptorSet,
+					draw.dynamicOffsets, draw.numDynamicOffsets);
+				stats.descriptorSetBinds++;
+			}
+			else { stats.bindsSkipped++; }
+		}
+
+		if (draw.materialSet != nullptr)
+		{
+			if (layoutChanged || draw.materialSet != prev->materialSet)
+			{
+				vtek::cmd_bind_descriptor_set_graphics(
+					commandBuffer, draw.pipeline, 1U, draw.materialSet);
+				stats.descriptorSetBinds++;
+			}
+			else { stats.bindsSkipped++; }
+		}
+
+		// Vertex and index buffers are not affected by pipeline changes
+		if (draw.numVertexBuffers > 0U)
+		{
+			if (prev == nullptr || !same_vertex_buffers(draw, *prev))
+			{
+				vtek::cmd_bind_vertex_buffers(
+					commandBuffer, 0U, draw.vertexBuffers, draw.vertexOffsets,
+					draw.numVertexBuffers);
+				stats.vertexBufferBinds++;
+			}
+			else { stats.bindsSkipped++; }
+		}
+
+		if (draw.indexBuffer != nullptr)
+		{
+			if (prev == nullptr || draw.indexBuffer != prev->indexBuffer ||
+			    draw.indexOffset != prev->indexOffset ||
+			    draw.indexType != prev->indexType)
+			{
+				vtek::cmd_bind_index_buffer(
+					commandBuffer, draw.indexBuffer, draw.indexOffset, draw.indexType);
+				stats.indexBufferBinds++;
+			}
+			else { stats.bindsSkipped++; }
+		}
+
+		if (draw.pushConstantSize > 0U)
+		{
+			vtek::cmd_push_constant_graphics(
+				commandBuffer, draw.pipeline,
+				queue->pushData.data() + queue->pushOffsets[index],
+				draw.pushConstantSize, draw.pushConstantStages);
+		}
+
+		if (draw.indexBuffer != nullptr)
+		{
+			vtek::cmd_draw_indexed_instanced(
+				commandBuffer, draw.numElements, draw.numInstances,
+				draw.firstElement, draw.vertexOffset, draw.firstInstance);
+		}
+		else
+		{
+			vtek::cmd_draw_vertices_instanced(
+				commandBuffer, draw.numElements, draw.numInstances,
+				draw.firstElement, draw.firstInstance);
+		}
+		stats.numDraws++;
+
+		prev = &draw;
+	}
+}
+
+
+
+/* interface */
+uint64_t vtek::render_queue_make_key(const vtek::RenderQueueKey* key)
+{
+	float depth = std::clamp(key->depth, 0.0f, 1.0f);
+	uint32_t depthBits = static_cast<uint32_t>(depth * kDepthMax);
+	if (key->backToFront) { depthBits = kDepthMax - depthBits; }
+
+	return ((key->pass & kPassMask) << kPassShift) |
+		((key->pipeline & kIdMask) << kPipelineShift) |
+		((key->descriptorSet & kIdMask) << kDescriptorSetShift) |
+		((key->material & kIdMask) << kMaterialShift) |
+		uint64_t{depthBits};
+}
+
+uint32_t vtek::render_queue_key_get_pass(uint64_t key)
+{
+	return static_cast<uint32_t>(key >> kPassShift);
+}
+
+vtek::RenderQueue* vtek::render_queue_create(const vtek::RenderQueueInfo* info)
+{
+	auto queue = new vtek::RenderQueue;
+	queue->draws.reserve(info->initialCapacity);
+	queue->pushOffsets.reserve(info->initialCapacity);
+	queue->entries.reserve(info->initialCapacity);
+	queue->scratch.reserve(info->initialCapacity);
+
+	return queue;
+}
+
+void vtek::render_queue_destroy(vtek::RenderQueue* queue)
+{
+	if (queue == nullptr) return;
+
+	delete queue;
+}
+
+void vtek::render_queue_reset(vtek::RenderQueue* queue)
+{
+	queue->draws.clear();
+	queue->pushOffsets.clear();
+	queue->pushData.clear();
+	queue->entries.clear();
+	queue->sorted = true;
+	queue->stats = vtek::RenderQueueStats{};
+}
+
+bool vtek::render_queue_submit(
+	vtek::RenderQueue* queue, uint64_t key, const vtek::RenderQueueDraw* draw)
+{
+	if (draw->pipeline == nullptr)
+	{
+		vtek_log_error("Render queue draw has no pipeline -- cannot submit!");
+		return false;
+	}
+	if (draw->numVertexBuffers > vtek::kRenderQueueMaxVertexBuffers ||
+	    draw->numDynamicOffsets > vtek::kRenderQueueMaxDynamicOffsets)
+	{
+		vtek_log_error("Render queue draw has too many vertex buffers or {}",
+		               "dynamic offsets -- cannot submit!");
+		return false;
+	}
+	if (draw->pushConstantSize > vtek::kRenderQueueMaxPushConstantSize ||
+	    (draw->pushConstantSize > 0U && draw->pushConstantData == nullptr))
+	{
+		vtek_log_error("Render queue draw has invalid push constant data -- {}",
+		               "cannot submit!");
+		return false;
+	}
+
+	const uint32_t index = static_cast<uint32_t>(queue->draws.size());
+	const uint32_t pushOffset = static_cast<uint32_t>(queue->pushData.size());
+	if (draw->pushConstantSize > 0U)
+	{
+		auto src = static_cast<const uint8_t*>(draw->pushConstantData);
+		queue->pushData.insert(queue->pushData.end(), src, src + draw->pushConstantSize);
+	}
+
+	queue->draws.push_back(*draw);
+	queue->draws.back().pushConstantData = nullptr; // copied above
+	queue->pushOffsets.push_back(pushOffset);
+
+	if (!queue->entries.empty() && key < queue->entries.back().key)
+	{
+		queue->sorted = false;
+	}
+	queue->entries.push_back({ key, index });
+
+	return true;
+}
+
+void vtek::render_queue_sort(vtek::RenderQueue* queue)
+{
+	if (queue->sorted) { return; }
+
+	if (queue->entries.size() < kRadixSortThreshold)
+	{
+		std::stable_sort(
+			queue->entries.begin(), queue->entries.end(),
+			[](const SortEntry& a, const SortEntry& b) { return a.key < b.key; });
+	}
+	else
+	{
+		radix_sort(queue->entries, queue->scratch);
+	}
+
+	queue->sorted = true;
+}
+
+void vtek::render_queue_record(vtek::RenderQueue* queue, vtek::CommandBuffer* commandBuffer)
+{
+	vtek::render_queue_sort(queue);
+	record_range(queue, commandBuffer, 0, queue->entries.size());
+}
+
+void vtek::render_queue_record_pass(
+	vtek::RenderQueue* queue, vtek::CommandBuffer* commandBuffer, uint32_t pass)
+{
+	vtek::render_queue_sort(queue);
+
+	// The pass occupies the topmost bits, so its draws are contiguous
+	const uint64_t passBegin = (uint64_t{pass} & kPassMask) << kPassShift;
+	auto begin = std::lower_bound(
+		queue->entries.begin(), queue->entries.end(), passBegin,
+		[](const SortEntry& e, uint64_t k) { return e.key < k; });
+	auto end = std::find_if(
+		begin, queue->entries.end(),
+		[pass](const SortEntry& e) { return vtek::render_queue_key_get_pass(e.key) != pass; });
+
+	record_range(
+		queue, commandBuffer, begin - queue->entries.begin(), end - queue->entries.begin());
+}
+
+uint32_t vtek::render_queue_get_num_draws(vtek::RenderQueue* queue)
+{
+	return static_cast<uint32_t>(queue->draws.size());
+}
+
+vtek::RenderQueueStats vtek::render_queue_get_stats(vtek::RenderQueue* queue)
+{
+	return queue->stats;
+}
+
+const vtek::RenderQueueDraw* vtek::render_queue_get_sorted_draw(
+	vtek::RenderQueue* queue, uint32_t index)
+{
+	if (index >= queue->entries.size()) { return nullptr; }
+
+	vtek::render_queue_sort(queue);
+	return &queue->draws[queue->entries[index].index];
+}
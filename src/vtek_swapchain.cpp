@@ -1,7 +1,10 @@
 #include "vtek_vulkan.pch"
 #include "vtek_swapchain.hpp"
 
+#include "impl/vtek_vma_helpers.hpp"
+#include "vtek_buffer.hpp"
 #include "vtek_command_buffer.hpp"
+#include "vtek_command_pool.hpp"
 #include "vtek_device.hpp"
 #include "vtek_image.hpp"
 #include "vtek_logging.hpp"
@@ -34,7 +37,7 @@ struct vtek::Swapchain
 
 	bool isInvalidated {false};
 
-	VkQueue presentQueue {VK_NULL_HANDLE};
+	vtek::Queue* presentQueue {nullptr};
 	uint32_t graphicsQueueIndex {0};
 	uint32_t presentQueueIndex {0};
 
@@ -55,25 +58,24 @@ struct vtek::Swapchain
 	uint32_t currentFrameIndex {0U};
 
 	// Semaphores that will be signaled once a swapchain image becomes ready.
-	// Used for acquiring swapchain images.
-	VkSemaphore imageAvailableSemaphores[vtek::kMaxFramesInFlight];
+	// Used for acquiring swapchain images. One for each frame in flight.
+	std::vector<VkSemaphore> imageAvailableSemaphores;
 
 	// Semaphores that will be signaled once rendering of a frame has completed.
-	// Used for releasing swapchain images to the presentation queue.
-	VkSemaphore renderFinishedSemaphores[vtek::kMaxFramesInFlight];
-
-	// Before we can start drawing a frame, the CPU needs to wait for
-	// the swapchain image to become ready. This is accomplished by
-	// having this list of frames which guard the current frame
-	// Before we can draw, we need to wait for fences guarding the current
-	// swap chain image.
-	VkFence inFlightFences[vtek::kMaxFramesInFlight];
-
-	// This vector will be created to the length of the swapchain,
-	// and for each swapchain image hold a pointer to a fence in
-	// `inFlightFences`. Used for signalling when it's possible to
-	// render to a swapchain image.
-	std::vector<VkFence> imagesInFlight;
+	// Used for releasing swapchain images to the presentation queue. These
+	// must be binary, since presentation does not accept timeline semaphores.
+	std::vector<VkSemaphore> renderFinishedSemaphores;
+
+	// A single timeline semaphore replaces a fence for each frame in flight.
+	// Every submitted frame signals the next value of `frameCounter`, so
+	// frame N has completed once the semaphore has reached N, and the CPU
+	// can wait for any earlier frame without resetting anything.
+	VkSemaphore frameTimeline {VK_NULL_HANDLE};
+	uint64_t frameCounter {0UL};
+
+	// For each swapchain image, the timeline value of the last frame that
+	// rendered into it, or zero if it has not been used yet.
+	std::vector<uint64_t> imageTimelineValues;
 
 	// ====================== //
 	// === Swapchain info === //
@@ -81,6 +83,38 @@ struct vtek::Swapchain
 	bool vsync {false};
 	bool prioritizeLowLatency {false};
 	VkPhysicalDevice physDev {VK_NULL_HANDLE};
+
+	// Layout of images when they are presented
+	VkImageLayout presentLayout {VK_IMAGE_LAYOUT_PRESENT_SRC_KHR};
+
+	// ================ //
+	// === Headless === //
+	// ================ //
+	// Without a surface the swapchain images are ordinary images, acquired
+	// in order. `images` and `imageViews` then refer to these.
+	bool isHeadless {false};
+	std::vector<vtek::Image2D*> headlessImages;
+	uint32_t nextHeadlessImage {0U};
+	vtek::Queue* graphicsQueue {nullptr};
+
+	// Presenting an image copies it into the image's readback buffer, with
+	// command buffers recorded once. Each copy signals the next value of
+	// `readbackCounter`, and the copies run on the GPU while the next frame
+	// is rendered. Rendering into an image waits for its previous copy.
+	bool readbackEnabled {false};
+	uint32_t readbackTexelSize {0U};
+	vtek::CommandPool* readbackPool {nullptr};
+	std::vector<vtek::CommandBuffer*> readbackCommandBuffers;
+	std::vector<vtek::Buffer*> readbackBuffers;
+	std::vector<void*> readbackMappings;
+	VkSemaphore readbackTimeline {VK_NULL_HANDLE};
+	uint64_t readbackCounter {0UL};
+
+	// For each image, the timeline value and frame number of its last copy,
+	// and if it has not yet been returned by `swapchain_poll_readback`.
+	std::vector<uint64_t> readbackValues;
+	std::vector<uint64_t> readbackFrameNumbers;
+	std::vector<bool> readbackUnread;
 };
 
 
@@ -552,84 +586,470 @@ static bool get_supported_depth_format(
 	return vtek::SupportedFormat::FindFormat(&info, formats, device, out);
 }
 
-static bool create_frame_sync_objects(vtek::Swapchain* swapchain, VkDevice dev)
+static uint32_t choose_num_frames_in_flight(uint32_t requested, uint32_t swapchainLength)
 {
-	const uint32_t numFrames = std::clamp(swapchain->length - 1, 1U, vtek::kMaxFramesInFlight);
-	swapchain->numFramesInFlight = numFrames;
-	swapchain->imagesInFlight.resize(swapchain->length, VK_NULL_HANDLE);
-	swapchain->currentFrameIndex = 0U;
+	const uint32_t numFrames = std::clamp(requested, 1U, vtek::kMaxFramesInFlight);
+	if (numFrames != requested)
+	{
+		vtek_log_warn("Swapchain: {} frames in flight requested, clamped to {}!",
+		              requested, numFrames);
+	}
+	if (numFrames > swapchainLength)
+	{
+		// Not an error, but acquiring images will then block instead
+		vtek_log_warn("Swapchain: More frames in flight ({}) than images ({})!",
+		              numFrames, swapchainLength);
+	}
 
+	return numFrames;
+}
+
+static bool create_binary_semaphores(vtek::Swapchain* swapchain, VkDevice dev)
+{
 	const VkSemaphoreCreateInfo semInfo {
 		.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
 		.pNext = nullptr,
 		.flags = 0U // reserved for future use
 	};
 
-	// All fences are created in signaled state, to avoid initial wait before any rendering.
-	const VkFenceCreateInfo fenceInfo {
-		.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
-		.pNext = nullptr,
-		.flags = VK_FENCE_CREATE_SIGNALED_BIT
-	};
+	const uint32_t numFrames = swapchain->numFramesInFlight;
+	swapchain->imageAvailableSemaphores.resize(numFrames, VK_NULL_HANDLE);
+	swapchain->renderFinishedSemaphores.resize(numFrames, VK_NULL_HANDLE);
 
-	for (uint32_t i = 0; i < vtek::kMaxFramesInFlight; i++)
+	for (uint32_t i = 0; i < numFrames; i++)
 	{
-		vkCreateSemaphore(dev, &semInfo, nullptr, &swapchain->imageAvailableSemaphores[i]);
-		vkCreateSemaphore(dev, &semInfo, nullptr, &swapchain->renderFinishedSemaphores[i]);
-		vkCreateFence(dev, &fenceInfo, nullptr, &swapchain->inFlightFences[i]);
+		VkSemaphore* available = &swapchain->imageAvailableSemaphores[i];
+		VkSemaphore* finished = &swapchain->renderFinishedSemaphores[i];
+		if (vkCreateSemaphore(dev, &semInfo, nullptr, available) != VK_SUCCESS ||
+		    vkCreateSemaphore(dev, &semInfo, nullptr, finished) != VK_SUCCESS)
+		{
+			return false;
+		}
 	}
 
 	return true;
 }
 
-static void destroy_frame_sync_objects(vtek::Swapchain* swapchain, VkDevice dev)
+static void destroy_binary_semaphores(vtek::Swapchain* swapchain, VkDevice dev)
 {
-	for (uint32_t i = 0; i < vtek::kMaxFramesInFlight; i++)
+	for (auto sem : swapchain->imageAvailableSemaphores)
 	{
-		vkDestroySemaphore(dev, swapchain->imageAvailableSemaphores[i], nullptr);
-		vkDestroySemaphore(dev, swapchain->renderFinishedSemaphores[i], nullptr);
-		vkDestroyFence(dev, swapchain->inFlightFences[i], nullptr);
+		if (sem != VK_NULL_HANDLE) { vkDestroySemaphore(dev, sem, nullptr); }
 	}
+	for (auto sem : swapchain->renderFinishedSemaphores)
+	{
+		if (sem != VK_NULL_HANDLE) { vkDestroySemaphore(dev, sem, nullptr); }
+	}
+	swapchain->imageAvailableSemaphores.clear();
+	swapchain->renderFinishedSemaphores.clear();
+}
+
+static vtek::SwapchainStatus wait_timeline(
+	VkDevice dev, VkSemaphore timeline, uint64_t value, uint64_t timeout)
+{
+	// Value zero is never signaled, and means there is nothing to wait for
+	if (value == 0UL) { return vtek::SwapchainStatus::ok; }
 
-	for (auto& fence : swapchain->imagesInFlight)
+	// If the frame has already completed, return without waiting
+	uint64_t completed = 0UL;
+	VkResult test = vkGetSemaphoreCounterValue(dev, timeline, &completed);
+	if (test == VK_SUCCESS && completed >= value) { return vtek::SwapchainStatus::ok; }
+
+	const VkSemaphoreWaitInfo waitInfo {
+		.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+		.pNext = nullptr,
+		.flags = 0U,
+		.semaphoreCount = 1,
+		.pSemaphores = &timeline,
+		.pValues = &value
+	};
+
+	VkResult result = vkWaitSemaphores(dev, &waitInfo, timeout);
+	switch (result)
 	{
-		fence = VK_NULL_HANDLE;
+	case VK_SUCCESS: return vtek::SwapchainStatus::ok;
+	case VK_TIMEOUT: return vtek::SwapchainStatus::timeout;
+	default:
+		return vtek::SwapchainStatus::error;
 	}
-	swapchain->imagesInFlight.clear();
+}
+
+static bool create_frame_sync_objects(
+	vtek::Swapchain* swapchain, VkDevice dev, uint32_t numFramesInFlight)
+{
+	swapchain->numFramesInFlight =
+		choose_num_frames_in_flight(numFramesInFlight, swapchain->length);
+	swapchain->imageTimelineValues.assign(swapchain->length, 0UL);
+	swapchain->currentFrameIndex = 0U;
+	swapchain->frameCounter = 0UL;
+
+	if (!create_binary_semaphores(swapchain, dev))
+	{
+		return false;
+	}
+
+	const VkSemaphoreTypeCreateInfo typeInfo {
+		.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+		.pNext = nullptr,
+		.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
+		.initialValue = 0UL
+	};
+	const VkSemaphoreCreateInfo timelineInfo {
+		.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+		.pNext = &typeInfo,
+		.flags = 0U
+	};
+
+	VkResult result = vkCreateSemaphore(
+		dev, &timelineInfo, nullptr, &swapchain->frameTimeline);
+	return result == VK_SUCCESS;
+}
+
+static void destroy_frame_sync_objects(vtek::Swapchain* swapchain, VkDevice dev)
+{
+	destroy_binary_semaphores(swapchain, dev);
+
+	if (swapchain->frameTimeline != VK_NULL_HANDLE)
+	{
+		vkDestroySemaphore(dev, swapchain->frameTimeline, nullptr);
+		swapchain->frameTimeline = VK_NULL_HANDLE;
+	}
+	swapchain->imageTimelineValues.clear();
 
 	swapchain->numFramesInFlight = 0U;
 	swapchain->currentFrameIndex = 0U;
+	swapchain->frameCounter = 0UL;
 }
 
 static void reset_frame_sync_objects(vtek::Swapchain* swapchain, VkDevice dev)
 {
-	for (uint32_t i = 0; i < vtek::kMaxFramesInFlight; i++)
+	// Let all submitted frames complete. An image may have been acquired for
+	// a frame that was never submitted, leaving its semaphore signaled, so
+	// the binary semaphores are recreated. The timeline keeps counting,
+	// since its value can never decrease.
+	wait_timeline(dev, swapchain->frameTimeline, swapchain->frameCounter, UINT64_MAX);
+
+	destroy_binary_semaphores(swapchain, dev);
+	if (!create_binary_semaphores(swapchain, dev))
+	{
+		vtek_log_error("Failed to recreate swapchain frame semaphores!");
+	}
+
+	swapchain->imageTimelineValues.assign(swapchain->length, 0UL);
+	swapchain->currentFrameIndex = 0U;
+}
+
+
+
+/* headless */
+static uint32_t get_headless_texel_size(vtek::Format format)
+{
+	// Formats that can be read back without conversion
+	switch (format)
+	{
+	case vtek::Format::r8g8b8a8_unorm:
+	case vtek::Format::r8g8b8a8_srgb:
+	case vtek::Format::b8g8r8a8_unorm:
+	case vtek::Format::b8g8r8a8_srgb:
+	case vtek::Format::a2b10g10r10_unorm_pack32:
+		return 4U;
+	case vtek::Format::r16g16b16a16_sfloat:
+		return 8U;
+	case vtek::Format::r32g32b32a32_sfloat:
+		return 16U;
+	default:
+		return 0U;
+	}
+}
+
+static bool create_headless_images(vtek::Swapchain* swapchain, vtek::Device* device)
+{
+	vtek::Image2DInfo imageInfo{};
+	imageInfo.requireDedicatedAllocation = true;
+	imageInfo.extent = swapchain->imageExtent;
+	imageInfo.format = swapchain->imageFormat;
+	imageInfo.usageFlags = vtek::ImageUsageFlag::color_attachment;
+	imageInfo.usageFlags.add_flag(vtek::ImageUsageFlag::transfer_src);
+	imageInfo.initialLayout = vtek::ImageInitialLayout::undefined;
+	imageInfo.useMipmaps = false;
+	imageInfo.multisampling = vtek::MultisampleType::none;
+	imageInfo.sharingMode = vtek::ImageSharingMode::exclusive;
+	imageInfo.createImageView = true;
+	imageInfo.imageViewInfo.aspectFlags = vtek::ImageAspectFlag::color;
+
+	swapchain->headlessImages.resize(swapchain->length, nullptr);
+	swapchain->images.resize(swapchain->length, VK_NULL_HANDLE);
+	swapchain->imageViews.resize(swapchain->length, VK_NULL_HANDLE);
+
+	for (uint32_t i = 0; i < swapchain->length; i++)
 	{
-		VkFence fence = swapchain->inFlightFences[i];
-		VkResult waitResult = vkWaitForFences(dev, 1, &fence, VK_TRUE, 0UL);
-		if (waitResult == VK_TIMEOUT)
+		vtek::Image2D* image = vtek::image2d_create(&imageInfo, device);
+		if (image == nullptr)
 		{
-			vkResetFences(dev, 1, &fence);
+			vtek_log_error("Failed to create headless swapchain image {}!", i);
+			return false;
 		}
+
+		swapchain->headlessImages[i] = image;
+		swapchain->images[i] = vtek::image2d_get_handle(image);
+		swapchain->imageViews[i] = vtek::image2d_get_view_handle(image);
 	}
 
-	const uint32_t numFrames = std::clamp(swapchain->length - 1, 1U, vtek::kMaxFramesInFlight);
-	swapchain->numFramesInFlight = numFrames;
-	swapchain->imagesInFlight.resize(numFrames, VK_NULL_HANDLE);
-	swapchain->currentFrameIndex = 0U;
+	swapchain->nextHeadlessImage = 0U;
+	return true;
 }
 
-static void set_image_in_use(
-	vtek::Swapchain* swapchain, VkDevice dev, uint32_t frameIndex)
+static void destroy_headless_images(vtek::Swapchain* swapchain, vtek::Device* device)
 {
-	// Mark the image fence as in-use by this frame
-	uint32_t currentFrame = swapchain->currentFrameIndex;
-	VkFence targetFence = swapchain->inFlightFences[currentFrame];
+	for (auto image : swapchain->headlessImages)
+	{
+		if (image != nullptr) { vtek::image2d_destroy(image, device); }
+	}
+
+	swapchain->headlessImages.clear();
+	swapchain->images.clear();
+	swapchain->imageViews.clear();
+}
+
+static void record_readback_commands(vtek::Swapchain* swapchain, uint32_t index)
+{
+	VkCommandBuffer cmdBuf =
+		vtek::command_buffer_get_handle(swapchain->readbackCommandBuffers[index]);
+	VkBuffer buffer = vtek::buffer_get_handle(swapchain->readbackBuffers[index]);
+
+	// Rendering left the image in `presentLayout`, and the copy waits for
+	// rendering to complete with a semaphore, so no barrier is needed before.
+	VkBufferImageCopy region{};
+	region.bufferOffset = 0;
+	region.bufferRowLength = 0; // tightly packed
+	region.bufferImageHeight = 0;
+	region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	region.imageSubresource.mipLevel = 0;
+	region.imageSubresource.baseArrayLayer = 0;
+	region.imageSubresource.layerCount = 1;
+	region.imageOffset = { 0, 0, 0 };
+	region.imageExtent = { swapchain->imageExtent.width, swapchain->imageExtent.height, 1 };
+
+	vkCmdCopyImageToBuffer(
+		cmdBuf, swapchain->images[index], VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+		buffer, 1, &region);
+
+	// Make the copied data visible to the host
+	VkBufferMemoryBarrier barrier{
+		.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+		.pNext = nullptr,
+		.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+		.dstAccessMask = VK_ACCESS_HOST_READ_BIT,
+		.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+		.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+		.buffer = buffer,
+		.offset = 0,
+		.size = VK_WHOLE_SIZE
+	};
+
+	vkCmdPipelineBarrier(
+		cmdBuf, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0,
+		0, nullptr, 1, &barrier, 0, nullptr);
+}
+
+static bool create_readback_resources(vtek::Swapchain* swapchain, vtek::Device* device)
+{
+	const uint32_t length = swapchain->length;
+	swapchain->readbackValues.assign(length, 0UL);
+	swapchain->readbackFrameNumbers.assign(length, 0UL);
+	swapchain->readbackUnread.assign(length, false);
+
+	vtek::BufferInfo bufferInfo{};
+	bufferInfo.size = static_cast<VkDeviceSize>(swapchain->imageExtent.width)
+		* swapchain->imageExtent.height * swapchain->readbackTexelSize;
+	bufferInfo.requireHostVisibleStorage = true;
+	bufferInfo.preferHostCachedStorage = true;
+	bufferInfo.disallowInternalStagingBuffer = true;
+	bufferInfo.usageFlags = vtek::BufferUsageFlag::transfer_dst;
+
+	swapchain->readbackBuffers = vtek::buffer_create(&bufferInfo, length, device);
+	if (swapchain->readbackBuffers.size() != length)
+	{
+		vtek_log_error("Failed to create headless swapchain readback buffers!");
+		return false;
+	}
+
+	// Readback buffers stay mapped for their entire lifetime
+	swapchain->readbackMappings.resize(length, nullptr);
+	for (uint32_t i = 0; i < length; i++)
+	{
+		void* mapped = vtek::allocator_buffer_map(swapchain->readbackBuffers[i]);
+		if (mapped == nullptr)
+		{
+			vtek_log_error("Failed to map headless swapchain readback buffer {}!", i);
+			return false;
+		}
+		swapchain->readbackMappings[i] = mapped;
+	}
+
+	// Copies are the same every frame, so they are recorded only once. A
+	// command buffer may be resubmitted while the GPU still runs its previous
+	// submission, which is ordered before the new one by semaphores.
+	swapchain->readbackCommandBuffers = vtek::command_pool_alloc_buffers(
+		swapchain->readbackPool, vtek::CommandBufferUsage::primary, length, device);
+	if (swapchain->readbackCommandBuffers.size() != length)
+	{
+		vtek_log_error("Failed to allocate headless swapchain readback command buffers!");
+		return false;
+	}
+
+	vtek::CommandBufferBeginInfo beginInfo{};
+	beginInfo.simultaneousUse = true;
+	for (uint32_t i = 0; i < length; i++)
+	{
+		vtek::CommandBuffer* commandBuffer = swapchain->readbackCommandBuffers[i];
+		if (!vtek::command_buffer_begin(commandBuffer, &beginInfo))
+		{
+			vtek_log_error("Failed to begin headless swapchain readback command buffer!");
+			return false;
+		}
+		record_readback_commands(swapchain, i);
+		if (!vtek::command_buffer_end(commandBuffer))
+		{
+			vtek_log_error("Failed to end headless swapchain readback command buffer!");
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static void destroy_readback_resources(vtek::Swapchain* swapchain, vtek::Device* device)
+{
+	if (swapchain->readbackPool != nullptr)
+	{
+		vtek::command_pool_free_buffers(
+			swapchain->readbackPool, swapchain->readbackCommandBuffers, device);
+	}
+
+	for (uint32_t i = 0; i < swapchain->readbackMappings.size(); i++)
+	{
+		if (swapchain->readbackMappings[i] != nullptr)
+		{
+			vtek::allocator_buffer_unmap(swapchain->readbackBuffers[i]);
+		}
+	}
+	swapchain->readbackMappings.clear();
+
+	vtek::buffer_destroy(swapchain->readbackBuffers);
+
+	swapchain->readbackValues.clear();
+	swapchain->readbackFrameNumbers.clear();
+	swapchain->readbackUnread.clear();
+}
+
+static void destroy_headless(vtek::Swapchain* swapchain, vtek::Device* device)
+{
+	VkDevice dev = vtek::device_get_handle(device);
+
+	destroy_readback_resources(swapchain, device);
+	if (swapchain->readbackPool != nullptr)
+	{
+		vtek::command_pool_destroy(swapchain->readbackPool, device);
+		swapchain->readbackPool = nullptr;
+	}
+	if (swapchain->readbackTimeline != VK_NULL_HANDLE)
+	{
+		vkDestroySemaphore(dev, swapchain->readbackTimeline, nullptr);
+		swapchain->readbackTimeline = VK_NULL_HANDLE;
+	}
+
+	destroy_frame_sync_objects(swapchain, dev);
+	destroy_depth_images(swapchain, device);
+	destroy_headless_images(swapchain, device);
+	swapchain->length = 0;
+}
+
+static vtek::SwapchainStatus present_headless(
+	vtek::Swapchain* swapchain, uint32_t imageIndex)
+{
+	uint32_t& curFrame = swapchain->currentFrameIndex;
+
+	if (swapchain->readbackEnabled)
+	{
+		const uint64_t value = swapchain->readbackCounter + 1;
+
+		vtek::SubmitInfo submitInfo{};
+		submitInfo.AddWaitSemaphore(
+			swapchain->renderFinishedSemaphores[curFrame], VK_PIPELINE_STAGE_TRANSFER_BIT);
+		submitInfo.AddSignalSemaphore(swapchain->readbackTimeline, value);
+
+		vtek::CommandBuffer* commandBuffer = swapchain->readbackCommandBuffers[imageIndex];
+		if (!vtek::queue_submit(swapchain->graphicsQueue, commandBuffer, &submitInfo))
+		{
+			vtek_log_error("Failed to submit headless swapchain readback!");
+			return vtek::SwapchainStatus::error;
+		}
+
+		swapchain->readbackCounter = value;
+		swapchain->readbackValues[imageIndex] = value;
+		swapchain->readbackFrameNumbers[imageIndex] = swapchain->frameCounter;
+		swapchain->readbackUnread[imageIndex] = true;
+	}
+
+	// Advance to next frame
+	curFrame = (curFrame + 1) % swapchain->numFramesInFlight;
+	return vtek::SwapchainStatus::ok;
+}
+
+
+
+static bool recreate_headless(
+	vtek::Swapchain* swapchain, vtek::Device* device,
+	uint32_t framebufferWidth, uint32_t framebufferHeight)
+{
+	VkDevice dev = vtek::device_get_handle(device);
+
+	// Let all frames and copies complete. Frames not yet read back are lost.
+	wait_timeline(dev, swapchain->frameTimeline, swapchain->frameCounter, UINT64_MAX);
+	if (swapchain->readbackEnabled)
+	{
+		wait_timeline(
+			dev, swapchain->readbackTimeline, swapchain->readbackCounter, UINT64_MAX);
+		destroy_readback_resources(swapchain, device);
+		vtek::command_pool_reset(swapchain->readbackPool);
+	}
+
+	destroy_depth_images(swapchain, device);
+	destroy_headless_images(swapchain, device);
+	swapchain->imageExtent = { framebufferWidth, framebufferHeight };
 
-	swapchain->imagesInFlight[frameIndex] = targetFence;
+	if (!create_headless_images(swapchain, device))
+	{
+		return false;
+	}
+
+	bool depthCreated = true;
+	switch (swapchain->depthBufferType)
+	{
+	case vtek::SwapchainDepthBuffer::single_shared:
+		depthCreated = create_depth_images(swapchain, device, 1, {});
+		break;
+	case vtek::SwapchainDepthBuffer::one_per_image:
+		depthCreated = create_depth_images(swapchain, device, swapchain->length, {});
+		break;
+	default:
+		break;
+	}
+	if (!depthCreated)
+	{
+		vtek_log_error("Failed to re-create headless swapchain depth buffers!");
+		return false;
+	}
 
-	// Reset the fence for use on the next frame
-	vkResetFences(dev, 1, &targetFence);
+	if (swapchain->readbackEnabled && !create_readback_resources(swapchain, device))
+	{
+		vtek_log_error("Failed to re-create headless swapchain readback!");
+		return false;
+	}
+
+	reset_frame_sync_objects(swapchain, dev);
+	return true;
 }
 
 
@@ -916,6 +1336,12 @@ vtek::Swapchain* vtek::swapchain_create(
 		vtek_log_error("--> Cannot create swapchain!");
 		return nullptr;
 	}
+	if (!vtek::device_get_timeline_semaphore_support(device))
+	{
+		vtek_log_error("Timeline semaphores not supported by the device {}",
+		               "(requires Vulkan >= 1.2) -- cannot create swapchain!");
+		return nullptr;
+	}
 
 
 	// =============================== //
@@ -1084,7 +1510,7 @@ vtek::Swapchain* vtek::swapchain_create(
 	swapchain->imageExtent = imageExtent;
 	swapchain->length = swapchainLength;
 	swapchain->isInvalidated = false;
-	swapchain->presentQueue = vtek::queue_get_handle(presentQueue);
+	swapchain->presentQueue = presentQueue;
 	swapchain->graphicsQueueIndex = qf_indices[0];
 	swapchain->presentQueueIndex = qf_indices[1];
 	swapchain->vsync = info->vsync;
@@ -1157,12 +1583,147 @@ vtek::Swapchain* vtek::swapchain_create(
 	// ================================= //
 	// === Create frame sync objects === //
 	// ================================= //
-	if (!create_frame_sync_objects(swapchain, dev))
+	if (!create_frame_sync_objects(swapchain, dev, info->numFramesInFlight))
+	{
+		vtek_log_error("Failed to create swapchain frame sync objects!");
+		return nullptr;
+	}
+
+	// All done
+	return swapchain;
+}
+
+vtek::Swapchain* vtek::swapchain_create_headless(
+	const SwapchainInfo* info, vtek::Device* device)
+{
+	VkDevice dev = vtek::device_get_handle(device);
+
+	if (!vtek::device_get_timeline_semaphore_support(device))
+	{
+		vtek_log_error("Timeline semaphores not supported by the device {}",
+		               "(requires Vulkan >= 1.2) -- cannot create swapchain!");
+		return nullptr;
+	}
+	if (info->framebufferWidth == 0U || info->framebufferHeight == 0U)
+	{
+		vtek_log_error("Headless swapchain must have non-zero extent!");
+		return nullptr;
+	}
+	if (info->headlessLength == 0U)
+	{
+		vtek_log_error("Headless swapchain must have non-zero length!");
+		return nullptr;
+	}
+	const uint32_t texelSize = get_headless_texel_size(info->headlessFormat);
+	if (info->headlessReadback && texelSize == 0U)
+	{
+		vtek_log_error("Headless swapchain format does not support readback!");
+		return nullptr;
+	}
+	vtek::Queue* graphicsQueue = vtek::device_get_graphics_queue(device);
+	if (graphicsQueue == nullptr)
+	{
+		vtek_log_error("Failed to retrieve graphics queue, cannot create swapchain!");
+		return nullptr;
+	}
+
+	auto swapchain = new vtek::Swapchain;
+	swapchain->isHeadless = true;
+	swapchain->imageFormat = info->headlessFormat;
+	swapchain->imageExtent = { info->framebufferWidth, info->framebufferHeight };
+	swapchain->length = info->headlessLength;
+	swapchain->graphicsQueue = graphicsQueue;
+	swapchain->graphicsQueueIndex = vtek::queue_get_family_index(graphicsQueue);
+	swapchain->presentQueueIndex = swapchain->graphicsQueueIndex;
+	swapchain->physDev = vtek::device_get_physical_handle(device);
+	swapchain->presentLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+	swapchain->readbackEnabled = info->headlessReadback;
+	swapchain->readbackTexelSize = texelSize;
+
+	if (!create_headless_images(swapchain, device))
+	{
+		destroy_headless(swapchain, device);
+		delete swapchain;
+		return nullptr;
+	}
+
+	// Depth buffering
+	vtek::SupportedFormat supportedDepthFormat;
+	if (!get_supported_depth_format(device, supportedDepthFormat))
+	{
+		vtek_log_error("Failed to find suitable swapchain depth image format!");
+		destroy_headless(swapchain, device);
+		delete swapchain;
+		return nullptr;
+	}
+	swapchain->depthImageFormat = supportedDepthFormat.get();
+	swapchain->depthBufferType = info->depthBuffer;
+
+	bool depthCreated = true;
+	switch (info->depthBuffer)
+	{
+	case vtek::SwapchainDepthBuffer::single_shared:
+		depthCreated = create_depth_images(swapchain, device, 1, {});
+		swapchain->fDynRenderBegin = dynrender_begin_shared_depth;
+		break;
+	case vtek::SwapchainDepthBuffer::one_per_image:
+		depthCreated = create_depth_images(swapchain, device, swapchain->length, {});
+		swapchain->fDynRenderBegin = dynrender_begin_oneperimage_depth;
+		break;
+	default:
+		swapchain->depthBufferType = vtek::SwapchainDepthBuffer::none;
+		swapchain->fDynRenderBegin = dynrender_begin_no_depth;
+		break;
+	}
+	if (!depthCreated)
+	{
+		vtek_log_error("Failed to create headless swapchain depth buffers!");
+		destroy_headless(swapchain, device);
+		delete swapchain;
+		return nullptr;
+	}
+
+	// Frame sync objects
+	if (!create_frame_sync_objects(swapchain, dev, info->numFramesInFlight))
 	{
 		vtek_log_error("Failed to create swapchain frame sync objects!");
+		destroy_headless(swapchain, device);
+		delete swapchain;
 		return nullptr;
 	}
 
+	// Readback
+	if (swapchain->readbackEnabled)
+	{
+		const VkSemaphoreTypeCreateInfo typeInfo {
+			.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+			.pNext = nullptr,
+			.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
+			.initialValue = 0UL
+		};
+		const VkSemaphoreCreateInfo semInfo {
+			.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+			.pNext = &typeInfo,
+			.flags = 0U
+		};
+		vtek::CommandPoolInfo poolInfo{};
+		poolInfo.allowIndividualBufferReset = false;
+
+		VkResult result = vkCreateSemaphore(
+			dev, &semInfo, nullptr, &swapchain->readbackTimeline);
+		swapchain->readbackPool =
+			vtek::command_pool_create(&poolInfo, device, graphicsQueue);
+
+		if (result != VK_SUCCESS || swapchain->readbackPool == nullptr ||
+		    !create_readback_resources(swapchain, device))
+		{
+			vtek_log_error("Failed to create headless swapchain readback!");
+			destroy_headless(swapchain, device);
+			delete swapchain;
+			return nullptr;
+		}
+	}
+
 	// All done
 	return swapchain;
 }
@@ -1172,6 +1733,11 @@ bool vtek::swapchain_recreate(
 	uint32_t framebufferWidth, uint32_t framebufferHeight)
 {
 	vtek_log_trace("vtek::swapchain_recreate()");
+	if (swapchain->isHeadless)
+	{
+		return recreate_headless(swapchain, device, framebufferWidth, framebufferHeight);
+	}
+
 	VkDevice dev = vtek::device_get_handle(device);
 	VkPhysicalDevice physDev = swapchain->physDev;
 
@@ -1323,7 +1889,14 @@ bool vtek::swapchain_recreate(
 
 void vtek::swapchain_destroy(vtek::Swapchain* swapchain, vtek::Device* device)
 {
-	if (swapchain == nullptr || swapchain->vulkanHandle == VK_NULL_HANDLE) return;
+	if (swapchain == nullptr) return;
+	if (swapchain->isHeadless)
+	{
+		destroy_headless(swapchain, device);
+		delete swapchain;
+		return;
+	}
+	if (swapchain->vulkanHandle == VK_NULL_HANDLE) return;
 
 	VkDevice dev = vtek::device_get_handle(device);
 
@@ -1347,6 +1920,16 @@ uint32_t vtek::swapchain_get_num_frames_in_flight(vtek::Swapchain* swapchain)
 	return swapchain->numFramesInFlight;
 }
 
+uint64_t vtek::swapchain_get_frame_counter(vtek::Swapchain* swapchain)
+{
+	return swapchain->frameCounter;
+}
+
+VkSemaphore vtek::swapchain_get_frame_timeline_semaphore(vtek::Swapchain* swapchain)
+{
+	return swapchain->frameTimeline;
+}
+
 VkImage vtek::swapchain_get_image(vtek::Swapchain* swapchain, uint32_t index)
 {
 	return swapchain->images[index];
@@ -1380,34 +1963,32 @@ vtek::Format vtek::swapchain_get_depth_image_format(vtek::Swapchain* swapchain)
 vtek::SwapchainStatus vtek::swapchain_wait_begin_frame(
 	vtek::Swapchain* swapchain, vtek::Device* device, uint64_t timeout)
 {
-	// In here, we wait for the fence guarding the current frame index to be in
-	// signaled state, after which the frame may commence.
-
+	// In here, we wait for the frame that last used the current frame index
+	// to complete, after which its semaphores may be reused and the frame
+	// may commence. That frame was submitted `numFramesInFlight` frames ago.
 	VkDevice dev = vtek::device_get_handle(device);
-	uint32_t index = swapchain->currentFrameIndex;
-	VkFence fence = swapchain->inFlightFences[index];
-
-	// Quoting the spec:
-	// If timeout is zero, then vkWaitForFences does not wait, but simply returns
-	// the current state of the fences. VK_TIMEOUT will be returned in this case
-	// if the condition is not satisfied, even though no actual wait was performed.
-	VkResult test = vkWaitForFences(dev, 1, &fence, VK_TRUE, 0UL);
-	if (test == VK_SUCCESS) { return vtek::SwapchainStatus::ok; }
+	const uint64_t nextFrame = swapchain->frameCounter + 1;
+	const uint64_t numFrames = swapchain->numFramesInFlight;
+	const uint64_t value = (nextFrame > numFrames) ? nextFrame - numFrames : 0UL;
 
-	VkResult result = vkWaitForFences(dev, 1, &fence, VK_TRUE, timeout);
-	switch (result)
-	{
-	case VK_SUCCESS: return vtek::SwapchainStatus::ok;
-	case VK_TIMEOUT: return vtek::SwapchainStatus::timeout;
-	default:
-		return vtek::SwapchainStatus::error;
-	}
+	return wait_timeline(dev, swapchain->frameTimeline, value, timeout);
 }
 
 vtek::SwapchainStatus vtek::swapchain_acquire_next_image(
 	vtek::Swapchain* swapchain, vtek::Device* device,
 	uint32_t* frameIndex, uint64_t timeout)
 {
+	// Headless images are acquired in order. They are ready once the
+	// previous copy of the image has completed, which rendering waits for
+	// on the GPU, see `swapchain_fill_queue_submit_info`.
+	if (swapchain->isHeadless)
+	{
+		*frameIndex = swapchain->nextHeadlessImage;
+		swapchain->currentImageIndex = *frameIndex;
+		swapchain->nextHeadlessImage = (*frameIndex + 1) % swapchain->length;
+		return vtek::SwapchainStatus::ok;
+	}
+
 	VkDevice dev = vtek::device_get_handle(device);
 	uint32_t currentFrame = swapchain->currentFrameIndex;
 	VkSemaphore semaphore = swapchain->imageAvailableSemaphores[currentFrame];
@@ -1437,36 +2018,19 @@ vtek::SwapchainStatus vtek::swapchain_wait_image_ready(
 	vtek::Swapchain* swapchain, vtek::Device* device,
 	uint32_t frameIndex, uint64_t timeout)
 {
+	// Wait for the previous frame that rendered into this image, if any,
+	// and then mark the image as in use by the frame about to be submitted.
 	VkDevice dev = vtek::device_get_handle(device);
-	VkFence fence = swapchain->imagesInFlight[frameIndex];
-
-	// Check if a previous frame is using this image, ie. if there is a fence
-	// to wait on.
-	if (fence == VK_NULL_HANDLE)
-	{
-		set_image_in_use(swapchain, dev, frameIndex);
-		return vtek::SwapchainStatus::ok;
-	}
+	uint64_t& imageValue = swapchain->imageTimelineValues[frameIndex];
 
-	// Is the fence already signaled, then return immediately without waiting:
-	VkResult test = vkWaitForFences(dev, 1, &fence, VK_TRUE, 0UL);
-	if (test == VK_SUCCESS)
+	vtek::SwapchainStatus status =
+		wait_timeline(dev, swapchain->frameTimeline, imageValue, timeout);
+	if (status == vtek::SwapchainStatus::ok)
 	{
-		set_image_in_use(swapchain, dev, frameIndex);
-		return vtek::SwapchainStatus::ok;
+		imageValue = swapchain->frameCounter + 1;
 	}
 
-	VkResult result = vkWaitForFences(dev, 1, &fence, VK_TRUE, timeout);
-	switch (result)
-	{
-	case VK_SUCCESS:
-		set_image_in_use(swapchain, dev, frameIndex);
-		return vtek::SwapchainStatus::ok;
-	case VK_TIMEOUT:
-		return vtek::SwapchainStatus::timeout;
-	default:
-		return vtek::SwapchainStatus::error;
-	}
+	return status;
 }
 
 void vtek::swapchain_fill_queue_submit_info(
@@ -1474,17 +2038,48 @@ void vtek::swapchain_fill_queue_submit_info(
 {
 	uint32_t currentIndex = swapchain->currentFrameIndex;
 
+	// The frame signals the next timeline value when it completes
+	swapchain->frameCounter++;
+
+	if (swapchain->isHeadless)
+	{
+		// Presenting an image submits its copy, which waits for rendering.
+		// Rendering waits for the image's previous copy, but the GPU keeps
+		// working on other images in the meantime.
+		if (swapchain->readbackEnabled)
+		{
+			submitInfo->AddSignalSemaphore(
+				swapchain->renderFinishedSemaphores[currentIndex]);
+
+			uint64_t copied = swapchain->readbackValues[swapchain->currentImageIndex];
+			if (copied > 0UL)
+			{
+				submitInfo->AddWaitSemaphore(
+					swapchain->readbackTimeline, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, copied);
+			}
+		}
+		submitInfo->AddSignalSemaphore(
+			swapchain->frameTimeline, swapchain->frameCounter);
+		return;
+	}
+
 	submitInfo->AddSignalSemaphore(
 		swapchain->renderFinishedSemaphores[currentIndex]);
+	submitInfo->AddSignalSemaphore(
+		swapchain->frameTimeline, swapchain->frameCounter);
 	submitInfo->AddWaitSemaphore(
 		swapchain->imageAvailableSemaphores[currentIndex],
 		VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
-	submitInfo->SetPostSignalFence(swapchain->inFlightFences[currentIndex]);
 }
 
 vtek::SwapchainStatus vtek::swapchain_present_frame(
 	vtek::Swapchain* swapchain, uint32_t frameIndex)
 {
+	if (swapchain->isHeadless)
+	{
+		return present_headless(swapchain, frameIndex);
+	}
+
 	uint32_t currentFrame = swapchain->currentFrameIndex;
 
 	const VkPresentInfoKHR info{
@@ -1499,7 +2094,7 @@ vtek::SwapchainStatus vtek::swapchain_present_frame(
 	};
 
 	// Submit frame to present queue
-	VkResult result = vkQueuePresentKHR(swapchain->presentQueue, &info);
+	VkResult result = vtek::queue_present(swapchain->presentQueue, &info);
 	switch (result)
 	{
 	case VK_SUCCESS:
@@ -1519,6 +2114,61 @@ vtek::SwapchainStatus vtek::swapchain_present_frame(
 	}
 }
 
+bool vtek::swapchain_is_headless(vtek::Swapchain* swapchain)
+{
+	return swapchain->isHeadless;
+}
+
+bool vtek::swapchain_poll_readback(
+	vtek::Swapchain* swapchain, vtek::Device* device, vtek::SwapchainReadback* outReadback)
+{
+	if (!swapchain->readbackEnabled) { return false; }
+
+	VkDevice dev = vtek::device_get_handle(device);
+	uint64_t completed = 0UL;
+	if (vkGetSemaphoreCounterValue(dev, swapchain->readbackTimeline, &completed) != VK_SUCCESS)
+	{
+		vtek_log_error("Failed to query headless swapchain readback timeline!");
+		return false;
+	}
+
+	// Oldest completed copy which has not been returned yet
+	uint32_t index = UINT32_MAX;
+	for (uint32_t i = 0; i < swapchain->length; i++)
+	{
+		if (!swapchain->readbackUnread[i] || swapchain->readbackValues[i] > completed)
+		{
+			continue;
+		}
+		if (index == UINT32_MAX ||
+		    swapchain->readbackValues[i] < swapchain->readbackValues[index])
+		{
+			index = i;
+		}
+	}
+	if (index == UINT32_MAX) { return false; }
+
+	vtek::Buffer* buffer = swapchain->readbackBuffers[index];
+	if (!buffer->memoryProperties.has_flag(vtek::MemoryProperty::host_coherent))
+	{
+		const vtek::BufferRegion region{ 0UL, VK_WHOLE_SIZE };
+		vtek::allocator_buffer_invalidate(buffer, &region);
+	}
+	swapchain->readbackUnread[index] = false;
+
+	const VkExtent2D extent = swapchain->imageExtent;
+	outReadback->data = swapchain->readbackMappings[index];
+	outReadback->size =
+		static_cast<uint64_t>(extent.width) * extent.height * swapchain->readbackTexelSize;
+	outReadback->rowPitch = extent.width * swapchain->readbackTexelSize;
+	outReadback->extent = extent;
+	outReadback->format = swapchain->imageFormat;
+	outReadback->imageIndex = index;
+	outReadback->frameNumber = swapchain->readbackFrameNumbers[index];
+
+	return true;
+}
+
 void vtek::swapchain_dynamic_rendering_begin(
 	vtek::Swapchain* swapchain, uint32_t imageIndex,
 	vtek::CommandBuffer* commandBuffer, glm::vec3 clearColor)
@@ -1535,14 +2185,15 @@ void vtek::swapchain_dynamic_rendering_end(
 	// End dynamic rendering
 	vkCmdEndRendering(cmdBuf);
 
-	// Transition from color attachment to present src
+	// Transition from color attachment to present src, or to transfer src
+	// for headless swapchains, whose images are copied when presented.
 	VkImageMemoryBarrier barrier{
 		.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
 		.pNext = nullptr,
 		.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
 		.dstAccessMask = 0,
 		.oldLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-		.newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+		.newLayout = swapchain->presentLayout,
 		.srcQueueFamilyIndex = swapchain->graphicsQueueIndex,
 		.dstQueueFamilyIndex = swapchain->presentQueueIndex,
 		.image = swapchain->images[imageIndex],
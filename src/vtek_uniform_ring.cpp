@@ -0,0 +1,172 @@
+#include "vtek_vulkan.pch"
+#include "vtek_uniform_ring.hpp"
+
+#include "impl/vtek_vma_helpers.hpp"
+#include "vtek_buffer.hpp"
+#include "vtek_device.hpp"
+#include "vtek_logging.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+
+/* struct implementation */
+struct vtek::UniformRing
+{
+	vtek::Buffer* buffer {nullptr};
+	uint8_t* mappedPtr {nullptr};
+
+	uint64_t regionSize {0UL};
+	uint64_t alignment {1UL};
+	uint32_t numFrames {0U};
+
+	// Start of the current frame's region, and write head within it
+	uint64_t regionOffset {0UL};
+	uint64_t head {0UL};
+};
+
+
+
+/* helper functions */
+static uint64_t align_up(uint64_t value, uint64_t alignment)
+{
+	return (value + alignment - 1) / alignment * alignment;
+}
+
+
+
+/* interface */
+vtek::UniformRing* vtek::uniform_ring_create(
+	const vtek::UniformRingInfo* info, vtek::Device* device)
+{
+	if (info->numFrames == 0U || info->sizePerFrame == 0UL)
+	{
+		vtek_log_error("Uniform ring must have non-zero size and frame count!");
+		return nullptr;
+	}
+
+	// Offsets must be aligned to what the device requires for dynamic
+	// offsets, which is at most 256 bytes on any implementation.
+	auto limits = vtek::device_get_physical_properties(device)->limits;
+	uint64_t alignment = limits.minUniformBufferOffsetAlignment;
+	if (info->allowStorageBuffer)
+	{
+		alignment = std::max<uint64_t>(
+			alignment, limits.minStorageBufferOffsetAlignment);
+	}
+	alignment = std::max<uint64_t>(alignment, 1UL);
+
+	const uint64_t regionSize = align_up(info->sizePerFrame, alignment);
+	const uint64_t totalSize = regionSize * info->numFrames;
+
+	// Dynamic offsets are 32-bit in Vulkan
+	if (totalSize > UINT32_MAX)
+	{
+		vtek_log_error("Uniform ring size exceeds 32-bit dynamic offsets -- {}",
+		               "cannot create uniform ring!");
+		return nullptr;
+	}
+
+	vtek::BufferInfo bufferInfo{};
+	bufferInfo.size = totalSize;
+	bufferInfo.requireHostVisibleStorage = true;
+	bufferInfo.disallowInternalStagingBuffer = true;
+	bufferInfo.writePolicy = vtek::BufferWritePolicy::overwrite_often;
+	bufferInfo.usageFlags = vtek::BufferUsageFlag::uniform_buffer;
+	if (info->allowStorageBuffer)
+	{
+		bufferInfo.usageFlags.add_flag(vtek::BufferUsageFlag::storage_buffer);
+	}
+
+	auto ring = new vtek::UniformRing;
+	ring->buffer = vtek::buffer_create(&bufferInfo, device);
+	if (ring->buffer == nullptr)
+	{
+		vtek_log_error("Failed to create buffer for uniform ring!");
+		delete ring;
+		return nullptr;
+	}
+
+	// The ring stays mapped for its entire lifetime
+	ring->mappedPtr = static_cast<uint8_t*>(
+		vtek::allocator_buffer_map(ring->buffer));
+	if (ring->mappedPtr == nullptr)
+	{
+		vtek_log_error("Failed to map uniform ring buffer!");
+		vtek::buffer_destroy(ring->buffer);
+		delete ring;
+		return nullptr;
+	}
+
+	ring->regionSize = regionSize;
+	ring->alignment = alignment;
+	ring->numFrames = info->numFrames;
+
+	return ring;
+}
+
+void vtek::uniform_ring_destroy(vtek::UniformRing* ring)
+{
+	if (ring == nullptr) return;
+
+	if (ring->mappedPtr != nullptr)
+	{
+		vtek::allocator_buffer_unmap(ring->buffer);
+		ring->mappedPtr = nullptr;
+	}
+	vtek::buffer_destroy(ring->buffer);
+	ring->buffer = nullptr;
+
+	delete ring;
+}
+
+vtek::Buffer* vtek::uniform_ring_get_buffer(vtek::UniformRing* ring)
+{
+	return ring->buffer;
+}
+
+void vtek::uniform_ring_begin_frame(vtek::UniformRing* ring, uint32_t frameIndex)
+{
+	if (frameIndex >= ring->numFrames)
+	{
+		vtek_log_error("Uniform ring frame index {} out of range!", frameIndex);
+		frameIndex = frameIndex % ring->numFrames;
+	}
+
+	ring->regionOffset = ring->regionSize * frameIndex;
+	ring->head = 0UL;
+}
+
+bool vtek::uniform_ring_push(
+	vtek::UniformRing* ring, const void* data, uint64_t size, uint32_t* outOffset)
+{
+	uint64_t offset = align_up(ring->head, ring->alignment);
+	if (offset + size > ring->regionSize)
+	{
+		vtek_log_error("Uniform ring is full for this frame ({} bytes) -- {}",
+		               ring->regionSize, "cannot push uniform data!");
+		return false;
+	}
+
+	std::memcpy(ring->mappedPtr + ring->regionOffset + offset, data, size);
+	ring->head = offset + size;
+
+	*outOffset = static_cast<uint32_t>(ring->regionOffset + offset);
+	return true;
+}
+
+void vtek::uniform_ring_flush(vtek::UniformRing* ring)
+{
+	if (ring->head == 0UL) { return; }
+
+	auto memProps = ring->buffer->memoryProperties;
+	if (memProps.has_flag(vtek::MemoryProperty::host_coherent)) { return; }
+
+	vtek::BufferRegion region{ ring->regionOffset, ring->head };
+	vtek::allocator_buffer_flush(ring->buffer, &region);
+}
+
+uint64_t vtek::uniform_ring_get_frame_usage(vtek::UniformRing* ring)
+{
+	return ring->head;
+}
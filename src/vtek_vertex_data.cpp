@@ -18,6 +18,11 @@ static uint32_t get_vertex_size(VAT vt)
 	case VAT::vec2:  return sizeof(glm::vec2);
 	case VAT::vec3:  return sizeof(glm::vec3);
 	case VAT::vec4:  return sizeof(glm::vec4);
+	case VAT::vec4_half:    return 4 * sizeof(uint16_t);
+	case VAT::vec4_unorm16: return 4 * sizeof(uint16_t);
+	case VAT::vec2_unorm16: return 2 * sizeof(uint16_t);
+	case VAT::vec2_snorm16: return 2 * sizeof(int16_t);
+	case VAT::vec2_snorm8:  return 2 * sizeof(int8_t);
 	default:
 		vtek_log_error(
 			"vtek_vertex_data.cpp: Invalid vertex type to calculate offset!");
@@ -54,6 +59,11 @@ static VkFormat get_vertex_format(VAT vt)
 	case VAT::vec2:  return VK_FORMAT_R32G32_SFLOAT;
 	case VAT::vec3:  return VK_FORMAT_R32G32B32_SFLOAT;
 	case VAT::vec4:  return VK_FORMAT_R32G32B32A32_SFLOAT;
+	case VAT::vec4_half:    return VK_FORMAT_R16G16B16A16_SFLOAT;
+	case VAT::vec4_unorm16: return VK_FORMAT_R16G16B16A16_UNORM;
+	case VAT::vec2_unorm16: return VK_FORMAT_R16G16_UNORM;
+	case VAT::vec2_snorm16: return VK_FORMAT_R16G16_SNORM;
+	case VAT::vec2_snorm8:  return VK_FORMAT_R8G8_SNORM;
 	default:
 		vtek_log_error(
 			"vtek_vertex_data.cpp: Invalid vertex type to calculate format!");
@@ -65,6 +75,16 @@ static VkFormat get_vertex_format(VAT vt)
 // ============================== //
 // === Vertex buffer bindings === //
 // ============================== //
+uint32_t vtek::vertex_attribute_get_size(VAT type)
+{
+	return get_vertex_size(type);
+}
+
+uint32_t vtek::vertex_attribute_align(uint32_t offset)
+{
+	return (offset + 3U) & ~3U;
+}
+
 void vtek::VertexBufferBindings::add_buffer(VAT vt, VIR rate)
 {
 	VkVertexInputAttributeDescription attrDesc{};
@@ -86,40 +106,52 @@ void vtek::VertexBufferBindings::add_buffer(VAT vt, VIR rate)
 
 void vtek::VertexBufferBindings::add_buffer(VAT vt1, VAT vt2, VIR rate)
 {
-	VkVertexInputAttributeDescription attrDesc1{};
-	attrDesc1.binding = mBindCount;
-	attrDesc1.location = mLocCount;
-	attrDesc1.format = get_vertex_format(vt1);
-	attrDesc1.offset = 0;
-	mAttrDesc.emplace_back(attrDesc1);
-	mLocCount++;
-
-	VkVertexInputAttributeDescription attrDesc2{};
-	attrDesc2.binding = mBindCount;
-	attrDesc2.location = mLocCount;
-	attrDesc2.format = get_vertex_format(vt2);
-	attrDesc2.offset = get_vertex_size(vt1);
-	mAttrDesc.emplace_back(attrDesc2);
-	mLocCount++;
-
-	VkVertexInputBindingDescription bindDesc{};
-	bindDesc.binding = mBindCount;
-	bindDesc.stride = get_vertex_size(vt1) + get_vertex_size(vt2);
-	bindDesc.inputRate = get_vertex_input_rate(rate);
-	mBindDesc.emplace_back(bindDesc);
-	mBindCount++;
+	const VAT types[2] = { vt1, vt2 };
+	add_interleaved_buffer(types, 2, rate);
 }
 
 void vtek::VertexBufferBindings::add_buffer(VAT vt1, VAT vt2, VAT vt3, VIR rate)
 {
-	vtek_log_error(
-		"vtek_vertex_data.cpp: add_buffer(vt1, vt2, vt3, rate): Not implemented!");
+	const VAT types[3] = { vt1, vt2, vt3 };
+	add_interleaved_buffer(types, 3, rate);
 }
 
 void vtek::VertexBufferBindings::add_buffer(
 	VAT vt1, VAT vt2, VAT vt3, VAT vt4, VIR rate)
 {
-	vtek_log_error(
-		"vtek_vertex_data.cpp: add_buffer(vt1, vt2, vt3, vt4, rate): {}",
-		"Not implemented!");
+	const VAT types[4] = { vt1, vt2, vt3, vt4 };
+	add_interleaved_buffer(types, 4, rate);
+}
+
+void vtek::VertexBufferBindings::add_instance_transform_buffer()
+{
+	const VAT types[4] = { VAT::vec4, VAT::vec4, VAT::vec4, VAT::vec4 };
+	add_interleaved_buffer(types, 4, VIR::per_instance);
+}
+
+void vtek::VertexBufferBindings::add_interleaved_buffer(
+	const VAT* types, uint32_t count, VIR rate)
+{
+	// Attributes are packed in the given order at 4-byte aligned offsets,
+	// and each attribute is assigned the next shader location.
+	uint32_t offset = 0U;
+	for (uint32_t i = 0; i < count; i++)
+	{
+		VkVertexInputAttributeDescription attrDesc{};
+		attrDesc.binding = mBindCount;
+		attrDesc.location = mLocCount;
+		attrDesc.format = get_vertex_format(types[i]);
+		attrDesc.offset = offset;
+		mAttrDesc.emplace_back(attrDesc);
+		mLocCount++;
+
+		offset += vertex_attribute_align(get_vertex_size(types[i]));
+	}
+
+	VkVertexInputBindingDescription bindDesc{};
+	bindDesc.binding = mBindCount;
+	bindDesc.stride = offset;
+	bindDesc.inputRate = get_vertex_input_rate(rate);
+	mBindDesc.emplace_back(bindDesc);
+	mBindCount++;
 }
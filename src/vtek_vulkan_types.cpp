@@ -58,6 +58,18 @@ VkCullModeFlags vtek::get_cull_mode(vtek::CullMode mode)
 	}
 }
 
+VkIndexType vtek::get_index_type(vtek::IndexType type)
+{
+	switch (type)
+	{
+	case vtek::IndexType::uint16: return VK_INDEX_TYPE_UINT16;
+	case vtek::IndexType::uint32: return VK_INDEX_TYPE_UINT32;
+	default:
+		vtek_log_error("vtek::get_index_type(): Invalid index type!");
+		return VK_INDEX_TYPE_UINT32;
+	}
+}
+
 VkPipelineStageFlags vtek::get_pipeline_stage(vtek::PipelineStage stage)
 {
 	switch (stage)
@@ -65,7 +77,7 @@ VkPipelineStageFlags vtek::get_pipeline_stage(vtek::PipelineStage stage)
 	case vtek::PipelineStage::top_of_pipe:
 		return VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
 	case vtek::PipelineStage::draw_indirect:
-		return VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+		return VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT;
 	case vtek::PipelineStage::vertex_input:
 		return VK_PIPELINE_STAGE_VERTEX_INPUT_BIT;
 	case vtek::PipelineStage::vertex_shader:
@@ -0,0 +1,241 @@
+#include "vtek_vulkan.pch"
+#define VTEK_DISABLE_LOGGING
+#include <vtek/vtek.hpp>
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include <boost/ut.hpp>
+using namespace boost::ut;
+
+// Camera at the origin looking down -z, with near plane at z = -0.5 and
+// far plane at z = -100.
+constexpr float kNear = 0.5f;
+constexpr float kFar = 100.0f;
+
+// Objects closer than this to any plane are skipped in randomized tests,
+// since the SIMD kernels may round differently from the scalar tests.
+constexpr float kTieEpsilon = 0.001f;
+
+vtek::Frustum make_frustum()
+{
+	glm::mat4 projection = glm::perspective(
+		glm::radians(60.0f), 16.0f / 9.0f, kNear, kFar);
+	glm::mat4 view = glm::lookAt(
+		glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	return vtek::frustum_extract(projection * view);
+}
+
+float min_plane_margin(const vtek::Frustum& frustum, const vtek::BoundingSphere& sphere)
+{
+	float margin = 1e30f;
+	for (const glm::vec4& plane : frustum.planes)
+	{
+		float d = glm::dot(glm::vec3(plane), sphere.center) + plane.w + sphere.radius;
+		margin = glm::min(margin, glm::abs(d));
+	}
+	return margin;
+}
+
+float min_plane_margin(const vtek::Frustum& frustum, const vtek::BoundingBox& box)
+{
+	const glm::vec3 center = (box.min + box.max) * 0.5f;
+	const glm::vec3 extent = (box.max - box.min) * 0.5f;
+	float margin = 1e30f;
+	for (const glm::vec4& plane : frustum.planes)
+	{
+		const glm::vec3 normal(plane);
+		float d = glm::dot(normal, center) + plane.w + glm::dot(glm::abs(normal), extent);
+		margin = glm::min(margin, glm::abs(d));
+	}
+	return margin;
+}
+
+// Random objects spread around and beyond the frustum, so that roughly
+// half of them are culled.
+void make_random_objects(
+	const vtek::Frustum& frustum, uint32_t count, uint32_t seed,
+	vtek::CullingSpheres& spheres, vtek::CullingBoxes& boxes)
+{
+	std::default_random_engine re(seed);
+	std::uniform_real_distribution<float> xy(-80.0f, 80.0f);
+	std::uniform_real_distribution<float> z(-120.0f, 10.0f);
+	std::uniform_real_distribution<float> size(0.05f, 4.0f);
+
+	spheres.clear();
+	while (spheres.size() < count)
+	{
+		vtek::BoundingSphere sphere { glm::vec3(xy(re), xy(re), z(re)), size(re) };
+		if (min_plane_margin(frustum, sphere) > kTieEpsilon) { spheres.add(sphere); }
+	}
+
+	boxes.clear();
+	while (boxes.size() < count)
+	{
+		glm::vec3 center(xy(re), xy(re), z(re));
+		glm::vec3 extent(size(re), size(re), size(re));
+		vtek::BoundingBox box { center - extent, center + extent };
+		if (min_plane_margin(frustum, box) > kTieEpsilon) { boxes.add(box); }
+	}
+}
+
+std::vector<uint32_t> reference_spheres(
+	const vtek::Frustum& frustum, const vtek::CullingSpheres& spheres)
+{
+	std::vector<uint32_t> visible;
+	for (uint32_t i = 0; i < spheres.size(); i++)
+	{
+		vtek::BoundingSphere sphere {
+			glm::vec3(spheres.x[i], spheres.y[i], spheres.z[i]), spheres.radius[i] };
+		if (vtek::frustum_test_sphere(&frustum, sphere)) { visible.push_back(i); }
+	}
+	return visible;
+}
+
+std::vector<uint32_t> reference_boxes(
+	const vtek::Frustum& frustum, const vtek::CullingBoxes& boxes)
+{
+	std::vector<uint32_t> visible;
+	for (uint32_t i = 0; i < boxes.size(); i++)
+	{
+		vtek::BoundingBox box {
+			glm::vec3(boxes.minX[i], boxes.minY[i], boxes.minZ[i]),
+			glm::vec3(boxes.maxX[i], boxes.maxY[i], boxes.maxZ[i]) };
+		if (vtek::frustum_test_box(&frustum, box)) { visible.push_back(i); }
+	}
+	return visible;
+}
+
+bool same_indices(const std::vector<uint32_t>& a, const std::vector<uint32_t>& b)
+{
+	return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin());
+}
+
+
+
+void test_frustum_extract()
+{
+	vtek::Frustum frustum = make_frustum();
+
+	for (const glm::vec4& plane : frustum.planes)
+	{
+		float len = glm::length(glm::vec3(plane));
+		expect(glm::abs(len - 1.0f) < 0.0001f) << "plane normal is not normalized: " << len;
+	}
+
+	// Near and far planes face each other along the view axis
+	expect(frustum.planes[4].z < -0.999f) << "near plane does not face -z!";
+	expect(glm::abs(frustum.planes[4].w + kNear) < 0.0001f) << "wrong near distance!";
+	expect(frustum.planes[5].z > 0.999f) << "far plane does not face +z!";
+	expect(glm::abs(frustum.planes[5].w - kFar) < 0.01f) << "wrong far distance!";
+
+	// Side planes are tilted inwards
+	expect(frustum.planes[0].x > 0.0f) << "left plane does not face +x!";
+	expect(frustum.planes[1].x < 0.0f) << "right plane does not face -x!";
+	expect(frustum.planes[2].y > 0.0f) << "bottom plane does not face +y!";
+	expect(frustum.planes[3].y < 0.0f) << "top plane does not face -y!";
+
+	vtek::BoundingSphere ahead { glm::vec3(0.0f, 0.0f, -10.0f), 0.0f };
+	vtek::BoundingSphere behind { glm::vec3(0.0f, 0.0f, 10.0f), 0.0f };
+	vtek::BoundingSphere aside { glm::vec3(50.0f, 0.0f, -10.0f), 1.0f };
+	expect(vtek::frustum_test_sphere(&frustum, ahead)) << "point ahead was culled!";
+	expect(!vtek::frustum_test_sphere(&frustum, behind)) << "point behind was not culled!";
+	expect(!vtek::frustum_test_sphere(&frustum, aside)) << "point aside was not culled!";
+}
+
+// Objects straddling the near and far planes are visible, and objects just
+// beyond them are not. Each count puts them in different SIMD lanes and in
+// the scalar remainder.
+void test_near_far_straddling(uint32_t count)
+{
+	vtek::Frustum frustum = make_frustum();
+
+	struct Case { float z; float r; bool visible; };
+	const Case cases[] = {
+		{ -kNear, 0.2f, true },           // centered on the near plane
+		{ -kNear + 0.3f, 0.4f, true },    // mostly in front of the near plane
+		{ -kNear + 0.5f, 0.2f, false },   // entirely in front of the near plane
+		{ -kFar, 1.0f, true },            // centered on the far plane
+		{ -kFar - 0.5f, 1.0f, true },     // mostly beyond the far plane
+		{ -kFar - 1.5f, 1.0f, false },    // entirely beyond the far plane
+	};
+	constexpr uint32_t kNumCases = sizeof(cases) / sizeof(cases[0]);
+
+	vtek::CullingSpheres spheres;
+	vtek::CullingBoxes boxes;
+	std::vector<uint32_t> expected;
+	for (uint32_t i = 0; i < count; i++)
+	{
+		const Case& c = cases[i % kNumCases];
+		glm::vec3 center(0.0f, 0.0f, c.z);
+		spheres.add({ center, c.r });
+		boxes.add({ center - glm::vec3(c.r), center + glm::vec3(c.r) });
+		if (c.visible) { expected.push_back(i); }
+	}
+
+	std::vector<uint32_t> visible;
+	vtek::frustum_cull_spheres(&frustum, &spheres, visible);
+	expect(same_indices(visible, expected)) << "wrong near/far spheres, count=" << count;
+	expect(same_indices(reference_spheres(frustum, spheres), expected))
+		<< "wrong near/far scalar spheres, count=" << count;
+
+	vtek::frustum_cull_boxes(&frustum, &boxes, visible);
+	expect(same_indices(visible, expected)) << "wrong near/far boxes, count=" << count;
+	expect(same_indices(reference_boxes(frustum, boxes), expected))
+		<< "wrong near/far scalar boxes, count=" << count;
+}
+
+// The SIMD kernels must agree with the scalar tests, including counts that
+// do not fill the last SIMD register.
+void test_simd_matches_scalar(uint32_t count, uint32_t numThreads)
+{
+	vtek::Frustum frustum = make_frustum();
+	vtek::CullingSpheres spheres;
+	vtek::CullingBoxes boxes;
+	make_random_objects(frustum, count, 1000U + count, spheres, boxes);
+
+	std::vector<uint32_t> visible;
+	uint32_t numVisible = vtek::frustum_cull_spheres(&frustum, &spheres, visible, numThreads);
+	expect(numVisible == visible.size()) << "sphere count mismatch, count=" << count;
+	expect(same_indices(visible, reference_spheres(frustum, spheres)))
+		<< "spheres differ from scalar, count=" << count << ", threads=" << numThreads;
+
+	numVisible = vtek::frustum_cull_boxes(&frustum, &boxes, visible, numThreads);
+	expect(numVisible == visible.size()) << "box count mismatch, count=" << count;
+	expect(same_indices(visible, reference_boxes(frustum, boxes)))
+		<< "boxes differ from scalar, count=" << count << ", threads=" << numThreads;
+}
+
+
+
+int main()
+{
+	"culling_tests"_test = []{
+		"frustum_extract"_test = []{
+			test_frustum_extract();
+		};
+
+		"near_far_straddling"_test = []{
+			for (uint32_t count : { 1U, 6U, 7U, 8U, 13U, 17U, 31U })
+			{
+				test_near_far_straddling(count);
+			}
+		};
+
+		"simd_matches_scalar"_test = []{
+			for (uint32_t count = 0; count <= 20; count++)
+			{
+				test_simd_matches_scalar(count, 1U);
+			}
+			test_simd_matches_scalar(1001U, 1U);
+			test_simd_matches_scalar(4099U, 1U);
+		};
+
+		// Large enough for several threads, and not a multiple of the chunk
+		// alignment, so the last chunk is partial.
+		"multithreaded"_test = []{
+			test_simd_matches_scalar(100003U, 4U);
+			test_simd_matches_scalar(70001U, 8U);
+		};
+	};
+}
@@ -0,0 +1,380 @@
+#include "vtek_vulkan.pch"
+#define VTEK_DISABLE_LOGGING
+#include <vtek/vtek.hpp>
+#include "meshutils/vtek_gltf.hpp"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <boost/ut.hpp>
+using namespace boost::ut;
+
+namespace fs = std::filesystem;
+
+// A single triangle: three float positions (36 bytes) followed by three
+// 16-bit indices (6 bytes), padded to 44 bytes.
+const float kPositions[9] = { 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f };
+const uint16_t kIndices[3] = { 0, 1, 2 };
+constexpr uint32_t kBufferSize = 44U;
+
+// The buffer is referenced as "BUFFER", which is replaced with either an
+// external file or the GLB binary chunk.
+const std::string kValidJson = R"({
+	"asset": { "version": "2.0" },
+	"scene": 0,
+	"scenes": [ { "nodes": [ 0 ] } ],
+	"nodes": [ { "mesh": 0, "children": [] } ],
+	"meshes": [ { "primitives": [
+		{ "attributes": { "POSITION": 0 }, "indices": 1, "material": 0 }
+	] } ],
+	"materials": [ { "name": "MATERIAL_NAME" } ],
+	"accessors": [
+		{ "bufferView": 0, "componentType": 5126, "count": 3, "type": "VEC3",
+		  "min": [ 0, 0, 0 ], "max": [ 1, 1, 0 ] },
+		{ "bufferView": 1, "componentType": 5123, "count": 3, "type": "SCALAR" }
+	],
+	"bufferViews": [
+		{ "buffer": 0, "byteOffset": 0, "byteLength": 36 },
+		{ "buffer": 0, "byteOffset": 36, "byteLength": 6 }
+	],
+	"buffers": [ { BUFFER "byteLength": 44 } ]
+})";
+
+std::vector<uint8_t> make_buffer()
+{
+	std::vector<uint8_t> buffer(kBufferSize, 0);
+	std::memcpy(buffer.data(), kPositions, sizeof(kPositions));
+	std::memcpy(buffer.data() + sizeof(kPositions), kIndices, sizeof(kIndices));
+	return buffer;
+}
+
+// Returns `text` with the first occurrence of `from` replaced, and fails the
+// test if there is none, so that broken test inputs are not mistaken for
+// rejected files.
+std::string replaced(std::string text, std::string_view from, std::string_view to)
+{
+	size_t pos = text.find(from);
+	expect(pos != std::string::npos) << "test input does not contain " << from << fatal;
+	return text.replace(pos, from.size(), to);
+}
+
+std::string make_gltf(std::string_view from = "", std::string_view to = "")
+{
+	std::string json = replaced(kValidJson, "BUFFER", R"("uri": "buffer.bin",)");
+	return from.empty() ? json : replaced(json, from, to);
+}
+
+void append_u32(std::string& out, uint32_t value)
+{
+	out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+// GLB container, where chunk lengths may be overridden to test corrupt files
+struct GlbLengths
+{
+	int64_t total {-1};
+	int64_t json {-1};
+	int64_t bin {-1};
+};
+
+std::string make_glb(std::string json, const GlbLengths& lengths = {})
+{
+	while (json.size() % 4 != 0) { json += ' '; }
+	const std::vector<uint8_t> bin = make_buffer();
+
+	std::string glb;
+	append_u32(glb, 0x46546C67U); // "glTF"
+	append_u32(glb, 2U);
+	append_u32(glb, 12U + 8U + json.size() + 8U + bin.size());
+	append_u32(glb, json.size());
+	append_u32(glb, 0x4E4F534AU); // "JSON"
+	glb += json;
+	append_u32(glb, bin.size());
+	append_u32(glb, 0x004E4942U); // "BIN\0"
+	glb.append(reinterpret_cast<const char*>(bin.data()), bin.size());
+
+	auto patch = [&glb](size_t offset, int64_t value) {
+		if (value < 0) { return; }
+		uint32_t v = static_cast<uint32_t>(value);
+		std::memcpy(glb.data() + offset, &v, sizeof(v));
+	};
+	patch(8, lengths.total);
+	patch(12, lengths.json);
+	patch(20 + json.size(), lengths.bin);
+
+	return glb;
+}
+
+std::string make_glb_json()
+{
+	return replaced(kValidJson, "BUFFER", "");
+}
+
+class GltfFixture
+{
+public:
+	GltfFixture()
+	{
+		mPath = fs::temp_directory_path() / "vtek_test_gltf";
+		fs::remove_all(mPath);
+		fs::create_directories(mPath);
+		mDir = vtek::directory_open(mPath.string());
+
+		const std::vector<uint8_t> buffer = make_buffer();
+		write("buffer.bin", std::string(buffer.begin(), buffer.end()));
+	}
+
+	~GltfFixture()
+	{
+		vtek::directory_close(mDir);
+		fs::remove_all(mPath);
+	}
+
+	void write(const std::string& filename, const std::string& contents)
+	{
+		std::ofstream file(mPath / filename, std::ios::binary | std::ios::trunc);
+		file.write(contents.data(), contents.size());
+	}
+
+	bool load(const std::string& filename, const std::string& contents,
+	          vtek::GltfDocument* doc)
+	{
+		write(filename, contents);
+		return vtek::gltf_load(mDir, filename, doc);
+	}
+
+	bool load(const std::string& filename, const std::string& contents)
+	{
+		vtek::GltfDocument doc;
+		bool ret = load(filename, contents, &doc);
+		vtek::gltf_release(&doc);
+		return ret;
+	}
+
+	bool load_gltf(const std::string& contents) { return load("test.gltf", contents); }
+	bool load_glb(const std::string& contents) { return load("test.glb", contents); }
+
+private:
+	fs::path mPath;
+	vtek::Directory* mDir {nullptr};
+};
+
+
+
+void test_valid_document(vtek::GltfDocument& doc)
+{
+	expect(doc.accessors.size() == 2U && doc.bufferViews.size() == 2U) << fatal;
+	expect(doc.meshes.size() == 1U && doc.meshes[0].primitives.size() == 1U) << fatal;
+	expect(doc.sceneNodes.size() == 1U && doc.sceneNodes[0] == 0U) << "wrong scene roots!";
+	expect(doc.accessors[0].hasBounds) << "position bounds were not read!";
+
+	uint64_t stride = 0UL;
+	const uint8_t* positions = vtek::gltf_get_accessor_data(&doc, doc.accessors[0], &stride);
+	expect(positions != nullptr && stride == 12UL) << "invalid position accessor!" << fatal;
+	expect(std::memcmp(positions, kPositions, sizeof(kPositions)) == 0) << "wrong positions!";
+
+	const uint8_t* indices = vtek::gltf_get_accessor_data(&doc, doc.accessors[1], &stride);
+	expect(indices != nullptr && stride == 2UL) << "invalid index accessor!" << fatal;
+	expect(std::memcmp(indices, kIndices, sizeof(kIndices)) == 0) << "wrong indices!";
+}
+
+void test_valid(GltfFixture& fixture)
+{
+	vtek::GltfDocument doc;
+	expect(fixture.load("test.gltf", make_gltf(), &doc)) << "failed to load .gltf!";
+	test_valid_document(doc);
+	vtek::gltf_release(&doc);
+
+	expect(fixture.load("test.glb", make_glb(make_glb_json()), &doc)) << "failed to load .glb!";
+	test_valid_document(doc);
+	vtek::gltf_release(&doc);
+}
+
+void test_malformed_json(GltfFixture& fixture)
+{
+	const std::string valid = make_gltf();
+	expect(!fixture.load_gltf(valid.substr(0, valid.size() - 1))) << "accepted missing brace!";
+	expect(!fixture.load_gltf(valid + "}")) << "accepted trailing brace!";
+	expect(!fixture.load_gltf(valid + " x")) << "accepted trailing garbage!";
+	expect(!fixture.load_gltf(make_gltf("\"scene\": 0,", "\"scene\": 0,,")))
+		<< "accepted double comma!";
+	expect(!fixture.load_gltf(make_gltf("\"children\": []", "\"children\": [0,]")))
+		<< "accepted trailing comma!";
+	expect(!fixture.load_gltf(valid.substr(0, valid.find("MATERIAL_NAME") + 4)))
+		<< "accepted unterminated string!";
+	expect(!fixture.load_gltf(make_gltf("MATERIAL_NAME", "bad\\escape")))
+		<< "accepted invalid escape!";
+	expect(!fixture.load_gltf(make_gltf("\"scene\": 0", "\"scene\": inf")))
+		<< "accepted inf!";
+	expect(!fixture.load_gltf(make_gltf("\"scene\": 0", "\"scene\": 0.0.0")))
+		<< "accepted malformed number!";
+	expect(!fixture.load_gltf(make_gltf("\"scene\": 0", "\"scene\": tru")))
+		<< "accepted truncated literal!";
+	expect(!fixture.load_gltf("[]")) << "accepted non-object root!";
+	expect(!fixture.load_gltf("")) << "accepted empty file!";
+	expect(!fixture.load_gltf(make_gltf("\"2.0\"", "\"1.0\""))) << "accepted glTF 1.0!";
+
+	// Nesting beyond the depth limit must fail instead of overflowing the stack
+	const std::string deep = std::string(100000, '[') + std::string(100000, ']');
+	expect(!fixture.load_gltf(make_gltf("\"scene\": 0", "\"extras\": " + deep + ", \"scene\": 0")))
+		<< "accepted deep nesting!";
+}
+
+void test_surrogates(GltfFixture& fixture)
+{
+	// U+1F600 encoded as a surrogate pair, and U+00E9 as a single escape
+	vtek::GltfDocument doc;
+	expect(fixture.load("test.gltf", make_gltf("MATERIAL_NAME", "\\uD83D\\uDE00-\\u00e9"), &doc))
+		<< "rejected valid surrogate pair!";
+	expect(doc.materials.size() == 1U) << fatal;
+	expect(doc.materials[0].name == "\xF0\x9F\x98\x80-\xC3\xA9")
+		<< "surrogate pair decoded incorrectly!";
+	vtek::gltf_release(&doc);
+
+	expect(!fixture.load_gltf(make_gltf("MATERIAL_NAME", "\\uD83D")))
+		<< "accepted unpaired high surrogate at the end!";
+	expect(!fixture.load_gltf(make_gltf("MATERIAL_NAME", "\\uD83Dx")))
+		<< "accepted unpaired high surrogate!";
+	expect(!fixture.load_gltf(make_gltf("MATERIAL_NAME", "\\uD83D\\u0041")))
+		<< "accepted high surrogate followed by a non-surrogate!";
+	expect(!fixture.load_gltf(make_gltf("MATERIAL_NAME", "\\uD83D\\uD83D")))
+		<< "accepted two high surrogates!";
+	expect(!fixture.load_gltf(make_gltf("MATERIAL_NAME", "\\uDE00")))
+		<< "accepted lone low surrogate!";
+	expect(!fixture.load_gltf(make_gltf("MATERIAL_NAME", "\\uD8")))
+		<< "accepted truncated escape!";
+	expect(!fixture.load_gltf(make_gltf("MATERIAL_NAME", "\\uZZZZ")))
+		<< "accepted invalid hex digits!";
+}
+
+void test_integer_overflow(GltfFixture& fixture)
+{
+	auto rejects = [&fixture](std::string_view from, std::string_view to) {
+		return !fixture.load_gltf(make_gltf(from, to));
+	};
+
+	expect(rejects("\"count\": 3", "\"count\": 4294967296")) << "accepted uint32 overflow!";
+	expect(rejects("\"count\": 3", "\"count\": -1")) << "accepted negative count!";
+	expect(rejects("\"count\": 3", "\"count\": 2.5")) << "accepted fractional count!";
+	expect(rejects("\"count\": 3", "\"count\": 1e300")) << "accepted huge count!";
+	expect(rejects("\"bufferView\": 0", "\"bufferView\": 2147483648"))
+		<< "accepted int32 overflow!";
+	expect(rejects("\"mesh\": 0", "\"mesh\": -2")) << "accepted negative mesh!";
+	expect(rejects("\"count\": 3", "\"byteOffset\": 18014398509481984, \"count\": 3"))
+		<< "accepted integer beyond 2^53!";
+	expect(rejects("\"byteLength\": 44", "\"byteLength\": 18446744073709551616"))
+		<< "accepted uint64 overflow!";
+	expect(rejects("\"nodes\": [ 0 ]", "\"nodes\": [ 4294967296 ]"))
+		<< "accepted scene node overflow!";
+	expect(rejects("\"byteLength\": 36", "\"byteLength\": \"36\""))
+		<< "accepted string as integer!";
+
+	// Offset and length must not wrap around when added
+	expect(rejects("\"byteOffset\": 36", "\"byteOffset\": 9007199254740991"))
+		<< "accepted huge buffer view offset!";
+}
+
+void test_out_of_range(GltfFixture& fixture)
+{
+	auto rejects = [&fixture](std::string_view from, std::string_view to) {
+		return !fixture.load_gltf(make_gltf(from, to));
+	};
+
+	expect(rejects("\"bufferView\": 1", "\"bufferView\": 2")) << "accepted missing buffer view!";
+	expect(rejects("\"buffer\": 0, \"byteOffset\": 36", "\"buffer\": 1, \"byteOffset\": 36"))
+		<< "accepted missing buffer!";
+	expect(rejects("\"byteLength\": 6", "\"byteLength\": 9"))
+		<< "accepted buffer view beyond its buffer!";
+	expect(rejects("\"byteLength\": 44", "\"byteLength\": 45"))
+		<< "accepted buffer larger than its file!";
+	expect(rejects("\"indices\": 1", "\"indices\": 2")) << "accepted missing index accessor!";
+	expect(rejects("\"POSITION\": 0", "\"POSITION\": 7")) << "accepted missing position accessor!";
+	expect(rejects("\"material\": 0", "\"material\": 1")) << "accepted missing material!";
+	expect(rejects("\"mesh\": 0", "\"mesh\": 1")) << "accepted missing mesh!";
+	expect(rejects("\"nodes\": [ 0 ]", "\"nodes\": [ 1 ]")) << "accepted missing scene node!";
+	expect(rejects("\"children\": []", "\"children\": [ 0 ]")) << "accepted node cycle!";
+	expect(rejects("\"componentType\": 5126", "\"componentType\": 5127"))
+		<< "accepted invalid component type!";
+	expect(rejects("\"VEC3\"", "\"VEC5\"")) << "accepted invalid accessor type!";
+	expect(rejects("\"byteOffset\": 0, \"byteLength\": 36",
+	               "\"byteOffset\": 0, \"byteLength\": 36, \"byteStride\": 2"))
+		<< "accepted byte stride below 4!";
+	expect(rejects("\"byteOffset\": 0, \"byteLength\": 36",
+	               "\"byteOffset\": 0, \"byteLength\": 36, \"byteStride\": 4294967292"))
+		<< "accepted byte stride above 252!";
+
+	// Accessors past the end of their buffer view load, but have no data
+	vtek::GltfDocument doc;
+	expect(fixture.load("test.gltf", make_gltf("\"count\": 3", "\"count\": 4"), &doc)) << fatal;
+	uint64_t stride = 0UL;
+	expect(vtek::gltf_get_accessor_data(&doc, doc.accessors[0], &stride) == nullptr)
+		<< "accessor beyond its buffer view has data!";
+	vtek::gltf_release(&doc);
+
+	expect(fixture.load("test.gltf", make_gltf("\"count\": 3", "\"byteOffset\": 4, \"count\": 3"), &doc))
+		<< fatal;
+	expect(vtek::gltf_get_accessor_data(&doc, doc.accessors[0], &stride) == nullptr)
+		<< "offset accessor beyond its buffer view has data!";
+	vtek::gltf_release(&doc);
+}
+
+void test_glb_chunks(GltfFixture& fixture)
+{
+	const std::string json = make_glb_json();
+	const std::string valid = make_glb(json);
+	const int64_t jsonSize = (json.size() + 3) & ~3;
+
+	expect(fixture.load_glb(valid)) << "rejected valid GLB!" << fatal;
+
+	expect(!fixture.load_glb(make_glb(json, { .total = static_cast<int64_t>(valid.size()) + 1 })))
+		<< "accepted total length beyond the file!";
+	expect(!fixture.load_glb(make_glb(json, { .json = static_cast<int64_t>(valid.size()) })))
+		<< "accepted JSON chunk beyond the file!";
+	expect(!fixture.load_glb(make_glb(json, { .json = 0xFFFFFFFF })))
+		<< "accepted JSON chunk length overflow!";
+	expect(!fixture.load_glb(make_glb(json, { .json = jsonSize - 4 })))
+		<< "accepted JSON chunk cutting the JSON short!";
+	expect(!fixture.load_glb(make_glb(json, { .bin = kBufferSize + 1 })))
+		<< "accepted BIN chunk beyond the file!";
+	expect(!fixture.load_glb(make_glb(json, { .bin = 0xFFFFFFFF })))
+		<< "accepted BIN chunk length overflow!";
+	expect(!fixture.load_glb(make_glb(json, { .bin = kBufferSize - 4 })))
+		<< "accepted BIN chunk smaller than the buffer!";
+
+	expect(!fixture.load_glb(valid.substr(0, 16))) << "accepted truncated header!";
+	expect(!fixture.load_glb(valid.substr(0, valid.size() - 4))) << "accepted truncated BIN chunk!";
+
+	std::string version = valid;
+	version[4] = 1;
+	expect(!fixture.load_glb(version)) << "accepted GLB version 1!";
+
+	std::string chunkType = valid;
+	chunkType[16] = 'X';
+	expect(!fixture.load_glb(chunkType)) << "accepted missing JSON chunk!";
+}
+
+
+
+int main()
+{
+	vtek::InitInfo initInfo{};
+	initInfo.disableLogging = true;
+	expect(vtek::initialize(&initInfo)) << "failed to initialize vtek!" << fatal;
+
+	{
+		GltfFixture fixture;
+
+		"gltf_tests"_test = [&fixture]{
+			"valid"_test = [&fixture]{ test_valid(fixture); };
+			"malformed_json"_test = [&fixture]{ test_malformed_json(fixture); };
+			"surrogates"_test = [&fixture]{ test_surrogates(fixture); };
+			"integer_overflow"_test = [&fixture]{ test_integer_overflow(fixture); };
+			"out_of_range"_test = [&fixture]{ test_out_of_range(fixture); };
+			"glb_chunks"_test = [&fixture]{ test_glb_chunks(fixture); };
+		};
+	}
+
+	vtek::terminate();
+}
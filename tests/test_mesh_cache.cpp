@@ -0,0 +1,297 @@
+#include "vtek_vulkan.pch"
+#define VTEK_DISABLE_LOGGING
+#include <vtek/vtek.hpp>
+#include "meshutils/vtek_mesh_cache.hpp"
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#include <boost/ut.hpp>
+using namespace boost::ut;
+
+namespace fs = std::filesystem;
+
+constexpr uint64_t kSourceHash = 0x0123456789abcdefUL;
+constexpr uint64_t kOptionsHash = 0xfedcba9876543210UL;
+constexpr const char* kFilename = "test.vtekmesh";
+
+// Slot contents, with some slots left empty and sizes which are not
+// multiples of the slot alignment.
+struct TestSlots
+{
+	std::vector<std::vector<uint8_t>> data;
+	const void* pointers[vtek::kMeshCacheNumSlots] {};
+	uint64_t sizes[vtek::kMeshCacheNumSlots] {};
+
+	TestSlots()
+	{
+		const uint64_t slotSizes[vtek::kMeshCacheNumSlots] = { 1000, 0, 37, 64, 0, 3 };
+		data.resize(vtek::kMeshCacheNumSlots);
+		for (uint32_t i = 0; i < vtek::kMeshCacheNumSlots; i++)
+		{
+			data[i].resize(slotSizes[i]);
+			for (uint64_t b = 0; b < slotSizes[i]; b++)
+			{
+				data[i][b] = static_cast<uint8_t>(b * 31 + i * 7 + 1);
+			}
+			pointers[i] = data[i].data();
+			sizes[i] = slotSizes[i];
+		}
+	}
+};
+
+vtek::MeshCacheHeader make_header()
+{
+	vtek::MeshCacheHeader header{};
+	header.sourceHash = kSourceHash;
+	header.optionsHash = kOptionsHash;
+	header.numVertices = 123U;
+	header.numIndices = 456U;
+	header.vertexStride = 20U;
+	header.boundsMin[0] = -1.5f;
+	header.boundsMax[2] = 2.5f;
+	return header;
+}
+
+bool write_test_file(const vtek::Directory* dir, const vtek::MeshCacheHeader& header)
+{
+	TestSlots slots;
+	return vtek::mesh_cache_write(dir, kFilename, header, slots.pointers, slots.sizes);
+}
+
+bool can_open(const vtek::Directory* dir, uint64_t sourceHash = kSourceHash,
+              uint64_t optionsHash = kOptionsHash)
+{
+	vtek::MeshCacheHeader header;
+	vtek::FileMapping* mapping = vtek::mesh_cache_open(
+		dir, kFilename, sourceHash, optionsHash, &header);
+	vtek::file_unmap(mapping);
+	return mapping != nullptr;
+}
+
+// Overwrite bytes of the file in place, to simulate corruption
+template<typename T>
+void patch_file(const std::string& path, uint64_t offset, const T& value)
+{
+	std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+	file.seekp(offset);
+	file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+uint32_t count_temp_files(const fs::path& path)
+{
+	uint32_t count = 0U;
+	for (const auto& entry : fs::directory_iterator(path))
+	{
+		if (entry.path().filename().string().find(".tmp") != std::string::npos) { count++; }
+	}
+	return count;
+}
+
+
+
+void test_round_trip(const vtek::Directory* dir)
+{
+	TestSlots slots;
+	expect(vtek::mesh_cache_write(dir, kFilename, make_header(), slots.pointers, slots.sizes))
+		<< "failed to write cache file!" << fatal;
+
+	vtek::MeshCacheHeader header;
+	vtek::FileMapping* mapping = vtek::mesh_cache_open(
+		dir, kFilename, kSourceHash, kOptionsHash, &header);
+	expect(mapping != nullptr) << "failed to open cache file!" << fatal;
+
+	expect(header.version == vtek::kMeshCacheVersion) << "wrong version!";
+	expect(header.numVertices == 123U && header.numIndices == 456U) << "wrong counts!";
+	expect(header.vertexStride == 20U) << "wrong stride!";
+	expect(header.boundsMin[0] == -1.5f && header.boundsMax[2] == 2.5f) << "wrong bounds!";
+
+	const auto data = static_cast<const uint8_t*>(vtek::file_mapping_get_data(mapping));
+	const uint64_t size = vtek::file_mapping_get_size(mapping);
+	for (uint32_t i = 0; i < vtek::kMeshCacheNumSlots; i++)
+	{
+		expect(header.slotSizes[i] == slots.sizes[i]) << "wrong size of slot " << i;
+		if (slots.sizes[i] == 0)
+		{
+			expect(header.slotOffsets[i] == 0UL) << "empty slot " << i << " has an offset!";
+			continue;
+		}
+
+		expect(header.slotOffsets[i] % vtek::kMeshCacheSlotAlignment == 0UL)
+			<< "slot " << i << " is not aligned!";
+		expect(header.slotOffsets[i] >= sizeof(vtek::MeshCacheHeader))
+			<< "slot " << i << " overlaps the header!";
+		expect(header.slotOffsets[i] + header.slotSizes[i] <= size)
+			<< "slot " << i << " is outside the file!" << fatal;
+		expect(std::memcmp(data + header.slotOffsets[i], slots.data[i].data(),
+		                   slots.sizes[i]) == 0)
+			<< "wrong contents of slot " << i;
+	}
+	vtek::file_unmap(mapping);
+
+	expect(count_temp_files(vtek::directory_get_path(dir)) == 0U)
+		<< "temporary file left behind!";
+}
+
+// Readers may have the old file mapped while it is replaced
+void test_overwrite_while_mapped(const vtek::Directory* dir)
+{
+	expect(write_test_file(dir, make_header())) << fatal;
+
+	vtek::MeshCacheHeader oldHeader;
+	vtek::FileMapping* oldMapping = vtek::mesh_cache_open(
+		dir, kFilename, kSourceHash, kOptionsHash, &oldHeader);
+	expect(oldMapping != nullptr) << fatal;
+
+	vtek::MeshCacheHeader header = make_header();
+	header.numVertices = 999U;
+	expect(write_test_file(dir, header)) << "failed to replace mapped file!";
+
+	vtek::MeshCacheHeader newHeader;
+	vtek::FileMapping* newMapping = vtek::mesh_cache_open(
+		dir, kFilename, kSourceHash, kOptionsHash, &newHeader);
+	expect(newMapping != nullptr) << fatal;
+	expect(newHeader.numVertices == 999U) << "new file was not read!";
+
+	vtek::MeshCacheHeader mappedHeader;
+	std::memcpy(&mappedHeader, vtek::file_mapping_get_data(oldMapping), sizeof(mappedHeader));
+	expect(mappedHeader.numVertices == 123U) << "old mapping was modified!";
+
+	vtek::file_unmap(oldMapping);
+	vtek::file_unmap(newMapping);
+}
+
+void test_truncated(const vtek::Directory* dir)
+{
+	const std::string path = vtek::directory_get_path(dir, kFilename);
+
+	// Missing the end of the last slot
+	expect(write_test_file(dir, make_header())) << fatal;
+	fs::resize_file(path, fs::file_size(path) - 1);
+	expect(!can_open(dir)) << "accepted file with truncated slot!";
+
+	// Missing part of the header
+	expect(write_test_file(dir, make_header())) << fatal;
+	fs::resize_file(path, sizeof(vtek::MeshCacheHeader) - 8);
+	expect(!can_open(dir)) << "accepted file with truncated header!";
+
+	// Empty file
+	expect(write_test_file(dir, make_header())) << fatal;
+	fs::resize_file(path, 0);
+	expect(!can_open(dir)) << "accepted empty file!";
+
+	// Missing file
+	fs::remove(path);
+	expect(!can_open(dir)) << "opened missing file!";
+}
+
+void test_corrupted(const vtek::Directory* dir)
+{
+	const std::string path = vtek::directory_get_path(dir, kFilename);
+
+	expect(write_test_file(dir, make_header())) << fatal;
+	patch_file(path, offsetof(vtek::MeshCacheHeader, magic), 'X');
+	expect(!can_open(dir)) << "accepted file with invalid magic!";
+
+	// Slots extending past the end of the file, also when the sum of
+	// offset and size overflows.
+	const uint64_t slotSizes = offsetof(vtek::MeshCacheHeader, slotSizes);
+	const uint64_t slotOffsets = offsetof(vtek::MeshCacheHeader, slotOffsets);
+
+	expect(write_test_file(dir, make_header())) << fatal;
+	patch_file(path, slotSizes + 2 * sizeof(uint64_t), uint64_t{1UL << 20});
+	expect(!can_open(dir)) << "accepted slot size larger than the file!";
+
+	expect(write_test_file(dir, make_header())) << fatal;
+	patch_file(path, slotOffsets + 3 * sizeof(uint64_t), uint64_t{1UL << 40});
+	expect(!can_open(dir)) << "accepted slot offset beyond the file!";
+
+	expect(write_test_file(dir, make_header())) << fatal;
+	patch_file(path, slotSizes, UINT64_MAX);
+	expect(!can_open(dir)) << "accepted overflowing slot size!";
+}
+
+void test_mismatch(const vtek::Directory* dir)
+{
+	const std::string path = vtek::directory_get_path(dir, kFilename);
+
+	vtek::MeshCacheHeader header = make_header();
+	header.version = vtek::kMeshCacheVersion + 1;
+	expect(write_test_file(dir, header)) << fatal;
+	expect(!can_open(dir)) << "accepted newer version!";
+
+	header.version = vtek::kMeshCacheVersion - 1;
+	expect(write_test_file(dir, header)) << fatal;
+	expect(!can_open(dir)) << "accepted older version!";
+
+	// A header layout change without a version bump
+	expect(write_test_file(dir, make_header())) << fatal;
+	patch_file(path, offsetof(vtek::MeshCacheHeader, headerSize),
+	           uint32_t{sizeof(vtek::MeshCacheHeader) - 8});
+	expect(!can_open(dir)) << "accepted wrong header size!";
+
+	expect(write_test_file(dir, make_header())) << fatal;
+	expect(can_open(dir)) << "rejected valid file!";
+	expect(!can_open(dir, kSourceHash + 1, kOptionsHash)) << "accepted stale source!";
+	expect(!can_open(dir, kSourceHash, kOptionsHash + 1)) << "accepted stale options!";
+}
+
+// The rename fails when the target is a non-empty directory, and the
+// temporary file must then be removed.
+void test_failed_rename(const vtek::Directory* dir)
+{
+	const fs::path target = vtek::directory_get_path(dir, kFilename);
+	fs::remove_all(target);
+	fs::create_directory(target);
+	std::ofstream(target / "keep").put('x');
+
+	expect(!write_test_file(dir, make_header())) << "rename over a directory succeeded!";
+	expect(count_temp_files(vtek::directory_get_path(dir)) == 0U)
+		<< "temporary file left behind after failed rename!";
+
+	fs::remove_all(target);
+}
+
+void test_filenames()
+{
+	expect(vtek::mesh_cache_get_filename("model.obj", true, 1UL, 2UL) == "model.obj.vtekmesh");
+	expect(vtek::mesh_cache_get_filename("model.obj", false, 1UL, 2UL)
+	       == "00000000000000010000000000000002.vtekmesh");
+
+	const char text[] = "some source file contents";
+	uint64_t h = vtek::mesh_cache_hash(text, sizeof(text));
+	expect(h == vtek::mesh_cache_hash(text, sizeof(text))) << "hash is not deterministic!";
+	expect(h != vtek::mesh_cache_hash(text, sizeof(text) - 1)) << "size is not hashed!";
+	expect(h != vtek::mesh_cache_hash(text, sizeof(text), 1UL)) << "seed is not hashed!";
+}
+
+
+
+int main()
+{
+	vtek::InitInfo initInfo{};
+	initInfo.disableLogging = true;
+	expect(vtek::initialize(&initInfo)) << "failed to initialize vtek!" << fatal;
+
+	const fs::path tempPath = fs::temp_directory_path() / "vtek_test_mesh_cache";
+	fs::remove_all(tempPath);
+	fs::create_directories(tempPath);
+	vtek::Directory* dir = vtek::directory_open(tempPath.string());
+	expect(dir != nullptr) << "failed to open temp directory!" << fatal;
+
+	"mesh_cache_tests"_test = [dir]{
+		"round_trip"_test = [dir]{ test_round_trip(dir); };
+		"overwrite_while_mapped"_test = [dir]{ test_overwrite_while_mapped(dir); };
+		"truncated"_test = [dir]{ test_truncated(dir); };
+		"corrupted"_test = [dir]{ test_corrupted(dir); };
+		"mismatch"_test = [dir]{ test_mismatch(dir); };
+		"failed_rename"_test = [dir]{ test_failed_rename(dir); };
+		"filenames"_test = []{ test_filenames(); };
+	};
+
+	vtek::directory_close(dir);
+	fs::remove_all(tempPath);
+	vtek::terminate();
+}
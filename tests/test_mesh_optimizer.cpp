@@ -0,0 +1,217 @@
+#include "vtek_vulkan.pch"
+#define VTEK_DISABLE_LOGGING
+#include <vtek/vtek.hpp>
+#include "meshutils/vtek_mesh_optimizer.hpp"
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <random>
+#include <vector>
+
+#include <boost/ut.hpp>
+using namespace boost::ut;
+
+constexpr uint32_t kCacheSize = 16U;
+
+struct TestMesh
+{
+	std::vector<glm::vec3> positions;
+	std::vector<uint32_t> indices;
+};
+
+// UV sphere with outward-facing counter-clockwise triangles. The poles are
+// duplicated per segment, which keeps the indexing simple.
+TestMesh make_sphere(uint32_t rings, uint32_t segments)
+{
+	TestMesh mesh;
+	for (uint32_t r = 0; r <= rings; r++)
+	{
+		float theta = glm::pi<float>() * r / rings;
+		for (uint32_t s = 0; s <= segments; s++)
+		{
+			float phi = 2.0f * glm::pi<float>() * s / segments;
+			mesh.positions.emplace_back(
+				glm::sin(theta) * glm::cos(phi),
+				glm::cos(theta),
+				glm::sin(theta) * glm::sin(phi));
+		}
+	}
+
+	const uint32_t stride = segments + 1;
+	for (uint32_t r = 0; r < rings; r++)
+	{
+		for (uint32_t s = 0; s < segments; s++)
+		{
+			uint32_t i0 = r * stride + s;
+			uint32_t i1 = i0 + 1;
+			uint32_t i2 = i0 + stride;
+			uint32_t i3 = i2 + 1;
+			mesh.indices.insert(mesh.indices.end(), { i0, i1, i2 });
+			mesh.indices.insert(mesh.indices.end(), { i1, i3, i2 });
+		}
+	}
+
+	return mesh;
+}
+
+void shuffle_triangles(std::vector<uint32_t>& indices, uint32_t seed)
+{
+	const uint32_t numTriangles = indices.size() / 3;
+	std::vector<uint32_t> order(numTriangles);
+	for (uint32_t t = 0; t < numTriangles; t++) { order[t] = t; }
+	std::shuffle(order.begin(), order.end(), std::default_random_engine(seed));
+
+	std::vector<uint32_t> shuffled;
+	shuffled.reserve(indices.size());
+	for (uint32_t t : order)
+	{
+		shuffled.insert(shuffled.end(),
+		                indices.begin() + 3 * t, indices.begin() + 3 * t + 3);
+	}
+	indices = shuffled;
+}
+
+// Triangles are compared as a multiset, each rotated so that its smallest
+// index comes first. Rotating keeps the winding, so a flipped triangle will
+// not compare equal.
+using TriangleList = std::vector<std::array<uint32_t, 3>>;
+
+TriangleList sorted_triangles(const std::vector<uint32_t>& indices)
+{
+	TriangleList tris;
+	for (size_t i = 0; i + 2 < indices.size(); i += 3)
+	{
+		std::array<uint32_t, 3> t { indices[i], indices[i + 1], indices[i + 2] };
+		std::rotate(t.begin(), std::min_element(t.begin(), t.end()), t.end());
+		tris.push_back(t);
+	}
+	std::sort(tris.begin(), tris.end());
+	return tris;
+}
+
+bool is_permutation_of(const std::vector<uint32_t>& output, const std::vector<uint32_t>& input)
+{
+	return std::equal_to<TriangleList>{}(sorted_triangles(output), sorted_triangles(input));
+}
+
+float acmr(const std::vector<uint32_t>& indices, uint32_t numVertices)
+{
+	return vtek::mesh_compute_acmr(
+		indices.data(), indices.size(), numVertices, kCacheSize);
+}
+
+
+
+void test_vertex_cache(const std::vector<uint32_t>& input, uint32_t numVertices)
+{
+	std::vector<uint32_t> indices = input;
+	vtek::mesh_optimize_vertex_cache(
+		indices.data(), indices.size(), numVertices, kCacheSize);
+
+	expect(indices.size() == input.size()) << "index count changed!";
+	expect(is_permutation_of(indices, input))
+		<< "output is not a permutation of the input triangles!";
+
+	float before = acmr(input, numVertices);
+	float after = acmr(indices, numVertices);
+	expect(after <= before) << "ACMR got worse: " << before << " -> " << after;
+}
+
+void test_overdraw(const TestMesh& mesh, float threshold)
+{
+	const uint32_t numVertices = mesh.positions.size();
+	std::vector<uint32_t> input = mesh.indices;
+	vtek::mesh_optimize_vertex_cache(
+		input.data(), input.size(), numVertices, kCacheSize);
+
+	std::vector<uint32_t> indices = input;
+	vtek::mesh_optimize_overdraw(
+		indices.data(), indices.size(), mesh.positions.data(), numVertices,
+		kCacheSize, threshold);
+
+	expect(is_permutation_of(indices, input))
+		<< "output is not a permutation of the input triangles!";
+
+	// Clusters are cut where the cache was restarted, or where the local
+	// miss ratio stays within the threshold, so reordering them may only
+	// cost what the threshold allows.
+	float before = acmr(input, numVertices);
+	float after = acmr(indices, numVertices);
+	expect(after <= before * threshold + 0.001f)
+		<< "ACMR exceeded the threshold: " << before << " -> " << after;
+}
+
+void test_vertex_fetch(const std::vector<uint32_t>& input, uint32_t numVertices)
+{
+	// One extra vertex which is never referenced
+	const uint32_t numTotal = numVertices + 1;
+
+	std::vector<uint32_t> indices = input;
+	std::vector<uint32_t> remap;
+	uint32_t numUsed = vtek::mesh_optimize_vertex_fetch(
+		indices.data(), indices.size(), numTotal, remap);
+
+	expect(numUsed == numVertices) << "wrong referenced vertex count: " << numUsed;
+	expect(remap.size() == numTotal) << "remap has wrong size!";
+	expect(remap[numVertices] == UINT32_MAX) << "unreferenced vertex was remapped!";
+
+	bool consistent = true;
+	uint32_t highest = 0U;
+	bool firstUseOrder = true;
+	for (size_t i = 0; i < input.size(); i++)
+	{
+		consistent &= (indices[i] == remap[input[i]]);
+		if (indices[i] > highest + (i == 0 ? 0 : 1)) { firstUseOrder = false; }
+		highest = std::max(highest, indices[i]);
+	}
+	expect(consistent) << "indices do not match the remap table!";
+	expect(firstUseOrder) << "vertices are not numbered in order of first use!";
+
+	// Renaming vertices never changes which accesses hit the cache
+	expect(acmr(indices, numTotal) == acmr(input, numTotal)) << "ACMR changed!";
+}
+
+
+
+int main()
+{
+	const TestMesh sphere = make_sphere(24, 48);
+	const uint32_t numVertices = sphere.positions.size();
+
+	std::vector<uint32_t> shuffled = sphere.indices;
+	shuffle_triangles(shuffled, 1337U);
+
+	"mesh_optimizer_tests"_test = [&]{
+		"vertex_cache"_test = [&]{
+			test_vertex_cache(sphere.indices, numVertices);
+			test_vertex_cache(shuffled, numVertices);
+		};
+
+		"vertex_cache_improves_shuffled"_test = [&]{
+			std::vector<uint32_t> indices = shuffled;
+			vtek::mesh_optimize_vertex_cache(
+				indices.data(), indices.size(), numVertices, kCacheSize);
+			expect(acmr(indices, numVertices) < 1.0f) << "Tipsify ACMR is too high!";
+		};
+
+		"overdraw"_test = [&]{
+			TestMesh mesh = sphere;
+			mesh.indices = shuffled;
+			test_overdraw(mesh, 1.0f);
+			test_overdraw(mesh, 1.05f);
+			test_overdraw(mesh, 1.5f);
+		};
+
+		"vertex_fetch"_test = [&]{
+			test_vertex_fetch(sphere.indices, numVertices);
+			test_vertex_fetch(shuffled, numVertices);
+		};
+
+		"small_inputs"_test = []{
+			std::vector<uint32_t> one { 0, 1, 2 };
+			vtek::mesh_optimize_vertex_cache(one.data(), one.size(), 3, kCacheSize);
+			expect(one[0] == 0U && one[1] == 1U && one[2] == 2U) << "single triangle changed!";
+			expect(vtek::mesh_compute_acmr(nullptr, 0, 0, kCacheSize) == 0.0f);
+		};
+	};
+}
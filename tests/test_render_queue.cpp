@@ -0,0 +1,257 @@
+#include "vtek_vulkan.pch"
+#define VTEK_DISABLE_LOGGING
+#include <vtek/vtek.hpp>
+#include <random>
+#include <vector>
+
+#include <boost/ut.hpp>
+using namespace boost::ut;
+
+// Draws are never recorded, so the pipeline only needs to be non-null
+static int sDummyPipeline = 0;
+vtek::GraphicsPipeline* const kPipeline =
+	reinterpret_cast<vtek::GraphicsPipeline*>(&sDummyPipeline);
+
+uint64_t make_key(uint32_t pass, uint32_t pipeline, uint32_t descriptorSet,
+                  uint32_t material, float depth, bool backToFront = false)
+{
+	vtek::RenderQueueKey key{};
+	key.pass = pass;
+	key.pipeline = pipeline;
+	key.descriptorSet = descriptorSet;
+	key.material = material;
+	key.depth = depth;
+	key.backToFront = backToFront;
+	return vtek::render_queue_make_key(&key);
+}
+
+// Submit one draw per key, tagged with its submission order in
+// `firstInstance`, and check that the sorted order has non-decreasing keys
+// and keeps the submission order of equal keys.
+bool submit_and_check_sorted(const std::vector<uint64_t>& keys)
+{
+	vtek::RenderQueueInfo info{};
+	vtek::RenderQueue* queue = vtek::render_queue_create(&info);
+	expect(queue != nullptr) << "failed to create render queue!" << fatal;
+
+	for (uint32_t i = 0; i < keys.size(); i++)
+	{
+		vtek::RenderQueueDraw draw{};
+		draw.pipeline = kPipeline;
+		draw.firstInstance = i;
+		vtek::render_queue_submit(queue, keys[i], &draw);
+	}
+	expect(vtek::render_queue_get_num_draws(queue) == keys.size()) << "wrong draw count!";
+
+	bool sorted = true;
+	bool stable = true;
+	bool unique = true;
+	std::vector<bool> seen(keys.size(), false);
+	const vtek::RenderQueueDraw* prev = nullptr;
+	for (uint32_t i = 0; i < keys.size(); i++)
+	{
+		const vtek::RenderQueueDraw* draw = vtek::render_queue_get_sorted_draw(queue, i);
+		expect(draw != nullptr) << "missing sorted draw " << i << fatal;
+
+		const uint32_t tag = draw->firstInstance;
+		unique &= !seen[tag];
+		seen[tag] = true;
+
+		if (prev != nullptr)
+		{
+			const uint64_t prevKey = keys[prev->firstInstance];
+			sorted &= (prevKey <= keys[tag]);
+			stable &= (prevKey != keys[tag] || prev->firstInstance < tag);
+		}
+		prev = draw;
+	}
+	expect(vtek::render_queue_get_sorted_draw(queue, keys.size()) == nullptr)
+		<< "draw beyond the end was returned!";
+
+	vtek::render_queue_destroy(queue);
+
+	expect(unique) << "draws were duplicated, count=" << keys.size();
+	expect(sorted) << "draws are not sorted, count=" << keys.size();
+	expect(stable) << "equal keys lost submission order, count=" << keys.size();
+	return unique && sorted && stable;
+}
+
+// Keys drawn from a small set, so that most keys have duplicates. Fields
+// are spread over the whole key, so every radix digit is used, including
+// the top bit.
+std::vector<uint64_t> make_random_keys(uint32_t count, uint32_t numDistinct, uint32_t seed)
+{
+	std::default_random_engine re(seed);
+	std::uniform_int_distribution<uint32_t> id(0U, 4095U);
+	std::uniform_int_distribution<uint32_t> pass(0U, 15U);
+	std::uniform_real_distribution<float> depth(0.0f, 1.0f);
+
+	std::vector<uint64_t> distinct;
+	for (uint32_t i = 0; i < numDistinct; i++)
+	{
+		distinct.push_back(make_key(pass(re), id(re), id(re), id(re), depth(re)));
+	}
+
+	std::uniform_int_distribution<uint32_t> pick(0U, numDistinct - 1);
+	std::vector<uint64_t> keys(count);
+	for (auto& key : keys) { key = distinct[pick(re)]; }
+	return keys;
+}
+
+
+
+void test_key_packing()
+{
+	expect(make_key(0, 0, 0, 0, 0.0f) == 0UL) << "empty key is not zero!";
+	expect(make_key(0xF, 0, 0, 0, 0.0f) == 0xF000000000000000UL) << "wrong pass bits!";
+	expect(make_key(0, 0xFFF, 0, 0, 0.0f) == 0x0FFF000000000000UL) << "wrong pipeline bits!";
+	expect(make_key(0, 0, 0xFFF, 0, 0.0f) == 0x0000FFF000000000UL) << "wrong descriptor set bits!";
+	expect(make_key(0, 0, 0, 0xFFF, 0.0f) == 0x0000000FFF000000UL) << "wrong material bits!";
+	expect(make_key(0, 0, 0, 0, 1.0f) == 0x0000000000FFFFFFUL) << "wrong depth bits!";
+	expect(make_key(0xF, 0xFFF, 0xFFF, 0xFFF, 1.0f) == UINT64_MAX) << "fields overlap!";
+
+	// Values too large for their field are masked, not carried into others
+	expect(make_key(0x1F, 0, 0, 0, 0.0f) == make_key(0xF, 0, 0, 0, 0.0f)) << "pass overflowed!";
+	expect(make_key(0, 0x1001, 0, 0, 0.0f) == make_key(0, 1, 0, 0, 0.0f)) << "pipeline overflowed!";
+	expect(make_key(0, 0, 0x1001, 0, 0.0f) == make_key(0, 0, 1, 0, 0.0f))
+		<< "descriptor set overflowed!";
+	expect(make_key(0, 0, 0, 0x1001, 0.0f) == make_key(0, 0, 0, 1, 0.0f)) << "material overflowed!";
+
+	// Depth is clamped to [0, 1], and inverted for back-to-front sorting
+	expect(make_key(0, 0, 0, 0, -1.0f) == make_key(0, 0, 0, 0, 0.0f)) << "depth not clamped below!";
+	expect(make_key(0, 0, 0, 0, 2.0f) == make_key(0, 0, 0, 0, 1.0f)) << "depth not clamped above!";
+	expect(make_key(0, 0, 0, 0, 0.0f, true) == 0xFFFFFFUL) << "wrong back-to-front near depth!";
+	expect(make_key(0, 0, 0, 0, 1.0f, true) == 0UL) << "wrong back-to-front far depth!";
+
+	for (uint32_t pass = 0; pass < 16; pass++)
+	{
+		uint64_t key = make_key(pass, 0xFFF, 0xFFF, 0xFFF, 1.0f);
+		expect(vtek::render_queue_key_get_pass(key) == pass) << "wrong pass from key: " << pass;
+	}
+}
+
+void test_key_ordering()
+{
+	// Each field outweighs all less significant fields combined
+	expect(make_key(1, 0, 0, 0, 0.0f) > make_key(0, 0xFFF, 0xFFF, 0xFFF, 1.0f))
+		<< "pass does not dominate!";
+	expect(make_key(0, 1, 0, 0, 0.0f) > make_key(0, 0, 0xFFF, 0xFFF, 1.0f))
+		<< "pipeline does not dominate!";
+	expect(make_key(0, 0, 1, 0, 0.0f) > make_key(0, 0, 0, 0xFFF, 1.0f))
+		<< "descriptor set does not dominate!";
+	expect(make_key(0, 0, 0, 1, 0.0f) > make_key(0, 0, 0, 0, 1.0f))
+		<< "material does not dominate!";
+
+	// Front-to-back by default, back-to-front when requested
+	expect(make_key(0, 0, 0, 0, 0.25f) < make_key(0, 0, 0, 0, 0.75f))
+		<< "near draws are not sorted first!";
+	expect(make_key(0, 0, 0, 0, 0.75f, true) < make_key(0, 0, 0, 0, 0.25f, true))
+		<< "far draws are not sorted first!";
+
+	// Nearby depths must not collapse to the same key
+	expect(make_key(0, 0, 0, 0, 0.5f) != make_key(0, 0, 0, 0, 0.5f + 1.0f / 0xFFFFFF))
+		<< "depth precision is below 24 bits!";
+}
+
+void test_submit_invalid()
+{
+	vtek::RenderQueueInfo info{};
+	vtek::RenderQueue* queue = vtek::render_queue_create(&info);
+
+	vtek::RenderQueueDraw draw{};
+	expect(!vtek::render_queue_submit(queue, 0UL, &draw)) << "accepted draw without pipeline!";
+
+	draw.pipeline = kPipeline;
+	draw.numVertexBuffers = vtek::kRenderQueueMaxVertexBuffers + 1;
+	expect(!vtek::render_queue_submit(queue, 0UL, &draw)) << "accepted too many vertex buffers!";
+
+	draw.numVertexBuffers = 0U;
+	draw.pushConstantSize = 16U;
+	expect(!vtek::render_queue_submit(queue, 0UL, &draw)) << "accepted missing push constants!";
+
+	expect(vtek::render_queue_get_num_draws(queue) == 0U) << "invalid draws were added!";
+	expect(vtek::render_queue_get_sorted_draw(queue, 0U) == nullptr) << "empty queue has draws!";
+
+	vtek::render_queue_destroy(queue);
+}
+
+void test_reset()
+{
+	vtek::RenderQueueInfo info{};
+	info.initialCapacity = 4U;
+	vtek::RenderQueue* queue = vtek::render_queue_create(&info);
+
+	vtek::RenderQueueDraw draw{};
+	draw.pipeline = kPipeline;
+	for (uint32_t i = 0; i < 100; i++)
+	{
+		draw.firstInstance = i;
+		vtek::render_queue_submit(queue, 100UL - i, &draw);
+	}
+	expect(vtek::render_queue_get_sorted_draw(queue, 0)->firstInstance == 99U)
+		<< "smallest key is not first!";
+
+	vtek::render_queue_reset(queue);
+	expect(vtek::render_queue_get_num_draws(queue) == 0U) << "reset kept draws!";
+
+	draw.firstInstance = 7U;
+	vtek::render_queue_submit(queue, 5UL, &draw);
+	expect(vtek::render_queue_get_sorted_draw(queue, 0)->firstInstance == 7U)
+		<< "draw from before the reset was returned!";
+
+	vtek::render_queue_destroy(queue);
+}
+
+
+
+int main()
+{
+	"render_queue_tests"_test = []{
+		"key_packing"_test = []{ test_key_packing(); };
+		"key_ordering"_test = []{ test_key_ordering(); };
+		"submit_invalid"_test = []{ test_submit_invalid(); };
+		"reset"_test = []{ test_reset(); };
+
+		// Below and above the threshold where the radix sort takes over
+		"sort_stable"_test = []{
+			for (uint32_t count : { 1U, 2U, 17U, 63U, 64U, 65U, 1000U, 20000U })
+			{
+				for (uint32_t numDistinct : { 1U, 3U, 50U })
+				{
+					submit_and_check_sorted(make_random_keys(count, numDistinct, count + numDistinct));
+				}
+			}
+		};
+
+		// Keys that differ in a single byte, so that all other radix
+		// digits are skipped, and keys that are already sorted.
+		"sort_single_digit"_test = []{
+			for (uint32_t digit = 0; digit < 8; digit++)
+			{
+				std::vector<uint64_t> keys;
+				for (uint32_t i = 0; i < 300; i++)
+				{
+					keys.push_back(uint64_t{(i * 37U) % 5U} << (digit * 8));
+				}
+				submit_and_check_sorted(keys);
+			}
+
+			std::vector<uint64_t> ascending;
+			for (uint32_t i = 0; i < 300; i++) { ascending.push_back(i / 4); }
+			submit_and_check_sorted(ascending);
+		};
+
+		"sort_depth"_test = []{
+			// Transparent draws sorted back-to-front after opaque front-to-back
+			std::vector<uint64_t> keys;
+			std::default_random_engine re(42U);
+			std::uniform_real_distribution<float> depth(0.0f, 1.0f);
+			for (uint32_t i = 0; i < 200; i++)
+			{
+				const bool transparent = (i % 3 == 0);
+				keys.push_back(make_key(transparent ? 1 : 0, 3, 2, 1, depth(re), transparent));
+			}
+			submit_and_check_sorted(keys);
+		};
+	};
+}